@@ -1,11 +1,70 @@
 LOCAL_PATH := $(call my-dir)
 
+# ndk-build UVCC_LOG_LEVEL=<n> keeps only log messages of priority n (ANDROID_LOG_*) or higher.
+UVCC_LOG_CFLAGS :=
+ifdef UVCC_LOG_LEVEL
+UVCC_LOG_CFLAGS += -DUVCC_LOG_LEVEL=$(UVCC_LOG_LEVEL)
+endif
+
+# ndk-build UVCC_USE_NEON=true builds the pixel kernels with NEON on armeabi-v7a.
+UVCC_NEON := $(if $(filter armeabi-v7a-true,$(TARGET_ARCH_ABI)-$(UVCC_USE_NEON)),true,false)
+
+# Scheduling and memory locking of the threads owned by uvccap and cconv.
+include $(CLEAR_VARS)
+
+LOCAL_MODULE           := uvccthread
+LOCAL_CFLAGS           := -Wall -Werror -O2
+LOCAL_SRC_FILES        := uvccthread.c
+LOCAL_EXPORT_C_INCLUDES := $(LOCAL_PATH)
+
+include $(BUILD_STATIC_LIBRARY)
+
+
+# Copies out of capture buffers, for uvccap and the publishing side of uvccshm.
+include $(CLEAR_VARS)
+
+LOCAL_MODULE           := uvcccopy
+LOCAL_CFLAGS           := -Wall -Werror -O2
+LOCAL_EXPORT_C_INCLUDES := $(LOCAL_PATH)
+
+ifeq ($(UVCC_NEON),true)
+LOCAL_SRC_FILES        := uvcccopy.c.neon
+else
+LOCAL_SRC_FILES        := uvcccopy.c
+endif
+
+include $(BUILD_STATIC_LIBRARY)
+
+
+# Shared frame ring, its reader side also serves processes that do not capture.
+include $(CLEAR_VARS)
+
+LOCAL_MODULE           := uvccshm
+LOCAL_CFLAGS           := -Wall -Werror -O2
+LOCAL_SRC_FILES        := uvccshm.c
+LOCAL_EXPORT_C_INCLUDES := $(LOCAL_PATH)
+# uvcc_shm_publish copies frames with uvcc_copy.
+LOCAL_STATIC_LIBRARIES := uvcccopy
+
+include $(BUILD_STATIC_LIBRARY)
+
+
 include $(CLEAR_VARS)
 
 LOCAL_MODULE    := uvccap
-LOCAL_CFLAGS    := -Wall -Werror -O2
-LOCAL_SRC_FILES := uvccap.c uvccap_jni.c
+LOCAL_CFLAGS    := -Wall -Werror -O2 $(UVCC_LOG_CFLAGS)
+# uvccap.h, and the header-only C++ layer uvccap.hpp (C++11).
+LOCAL_EXPORT_C_INCLUDES := $(LOCAL_PATH)
+LOCAL_SRC_FILES := uvccap.c uvccap_jni.c uvcctrace.c uvcccache.c uvccpump.c uvccpump_jni.c uvccshm_jni.c \
+                   uvccgroup.c uvccgroup_jni.c uvccthread_jni.c
 LOCAL_LDLIBS    += -llog
+LOCAL_STATIC_LIBRARIES := uvccshm uvcccopy uvccthread
+
+ifeq ($(UVCC_NEON),true)
+LOCAL_SRC_FILES += uvccstats.c.neon
+else
+LOCAL_SRC_FILES += uvccstats.c
+endif
 
 include $(BUILD_SHARED_LIBRARY)
 
@@ -14,7 +73,26 @@ include $(CLEAR_VARS)
 
 LOCAL_MODULE    := cconv
 LOCAL_CFLAGS    := -Wall -Werror -O2
-LOCAL_SRC_FILES := colorconv.c
-LOCAL_LDLIBS    += -llog
+LOCAL_SRC_FILES := colorconv.c jpegtab.c mjpegdec.c mjpegdec_jni.c lossless_jni.c \
+                   scaler_jni.c jpegenc_jni.c
+LOCAL_LDLIBS    += -llog -lm
+LOCAL_STATIC_LIBRARIES := uvccthread
+
+ifeq ($(UVCC_NEON),true)
+LOCAL_SRC_FILES += cconv.c.neon scaler.c.neon jpegenc.c.neon lossless.c.neon
+else
+LOCAL_SRC_FILES += cconv.c scaler.c jpegenc.c lossless.c
+endif
+
+# ndk-build UVCC_USE_LIBJPEG_TURBO=true decodes MJPEG to RGBA and encodes snapshots
+# with libjpeg-turbo (1.4 or later, for its YUV planes interface).
+ifeq ($(UVCC_USE_LIBJPEG_TURBO),true)
+LOCAL_CFLAGS           += -DUVCC_USE_LIBJPEG_TURBO
+LOCAL_STATIC_LIBRARIES += libjpeg-turbo
+endif
 
 include $(BUILD_SHARED_LIBRARY)
+
+ifeq ($(UVCC_USE_LIBJPEG_TURBO),true)
+$(call import-module,libjpeg-turbo)
+endif
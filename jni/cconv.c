@@ -0,0 +1,277 @@
+#include "cconv.h"
+#include <stddef.h>
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define CCONV_NEON 1
+#endif
+
+// rotated output is converted in tiles of TILE x TILE source pixels.
+#define TILE 16
+
+static int32_t clamp(int32_t value, int32_t min, int32_t max)
+{
+	return (value < min) ? min : (value > max) ? max : value;
+}
+
+static inline uint32_t yuv2rgba(uint8_t y, uint8_t u, uint8_t v)
+{
+	int const iy = 1192 * clamp(y - 16, 0, 255);
+	int const iu = u - 128;
+	int const iv = v - 128;
+
+	int32_t const r = clamp(iy + 1634 * iv +    0 * iu, 0, 262143);
+	int32_t const g = clamp(iy -  833 * iv -  400 * iu, 0, 262143);
+	int32_t const b = clamp(iy +    0 * iv + 2066 * iu, 0, 262143);
+
+	return 0xff000000 | ((r << 6) & 0xff0000) | ((g >> 2) & 0xff00) | ((b >> 10) & 0xff);
+}
+
+static inline uint32_t jfif2rgba(uint8_t y, uint8_t u, uint8_t v)
+{
+	int const iy = 1024 * y;
+	int const iu = u - 128;
+	int const iv = v - 128;
+
+	int32_t const r = clamp(iy + 1436 * iv +    0 * iu + 512, 0, 262143);
+	int32_t const g = clamp(iy -  731 * iv -  352 * iu + 512, 0, 262143);
+	int32_t const b = clamp(iy +    0 * iv + 1815 * iu + 512, 0, 262143);
+
+	return 0xff000000 | ((r << 6) & 0xff0000) | ((g >> 2) & 0xff00) | ((b >> 10) & 0xff);
+}
+
+void cconv_yuyv_to_rgba(uint8_t *rgba, int rgba_stride, uint8_t const *yuyv, int yuyv_stride, int width, int height)
+{
+	int x, y;
+	int const w = width / 2;
+
+	for (y = 0; y < height; ++y) {
+		uint32_t *dst = (uint32_t*)(rgba + y * rgba_stride);
+		uint8_t const *src = yuyv + y * yuyv_stride;
+
+		for (x = 0; x < w; ++x) {
+			uint8_t y1 = src[0];
+			uint8_t u1 = src[1];
+			uint8_t y2 = src[2];
+			uint8_t v1 = src[3];
+
+			dst[0] = yuv2rgba(y1, u1, v1);
+			dst[1] = yuv2rgba(y2, u1, v1);
+			src += 4;
+			dst += 2;
+		}
+	}
+}
+
+/* Convert a TILE x TILE block of YUYV, walking the output in the direction it is laid out. */
+static void yuyv_tile_to_rgba(uint8_t *dst, ptrdiff_t step_x, ptrdiff_t step_y,
+	uint8_t const *src, int src_stride, int width, int height)
+{
+	int x, y;
+
+	if ((4 == step_x) || (-4 == step_x)) {
+		// source rows stay output rows.
+		for (y = 0; y < height; ++y) {
+			uint8_t *d = dst + y * step_y;
+			uint8_t const *s = src + y * src_stride;
+			for (x = 0; x < width; x += 2) {
+				*(uint32_t*)d            = yuv2rgba(s[0], s[1], s[3]);
+				*(uint32_t*)(d + step_x) = yuv2rgba(s[2], s[1], s[3]);
+				d += 2 * step_x;
+				s += 4;
+			}
+		}
+	} else {
+		// source columns become output rows, each is written in one go.
+		for (x = 0; x < width; x += 2) {
+			uint8_t *d0 = dst + x * step_x;
+			uint8_t *d1 = d0 + step_x;
+			uint8_t const *s = src + x * 2;
+			for (y = 0; y < height; ++y) {
+				*(uint32_t*)d0 = yuv2rgba(s[0], s[1], s[3]);
+				*(uint32_t*)d1 = yuv2rgba(s[2], s[1], s[3]);
+				d0 += step_y;
+				d1 += step_y;
+				s += src_stride;
+			}
+		}
+	}
+}
+
+void cconv_yuyv_to_rgba_transformed(uint8_t *rgba, int rgba_stride, uint8_t const *yuyv, int yuyv_stride,
+	int width, int height, cconv_rotation_t rotation, int flip)
+{
+	ptrdiff_t step_x, step_y, origin;
+	int transposed;
+	int i, j, tx, ty, w, h;
+
+	if ((CCONV_ROTATE_0 == rotation) && (0 == flip)) {
+		cconv_yuyv_to_rgba(rgba, rgba_stride, yuyv, yuyv_stride, width, height);
+		return;
+	}
+
+	/*
+	 * Where the source origin lands in the output and where a step along
+	 * a source row (x) and column (y) moves, as (column, row). Mirroring
+	 * of the source then swaps the ends of the flipped axes.
+	 */
+	{
+		int const w1 = width - 1;
+		int const h1 = height - 1;
+		int ox, oy, xx, xy, yx, yy;
+
+		switch (rotation) {
+		case CCONV_ROTATE_90:
+			ox = h1; oy = 0;  xx = 0;  xy = 1;  yx = -1; yy = 0;
+			break;
+		case CCONV_ROTATE_180:
+			ox = w1; oy = h1; xx = -1; xy = 0;  yx = 0;  yy = -1;
+			break;
+		case CCONV_ROTATE_270:
+			ox = 0;  oy = w1; xx = 0;  xy = -1; yx = 1;  yy = 0;
+			break;
+		default:
+			ox = 0;  oy = 0;  xx = 1;  xy = 0;  yx = 0;  yy = 1;
+			break;
+		}
+		if (0 != (flip & CCONV_FLIP_HORIZONTAL)) {
+			ox += xx * w1; oy += xy * w1; xx = -xx; xy = -xy;
+		}
+		if (0 != (flip & CCONV_FLIP_VERTICAL)) {
+			ox += yx * h1; oy += yy * h1; yx = -yx; yy = -yy;
+		}
+		step_x = xx * 4 + xy * (ptrdiff_t)rgba_stride;
+		step_y = yx * 4 + yy * (ptrdiff_t)rgba_stride;
+		origin = ox * 4 + oy * (ptrdiff_t)rgba_stride;
+		transposed = (0 != xy);
+	}
+
+	/*
+	 * Tiles are visited so that the output is filled row by row: across
+	 * the source for plain flips, down the source columns when the image
+	 * is turned by 90 or 270 degrees. The rows of a tile are then written
+	 * as TILE sequential streams.
+	 */
+	for (i = 0; i < (transposed ? width : height); i += TILE) {
+		for (j = 0; j < (transposed ? height : width); j += TILE) {
+			tx = transposed ? i : j;
+			ty = transposed ? j : i;
+			w = (width  - tx < TILE) ? width  - tx : TILE;
+			h = (height - ty < TILE) ? height - ty : TILE;
+			yuyv_tile_to_rgba(rgba + origin + tx * step_x + ty * step_y, step_x, step_y,
+				yuyv + ty * yuyv_stride + tx * 2, yuyv_stride, w, h);
+		}
+	}
+}
+
+void cconv_yuv_planar_to_rgba(uint8_t *rgba, int rgba_stride,
+	uint8_t const * const planes[3], int const strides[3], int hshift, int vshift,
+	int width, int height, cconv_matrix_t matrix)
+{
+	int x, y;
+
+	for (y = 0; y < height; ++y) {
+		uint32_t *dst = (uint32_t*)(rgba + y * rgba_stride);
+		uint8_t const *py = planes[0] + y * strides[0];
+		uint8_t const *pu = planes[1] + (y >> vshift) * strides[1];
+		uint8_t const *pv = planes[2] + (y >> vshift) * strides[2];
+
+		if (CCONV_MATRIX_JFIF == matrix) {
+			for (x = 0; x < width; ++x) {
+				dst[x] = jfif2rgba(py[x], pu[x >> hshift], pv[x >> hshift]);
+			}
+		} else {
+			for (x = 0; x < width; ++x) {
+				dst[x] = yuv2rgba(py[x], pu[x >> hshift], pv[x >> hshift]);
+			}
+		}
+	}
+}
+
+/*
+ * One output row of luma from each of two packed rows, and their averaged
+ * chroma. 'u' and 'v' point into the same row with a step of 2 for NV12
+ * and NV21. 's0' and 's1' are the same row for an odd last row.
+ */
+static void packed_rows_to_planar(uint8_t const *s0, uint8_t const *s1, int luma,
+	uint8_t *y0, uint8_t *y1, uint8_t *u, uint8_t *v, int chroma_step, int pairs)
+{
+	int const chroma = 1 - luma;
+	int x = 0;
+
+#ifdef CCONV_NEON
+	// 16 pixel pairs at a time: vld4 splits them into Y0, U, Y1 and V (YUYV).
+	for (; x + 16 <= pairs; x += 16) {
+		uint8x16x4_t const a = vld4q_u8(s0 + x * 4);
+		uint8x16x4_t const b = vld4q_u8(s1 + x * 4);
+		uint8x16x2_t ya, yb;
+		uint8x16_t cu, cv;
+
+		ya.val[0] = a.val[luma];
+		ya.val[1] = a.val[luma + 2];
+		yb.val[0] = b.val[luma];
+		yb.val[1] = b.val[luma + 2];
+		vst2q_u8(y0 + x * 2, ya);
+		vst2q_u8(y1 + x * 2, yb);
+
+		cu = vrhaddq_u8(a.val[chroma], b.val[chroma]);
+		cv = vrhaddq_u8(a.val[chroma + 2], b.val[chroma + 2]);
+		if (1 == chroma_step) {
+			vst1q_u8(u + x, cu);
+			vst1q_u8(v + x, cv);
+		} else {
+			uint8x16x2_t uv;
+			// u and v are adjacent, the lower address comes first.
+			uv.val[0] = (u < v) ? cu : cv;
+			uv.val[1] = (u < v) ? cv : cu;
+			vst2q_u8(((u < v) ? u : v) + x * 2, uv);
+		}
+	}
+#endif
+	for (; x < pairs; ++x) {
+		uint8_t const *a = s0 + x * 4;
+		uint8_t const *b = s1 + x * 4;
+		y0[x * 2]     = a[luma];
+		y0[x * 2 + 1] = a[luma + 2];
+		y1[x * 2]     = b[luma];
+		y1[x * 2 + 1] = b[luma + 2];
+		u[x * chroma_step] = (uint8_t)((a[chroma] + b[chroma] + 1) >> 1);
+		v[x * chroma_step] = (uint8_t)((a[chroma + 2] + b[chroma + 2] + 1) >> 1);
+	}
+}
+
+void cconv_packed_to_planar(uint8_t const *src, int src_stride, cconv_packed_format_t src_format,
+	uint8_t * const planes[3], int const strides[3], cconv_planar_format_t dst_format, int width, int height)
+{
+	int const luma = (CCONV_PACKED_UYVY == src_format) ? 1 : 0;
+	int const pairs = width / 2;
+	uint8_t *u, *v;
+	int u_stride, v_stride, chroma_step;
+	int y;
+
+	switch (dst_format) {
+	case CCONV_PLANAR_NV12:
+	case CCONV_PLANAR_NV21:
+		u = planes[1] + ((CCONV_PLANAR_NV21 == dst_format) ? 1 : 0);
+		v = planes[1] + ((CCONV_PLANAR_NV21 == dst_format) ? 0 : 1);
+		u_stride = v_stride = strides[1];
+		chroma_step = 2;
+		break;
+	default:
+		u = planes[1];
+		v = planes[2];
+		u_stride = strides[1];
+		v_stride = strides[2];
+		chroma_step = 1;
+		break;
+	}
+
+	for (y = 0; y < height; y += 2) {
+		uint8_t const *s0 = src + y * src_stride;
+		uint8_t const *s1 = (y + 1 < height) ? s0 + src_stride : s0;
+		uint8_t *y0 = planes[0] + y * strides[0];
+		uint8_t *y1 = (y + 1 < height) ? y0 + strides[0] : y0;
+
+		packed_rows_to_planar(s0, s1, luma, y0, y1, u + (y / 2) * u_stride, v + (y / 2) * v_stride, chroma_step, pairs);
+	}
+}
@@ -0,0 +1,69 @@
+#ifndef CCONV_H
+#define CCONV_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Color conversion kernels shared by the JNI bindings and the decoders.
+ * RGBA output is written as one native-endian 0xAARRGGBB word per pixel
+ * (the layout of Java's int[] pixels), strides are given in bytes.
+ */
+
+typedef enum cconv_matrix_t {
+	CCONV_MATRIX_BT601 = 0, // limited range, as delivered by UVC YUV formats.
+	CCONV_MATRIX_JFIF,      // full range, as used by JPEG.
+} cconv_matrix_t;
+
+/* Clockwise rotation of the output. */
+typedef enum cconv_rotation_t {
+	CCONV_ROTATE_0 = 0,
+	CCONV_ROTATE_90,
+	CCONV_ROTATE_180,
+	CCONV_ROTATE_270,
+} cconv_rotation_t;
+
+#define CCONV_FLIP_HORIZONTAL 0x01
+#define CCONV_FLIP_VERTICAL   0x02
+
+extern void cconv_yuyv_to_rgba(uint8_t *rgba, int rgba_stride, uint8_t const *yuyv, int yuyv_stride, int width, int height);
+/*
+ * cconv_yuyv_to_rgba that mirrors the image by 'flip' (CCONV_FLIP_*) and
+ * then rotates it. 'width' and 'height' are those of the source, the
+ * output is height x width for 90 and 270 degrees.
+ */
+extern void cconv_yuyv_to_rgba_transformed(uint8_t *rgba, int rgba_stride, uint8_t const *yuyv, int yuyv_stride,
+	int width, int height, cconv_rotation_t rotation, int flip);
+/* Layouts of cconv_packed_to_planar. */
+typedef enum cconv_packed_format_t {
+	CCONV_PACKED_YUYV = 0,
+	CCONV_PACKED_UYVY,
+} cconv_packed_format_t;
+
+typedef enum cconv_planar_format_t {
+	CCONV_PLANAR_I420 = 0, // Y, U and V planes.
+	CCONV_PLANAR_NV12,     // Y and interleaved UV.
+	CCONV_PLANAR_NV21,     // Y and interleaved VU.
+} cconv_planar_format_t;
+
+/*
+ * Repack 4:2:2 YUYV or UYVY into 4:2:0 planes, the chroma of each pair of
+ * rows is averaged (rounded up). No color conversion takes place, the
+ * samples keep their range. 'width' has to be even; an odd last row takes
+ * its chroma as is.
+ */
+extern void cconv_packed_to_planar(uint8_t const *src, int src_stride, cconv_packed_format_t src_format,
+	uint8_t * const planes[3], int const strides[3], cconv_planar_format_t dst_format, int width, int height);
+
+extern void cconv_yuv_planar_to_rgba(uint8_t *rgba, int rgba_stride,
+	uint8_t const * const planes[3], int const strides[3], int hshift, int vshift,
+	int width, int height, cconv_matrix_t matrix);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
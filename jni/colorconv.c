@@ -1,61 +1,236 @@
 #include "colorconv.h"
+#include "cconv.h"
 #include <stdint.h>
 
 static void throw_IllegalArgumentException(JNIEnv *env, char const * const message);
 static void throw_NullPointerException(JNIEnv *env, char const * const message);
 
-static uint32_t yuv2rgba(uint8_t y, uint8_t u, uint8_t v);
-
 /*
  * Class:     net_crimsonwoods_android_libs_uvccap_ColorConverter
- * Method:    yuyvtorgb
- * Signature: ([I[BII)V
+ * Method:    n_yuyvtorgb
+ * Signature: ([II[BIII)V
  */
-JNIEXPORT void JNICALL Java_net_crimsonwoods_android_libs_uvccap_ColorConverter_yuyvtorgb
-  (JNIEnv *env, jclass cls, jintArray rgba, jbyteArray yuyv, jint width, jint height)
+JNIEXPORT void JNICALL Java_net_crimsonwoods_android_libs_uvccap_ColorConverter_n_1yuyvtorgb
+  (JNIEnv *env, jclass cls, jintArray rgba, jint rgba_stride, jbyteArray yuyv, jint yuyv_stride, jint width, jint height)
 {
 	jbyte *yuyv_ptr = NULL;
 	jint  *rgba_ptr = NULL;
-	jboolean is_yuyv_copy = JNI_FALSE;
-	jboolean is_rgba_copy = JNI_FALSE;
-	int x, y;
-	int const w = width / 2;
-	int const h = height;
-	uint32_t yuyv_ofst = 0;
-	uint32_t rgba_ofst = 0;
 
-	if (NULL == rgba) {
-		throw_NullPointerException(env, "'rgba' have to be set not null.");
+	if ((NULL == rgba) || (NULL == yuyv)) {
+		throw_NullPointerException(env, "'rgba' and 'yuyv' have to be set not null.");
 		return;
 	}
 
-	if (NULL == yuyv) {
-		throw_NullPointerException(env, "'yuyv' have to be set not null.");
+	if ((0 != (width & 0x01)) || (width < 0) || (height < 0)) {
+		throw_IllegalArgumentException(env, "'width' have to be even number.");
+		return;
+	}
+	if ((rgba_stride < width * 4) || (0 != (rgba_stride & 0x03)) || (yuyv_stride < width * 2)) {
+		throw_IllegalArgumentException(env, "Strides are shorter than a row.");
+		return;
+	}
+	if (0 == height) {
+		return;
+	}
+	// the last row does not need its padding.
+	if (((jlong)(*env)->GetArrayLength(env, rgba) * 4 < (jlong)rgba_stride * (height - 1) + width * 4) ||
+	    ((jlong)(*env)->GetArrayLength(env, yuyv) < (jlong)yuyv_stride * (height - 1) + width * 2)) {
+		throw_IllegalArgumentException(env, "Arrays are too small.");
 		return;
 	}
 
-	if (0 != (width & 0x01)) {
+	// a whole frame is converted, far too long to hold the arrays in a critical region.
+	rgba_ptr = (*env)->GetIntArrayElements(env, rgba, NULL);
+	if (NULL == rgba_ptr) {
+		return;
+	}
+	yuyv_ptr = (*env)->GetByteArrayElements(env, yuyv, NULL);
+	if (NULL == yuyv_ptr) {
+		(*env)->ReleaseIntArrayElements(env, rgba, rgba_ptr, JNI_ABORT);
+		return;
+	}
+
+	cconv_yuyv_to_rgba((uint8_t*)rgba_ptr, rgba_stride, (uint8_t const*)yuyv_ptr, yuyv_stride, width, height);
+
+	(*env)->ReleaseByteArrayElements(env, yuyv, yuyv_ptr, JNI_ABORT);
+	(*env)->ReleaseIntArrayElements(env, rgba, rgba_ptr, 0);
+}
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_ColorConverter
+ * Method:    n_yuyvtorgbDirect
+ * Signature: (Ljava/nio/ByteBuffer;ILjava/nio/ByteBuffer;III)V
+ */
+JNIEXPORT void JNICALL Java_net_crimsonwoods_android_libs_uvccap_ColorConverter_n_1yuyvtorgbDirect
+  (JNIEnv *env, jclass cls, jobject rgba, jint rgba_stride, jobject yuyv, jint yuyv_stride, jint width, jint height)
+{
+	void *rgba_ptr = NULL;
+	void *yuyv_ptr = NULL;
+
+	if ((NULL == rgba) || (NULL == yuyv)) {
+		throw_NullPointerException(env, "'rgba' and 'yuyv' have to be set not null.");
+		return;
+	}
+
+	if ((0 != (width & 0x01)) || (width < 0) || (height < 0)) {
 		throw_IllegalArgumentException(env, "'width' have to be even number.");
 		return;
 	}
+	if ((rgba_stride < width * 4) || (yuyv_stride < width * 2)) {
+		throw_IllegalArgumentException(env, "Strides are shorter than a row.");
+		return;
+	}
+	if (0 == height) {
+		return;
+	}
+
+	rgba_ptr = (*env)->GetDirectBufferAddress(env, rgba);
+	yuyv_ptr = (*env)->GetDirectBufferAddress(env, yuyv);
+	if ((NULL == rgba_ptr) || (NULL == yuyv_ptr)) {
+		throw_IllegalArgumentException(env, "Buffers have to be direct.");
+		return;
+	}
+	// the last row does not need its padding.
+	if (((*env)->GetDirectBufferCapacity(env, rgba) < (jlong)rgba_stride * (height - 1) + width * 4) ||
+	    ((*env)->GetDirectBufferCapacity(env, yuyv) < (jlong)yuyv_stride * (height - 1) + width * 2)) {
+		throw_IllegalArgumentException(env, "Buffers are too small.");
+		return;
+	}
+
+	cconv_yuyv_to_rgba((uint8_t*)rgba_ptr, rgba_stride, (uint8_t const*)yuyv_ptr, yuyv_stride, width, height);
+}
 
-	rgba_ptr = (*env)->GetPrimitiveArrayCritical(env, rgba, &is_rgba_copy);
-	yuyv_ptr = (*env)->GetPrimitiveArrayCritical(env, yuyv, &is_yuyv_copy);
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_ColorConverter
+ * Method:    n_yuyvtorgbTransformed
+ * Signature: (Ljava/nio/ByteBuffer;ILjava/nio/ByteBuffer;IIIII)V
+ */
+JNIEXPORT void JNICALL Java_net_crimsonwoods_android_libs_uvccap_ColorConverter_n_1yuyvtorgbTransformed
+  (JNIEnv *env, jclass cls, jobject rgba, jint rgba_stride, jobject yuyv, jint yuyv_stride, jint width, jint height, jint rotation, jint flip)
+{
+	void *rgba_ptr = NULL;
+	void *yuyv_ptr = NULL;
+	int out_width, out_height;
 
-	for (y = 0; y < h; ++y) {
-		for (x = 0; x < w; ++x) {
-			uint8_t y1 = yuyv_ptr[yuyv_ofst++];
-			uint8_t u1 = yuyv_ptr[yuyv_ofst++];
-			uint8_t y2 = yuyv_ptr[yuyv_ofst++];
-			uint8_t v1 = yuyv_ptr[yuyv_ofst++];
+	if ((NULL == rgba) || (NULL == yuyv)) {
+		throw_NullPointerException(env, "'rgba' and 'yuyv' have to be set not null.");
+		return;
+	}
 
-			rgba_ptr[rgba_ofst++] = yuv2rgba(y1, u1, v1);
-			rgba_ptr[rgba_ofst++] = yuv2rgba(y2, u1, v1);
+	if ((0 != (width & 0x01)) || (width < 0) || (height < 0)) {
+		throw_IllegalArgumentException(env, "'width' have to be even number.");
+		return;
+	}
+	if ((rotation < CCONV_ROTATE_0) || (rotation > CCONV_ROTATE_270) ||
+		(0 != (flip & ~(CCONV_FLIP_HORIZONTAL | CCONV_FLIP_VERTICAL)))) {
+		throw_IllegalArgumentException(env, "'rotation' or 'flip' is invalid.");
+		return;
+	}
+	out_width  = (0 != (rotation & 1)) ? height : width;
+	out_height = (0 != (rotation & 1)) ? width : height;
+	if ((rgba_stride < out_width * 4) || (yuyv_stride < width * 2)) {
+		throw_IllegalArgumentException(env, "Strides are shorter than a row.");
+		return;
+	}
+	if ((0 == width) || (0 == height)) {
+		return;
+	}
+
+	rgba_ptr = (*env)->GetDirectBufferAddress(env, rgba);
+	yuyv_ptr = (*env)->GetDirectBufferAddress(env, yuyv);
+	if ((NULL == rgba_ptr) || (NULL == yuyv_ptr)) {
+		throw_IllegalArgumentException(env, "Buffers have to be direct.");
+		return;
+	}
+	if (((*env)->GetDirectBufferCapacity(env, rgba) < (jlong)rgba_stride * (out_height - 1) + out_width * 4) ||
+	    ((*env)->GetDirectBufferCapacity(env, yuyv) < (jlong)yuyv_stride * (height - 1) + width * 2)) {
+		throw_IllegalArgumentException(env, "Buffers are too small.");
+		return;
+	}
+
+	cconv_yuyv_to_rgba_transformed((uint8_t*)rgba_ptr, rgba_stride, (uint8_t const*)yuyv_ptr, yuyv_stride,
+		width, height, (cconv_rotation_t)rotation, flip);
+}
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_ColorConverter
+ * Method:    n_packedToPlanar
+ * Signature: (Ljava/nio/ByteBuffer;II[Ljava/nio/ByteBuffer;[IIII)V
+ */
+JNIEXPORT void JNICALL Java_net_crimsonwoods_android_libs_uvccap_ColorConverter_n_1packedToPlanar
+  (JNIEnv *env, jclass cls, jobject src, jint src_stride, jint src_format, jobjectArray dst, jintArray dst_strides, jint dst_format, jint width, jint height)
+{
+	uint8_t *planes[3] = { NULL, NULL, NULL };
+	int strides[3] = { 0, 0, 0 };
+	int row_bytes[3];
+	int rows[3];
+	void *src_ptr;
+	int count;
+	int i;
+
+	if ((NULL == src) || (NULL == dst) || (NULL == dst_strides)) {
+		throw_NullPointerException(env, "'src', 'planes' and 'strides' have to be set not null.");
+		return;
+	}
+	if ((0 != (width & 0x01)) || (width < 0) || (height < 0)) {
+		throw_IllegalArgumentException(env, "'width' have to be even number.");
+		return;
+	}
+	if ((CCONV_PACKED_YUYV != src_format) && (CCONV_PACKED_UYVY != src_format)) {
+		throw_IllegalArgumentException(env, "Unsupported source format.");
+		return;
+	}
+	if ((0 == width) || (0 == height)) {
+		return;
+	}
+
+	row_bytes[0] = width;
+	rows[0] = height;
+	rows[1] = rows[2] = (height + 1) / 2;
+	switch (dst_format) {
+	case CCONV_PLANAR_I420:
+		count = 3;
+		row_bytes[1] = row_bytes[2] = width / 2;
+		break;
+	case CCONV_PLANAR_NV12:
+	case CCONV_PLANAR_NV21:
+		count = 2;
+		row_bytes[1] = width;
+		break;
+	default:
+		throw_IllegalArgumentException(env, "Unsupported destination format.");
+		return;
+	}
+
+	src_ptr = (*env)->GetDirectBufferAddress(env, src);
+	if ((NULL == src_ptr) || (src_stride < width * 2) ||
+		((*env)->GetDirectBufferCapacity(env, src) < (jlong)src_stride * (height - 1) + width * 2)) {
+		throw_IllegalArgumentException(env, "'src' is not a direct buffer large enough for the frame.");
+		return;
+	}
+	if (((*env)->GetArrayLength(env, dst) < count) || ((*env)->GetArrayLength(env, dst_strides) < count)) {
+		throw_IllegalArgumentException(env, "'planes' and 'strides' have to hold every plane.");
+		return;
+	}
+	(*env)->GetIntArrayRegion(env, dst_strides, 0, count, strides);
+	for (i = 0; i < count; ++i) {
+		jobject plane = (*env)->GetObjectArrayElement(env, dst, i);
+		if (NULL == plane) {
+			throw_NullPointerException(env, "'planes' have to be set not null.");
+			return;
+		}
+		planes[i] = (uint8_t*)(*env)->GetDirectBufferAddress(env, plane);
+		jlong const capacity = (*env)->GetDirectBufferCapacity(env, plane);
+		(*env)->DeleteLocalRef(env, plane);
+		if ((NULL == planes[i]) || (strides[i] < row_bytes[i]) ||
+			(capacity < (jlong)strides[i] * (rows[i] - 1) + row_bytes[i])) {
+			throw_IllegalArgumentException(env, "A plane is not a direct buffer large enough for the frame.");
+			return;
 		}
 	}
 
-	(*env)->ReleasePrimitiveArrayCritical(env, yuyv, yuyv_ptr, (JNI_FALSE != is_yuyv_copy) ? JNI_COMMIT : 0);
-	(*env)->ReleasePrimitiveArrayCritical(env, rgba, rgba_ptr, (JNI_FALSE != is_rgba_copy) ? JNI_COMMIT : 0);
+	cconv_packed_to_planar((uint8_t const*)src_ptr, src_stride, (cconv_packed_format_t)src_format,
+		planes, strides, (cconv_planar_format_t)dst_format, width, height);
 }
 
 static void throw_exception(JNIEnv *env, char const * const cls, char const * const message)
@@ -77,22 +252,3 @@ static void throw_NullPointerException(JNIEnv *env, char const * const message)
 {
 	throw_exception(env, "java/lang/NullPointerException", message);
 }
-
-static int32_t clamp(int32_t value, int32_t min, int32_t max)
-{
-	return (value < min) ? min : (value > max) ? max : value;
-}
-
-static inline uint32_t yuv2rgba(uint8_t y, uint8_t u, uint8_t v)
-{
-	int const iy = 1192 * clamp(y - 16, 0, 255);
-	int const iu = u - 128;
-	int const iv = v - 128;
-
-	int32_t const r = clamp(iy + 1634 * iv +    0 * iu, 0, 262143);
-	int32_t const g = clamp(iy -  833 * iv -  400 * iu, 0, 262143);
-	int32_t const b = clamp(iy +    0 * iv + 2066 * iu, 0, 262143);
-
-	return 0xff000000 | ((r << 6) & 0xff0000) | ((g >> 2) & 0xff00) | ((b >> 10) & 0xff);
-}
-
@@ -9,11 +9,35 @@ extern "C" {
 #endif
 /*
  * Class:     net_crimsonwoods_android_libs_uvccap_ColorConverter
- * Method:    yuyvtorgb
- * Signature: ([I[BII)V
+ * Method:    n_yuyvtorgb
+ * Signature: ([II[BIII)V
  */
-JNIEXPORT void JNICALL Java_net_crimsonwoods_android_libs_uvccap_ColorConverter_yuyvtorgb
-  (JNIEnv *, jclass, jintArray, jbyteArray, jint, jint);
+JNIEXPORT void JNICALL Java_net_crimsonwoods_android_libs_uvccap_ColorConverter_n_1yuyvtorgb
+  (JNIEnv *, jclass, jintArray, jint, jbyteArray, jint, jint, jint);
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_ColorConverter
+ * Method:    n_yuyvtorgbDirect
+ * Signature: (Ljava/nio/ByteBuffer;ILjava/nio/ByteBuffer;III)V
+ */
+JNIEXPORT void JNICALL Java_net_crimsonwoods_android_libs_uvccap_ColorConverter_n_1yuyvtorgbDirect
+  (JNIEnv *, jclass, jobject, jint, jobject, jint, jint, jint);
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_ColorConverter
+ * Method:    n_yuyvtorgbTransformed
+ * Signature: (Ljava/nio/ByteBuffer;ILjava/nio/ByteBuffer;IIIII)V
+ */
+JNIEXPORT void JNICALL Java_net_crimsonwoods_android_libs_uvccap_ColorConverter_n_1yuyvtorgbTransformed
+  (JNIEnv *, jclass, jobject, jint, jobject, jint, jint, jint, jint, jint);
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_ColorConverter
+ * Method:    n_packedToPlanar
+ * Signature: (Ljava/nio/ByteBuffer;II[Ljava/nio/ByteBuffer;[IIII)V
+ */
+JNIEXPORT void JNICALL Java_net_crimsonwoods_android_libs_uvccap_ColorConverter_n_1packedToPlanar
+  (JNIEnv *, jclass, jobject, jint, jint, jobjectArray, jintArray, jint, jint, jint);
 
 #ifdef __cplusplus
 }
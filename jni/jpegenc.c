@@ -0,0 +1,677 @@
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+
+#include "jpegenc.h"
+#include "jpegtab.h"
+
+#ifdef UVCC_USE_LIBJPEG_TURBO
+#include <turbojpeg.h>
+#endif
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define JPEGENC_NEON 1
+#endif
+
+#define MCU_SIZE      16
+#define MAX_DIMENSION 65535
+#define HEADER_SIZE   1024 // SOI, APP0, DQT, SOF0, DHT, SOS and EOI take about 620 bytes.
+
+// DCT coefficients are Q13, the first pass keeps PASS1_BITS more than the samples.
+#define CONST_BITS 13
+#define PASS1_BITS 2
+
+#define DESCALE(x, n) (((x) + (1 << ((n) - 1))) >> (n))
+
+/* Code and length of every symbol of a Huffman table. */
+typedef struct huffman_code_t_ {
+	uint16_t code[256];
+	uint8_t  size[256];
+} huffman_code_t;
+
+/* Quantizer of one table: (|F| + bias) * recip >> 15 rounds |F| / Q. */
+typedef struct quantizer_t_ {
+	uint8_t  zigzag[64]; // as written to DQT.
+	uint16_t recip[64];  // natural order.
+	uint16_t bias[64];
+} quantizer_t;
+
+typedef struct bit_writer_t_ {
+	uint8_t *p;
+	uint8_t *end;
+	uint32_t acc;
+	int      bits;
+	int      overflow; // non zero once a byte did not fit.
+} bit_writer_t;
+
+/* Frame being encoded, as read by extract_rows. */
+typedef struct source_t_ {
+	jpegenc_format_t format;
+	uint8_t const   *planes[3];
+	int              strides[3];
+	int              width;
+	int              height;
+} source_t;
+
+struct jpegenc_t_ {
+	int          quality; // of the quantizers, 0 before the first frame.
+	quantizer_t  quant[2]; // luminance, chrominance.
+	uint8_t     *rows;     // one MCU row of Y, Cb and Cr.
+	size_t       rows_size;
+#ifdef UVCC_USE_LIBJPEG_TURBO
+	tjhandle     turbo;
+	uint8_t     *frame;    // whole 4:2:0 frame handed to libjpeg-turbo.
+	size_t       frame_size;
+#endif
+};
+
+static pthread_once_t  tables_once = PTHREAD_ONCE_INIT;
+static int16_t         dct_matrix[8][8];
+static huffman_code_t  dc_codes[2];
+static huffman_code_t  ac_codes[2];
+static uint8_t         luma_range[256];
+static uint8_t         chroma_range[256];
+
+static void build_huffman_code(huffman_code_t *table, uint8_t const *bits, uint8_t const *values) {
+	int code = 0;
+	int k = 0;
+	int len, i;
+
+	memset(table, 0, sizeof(*table));
+	for (len = 1; len <= 16; ++len) {
+		for (i = 0; i < bits[len - 1]; ++i, ++k, ++code) {
+			table->code[values[k]] = (uint16_t)code;
+			table->size[values[k]] = (uint8_t)len;
+		}
+		code <<= 1;
+	}
+}
+
+static uint8_t clamp_sample(double value) {
+	return (value < 0.0) ? 0 : (value > 255.0) ? 255 : (uint8_t)(value + 0.5);
+}
+
+static void init_tables(void) {
+	int k, n;
+
+	// orthonormal DCT-II, which is the JPEG FDCT applied to rows and then columns.
+	for (k = 0; k < 8; ++k) {
+		double const scale = (0 == k) ? sqrt(0.125) : 0.5;
+		for (n = 0; n < 8; ++n) {
+			dct_matrix[k][n] = (int16_t)floor(scale * cos((2 * n + 1) * k * M_PI / 16.0) * (1 << CONST_BITS) + 0.5);
+		}
+	}
+
+	build_huffman_code(&dc_codes[0], JPEG_DC_LUMINANCE_BITS, JPEG_DC_LUMINANCE_VALUES);
+	build_huffman_code(&dc_codes[1], JPEG_DC_CHROMINANCE_BITS, JPEG_DC_CHROMINANCE_VALUES);
+	build_huffman_code(&ac_codes[0], JPEG_AC_LUMINANCE_BITS, JPEG_AC_LUMINANCE_VALUES);
+	build_huffman_code(&ac_codes[1], JPEG_AC_CHROMINANCE_BITS, JPEG_AC_CHROMINANCE_VALUES);
+
+	for (n = 0; n < 256; ++n) {
+		luma_range[n] = clamp_sample((n - 16) * 255.0 / 219.0);
+		chroma_range[n] = clamp_sample((n - 128) * 255.0 / 224.0 + 128.0);
+	}
+}
+
+// libjpeg's scaling of the Annex K tables.
+static void set_quality(jpegenc_t *enc, int quality) {
+	int const scale = (quality < 50) ? 5000 / quality : 200 - quality * 2;
+	uint8_t const *bases[2] = { JPEG_LUMINANCE_QUANT, JPEG_CHROMINANCE_QUANT };
+	int t, i, q;
+
+	for (t = 0; t < 2; ++t) {
+		quantizer_t *const quant = &enc->quant[t];
+		for (i = 0; i < 64; ++i) {
+			q = (bases[t][i] * scale + 50) / 100;
+			q = (q < 1) ? 1 : (q > 255) ? 255 : q;
+			quant->recip[i] = (uint16_t)((32768 + q / 2) / q);
+			quant->bias[i] = (uint16_t)(q / 2);
+		}
+		for (i = 0; i < 64; ++i) {
+			q = (bases[t][JPEG_ZIGZAG[i]] * scale + 50) / 100;
+			quant->zigzag[i] = (uint8_t)((q < 1) ? 1 : (q > 255) ? 255 : q);
+		}
+	}
+	enc->quality = quality;
+}
+
+#ifdef JPEGENC_NEON
+/* One pass over 8 rows of 8 lanes: out[k] = sum of dct_matrix[k][n] * in[n]. */
+static void dct_pass(int16x8_t const in[8], int16x8_t out[8], int shift_pass1) {
+	int k, n;
+
+	for (k = 0; k < 8; ++k) {
+		int32x4_t lo = vmull_n_s16(vget_low_s16(in[0]), dct_matrix[k][0]);
+		int32x4_t hi = vmull_n_s16(vget_high_s16(in[0]), dct_matrix[k][0]);
+		for (n = 1; n < 8; ++n) {
+			lo = vmlal_n_s16(lo, vget_low_s16(in[n]), dct_matrix[k][n]);
+			hi = vmlal_n_s16(hi, vget_high_s16(in[n]), dct_matrix[k][n]);
+		}
+		if (shift_pass1) {
+			out[k] = vcombine_s16(vrshrn_n_s32(lo, CONST_BITS - PASS1_BITS), vrshrn_n_s32(hi, CONST_BITS - PASS1_BITS));
+		} else {
+			out[k] = vcombine_s16(vrshrn_n_s32(lo, CONST_BITS + PASS1_BITS), vrshrn_n_s32(hi, CONST_BITS + PASS1_BITS));
+		}
+	}
+}
+
+static void transpose(int16x8_t m[8]) {
+	int16x8x2_t const a0 = vtrnq_s16(m[0], m[1]);
+	int16x8x2_t const a1 = vtrnq_s16(m[2], m[3]);
+	int16x8x2_t const a2 = vtrnq_s16(m[4], m[5]);
+	int16x8x2_t const a3 = vtrnq_s16(m[6], m[7]);
+	int32x4x2_t const b0 = vtrnq_s32(vreinterpretq_s32_s16(a0.val[0]), vreinterpretq_s32_s16(a1.val[0]));
+	int32x4x2_t const b1 = vtrnq_s32(vreinterpretq_s32_s16(a0.val[1]), vreinterpretq_s32_s16(a1.val[1]));
+	int32x4x2_t const b2 = vtrnq_s32(vreinterpretq_s32_s16(a2.val[0]), vreinterpretq_s32_s16(a3.val[0]));
+	int32x4x2_t const b3 = vtrnq_s32(vreinterpretq_s32_s16(a2.val[1]), vreinterpretq_s32_s16(a3.val[1]));
+
+	m[0] = vreinterpretq_s16_s32(vcombine_s32(vget_low_s32(b0.val[0]), vget_low_s32(b2.val[0])));
+	m[4] = vreinterpretq_s16_s32(vcombine_s32(vget_high_s32(b0.val[0]), vget_high_s32(b2.val[0])));
+	m[1] = vreinterpretq_s16_s32(vcombine_s32(vget_low_s32(b1.val[0]), vget_low_s32(b3.val[0])));
+	m[5] = vreinterpretq_s16_s32(vcombine_s32(vget_high_s32(b1.val[0]), vget_high_s32(b3.val[0])));
+	m[2] = vreinterpretq_s16_s32(vcombine_s32(vget_low_s32(b0.val[1]), vget_low_s32(b2.val[1])));
+	m[6] = vreinterpretq_s16_s32(vcombine_s32(vget_high_s32(b0.val[1]), vget_high_s32(b2.val[1])));
+	m[3] = vreinterpretq_s16_s32(vcombine_s32(vget_low_s32(b1.val[1]), vget_low_s32(b3.val[1])));
+	m[7] = vreinterpretq_s16_s32(vcombine_s32(vget_high_s32(b1.val[1]), vget_high_s32(b3.val[1])));
+}
+
+/* FDCT of an 8x8 block of samples and quantization, coef in natural order. */
+static void fdct_quantize(uint8_t const *src, int stride, quantizer_t const *quant, int16_t *coef) {
+	int16x8_t rows[8];
+	int16x8_t tmp[8];
+	uint8x8_t const center = vdup_n_u8(128);
+	int i;
+
+	for (i = 0; i < 8; ++i) {
+		rows[i] = vreinterpretq_s16_u16(vsubl_u8(vld1_u8(src + i * stride), center));
+	}
+	// columns first, each lane is one column.
+	dct_pass(rows, tmp, 1);
+	transpose(tmp);
+	dct_pass(tmp, rows, 0);
+	transpose(rows);
+
+	for (i = 0; i < 8; ++i) {
+		int16x8_t const value = rows[i];
+		uint16x8_t const magnitude = vreinterpretq_u16_s16(vabsq_s16(value));
+		uint16x8_t const biased = vaddq_u16(magnitude, vld1q_u16(quant->bias + i * 8));
+		uint16x8_t const recip = vld1q_u16(quant->recip + i * 8);
+		uint32x4_t const lo = vmull_u16(vget_low_u16(biased), vget_low_u16(recip));
+		uint32x4_t const hi = vmull_u16(vget_high_u16(biased), vget_high_u16(recip));
+		int16x8_t const q = vreinterpretq_s16_u16(vcombine_u16(vshrn_n_u32(lo, 15), vshrn_n_u32(hi, 15)));
+		// negate where the coefficient is negative.
+		int16x8_t const sign = vshrq_n_s16(value, 15);
+		vst1q_s16(coef + i * 8, vsubq_s16(veorq_s16(q, sign), sign));
+	}
+}
+#else
+/*
+ * out[k * step] = sum of dct_matrix[k][n] * in[n], with the rows of the matrix
+ * being even or odd around the middle; the sums equal those of NEON.
+ */
+static void dct_1d(int32_t const *in, int32_t *out, int step) {
+	int32_t even[4], odd[4];
+	int k, n;
+
+	for (n = 0; n < 4; ++n) {
+		even[n] = in[n] + in[7 - n];
+		odd[n] = in[n] - in[7 - n];
+	}
+	for (k = 0; k < 8; ++k) {
+		int32_t const *const half = (k & 1) ? odd : even;
+		out[k * step] = dct_matrix[k][0] * half[0] + dct_matrix[k][1] * half[1] +
+			dct_matrix[k][2] * half[2] + dct_matrix[k][3] * half[3];
+	}
+}
+
+static void fdct_quantize(uint8_t const *src, int stride, quantizer_t const *quant, int16_t *coef) {
+	int32_t column[8], row[8], sums[8];
+	int16_t tmp[64];
+	int32_t value, magnitude, q;
+	int x, y, k;
+
+	// columns first, as the NEON variant does.
+	for (x = 0; x < 8; ++x) {
+		for (y = 0; y < 8; ++y) {
+			column[y] = src[y * stride + x] - 128;
+		}
+		dct_1d(column, sums, 1);
+		for (k = 0; k < 8; ++k) {
+			tmp[k * 8 + x] = (int16_t)DESCALE(sums[k], CONST_BITS - PASS1_BITS);
+		}
+	}
+	for (y = 0; y < 8; ++y) {
+		for (x = 0; x < 8; ++x) {
+			row[x] = tmp[y * 8 + x];
+		}
+		dct_1d(row, sums, 1);
+		for (k = 0; k < 8; ++k) {
+			value = DESCALE(sums[k], CONST_BITS + PASS1_BITS);
+			magnitude = (value < 0) ? -value : value;
+			q = (int32_t)(((uint32_t)(uint16_t)(magnitude + quant->bias[y * 8 + k]) * quant->recip[y * 8 + k]) >> 15);
+			coef[y * 8 + k] = (int16_t)((value < 0) ? -q : q);
+		}
+	}
+}
+#endif
+
+static void emit_byte(bit_writer_t *w, uint8_t byte) {
+	if (w->p >= w->end) {
+		w->overflow = 1;
+		return;
+	}
+	*w->p++ = byte;
+}
+
+static void put_bits(bit_writer_t *w, uint32_t code, int size) {
+	uint8_t byte;
+
+	w->acc = (w->acc << size) | (code & ((1u << size) - 1));
+	w->bits += size;
+	while (w->bits >= 8) {
+		w->bits -= 8;
+		byte = (uint8_t)(w->acc >> w->bits);
+		emit_byte(w, byte);
+		// a 0xff in entropy coded data is followed by a stuffed zero.
+		if (0xff == byte) {
+			emit_byte(w, 0);
+		}
+	}
+}
+
+// pads the last byte with ones.
+static void flush_bits(bit_writer_t *w) {
+	if (0 < w->bits) {
+		put_bits(w, 0x7f, 8 - w->bits);
+	}
+}
+
+static int bit_length(int value) {
+	return (0 == value) ? 0 : 32 - __builtin_clz((unsigned int)value);
+}
+
+static void encode_block(bit_writer_t *w, int16_t const *coef, int *last_dc,
+	huffman_code_t const *dc, huffman_code_t const *ac)
+{
+	int const diff = coef[0] - *last_dc;
+	int const magnitude = (diff < 0) ? -diff : diff;
+	int nbits = bit_length(magnitude);
+	int run = 0;
+	int k, value, symbol;
+
+	*last_dc = coef[0];
+	put_bits(w, dc->code[nbits], dc->size[nbits]);
+	if (0 != nbits) {
+		// negative values are sent as their ones' complement.
+		put_bits(w, (uint32_t)((diff < 0) ? diff - 1 : diff), nbits);
+	}
+
+	for (k = 1; k < 64; ++k) {
+		value = coef[JPEG_ZIGZAG[k]];
+		if (0 == value) {
+			++run;
+			continue;
+		}
+		while (run > 15) {
+			put_bits(w, ac->code[0xf0], ac->size[0xf0]);
+			run -= 16;
+		}
+		nbits = bit_length((value < 0) ? -value : value);
+		symbol = (run << 4) | nbits;
+		put_bits(w, ac->code[symbol], ac->size[symbol]);
+		put_bits(w, (uint32_t)((value < 0) ? value - 1 : value), nbits);
+		run = 0;
+	}
+	if (0 < run) {
+		put_bits(w, ac->code[0x00], ac->size[0x00]);
+	}
+}
+
+static void pad_row(uint8_t *row, int width, int padded) {
+	memset(row + width, row[width - 1], padded - width);
+}
+
+/*
+ * Read 'rows' luma rows from 'y0' and their chroma rows into 4:2:0 planes
+ * of 'padded' luma columns, repeating the last row and column of the frame.
+ */
+static void extract_rows(source_t const *src, int y0, int rows, int padded,
+	uint8_t *dst_y, int y_stride, uint8_t *dst_cb, uint8_t *dst_cr, int c_stride)
+{
+	int const cw = (src->width + 1) / 2;
+	int const ch = (src->height + 1) / 2;
+	int const luma = (JPEGENC_FORMAT_UYVY == src->format) ? 1 : 0;
+	int const chroma = 1 - luma;
+	uint8_t const *s, *s0, *s1;
+	uint8_t *dy, *dcb, *dcr;
+	int r, x, u, sy, cy;
+
+	for (r = 0; r < rows; ++r) {
+		sy = y0 + r;
+		sy = (sy < src->height) ? sy : src->height - 1;
+		s = src->planes[0] + sy * src->strides[0];
+		dy = dst_y + r * y_stride;
+		if ((JPEGENC_FORMAT_YUYV == src->format) || (JPEGENC_FORMAT_UYVY == src->format)) {
+			for (x = 0; x < src->width; ++x) {
+				dy[x] = luma_range[s[x * 2 + luma]];
+			}
+		} else {
+			for (x = 0; x < src->width; ++x) {
+				dy[x] = luma_range[s[x]];
+			}
+		}
+		pad_row(dy, src->width, padded);
+	}
+
+	for (r = 0; r < rows / 2; ++r) {
+		cy = y0 / 2 + r;
+		cy = (cy < ch) ? cy : ch - 1;
+		dcb = dst_cb + r * c_stride;
+		dcr = dst_cr + r * c_stride;
+		switch (src->format) {
+		case JPEGENC_FORMAT_YUYV:
+		case JPEGENC_FORMAT_UYVY:
+			s0 = src->planes[0] + cy * 2 * src->strides[0];
+			s1 = (cy * 2 + 1 < src->height) ? s0 + src->strides[0] : s0;
+			for (x = 0; x < cw; ++x) {
+				dcb[x] = chroma_range[(s0[x * 4 + chroma] + s1[x * 4 + chroma] + 1) >> 1];
+				dcr[x] = chroma_range[(s0[x * 4 + chroma + 2] + s1[x * 4 + chroma + 2] + 1) >> 1];
+			}
+			break;
+		case JPEGENC_FORMAT_I420:
+			s0 = src->planes[1] + cy * src->strides[1];
+			s1 = src->planes[2] + cy * src->strides[2];
+			for (x = 0; x < cw; ++x) {
+				dcb[x] = chroma_range[s0[x]];
+				dcr[x] = chroma_range[s1[x]];
+			}
+			break;
+		default:
+			s = src->planes[1] + cy * src->strides[1];
+			u = (JPEGENC_FORMAT_NV21 == src->format) ? 1 : 0;
+			for (x = 0; x < cw; ++x) {
+				dcb[x] = chroma_range[s[x * 2 + u]];
+				dcr[x] = chroma_range[s[x * 2 + 1 - u]];
+			}
+			break;
+		}
+		pad_row(dcb, cw, padded / 2);
+		pad_row(dcr, cw, padded / 2);
+	}
+}
+
+static void put_marker_header(bit_writer_t *w, uint8_t marker, int length) {
+	emit_byte(w, 0xff);
+	emit_byte(w, marker);
+	emit_byte(w, (uint8_t)(length >> 8));
+	emit_byte(w, (uint8_t)length);
+}
+
+static void put_huffman_table(bit_writer_t *w, int class_id, uint8_t const *bits, uint8_t const *values) {
+	int count = 0;
+	int i;
+
+	for (i = 0; i < 16; ++i) {
+		count += bits[i];
+	}
+	put_marker_header(w, 0xc4, 2 + 1 + 16 + count);
+	emit_byte(w, (uint8_t)class_id);
+	for (i = 0; i < 16; ++i) {
+		emit_byte(w, bits[i]);
+	}
+	for (i = 0; i < count; ++i) {
+		emit_byte(w, values[i]);
+	}
+}
+
+static void write_headers(jpegenc_t const *enc, bit_writer_t *w, int width, int height) {
+	static uint8_t const jfif[] = { 'J', 'F', 'I', 'F', 0, 1, 1, 0, 0, 1, 0, 1, 0, 0 };
+	int t, i;
+
+	emit_byte(w, 0xff);
+	emit_byte(w, 0xd8); // SOI
+	put_marker_header(w, 0xe0, 2 + sizeof(jfif));
+	for (i = 0; i < (int)sizeof(jfif); ++i) {
+		emit_byte(w, jfif[i]);
+	}
+
+	for (t = 0; t < 2; ++t) {
+		put_marker_header(w, 0xdb, 2 + 1 + 64);
+		emit_byte(w, (uint8_t)t);
+		for (i = 0; i < 64; ++i) {
+			emit_byte(w, enc->quant[t].zigzag[i]);
+		}
+	}
+
+	// SOF0: 8 bits, Y sampled 2x2 with table 0, Cb and Cr 1x1 with table 1.
+	put_marker_header(w, 0xc0, 2 + 6 + 3 * 3);
+	emit_byte(w, 8);
+	emit_byte(w, (uint8_t)(height >> 8));
+	emit_byte(w, (uint8_t)height);
+	emit_byte(w, (uint8_t)(width >> 8));
+	emit_byte(w, (uint8_t)width);
+	emit_byte(w, 3);
+	for (i = 1; i <= 3; ++i) {
+		emit_byte(w, (uint8_t)i);
+		emit_byte(w, (1 == i) ? 0x22 : 0x11);
+		emit_byte(w, (1 == i) ? 0 : 1);
+	}
+
+	put_huffman_table(w, 0x00, JPEG_DC_LUMINANCE_BITS, JPEG_DC_LUMINANCE_VALUES);
+	put_huffman_table(w, 0x10, JPEG_AC_LUMINANCE_BITS, JPEG_AC_LUMINANCE_VALUES);
+	put_huffman_table(w, 0x01, JPEG_DC_CHROMINANCE_BITS, JPEG_DC_CHROMINANCE_VALUES);
+	put_huffman_table(w, 0x11, JPEG_AC_CHROMINANCE_BITS, JPEG_AC_CHROMINANCE_VALUES);
+
+	put_marker_header(w, 0xda, 2 + 1 + 3 * 2 + 3);
+	emit_byte(w, 3);
+	for (i = 1; i <= 3; ++i) {
+		emit_byte(w, (uint8_t)i);
+		emit_byte(w, (1 == i) ? 0x00 : 0x11);
+	}
+	emit_byte(w, 0);  // Ss
+	emit_byte(w, 63); // Se
+	emit_byte(w, 0);  // Ah, Al
+}
+
+static int encode_builtin(jpegenc_t *enc, source_t const *src, uint8_t *dst, size_t dst_size, size_t *written) {
+	int const padded = (src->width + MCU_SIZE - 1) & ~(MCU_SIZE - 1);
+	size_t const plane = (size_t)padded * MCU_SIZE;
+	uint8_t *y_rows, *cb_rows, *cr_rows;
+	int16_t coef[64];
+	int dc[3] = { 0, 0, 0 };
+	bit_writer_t w;
+	int y0, x, i;
+
+	if (enc->rows_size < plane * 3 / 2) {
+		uint8_t *rows = (uint8_t*)realloc(enc->rows, plane * 3 / 2);
+		if (NULL == rows) {
+			return JPEGENC_INSUFFICIENT_MEMORY;
+		}
+		enc->rows = rows;
+		enc->rows_size = plane * 3 / 2;
+	}
+	y_rows = enc->rows;
+	cb_rows = y_rows + plane;
+	cr_rows = cb_rows + plane / 4;
+
+	w.p = dst;
+	w.end = dst + dst_size;
+	w.acc = 0;
+	w.bits = 0;
+	w.overflow = 0;
+
+	write_headers(enc, &w, src->width, src->height);
+
+	for (y0 = 0; (y0 < src->height) && !w.overflow; y0 += MCU_SIZE) {
+		extract_rows(src, y0, MCU_SIZE, padded, y_rows, padded, cb_rows, cr_rows, padded / 2);
+		for (x = 0; x < padded; x += MCU_SIZE) {
+			for (i = 0; i < 4; ++i) {
+				fdct_quantize(y_rows + (i >> 1) * 8 * padded + x + (i & 1) * 8, padded, &enc->quant[0], coef);
+				encode_block(&w, coef, &dc[0], &dc_codes[0], &ac_codes[0]);
+			}
+			fdct_quantize(cb_rows + x / 2, padded / 2, &enc->quant[1], coef);
+			encode_block(&w, coef, &dc[1], &dc_codes[1], &ac_codes[1]);
+			fdct_quantize(cr_rows + x / 2, padded / 2, &enc->quant[1], coef);
+			encode_block(&w, coef, &dc[2], &dc_codes[1], &ac_codes[1]);
+		}
+	}
+	flush_bits(&w);
+	emit_byte(&w, 0xff);
+	emit_byte(&w, 0xd9); // EOI
+
+	if (w.overflow) {
+		return JPEGENC_BUFFER_TOO_SMALL;
+	}
+	*written = (size_t)(w.p - dst);
+	return JPEGENC_NOERROR;
+}
+
+#ifdef UVCC_USE_LIBJPEG_TURBO
+/* Hand libjpeg-turbo the frame already in 4:2:0, through its raw (YUV planes) interface. */
+static int encode_turbo(jpegenc_t *enc, source_t const *src, int quality, uint8_t *dst, size_t dst_size, size_t *written) {
+	int const padded = (src->width + MCU_SIZE - 1) & ~(MCU_SIZE - 1);
+	int const rows = (src->height + MCU_SIZE - 1) & ~(MCU_SIZE - 1);
+	size_t const plane = (size_t)padded * rows;
+	unsigned char const *planes[3];
+	int strides[3];
+	unsigned char *out = dst;
+	unsigned long size = dst_size;
+	int y0;
+
+	if (NULL == enc->turbo) {
+		enc->turbo = tjInitCompress();
+		if (NULL == enc->turbo) {
+			return JPEGENC_INSUFFICIENT_MEMORY;
+		}
+	}
+	if (enc->frame_size < plane * 3 / 2) {
+		uint8_t *frame = (uint8_t*)realloc(enc->frame, plane * 3 / 2);
+		if (NULL == frame) {
+			return JPEGENC_INSUFFICIENT_MEMORY;
+		}
+		enc->frame = frame;
+		enc->frame_size = plane * 3 / 2;
+	}
+	planes[0] = enc->frame;
+	planes[1] = enc->frame + plane;
+	planes[2] = enc->frame + plane + plane / 4;
+	strides[0] = padded;
+	strides[1] = padded / 2;
+	strides[2] = padded / 2;
+
+	for (y0 = 0; y0 < src->height; y0 += MCU_SIZE) {
+		extract_rows(src, y0, MCU_SIZE, padded,
+			(uint8_t*)planes[0] + y0 * strides[0], strides[0],
+			(uint8_t*)planes[1] + (y0 / 2) * strides[1], (uint8_t*)planes[2] + (y0 / 2) * strides[2], strides[1]);
+	}
+	if (0 != tjCompressFromYUVPlanes(enc->turbo, planes, src->width, strides, src->height, TJSAMP_420,
+		&out, &size, quality, TJFLAG_NOREALLOC)) {
+		return JPEGENC_BUFFER_TOO_SMALL;
+	}
+	*written = size;
+	return JPEGENC_NOERROR;
+}
+#endif
+
+jpegenc_t *jpegenc_create(void) {
+	pthread_once(&tables_once, init_tables);
+	return (jpegenc_t*)calloc(1, sizeof(jpegenc_t));
+}
+
+void jpegenc_destroy(jpegenc_t *enc) {
+	if (NULL == enc) {
+		return;
+	}
+#ifdef UVCC_USE_LIBJPEG_TURBO
+	if (NULL != enc->turbo) {
+		tjDestroy(enc->turbo);
+	}
+	free(enc->frame);
+#endif
+	free(enc->rows);
+	free(enc);
+}
+
+size_t jpegenc_bound(int width, int height) {
+	size_t samples;
+
+	if ((0 >= width) || (0 >= height) || (MAX_DIMENSION < width) || (MAX_DIMENSION < height)) {
+		return 0;
+	}
+	samples = (size_t)((width + MCU_SIZE - 1) & ~(MCU_SIZE - 1)) * ((height + MCU_SIZE - 1) & ~(MCU_SIZE - 1)) * 3 / 2;
+	// noise at quality 100 stays below 3 bytes per sample.
+	return samples * 3 + HEADER_SIZE;
+}
+
+size_t jpegenc_plane_size(jpegenc_format_t format, int width, int height, int plane, int stride) {
+	int const cw = (width + 1) / 2;
+	int const ch = (height + 1) / 2;
+
+	if ((0 >= width) || (0 >= height)) {
+		return 0;
+	}
+	switch (format) {
+	case JPEGENC_FORMAT_YUYV:
+	case JPEGENC_FORMAT_UYVY:
+		return (0 == plane) ? (size_t)stride * (height - 1) + width * 2 : 0;
+	case JPEGENC_FORMAT_I420:
+		if (0 == plane) {
+			return (size_t)stride * (height - 1) + width;
+		}
+		return (plane < 3) ? (size_t)stride * (ch - 1) + cw : 0;
+	case JPEGENC_FORMAT_NV12:
+	case JPEGENC_FORMAT_NV21:
+		if (0 == plane) {
+			return (size_t)stride * (height - 1) + width;
+		}
+		return (1 == plane) ? (size_t)stride * (ch - 1) + cw * 2 : 0;
+	default:
+		return 0;
+	}
+}
+
+int jpegenc_encode(jpegenc_t *enc, jpegenc_format_t format, int width, int height,
+	uint8_t const * const planes[3], int const strides[3], int quality,
+	uint8_t *dst, size_t dst_size, size_t *written)
+{
+	source_t src;
+	int i;
+
+	if ((NULL == enc) || (NULL == planes) || (NULL == strides) || (NULL == dst) || (NULL == written)) {
+		return JPEGENC_INVALID_ARGUMENTS;
+	}
+	if ((0 > (int)format) || (JPEGENC_FORMAT_COUNT <= format) || (quality < 1) || (quality > 100)) {
+		return JPEGENC_INVALID_ARGUMENTS;
+	}
+	if ((0 >= width) || (0 >= height) || (MAX_DIMENSION < width) || (MAX_DIMENSION < height)) {
+		return JPEGENC_INVALID_ARGUMENTS;
+	}
+	// packed formats carry the chroma of pixel pairs.
+	if (((JPEGENC_FORMAT_YUYV == format) || (JPEGENC_FORMAT_UYVY == format)) && (width & 1)) {
+		return JPEGENC_INVALID_ARGUMENTS;
+	}
+
+	src.format = format;
+	src.width = width;
+	src.height = height;
+	for (i = 0; i < 3; ++i) {
+		src.planes[i] = planes[i];
+		src.strides[i] = strides[i];
+		if ((0 != jpegenc_plane_size(format, width, height, i, 1)) && ((NULL == planes[i]) || (0 >= strides[i]))) {
+			return JPEGENC_INVALID_ARGUMENTS;
+		}
+	}
+
+#ifdef UVCC_USE_LIBJPEG_TURBO
+	// libjpeg-turbo only writes into buffers of its own bound.
+	if (dst_size >= tjBufSize(width, height, TJSAMP_420)) {
+		return encode_turbo(enc, &src, quality, dst, dst_size, written);
+	}
+#endif
+	if (quality != enc->quality) {
+		set_quality(enc, quality);
+	}
+	return encode_builtin(enc, &src, dst, dst_size, written);
+}
@@ -0,0 +1,64 @@
+#ifndef JPEG_ENCODER_H
+#define JPEG_ENCODER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum jpegenc_error_t {
+	JPEGENC_NOERROR = 0,
+	JPEGENC_INVALID_ARGUMENTS,
+	JPEGENC_INSUFFICIENT_MEMORY,
+	JPEGENC_BUFFER_TOO_SMALL,
+} jpegenc_error_t;
+
+/*
+ * Layouts of the frames, strides in bytes. The output is always a baseline
+ * 4:2:0 JFIF: 4:2:2 chroma is averaged over pairs of rows while the frame
+ * is read, and the limited range samples of UVC cameras are stretched to
+ * the full range JFIF expects.
+ */
+typedef enum jpegenc_format_t {
+	JPEGENC_FORMAT_YUYV = 0,
+	JPEGENC_FORMAT_UYVY,
+	JPEGENC_FORMAT_I420,
+	JPEGENC_FORMAT_NV12,
+	JPEGENC_FORMAT_NV21,
+	JPEGENC_FORMAT_COUNT,
+} jpegenc_format_t;
+
+/*
+ * Scratch rows and the tables of the last quality are kept by the encoder.
+ * An encoder is not reentrant.
+ */
+typedef struct jpegenc_t_ jpegenc_t;
+
+extern jpegenc_t *jpegenc_create(void);
+extern void jpegenc_destroy(jpegenc_t *enc);
+
+/*
+ * Size of dst that holds a snapshot of any camera image up to quality 100.
+ * The encoder never writes past dst_size, it fails with
+ * JPEGENC_BUFFER_TOO_SMALL instead.
+ */
+extern size_t jpegenc_bound(int width, int height);
+
+/* Bytes of 'plane' a frame spans with 'stride', 0 if the format has no such plane. */
+extern size_t jpegenc_plane_size(jpegenc_format_t format, int width, int height, int plane, int stride);
+
+/*
+ * Encode one frame, which may be the mapped driver buffer (it is only read).
+ * 'quality' runs from 1 to 100 and scales the Annex K tables like libjpeg.
+ */
+extern int jpegenc_encode(jpegenc_t *enc, jpegenc_format_t format, int width, int height,
+	uint8_t const * const planes[3], int const strides[3], int quality,
+	uint8_t *dst, size_t dst_size, size_t *written);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,183 @@
+#include "jpegenc_jni.h"
+#include "jpegenc.h"
+#include <stdint.h>
+
+static void throw_IllegalArgumentException(JNIEnv *env, char const * const message);
+static void throw_NullPointerException(JNIEnv *env, char const * const message);
+static void throw_RuntimeException(JNIEnv *env, char const * const message);
+static int  get_planes(JNIEnv *env, jobjectArray planes, jintArray strides,
+	int format, int width, int height, uint8_t *ptrs[3], int pitches[3]);
+
+#define TO_ENCODER(h) ((jpegenc_t*)(intptr_t)h)
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_JpegEncoder
+ * Method:    n_create
+ * Signature: ()J
+ */
+JNIEXPORT jlong JNICALL Java_net_crimsonwoods_android_libs_uvccap_JpegEncoder_n_1create
+  (JNIEnv *env, jclass cls)
+{
+	jpegenc_t *enc = jpegenc_create();
+	if (NULL == enc) {
+		throw_RuntimeException(env, "JPEG encoder can't create.");
+	}
+	return (jlong)(intptr_t)enc;
+}
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_JpegEncoder
+ * Method:    n_destroy
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_net_crimsonwoods_android_libs_uvccap_JpegEncoder_n_1destroy
+  (JNIEnv *env, jclass cls, jlong handle)
+{
+	jpegenc_destroy(TO_ENCODER(handle));
+}
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_JpegEncoder
+ * Method:    n_getMaxEncodedSize
+ * Signature: (II)I
+ */
+JNIEXPORT jint JNICALL Java_net_crimsonwoods_android_libs_uvccap_JpegEncoder_n_1getMaxEncodedSize
+  (JNIEnv *env, jclass cls, jint width, jint height)
+{
+	size_t const size = jpegenc_bound(width, height);
+	if ((0 == size) || (INT32_MAX < size)) {
+		throw_IllegalArgumentException(env, "Unsupported size.");
+		return 0;
+	}
+	return (jint)size;
+}
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_JpegEncoder
+ * Method:    n_encode
+ * Signature: (JLjava/nio/ByteBuffer;III[Ljava/nio/ByteBuffer;[II)I
+ */
+JNIEXPORT jint JNICALL Java_net_crimsonwoods_android_libs_uvccap_JpegEncoder_n_1encode
+  (JNIEnv *env, jclass cls, jlong handle, jobject dst, jint format, jint width, jint height,
+   jobjectArray planes, jintArray strides, jint quality)
+{
+	uint8_t *ptrs[3];
+	int pitches[3];
+	uint8_t *dst_ptr;
+	jlong dst_capacity;
+	size_t written = 0;
+	int result;
+
+	if (NULL == dst) {
+		throw_NullPointerException(env, "'dst' have to be set not null.");
+		return 0;
+	}
+	if ((quality < 1) || (quality > 100)) {
+		throw_IllegalArgumentException(env, "'quality' have to be from 1 to 100.");
+		return 0;
+	}
+	dst_ptr = (uint8_t*)(*env)->GetDirectBufferAddress(env, dst);
+	dst_capacity = (*env)->GetDirectBufferCapacity(env, dst);
+	if ((NULL == dst_ptr) || (0 > dst_capacity)) {
+		throw_IllegalArgumentException(env, "'dst' have to be direct buffer.");
+		return 0;
+	}
+	if (!get_planes(env, planes, strides, format, width, height, ptrs, pitches)) {
+		return 0;
+	}
+
+	result = jpegenc_encode(TO_ENCODER(handle), (jpegenc_format_t)format, width, height,
+		(uint8_t const * const*)ptrs, pitches, quality, dst_ptr, (size_t)dst_capacity, &written);
+	if (JPEGENC_BUFFER_TOO_SMALL == result) {
+		throw_IllegalArgumentException(env, "'dst' is too small.");
+		return 0;
+	} else if (JPEGENC_INVALID_ARGUMENTS == result) {
+		throw_IllegalArgumentException(env, "Unsupported format or size.");
+		return 0;
+	} else if (JPEGENC_NOERROR != result) {
+		throw_RuntimeException(env, "Frame can't be encoded.");
+		return 0;
+	}
+	return (jint)written;
+}
+
+static int get_planes(JNIEnv *env, jobjectArray planes, jintArray strides,
+	int format, int width, int height, uint8_t *ptrs[3], int pitches[3])
+{
+	jint values[3] = { 0, 0, 0 };
+	jobject plane;
+	jlong capacity;
+	size_t required;
+	jsize count;
+	int i;
+
+	if ((NULL == planes) || (NULL == strides)) {
+		throw_NullPointerException(env, "'planes' and 'strides' have to be set not null.");
+		return 0;
+	}
+	if (0 == jpegenc_plane_size((jpegenc_format_t)format, width, height, 0, 1)) {
+		throw_IllegalArgumentException(env, "Unsupported format or size.");
+		return 0;
+	}
+	count = (*env)->GetArrayLength(env, planes);
+	if ((3 < count) || ((*env)->GetArrayLength(env, strides) < count)) {
+		throw_IllegalArgumentException(env, "'planes' or 'strides' is out of range.");
+		return 0;
+	}
+	(*env)->GetIntArrayRegion(env, strides, 0, count, values);
+
+	for (i = 0; i < 3; ++i) {
+		ptrs[i] = NULL;
+		pitches[i] = values[i];
+		required = jpegenc_plane_size((jpegenc_format_t)format, width, height, i, values[i]);
+		if (0 == required) {
+			continue;
+		}
+		if ((i >= count) || (0 >= values[i])) {
+			throw_IllegalArgumentException(env, "Too few planes for the format.");
+			return 0;
+		}
+		plane = (*env)->GetObjectArrayElement(env, planes, i);
+		if (NULL == plane) {
+			throw_NullPointerException(env, "'planes' have to be set not null.");
+			return 0;
+		}
+		ptrs[i] = (uint8_t*)(*env)->GetDirectBufferAddress(env, plane);
+		capacity = (*env)->GetDirectBufferCapacity(env, plane);
+		(*env)->DeleteLocalRef(env, plane);
+		if (NULL == ptrs[i]) {
+			throw_IllegalArgumentException(env, "'planes' have to be direct buffers.");
+			return 0;
+		}
+		if ((0 > capacity) || ((size_t)capacity < required)) {
+			throw_IllegalArgumentException(env, "A plane is smaller than the frame.");
+			return 0;
+		}
+	}
+	return 1;
+}
+
+static void throw_exception(JNIEnv *env, char const * const cls, char const * const message)
+{
+	jclass ioe_cls = (*env)->FindClass(env, cls);
+	if (NULL == ioe_cls) {
+		return;
+	}
+	(*env)->ThrowNew(env, ioe_cls, message);
+	(*env)->DeleteLocalRef(env, ioe_cls);
+}
+
+static void throw_IllegalArgumentException(JNIEnv *env, char const * const message)
+{
+	throw_exception(env, "java/lang/IllegalArgumentException", message);
+}
+
+static void throw_NullPointerException(JNIEnv *env, char const * const message)
+{
+	throw_exception(env, "java/lang/NullPointerException", message);
+}
+
+static void throw_RuntimeException(JNIEnv *env, char const * const message)
+{
+	throw_exception(env, "java/lang/RuntimeException", message);
+}
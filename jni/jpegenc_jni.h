@@ -0,0 +1,45 @@
+/* DO NOT EDIT THIS FILE - it is machine generated */
+#include <jni.h>
+/* Header for class net_crimsonwoods_android_libs_uvccap_JpegEncoder */
+
+#ifndef _Included_net_crimsonwoods_android_libs_uvccap_JpegEncoder
+#define _Included_net_crimsonwoods_android_libs_uvccap_JpegEncoder
+#ifdef __cplusplus
+extern "C" {
+#endif
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_JpegEncoder
+ * Method:    n_create
+ * Signature: ()J
+ */
+JNIEXPORT jlong JNICALL Java_net_crimsonwoods_android_libs_uvccap_JpegEncoder_n_1create
+  (JNIEnv *, jclass);
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_JpegEncoder
+ * Method:    n_destroy
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_net_crimsonwoods_android_libs_uvccap_JpegEncoder_n_1destroy
+  (JNIEnv *, jclass, jlong);
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_JpegEncoder
+ * Method:    n_getMaxEncodedSize
+ * Signature: (II)I
+ */
+JNIEXPORT jint JNICALL Java_net_crimsonwoods_android_libs_uvccap_JpegEncoder_n_1getMaxEncodedSize
+  (JNIEnv *, jclass, jint, jint);
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_JpegEncoder
+ * Method:    n_encode
+ * Signature: (JLjava/nio/ByteBuffer;III[Ljava/nio/ByteBuffer;[II)I
+ */
+JNIEXPORT jint JNICALL Java_net_crimsonwoods_android_libs_uvccap_JpegEncoder_n_1encode
+  (JNIEnv *, jclass, jlong, jobject, jint, jint, jint, jobjectArray, jintArray, jint);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,31 @@
+#ifndef JPEG_TABLES_H
+#define JPEG_TABLES_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* zigzag index to natural (row-major) index of an 8x8 block. */
+extern uint8_t const JPEG_ZIGZAG[64];
+
+/* Typical Huffman tables (ITU-T T.81 Annex K.3), used by MJPEG streams without DHT. */
+extern uint8_t const JPEG_DC_LUMINANCE_BITS[16];
+extern uint8_t const JPEG_DC_LUMINANCE_VALUES[12];
+extern uint8_t const JPEG_DC_CHROMINANCE_BITS[16];
+extern uint8_t const JPEG_DC_CHROMINANCE_VALUES[12];
+extern uint8_t const JPEG_AC_LUMINANCE_BITS[16];
+extern uint8_t const JPEG_AC_LUMINANCE_VALUES[162];
+extern uint8_t const JPEG_AC_CHROMINANCE_BITS[16];
+extern uint8_t const JPEG_AC_CHROMINANCE_VALUES[162];
+
+/* Example quantization tables (ITU-T T.81 Annex K.1) in natural order, the quality 50 of encoders. */
+extern uint8_t const JPEG_LUMINANCE_QUANT[64];
+extern uint8_t const JPEG_CHROMINANCE_QUANT[64];
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,736 @@
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define LOSSLESS_NEON 1
+#endif
+
+#include "lossless.h"
+
+#define LOSSLESS_VERSION 1
+#define HEADER_SIZE      16
+#define COMPONENT_HEADER 5
+
+#define MODE_RAW  0
+#define MODE_RICE 1
+
+// residuals are coded in blocks sharing one Rice parameter.
+#define BLOCK_SIZE 16
+#define MAX_K      7
+#define K_BITS     3
+// quotients from here on are escaped and followed by the raw residual.
+#define ESCAPE     16
+// bits the decoder looks up at once, short codes come out two at a time.
+#define PEEK_BITS  12
+
+#define MAX_DIMENSION 65536
+
+/* One plane of samples as seen by the coder, spread over a source plane. */
+typedef struct component_t_ {
+	int plane;
+	int offset; // byte offset of the first sample of a row.
+	int step;   // bytes between samples.
+	int width;
+	int height;
+} component_t;
+
+/* Rice code of every symbol for every parameter, bits in emission order. */
+typedef struct rice_code_t_ {
+	uint32_t bits;
+	uint32_t length;
+} rice_code_t;
+
+static rice_code_t     rice_codes[MAX_K + 1][256];
+// up to two symbols starting at the peeked bits: count in bits 0-1, length of
+// the first in 2-6, of both in 7-11, then the symbols; 0 if none fits.
+static uint32_t        rice_peeks[MAX_K + 1][1 << PEEK_BITS];
+static pthread_once_t  rice_codes_once = PTHREAD_ONCE_INIT;
+
+typedef struct bit_writer_t_ {
+	uint8_t *p;
+	uint64_t acc;
+	int      bits;
+} bit_writer_t;
+
+typedef struct bit_reader_t_ {
+	uint8_t const *p;
+	uint8_t const *end;
+	uint64_t       acc;
+	int            bits;
+	int            padding; // zero bytes appended past 'end'.
+} bit_reader_t;
+
+// symbol of the code at the bottom of 'bits', 0 if it does not end within 'avail' bits.
+static uint32_t peek_code(uint32_t bits, uint32_t avail, uint32_t k, uint32_t *v) {
+	uint32_t q;
+
+	for (q = 0; (q < avail) && (bits & (1u << q)); ++q) {
+	}
+	if ((ESCAPE <= q) || (q + 1 + k > avail)) {
+		return 0;
+	}
+	*v = (q << k) | ((bits >> (q + 1)) & ((1u << k) - 1));
+	// left to the slow path, which reports it as corrupted.
+	if (255 < *v) {
+		return 0;
+	}
+	return q + 1 + k;
+}
+
+// q ones, a zero and the k low bits; large quotients are escaped.
+static void init_rice_codes(void) {
+	uint32_t k, v, q;
+	uint32_t p, v0, v1, len0, len1;
+
+	for (k = 0; k <= MAX_K; ++k) {
+		for (v = 0; v < 256; ++v) {
+			q = v >> k;
+			if (ESCAPE > q) {
+				rice_codes[k][v].bits = ((1u << q) - 1) | ((v & ((1u << k) - 1)) << (q + 1));
+				rice_codes[k][v].length = q + 1 + k;
+			} else {
+				rice_codes[k][v].bits = ((1u << ESCAPE) - 1) | (v << ESCAPE);
+				rice_codes[k][v].length = ESCAPE + 8;
+			}
+		}
+		for (p = 0; p < (1u << PEEK_BITS); ++p) {
+			len0 = peek_code(p, PEEK_BITS, k, &v0);
+			if (0 == len0) {
+				rice_peeks[k][p] = 0;
+				continue;
+			}
+			len1 = peek_code(p >> len0, PEEK_BITS - len0, k, &v1);
+			if (0 == len1) {
+				rice_peeks[k][p] = 1 | (len0 << 2) | (len0 << 7) | (v0 << 12);
+			} else {
+				rice_peeks[k][p] = 2 | (len0 << 2) | ((len0 + len1) << 7) | (v0 << 12) | (v1 << 20);
+			}
+		}
+	}
+}
+
+static void set_component(component_t *c, int plane, int offset, int step, int width, int height) {
+	c->plane = plane;
+	c->offset = offset;
+	c->step = step;
+	c->width = width;
+	c->height = height;
+}
+
+static int get_components(lossless_format_t format, int width, int height, component_t comps[3]) {
+	int const cw = (width + 1) / 2;
+	int const ch = (height + 1) / 2;
+
+	if ((0 >= width) || (0 >= height) || (MAX_DIMENSION < width) || (MAX_DIMENSION < height)) {
+		return 0;
+	}
+
+	switch (format) {
+	case LOSSLESS_FORMAT_YUYV:
+		if (width & 1) {
+			return 0; // macropixels are never split.
+		}
+		set_component(&comps[0], 0, 0, 2, width, height);
+		set_component(&comps[1], 0, 1, 4, cw, height);
+		set_component(&comps[2], 0, 3, 4, cw, height);
+		return 3;
+	case LOSSLESS_FORMAT_UYVY:
+		if (width & 1) {
+			return 0;
+		}
+		set_component(&comps[0], 0, 1, 2, width, height);
+		set_component(&comps[1], 0, 0, 4, cw, height);
+		set_component(&comps[2], 0, 2, 4, cw, height);
+		return 3;
+	case LOSSLESS_FORMAT_I420:
+		set_component(&comps[0], 0, 0, 1, width, height);
+		set_component(&comps[1], 1, 0, 1, cw, ch);
+		set_component(&comps[2], 2, 0, 1, cw, ch);
+		return 3;
+	case LOSSLESS_FORMAT_YUV422P:
+		set_component(&comps[0], 0, 0, 1, width, height);
+		set_component(&comps[1], 1, 0, 1, cw, height);
+		set_component(&comps[2], 2, 0, 1, cw, height);
+		return 3;
+	case LOSSLESS_FORMAT_NV12:
+		set_component(&comps[0], 0, 0, 1, width, height);
+		set_component(&comps[1], 1, 0, 2, cw, ch);
+		set_component(&comps[2], 1, 1, 2, cw, ch);
+		return 3;
+	case LOSSLESS_FORMAT_NV21:
+		set_component(&comps[0], 0, 0, 1, width, height);
+		set_component(&comps[1], 1, 1, 2, cw, ch);
+		set_component(&comps[2], 1, 0, 2, cw, ch);
+		return 3;
+	case LOSSLESS_FORMAT_GREY:
+		set_component(&comps[0], 0, 0, 1, width, height);
+		return 1;
+	default:
+		return 0;
+	}
+}
+
+static void put_le32(uint8_t *p, uint32_t v) {
+	p[0] = (uint8_t)v;
+	p[1] = (uint8_t)(v >> 8);
+	p[2] = (uint8_t)(v >> 16);
+	p[3] = (uint8_t)(v >> 24);
+}
+
+static uint32_t get_le32(uint8_t const *p) {
+	return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+size_t lossless_bound(lossless_format_t format, int width, int height) {
+	component_t comps[3];
+	size_t size = HEADER_SIZE;
+	int count;
+	int i;
+
+	count = get_components(format, width, height, comps);
+	if (0 == count) {
+		return 0;
+	}
+	for (i = 0; i < count; ++i) {
+		size += COMPONENT_HEADER + (size_t)comps[i].width * comps[i].height;
+	}
+	return size;
+}
+
+size_t lossless_plane_size(lossless_format_t format, int width, int height, int plane, int stride) {
+	component_t comps[3];
+	size_t size = 0;
+	size_t end;
+	int count;
+	int i;
+
+	count = get_components(format, width, height, comps);
+	for (i = 0; i < count; ++i) {
+		if (plane != comps[i].plane) {
+			continue;
+		}
+		end = (size_t)stride * (comps[i].height - 1) + comps[i].offset + (size_t)comps[i].step * (comps[i].width - 1) + 1;
+		if (end > size) {
+			size = end;
+		}
+	}
+	return size;
+}
+
+static void gather_row(uint8_t *row, uint8_t const *src, int step, int n) {
+	int i = 0;
+	if (1 == step) {
+		memcpy(row, src, n);
+		return;
+	}
+#ifdef LOSSLESS_NEON
+	// the last sample of a packed row is the only one read, never the bytes past it.
+	if (2 == step) {
+		for (; i + 16 <= n - 1; i += 16) {
+			vst1q_u8(row + i, vld2q_u8(src + i * 2).val[0]);
+		}
+	} else if (4 == step) {
+		for (; i + 16 <= n - 1; i += 16) {
+			vst1q_u8(row + i, vld4q_u8(src + i * 4).val[0]);
+		}
+	}
+#endif
+	for (; i < n; ++i) {
+		row[i] = src[i * step];
+	}
+}
+
+static void scatter_row(uint8_t *dst, uint8_t const *row, int step, int n) {
+	int i;
+	if (1 == step) {
+		memcpy(dst, row, n);
+		return;
+	}
+	for (i = 0; i < n; ++i) {
+		dst[i * step] = row[i];
+	}
+}
+
+// median edge detector of LOCO-I, median(a, b, a + b - c) written without
+// branches: the gradient clamped between left and up.
+static inline int predict(int a, int b, int c) {
+	int const mx = (a > b) ? a : b;
+	int const mn = (a > b) ? b : a;
+	int const g = a + b - c;
+	return (g > mx) ? mx : ((g < mn) ? mn : g);
+}
+
+// zig-zag mapping of residuals: 0, -1, 1, -2, 2... to 0, 1, 2, 3, 4...
+static inline uint8_t to_symbol(int residual) {
+	int8_t const r = (int8_t)residual;
+	return (uint8_t)(((uint32_t)r << 1) ^ (uint32_t)(r >> 7));
+}
+
+static inline int from_symbol(uint32_t v) {
+	return (int)(v >> 1) ^ -(int)(v & 1);
+}
+
+#ifdef LOSSLESS_NEON
+static inline uint8x16_t to_symbols(uint8x16_t r) {
+	int8x16_t const sign = vshrq_n_s8(vreinterpretq_s8_u8(r), 7);
+	return veorq_u8(vshlq_n_u8(r, 1), vreinterpretq_u8_s8(sign));
+}
+
+// predict() in 8 bits: left and up bound the gradient, so it wraps only when clamped.
+static inline uint8x16_t predict16(uint8x16_t a, uint8x16_t b, uint8x16_t c) {
+	uint8x16_t const mx = vmaxq_u8(a, b);
+	uint8x16_t const mn = vminq_u8(a, b);
+	uint8x16_t const g = vsubq_u8(vaddq_u8(a, b), c);
+	return vbslq_u8(vcgeq_u8(c, mx), mn, vbslq_u8(vcleq_u8(c, mn), mx, g));
+}
+#endif
+
+// the encoder knows the whole row, so no sample depends on the previous residual.
+static void residual_row(uint8_t *res, uint8_t const *cur, uint8_t const *up, int n) {
+	int i = 1;
+	if (NULL == up) {
+		res[0] = to_symbol(cur[0] - 128);
+#ifdef LOSSLESS_NEON
+		for (; i + 16 <= n; i += 16) {
+			vst1q_u8(res + i, to_symbols(vsubq_u8(vld1q_u8(cur + i), vld1q_u8(cur + i - 1))));
+		}
+#endif
+		for (; i < n; ++i) {
+			res[i] = to_symbol(cur[i] - cur[i - 1]);
+		}
+		return;
+	}
+	res[0] = to_symbol(cur[0] - up[0]);
+#ifdef LOSSLESS_NEON
+	for (; i + 16 <= n; i += 16) {
+		uint8x16_t const p = predict16(vld1q_u8(cur + i - 1), vld1q_u8(up + i), vld1q_u8(up + i - 1));
+		vst1q_u8(res + i, to_symbols(vsubq_u8(vld1q_u8(cur + i), p)));
+	}
+#endif
+	for (; i < n; ++i) {
+		res[i] = to_symbol(cur[i] - predict(cur[i - 1], up[i], up[i - 1]));
+	}
+}
+
+// bits are packed from the least significant end; the whole accumulator is
+// stored (little endian) every time so the writer needs 8 bytes of slack and
+// never branches.
+static inline void put_bits(bit_writer_t *bw, uint64_t value, int len) {
+	bw->acc |= (uint64_t)value << bw->bits;
+	bw->bits += len;
+	memcpy(bw->p, &bw->acc, sizeof(bw->acc));
+	bw->p += bw->bits >> 3;
+	bw->acc >>= bw->bits & ~7;
+	bw->bits &= 7;
+}
+
+static void flush_bits(bit_writer_t *bw) {
+	if (0 < bw->bits) {
+		*bw->p++ = (uint8_t)bw->acc;
+	}
+	bw->acc = 0;
+	bw->bits = 0;
+}
+
+static inline uint32_t block_sum(uint8_t const *res, int m) {
+	uint32_t sum = 0;
+	int j;
+#ifdef LOSSLESS_NEON
+	if (BLOCK_SIZE == m) {
+		uint64x2_t const s = vpaddlq_u32(vpaddlq_u16(vpaddlq_u8(vld1q_u8(res))));
+		return (uint32_t)(vgetq_lane_u64(s, 0) + vgetq_lane_u64(s, 1));
+	}
+#endif
+	for (j = 0; j < m; ++j) {
+		sum += res[j];
+	}
+	return sum;
+}
+
+static void encode_row(bit_writer_t *out, uint8_t const *res, int n) {
+	// a local writer stays in registers, the byte stores could alias '*out'.
+	bit_writer_t w = *out;
+	bit_writer_t *bw = &w;
+	rice_code_t const *codes;
+	rice_code_t const *c0;
+	rice_code_t const *c1;
+	uint32_t sum;
+	int i, j, m, k;
+
+	for (i = 0; i < n; i += BLOCK_SIZE) {
+		m = (n - i < BLOCK_SIZE) ? n - i : BLOCK_SIZE;
+		sum = block_sum(res + i, m);
+		// the smallest k whose 2^k covers the mean symbol.
+		for (k = 0; (MAX_K > k) && (((uint32_t)m << k) < sum); ++k) {
+		}
+		put_bits(bw, k, K_BITS);
+		codes = rice_codes[k];
+		// two codes are 48 bits at most, they go out with a single store.
+		for (j = 0; j + 2 <= m; j += 2) {
+			c0 = &codes[res[i + j]];
+			c1 = &codes[res[i + j + 1]];
+			put_bits(bw, c0->bits | ((uint64_t)c1->bits << c0->length), c0->length + c1->length);
+		}
+		if (j < m) {
+			put_bits(bw, codes[res[i + j]].bits, codes[res[i + j]].length);
+		}
+	}
+	*out = w;
+}
+
+// bytes a row of n samples may take at most, flush included.
+static size_t row_bound(int n) {
+	return ((size_t)n * (ESCAPE + 8) + ((size_t)n / BLOCK_SIZE + 1) * K_BITS) / 8 + 8;
+}
+
+static int encode_component(component_t const *c, uint8_t const *base, int stride,
+	uint8_t *rows, uint8_t *res, uint8_t *dst, size_t capacity, size_t *written) {
+	size_t const raw_size = (size_t)c->width * c->height;
+	size_t const limit = (raw_size < capacity - COMPONENT_HEADER) ? raw_size : capacity - COMPONENT_HEADER;
+	uint8_t *payload = dst + COMPONENT_HEADER;
+	uint8_t *cur = rows;
+	uint8_t *up = NULL;
+	uint8_t *tmp;
+	bit_writer_t bw;
+	size_t size;
+	int y;
+
+	if (COMPONENT_HEADER > capacity) {
+		return LOSSLESS_BUFFER_TOO_SMALL;
+	}
+
+	bw.p = payload;
+	bw.acc = 0;
+	bw.bits = 0;
+	for (y = 0; y < c->height; ++y) {
+		if ((size_t)(bw.p - payload) + row_bound(c->width) > limit) {
+			break;
+		}
+		gather_row(cur, base + (size_t)stride * y + c->offset, c->step, c->width);
+		residual_row(res, cur, up, c->width);
+		encode_row(&bw, res, c->width);
+		tmp = (NULL == up) ? rows + c->width : up;
+		up = cur;
+		cur = tmp;
+	}
+	flush_bits(&bw);
+	size = bw.p - payload;
+
+	if ((y < c->height) || (size >= raw_size)) {
+		// does not shrink, or may not fit; store the samples as is.
+		if (raw_size > capacity - COMPONENT_HEADER) {
+			return LOSSLESS_BUFFER_TOO_SMALL;
+		}
+		for (y = 0; y < c->height; ++y) {
+			gather_row(payload + (size_t)c->width * y, base + (size_t)stride * y + c->offset, c->step, c->width);
+		}
+		dst[0] = MODE_RAW;
+		size = raw_size;
+	} else {
+		dst[0] = MODE_RICE;
+	}
+	put_le32(dst + 1, (uint32_t)size);
+	*written = COMPONENT_HEADER + size;
+	return LOSSLESS_NOERROR;
+}
+
+int lossless_encode(lossless_format_t format, int width, int height,
+	uint8_t const * const planes[3], int const strides[3],
+	uint8_t *dst, size_t dst_size, size_t *written) {
+	component_t comps[3];
+	uint8_t *rows;
+	size_t pos = HEADER_SIZE;
+	size_t size = 0;
+	int count;
+	int result = LOSSLESS_NOERROR;
+	int i;
+
+	count = get_components(format, width, height, comps);
+	if ((0 == count) || (NULL == planes) || (NULL == strides) || (NULL == dst) || (NULL == written)) {
+		return LOSSLESS_INVALID_ARGUMENTS;
+	}
+	for (i = 0; i < count; ++i) {
+		if (NULL == planes[comps[i].plane]) {
+			return LOSSLESS_INVALID_ARGUMENTS;
+		}
+	}
+	if (HEADER_SIZE > dst_size) {
+		return LOSSLESS_BUFFER_TOO_SMALL;
+	}
+
+	pthread_once(&rice_codes_once, init_rice_codes);
+
+	// two rows of samples and one of residuals.
+	rows = (uint8_t*)malloc((size_t)width * 3);
+	if (NULL == rows) {
+		return LOSSLESS_INSUFFICIENT_MEMORY;
+	}
+
+	memcpy(dst, "ULLC", 4);
+	dst[4] = LOSSLESS_VERSION;
+	dst[5] = (uint8_t)format;
+	dst[6] = 0;
+	dst[7] = 0;
+	put_le32(dst + 8, width);
+	put_le32(dst + 12, height);
+
+	for (i = 0; (i < count) && (LOSSLESS_NOERROR == result); ++i) {
+		result = encode_component(&comps[i], planes[comps[i].plane], strides[comps[i].plane],
+			rows, rows + (size_t)width * 2, dst + pos, dst_size - pos, &size);
+		pos += size;
+	}
+	free(rows);
+
+	if (LOSSLESS_NOERROR == result) {
+		*written = pos;
+	}
+	return result;
+}
+
+int lossless_get_info(uint8_t const *src, size_t size, lossless_format_t *format, int *width, int *height) {
+	component_t comps[3];
+	uint32_t w, h;
+
+	if ((NULL == src) || (HEADER_SIZE > size)) {
+		return LOSSLESS_INVALID_ARGUMENTS;
+	}
+	if ((0 != memcmp(src, "ULLC", 4)) || (LOSSLESS_VERSION != src[4])) {
+		return LOSSLESS_CORRUPTED;
+	}
+	w = get_le32(src + 8);
+	h = get_le32(src + 12);
+	if ((MAX_DIMENSION < w) || (MAX_DIMENSION < h) ||
+		(0 == get_components((lossless_format_t)src[5], (int)w, (int)h, comps))) {
+		return LOSSLESS_CORRUPTED;
+	}
+	if (NULL != format) {
+		*format = (lossless_format_t)src[5];
+	}
+	if (NULL != width) {
+		*width = (int)w;
+	}
+	if (NULL != height) {
+		*height = (int)h;
+	}
+	return LOSSLESS_NOERROR;
+}
+
+static inline void refill(bit_reader_t *br) {
+	uint64_t w;
+	int n;
+
+	if (8 <= br->end - br->p) {
+		memcpy(&w, br->p, sizeof(w));
+		br->acc |= w << br->bits;
+		n = (63 - br->bits) >> 3;
+		br->p += n;
+		br->bits += n * 8;
+		return;
+	}
+	while (56 >= br->bits) {
+		if (br->p < br->end) {
+			br->acc |= (uint64_t)*br->p++ << br->bits;
+		} else {
+			++br->padding;
+		}
+		br->bits += 8;
+	}
+}
+
+static inline uint32_t get_bits(bit_reader_t *br, int len) {
+	uint32_t const v = (uint32_t)br->acc & ((1u << len) - 1);
+	br->acc >>= len;
+	br->bits -= len;
+	return v;
+}
+
+// samples 'i' to 'n' of a row whose residuals are known up to 'n'.
+static void reconstruct_span(uint8_t *cur, uint8_t const *res, uint8_t const *up, int i, int n) {
+	int a;
+
+	if (0 == i) {
+		cur[0] = (uint8_t)(((NULL == up) ? 128 : up[0]) + from_symbol(res[0]));
+		i = 1;
+	}
+	if (NULL == up) {
+		for (; i < n; ++i) {
+			cur[i] = (uint8_t)(cur[i - 1] + from_symbol(res[i]));
+		}
+		return;
+	}
+	// predict() as left plus up minus left, clamped between 0 and up minus up-left:
+	// the bounds do not depend on the left sample, which shortens the chain through it.
+	a = cur[i - 1];
+	for (; i < n; ++i) {
+		int const d = up[i] - up[i - 1];
+		int const lo = (0 > d) ? d : 0;
+		int const hi = (0 > d) ? 0 : d;
+		int e = up[i] - a;
+		e = (e < lo) ? lo : e;
+		e = (e > hi) ? hi : e;
+		a = (uint8_t)(a + e + from_symbol(res[i]));
+		cur[i] = (uint8_t)a;
+	}
+}
+
+/*
+ * Each block is reconstructed as soon as it is decoded: parsing the bits and
+ * predicting are two serial chains, the CPU overlaps them across blocks.
+ */
+static int decode_row(bit_reader_t *in, uint8_t *res, uint8_t *cur, uint8_t const *up, int n) {
+	// as in encode_row, the stores to 'res' and 'cur' could alias '*in'.
+	bit_reader_t r = *in;
+	uint32_t const *peeks;
+	uint32_t e, v, q, len;
+	int result = LOSSLESS_NOERROR;
+	int i, j, m, k;
+
+	for (i = 0; i < n; i += BLOCK_SIZE) {
+		m = (n - i < BLOCK_SIZE) ? n - i : BLOCK_SIZE;
+		refill(&r);
+		k = get_bits(&r, K_BITS);
+		if (MAX_K < k) {
+			result = LOSSLESS_CORRUPTED;
+			break;
+		}
+		peeks = rice_peeks[k];
+		for (j = i; j < i + m; ) {
+			// a refill leaves at least 56 bits, enough for two codes.
+			if (ESCAPE + 8 > r.bits) {
+				refill(&r);
+			}
+			e = peeks[r.acc & ((1u << PEEK_BITS) - 1)];
+			if ((2 == (e & 3)) && (j + 1 < i + m)) {
+				res[j++] = (uint8_t)(e >> 12);
+				res[j++] = (uint8_t)(e >> 20);
+				len = (e >> 7) & 0x1f;
+			} else if (0 != e) {
+				res[j++] = (uint8_t)(e >> 12);
+				len = (e >> 2) & 0x1f;
+			} else {
+				q = __builtin_ctzll(~r.acc | ((uint64_t)1 << ESCAPE));
+				if (ESCAPE <= q) {
+					v = (uint32_t)(r.acc >> ESCAPE) & 0xff;
+					len = ESCAPE + 8;
+				} else {
+					v = (q << k) | ((uint32_t)(r.acc >> (q + 1)) & ((1u << k) - 1));
+					len = q + 1 + k;
+					if (255 < v) {
+						result = LOSSLESS_CORRUPTED;
+						break;
+					}
+				}
+				res[j++] = (uint8_t)v;
+			}
+			r.acc >>= len;
+			r.bits -= len;
+		}
+		if (LOSSLESS_NOERROR != result) {
+			break;
+		}
+		reconstruct_span(cur, res, up, i, i + m);
+	}
+	*in = r;
+	return result;
+}
+
+static int decode_component(component_t const *c, uint8_t const *src, size_t size,
+	uint8_t *rows, uint8_t *res, uint8_t *base, int stride) {
+	uint8_t *cur = rows;
+	uint8_t *up = NULL;
+	uint8_t *tmp;
+	bit_reader_t br;
+	int result;
+	int y;
+
+	br.p = src;
+	br.end = src + size;
+	br.acc = 0;
+	br.bits = 0;
+	br.padding = 0;
+	for (y = 0; y < c->height; ++y) {
+		result = decode_row(&br, res, cur, up, c->width);
+		if (LOSSLESS_NOERROR != result) {
+			return result;
+		}
+		scatter_row(base + (size_t)stride * y + c->offset, cur, c->step, c->width);
+		tmp = (NULL == up) ? rows + c->width : up;
+		up = cur;
+		cur = tmp;
+	}
+	// bits read past the end of the payload.
+	if (br.padding * 8 > br.bits) {
+		return LOSSLESS_CORRUPTED;
+	}
+	return LOSSLESS_NOERROR;
+}
+
+int lossless_decode(uint8_t const *src, size_t size, uint8_t * const planes[3], int const strides[3]) {
+	component_t comps[3];
+	lossless_format_t format;
+	uint8_t *rows;
+	size_t pos = HEADER_SIZE;
+	size_t payload;
+	int width, height;
+	int count;
+	int result;
+	int i, y;
+
+	result = lossless_get_info(src, size, &format, &width, &height);
+	if (LOSSLESS_NOERROR != result) {
+		return result;
+	}
+	if ((NULL == planes) || (NULL == strides)) {
+		return LOSSLESS_INVALID_ARGUMENTS;
+	}
+	count = get_components(format, width, height, comps);
+	for (i = 0; i < count; ++i) {
+		if (NULL == planes[comps[i].plane]) {
+			return LOSSLESS_INVALID_ARGUMENTS;
+		}
+	}
+
+	pthread_once(&rice_codes_once, init_rice_codes);
+
+	// two rows of samples and one of residuals.
+	rows = (uint8_t*)malloc((size_t)width * 3);
+	if (NULL == rows) {
+		return LOSSLESS_INSUFFICIENT_MEMORY;
+	}
+
+	for (i = 0; (i < count) && (LOSSLESS_NOERROR == result); ++i) {
+		component_t const *c = &comps[i];
+		uint8_t *base = planes[c->plane];
+		int const stride = strides[c->plane];
+
+		if (COMPONENT_HEADER > size - pos) {
+			result = LOSSLESS_CORRUPTED;
+			break;
+		}
+		payload = get_le32(src + pos + 1);
+		if (payload > size - pos - COMPONENT_HEADER) {
+			result = LOSSLESS_CORRUPTED;
+			break;
+		}
+		if (MODE_RAW == src[pos]) {
+			if (payload != (size_t)c->width * c->height) {
+				result = LOSSLESS_CORRUPTED;
+				break;
+			}
+			for (y = 0; y < c->height; ++y) {
+				scatter_row(base + (size_t)stride * y + c->offset,
+					src + pos + COMPONENT_HEADER + (size_t)c->width * y, c->step, c->width);
+			}
+		} else if (MODE_RICE == src[pos]) {
+			result = decode_component(c, src + pos + COMPONENT_HEADER, payload, rows, rows + (size_t)width * 2, base, stride);
+		} else {
+			result = LOSSLESS_CORRUPTED;
+		}
+		pos += COMPONENT_HEADER + payload;
+	}
+	free(rows);
+
+	return result;
+}
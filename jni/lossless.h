@@ -0,0 +1,59 @@
+#ifndef LOSSLESS_CODEC_H
+#define LOSSLESS_CODEC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum lossless_error_t {
+	LOSSLESS_NOERROR = 0,
+	LOSSLESS_INVALID_ARGUMENTS,
+	LOSSLESS_INSUFFICIENT_MEMORY,
+	LOSSLESS_BUFFER_TOO_SMALL,
+	LOSSLESS_CORRUPTED,
+} lossless_error_t;
+
+/*
+ * Layouts of the frames. Packed and semi-planar formats are split into Y, U
+ * and V while they are coded, each plane is then predicted row by row
+ * (left neighbour on the first row, median of left, up and up-left after)
+ * and the residuals are Rice coded with a parameter chosen per 16 samples.
+ * A plane that does not shrink is stored as is.
+ */
+typedef enum lossless_format_t {
+	LOSSLESS_FORMAT_YUYV = 0,
+	LOSSLESS_FORMAT_UYVY,
+	LOSSLESS_FORMAT_I420,
+	LOSSLESS_FORMAT_YUV422P,
+	LOSSLESS_FORMAT_NV12,
+	LOSSLESS_FORMAT_NV21,
+	LOSSLESS_FORMAT_GREY,
+	LOSSLESS_FORMAT_COUNT,
+} lossless_format_t;
+
+/* Largest encoded size of a frame, 0 if the arguments are invalid. */
+extern size_t lossless_bound(lossless_format_t format, int width, int height);
+
+/* Bytes of 'plane' the frame spans with 'stride', 0 if the format has no such plane. */
+extern size_t lossless_plane_size(lossless_format_t format, int width, int height, int plane, int stride);
+
+/*
+ * 'planes' and 'strides' (in bytes) follow the format: one packed plane,
+ * Y and interleaved UV, or Y, U and V. The source may be the mapped driver
+ * buffer, it is only read.
+ */
+extern int lossless_encode(lossless_format_t format, int width, int height,
+	uint8_t const * const planes[3], int const strides[3],
+	uint8_t *dst, size_t dst_size, size_t *written);
+
+extern int lossless_get_info(uint8_t const *src, size_t size, lossless_format_t *format, int *width, int *height);
+extern int lossless_decode(uint8_t const *src, size_t size, uint8_t * const planes[3], int const strides[3]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
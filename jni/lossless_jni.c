@@ -0,0 +1,225 @@
+#include "lossless_jni.h"
+#include "lossless.h"
+#include <stdint.h>
+
+static void throw_IllegalArgumentException(JNIEnv *env, char const * const message);
+static void throw_NullPointerException(JNIEnv *env, char const * const message);
+static void throw_RuntimeException(JNIEnv *env, char const * const message);
+static int  get_planes(JNIEnv *env, jobjectArray planes, jintArray strides,
+	int format, int width, int height, uint8_t *ptrs[3], int pitches[3]);
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_LosslessCodec
+ * Method:    n_getMaxEncodedSize
+ * Signature: (III)I
+ */
+JNIEXPORT jint JNICALL Java_net_crimsonwoods_android_libs_uvccap_LosslessCodec_n_1getMaxEncodedSize
+  (JNIEnv *env, jclass cls, jint format, jint width, jint height)
+{
+	size_t const size = lossless_bound((lossless_format_t)format, width, height);
+	if ((0 == size) || (INT32_MAX < size)) {
+		throw_IllegalArgumentException(env, "Unsupported format or size.");
+		return 0;
+	}
+	return (jint)size;
+}
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_LosslessCodec
+ * Method:    n_encode
+ * Signature: (Ljava/nio/ByteBuffer;III[Ljava/nio/ByteBuffer;[I)I
+ */
+JNIEXPORT jint JNICALL Java_net_crimsonwoods_android_libs_uvccap_LosslessCodec_n_1encode
+  (JNIEnv *env, jclass cls, jobject dst, jint format, jint width, jint height, jobjectArray planes, jintArray strides)
+{
+	uint8_t *ptrs[3];
+	int pitches[3];
+	uint8_t *dst_ptr;
+	jlong dst_capacity;
+	size_t written = 0;
+	int result;
+
+	if (NULL == dst) {
+		throw_NullPointerException(env, "'dst' have to be set not null.");
+		return 0;
+	}
+	dst_ptr = (uint8_t*)(*env)->GetDirectBufferAddress(env, dst);
+	dst_capacity = (*env)->GetDirectBufferCapacity(env, dst);
+	if ((NULL == dst_ptr) || (0 > dst_capacity)) {
+		throw_IllegalArgumentException(env, "'dst' have to be direct buffer.");
+		return 0;
+	}
+	if (!get_planes(env, planes, strides, format, width, height, ptrs, pitches)) {
+		return 0;
+	}
+
+	result = lossless_encode((lossless_format_t)format, width, height,
+		(uint8_t const * const*)ptrs, pitches, dst_ptr, (size_t)dst_capacity, &written);
+	if (LOSSLESS_BUFFER_TOO_SMALL == result) {
+		throw_IllegalArgumentException(env, "'dst' is too small.");
+		return 0;
+	} else if (LOSSLESS_NOERROR != result) {
+		throw_RuntimeException(env, "Frame can't be encoded.");
+		return 0;
+	}
+	return (jint)written;
+}
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_LosslessCodec
+ * Method:    n_getInfo
+ * Signature: (Ljava/nio/ByteBuffer;I[I)Z
+ */
+JNIEXPORT jboolean JNICALL Java_net_crimsonwoods_android_libs_uvccap_LosslessCodec_n_1getInfo
+  (JNIEnv *env, jclass cls, jobject src, jint length, jintArray info)
+{
+	lossless_format_t format;
+	uint8_t const *src_ptr;
+	jint values[3];
+	int width, height;
+
+	if ((NULL == src) || (NULL == info)) {
+		throw_NullPointerException(env, "'src' and 'info' have to be set not null.");
+		return JNI_FALSE;
+	}
+	src_ptr = (uint8_t const*)(*env)->GetDirectBufferAddress(env, src);
+	if (NULL == src_ptr) {
+		throw_IllegalArgumentException(env, "'src' have to be direct buffer.");
+		return JNI_FALSE;
+	}
+	if ((0 > length) || (length > (*env)->GetDirectBufferCapacity(env, src)) || (3 > (*env)->GetArrayLength(env, info))) {
+		throw_IllegalArgumentException(env, "'length' or 'info' is out of range.");
+		return JNI_FALSE;
+	}
+	if (LOSSLESS_NOERROR != lossless_get_info(src_ptr, length, &format, &width, &height)) {
+		return JNI_FALSE;
+	}
+	values[0] = format;
+	values[1] = width;
+	values[2] = height;
+	(*env)->SetIntArrayRegion(env, info, 0, 3, values);
+	return JNI_TRUE;
+}
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_LosslessCodec
+ * Method:    n_decode
+ * Signature: ([Ljava/nio/ByteBuffer;[ILjava/nio/ByteBuffer;I)V
+ */
+JNIEXPORT void JNICALL Java_net_crimsonwoods_android_libs_uvccap_LosslessCodec_n_1decode
+  (JNIEnv *env, jclass cls, jobjectArray planes, jintArray strides, jobject src, jint length)
+{
+	lossless_format_t format;
+	uint8_t const *src_ptr;
+	uint8_t *ptrs[3];
+	int pitches[3];
+	int width, height;
+	int result;
+
+	if (NULL == src) {
+		throw_NullPointerException(env, "'src' have to be set not null.");
+		return;
+	}
+	src_ptr = (uint8_t const*)(*env)->GetDirectBufferAddress(env, src);
+	if (NULL == src_ptr) {
+		throw_IllegalArgumentException(env, "'src' have to be direct buffer.");
+		return;
+	}
+	if ((0 > length) || (length > (*env)->GetDirectBufferCapacity(env, src))) {
+		throw_IllegalArgumentException(env, "'length' is out of range.");
+		return;
+	}
+	if (LOSSLESS_NOERROR != lossless_get_info(src_ptr, length, &format, &width, &height)) {
+		throw_RuntimeException(env, "Corrupted stream.");
+		return;
+	}
+	// the planes are checked against the geometry recorded in the stream.
+	if (!get_planes(env, planes, strides, format, width, height, ptrs, pitches)) {
+		return;
+	}
+	result = lossless_decode(src_ptr, length, ptrs, pitches);
+	if (LOSSLESS_NOERROR != result) {
+		throw_RuntimeException(env, "Corrupted stream.");
+	}
+}
+
+static int get_planes(JNIEnv *env, jobjectArray planes, jintArray strides,
+	int format, int width, int height, uint8_t *ptrs[3], int pitches[3])
+{
+	jint values[3] = { 0, 0, 0 };
+	jobject plane;
+	jlong capacity;
+	size_t required;
+	jsize count;
+	int i;
+
+	if ((NULL == planes) || (NULL == strides)) {
+		throw_NullPointerException(env, "'planes' and 'strides' have to be set not null.");
+		return 0;
+	}
+	if (0 == lossless_bound((lossless_format_t)format, width, height)) {
+		throw_IllegalArgumentException(env, "Unsupported format or size.");
+		return 0;
+	}
+	count = (*env)->GetArrayLength(env, planes);
+	if ((3 < count) || ((*env)->GetArrayLength(env, strides) < count)) {
+		throw_IllegalArgumentException(env, "'planes' or 'strides' is out of range.");
+		return 0;
+	}
+	(*env)->GetIntArrayRegion(env, strides, 0, count, values);
+
+	for (i = 0; i < 3; ++i) {
+		ptrs[i] = NULL;
+		pitches[i] = values[i];
+		required = lossless_plane_size((lossless_format_t)format, width, height, i, values[i]);
+		if (0 == required) {
+			continue;
+		}
+		if ((i >= count) || (0 >= values[i])) {
+			throw_IllegalArgumentException(env, "Too few planes for the format.");
+			return 0;
+		}
+		plane = (*env)->GetObjectArrayElement(env, planes, i);
+		if (NULL == plane) {
+			throw_NullPointerException(env, "'planes' have to be set not null.");
+			return 0;
+		}
+		ptrs[i] = (uint8_t*)(*env)->GetDirectBufferAddress(env, plane);
+		capacity = (*env)->GetDirectBufferCapacity(env, plane);
+		(*env)->DeleteLocalRef(env, plane);
+		if (NULL == ptrs[i]) {
+			throw_IllegalArgumentException(env, "'planes' have to be direct buffers.");
+			return 0;
+		}
+		if ((0 > capacity) || ((size_t)capacity < required)) {
+			throw_IllegalArgumentException(env, "A plane is smaller than the frame.");
+			return 0;
+		}
+	}
+	return 1;
+}
+
+static void throw_exception(JNIEnv *env, char const * const cls, char const * const message)
+{
+	jclass ioe_cls = (*env)->FindClass(env, cls);
+	if (NULL == ioe_cls) {
+		return;
+	}
+	(*env)->ThrowNew(env, ioe_cls, message);
+	(*env)->DeleteLocalRef(env, ioe_cls);
+}
+
+static void throw_IllegalArgumentException(JNIEnv *env, char const * const message)
+{
+	throw_exception(env, "java/lang/IllegalArgumentException", message);
+}
+
+static void throw_NullPointerException(JNIEnv *env, char const * const message)
+{
+	throw_exception(env, "java/lang/NullPointerException", message);
+}
+
+static void throw_RuntimeException(JNIEnv *env, char const * const message)
+{
+	throw_exception(env, "java/lang/RuntimeException", message);
+}
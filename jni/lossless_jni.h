@@ -0,0 +1,45 @@
+/* DO NOT EDIT THIS FILE - it is machine generated */
+#include <jni.h>
+/* Header for class net_crimsonwoods_android_libs_uvccap_LosslessCodec */
+
+#ifndef _Included_net_crimsonwoods_android_libs_uvccap_LosslessCodec
+#define _Included_net_crimsonwoods_android_libs_uvccap_LosslessCodec
+#ifdef __cplusplus
+extern "C" {
+#endif
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_LosslessCodec
+ * Method:    n_getMaxEncodedSize
+ * Signature: (III)I
+ */
+JNIEXPORT jint JNICALL Java_net_crimsonwoods_android_libs_uvccap_LosslessCodec_n_1getMaxEncodedSize
+  (JNIEnv *, jclass, jint, jint, jint);
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_LosslessCodec
+ * Method:    n_encode
+ * Signature: (Ljava/nio/ByteBuffer;III[Ljava/nio/ByteBuffer;[I)I
+ */
+JNIEXPORT jint JNICALL Java_net_crimsonwoods_android_libs_uvccap_LosslessCodec_n_1encode
+  (JNIEnv *, jclass, jobject, jint, jint, jint, jobjectArray, jintArray);
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_LosslessCodec
+ * Method:    n_getInfo
+ * Signature: (Ljava/nio/ByteBuffer;I[I)Z
+ */
+JNIEXPORT jboolean JNICALL Java_net_crimsonwoods_android_libs_uvccap_LosslessCodec_n_1getInfo
+  (JNIEnv *, jclass, jobject, jint, jintArray);
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_LosslessCodec
+ * Method:    n_decode
+ * Signature: ([Ljava/nio/ByteBuffer;[ILjava/nio/ByteBuffer;I)V
+ */
+JNIEXPORT void JNICALL Java_net_crimsonwoods_android_libs_uvccap_LosslessCodec_n_1decode
+  (JNIEnv *, jclass, jobjectArray, jintArray, jobject, jint);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
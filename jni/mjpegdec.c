@@ -0,0 +1,1258 @@
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+
+#include "mjpegdec.h"
+#include "jpegtab.h"
+#include "cconv.h"
+#include "uvccthread.h"
+
+#ifdef UVCC_USE_LIBJPEG_TURBO
+#include <turbojpeg.h>
+#endif
+
+#define MAX_COMPONENTS 3
+#define FAST_BITS      9
+#define CONST_BITS     13
+#define PASS1_BITS     2
+#define REDUCED_BITS   10
+#define MAX_COEF       2047 // 8 bit samples give 12 bit signed DCT coefficients
+
+#define DESCALE(x, n) (((x) + (1 << ((n) - 1))) >> (n))
+
+/* Data structure and constant values */
+typedef struct huffman_table_t_ {
+	uint8_t fast_length[1 << FAST_BITS]; // 0 if the code is longer than FAST_BITS.
+	uint8_t fast_value[1 << FAST_BITS];
+	int32_t maxcode[17];
+	int32_t valoffset[17];
+	uint8_t values[256];
+} huffman_table_t;
+
+typedef struct component_t_ {
+	int      id;
+	int      h;
+	int      v;
+	int      tq;
+	int      td;
+	int      ta;
+	uint8_t *plane;  // destination of the decoded samples.
+	int      stride;
+	int      width;  // visible samples in 'plane'.
+	int      height;
+} component_t;
+
+typedef struct bit_reader_t_ {
+	uint8_t const *ptr;
+	uint8_t const *end;
+	uint32_t       acc;
+	int            count;
+} bit_reader_t;
+
+typedef struct decode_job_t_ {
+	uint8_t const *begin;
+	uint8_t const *end;
+	int            mcu_begin;
+	int            mcu_end;
+	int            result;
+} decode_job_t;
+
+struct mjpeg_decoder_t_ {
+	huffman_table_t  dc_tables[4];
+	huffman_table_t  ac_tables[4];
+	uint16_t         qt[4][64];
+	component_t      comps[MAX_COMPONENTS];
+	int              comp_count;
+	int              width;
+	int              height;
+	int              hmax;
+	int              vmax;
+	int              mcus_x;
+	int              mcus_y;
+	int              restart_interval;
+	int              block_size;
+	uint8_t         *scratch;
+	size_t           scratch_size;
+	uint8_t const  **segments;
+	int              segment_capacity;
+	pthread_t       *workers;
+	int              worker_count;
+	pid_t           *worker_tids;
+	int              started_count;
+	pthread_mutex_t  lock;
+	pthread_cond_t   start_cond;
+	pthread_cond_t   done_cond;
+	unsigned         generation;
+	int              quit;
+	decode_job_t    *jobs;
+	int              job_capacity;
+	int              job_count;
+	int              next_job;
+	int              done_jobs;
+#ifdef UVCC_USE_LIBJPEG_TURBO
+	tjhandle         turbo;
+#endif
+};
+
+static pthread_once_t  tables_once = PTHREAD_ONCE_INIT;
+static huffman_table_t default_dc_tables[2];
+static huffman_table_t default_ac_tables[2];
+static int32_t         reduced_table_4[4][4];
+static int32_t         reduced_table_2[2][2];
+
+/* Internal APIs */
+static int  build_huffman_table(huffman_table_t *table, uint8_t const *bits, uint8_t const *values);
+static void init_tables(void);
+static int  decode_range(mjpeg_decoder_t *dec, uint8_t const *begin, uint8_t const *end, int mcu_begin, int mcu_end);
+static void run_jobs_locked(mjpeg_decoder_t *dec);
+static void *worker_main(void *arg);
+
+static int build_huffman_table(huffman_table_t *table, uint8_t const *bits, uint8_t const *values) {
+	int code = 0;
+	int k = 0;
+	int len, i, j;
+
+	memset(table->fast_length, 0, sizeof(table->fast_length));
+
+	for (len = 1; len <= 16; ++len) {
+		int const n = bits[len - 1];
+		table->valoffset[len] = k - code;
+		for (i = 0; i < n; ++i, ++code, ++k) {
+			// oversized counts would run the codes past 'len' bits and the fast table.
+			if ((k >= 256) || (code >= (1 << len))) {
+				return MJPEG_CORRUPTED;
+			}
+			table->values[k] = values[k];
+			if (len <= FAST_BITS) {
+				int const shift = FAST_BITS - len;
+				for (j = 0; j < (1 << shift); ++j) {
+					table->fast_length[(code << shift) + j] = len;
+					table->fast_value[(code << shift) + j]  = values[k];
+				}
+			}
+		}
+		table->maxcode[len] = (0 == n) ? -1 : code - 1;
+		code <<= 1;
+	}
+
+	return MJPEG_NOERROR;
+}
+
+static void build_reduced_table(int32_t *table, int n) {
+	int const s = 8 / n;
+	int i, k, m;
+
+	// box filtered basis: the average of 's' full resolution samples.
+	for (i = 0; i < n; ++i) {
+		for (k = 0; k < n; ++k) {
+			double sum = 0.0;
+			for (m = i * s; m < (i + 1) * s; ++m) {
+				sum += cos((2 * m + 1) * k * M_PI / 16.0);
+			}
+			sum = sum / s / 2.0;
+			if (0 == k) {
+				sum /= sqrt(2.0);
+			}
+			table[i * n + k] = (int32_t)floor(sum * (1 << REDUCED_BITS) + 0.5);
+		}
+	}
+}
+
+static void init_tables(void) {
+	build_huffman_table(&default_dc_tables[0], JPEG_DC_LUMINANCE_BITS, JPEG_DC_LUMINANCE_VALUES);
+	build_huffman_table(&default_dc_tables[1], JPEG_DC_CHROMINANCE_BITS, JPEG_DC_CHROMINANCE_VALUES);
+	build_huffman_table(&default_ac_tables[0], JPEG_AC_LUMINANCE_BITS, JPEG_AC_LUMINANCE_VALUES);
+	build_huffman_table(&default_ac_tables[1], JPEG_AC_CHROMINANCE_BITS, JPEG_AC_CHROMINANCE_VALUES);
+	build_reduced_table(&reduced_table_4[0][0], 4);
+	build_reduced_table(&reduced_table_2[0][0], 2);
+}
+
+static inline uint8_t clamp_sample(int32_t value) {
+	return (value < 0) ? 0 : (value > 255) ? 255 : (uint8_t)value;
+}
+
+static inline int32_t clamp_coef(int32_t value) {
+	return (value < -MAX_COEF) ? -MAX_COEF : (value > MAX_COEF) ? MAX_COEF : value;
+}
+
+/*
+ * Valid streams never leave the 12 bit range, corrupt ones would otherwise
+ * overflow the fixed point IDCT.
+ */
+static inline int32_t dequantize(int32_t value, uint16_t q) {
+	return clamp_coef(clamp_coef(value) * q);
+}
+
+static void fill_bits(bit_reader_t *br) {
+	while (br->count <= 24) {
+		uint32_t byte = 0;
+		if (br->ptr < br->end) {
+			byte = *br->ptr;
+			if (0xff != byte) {
+				++br->ptr;
+			} else if ((br->ptr + 1 < br->end) && (0x00 == br->ptr[1])) {
+				br->ptr += 2;
+			} else {
+				// a marker terminates the segment, feed zeros until it is skipped.
+				byte = 0;
+			}
+		}
+		br->acc = (br->acc << 8) | byte;
+		br->count += 8;
+	}
+}
+
+static inline int decode_huffman(bit_reader_t *br, huffman_table_t const *table) {
+	int code, len, idx;
+
+	if (br->count < 16) {
+		fill_bits(br);
+	}
+
+	idx = (br->acc >> (br->count - FAST_BITS)) & ((1 << FAST_BITS) - 1);
+	len = table->fast_length[idx];
+	if (0 != len) {
+		br->count -= len;
+		return table->fast_value[idx];
+	}
+
+	code = (br->acc >> (br->count - 16)) & 0xffff;
+	for (len = FAST_BITS + 1; len <= 16; ++len) {
+		int const c = code >> (16 - len);
+		if (c <= table->maxcode[len]) {
+			br->count -= len;
+			return table->values[c + table->valoffset[len]];
+		}
+	}
+
+	return -1;
+}
+
+static inline int receive_extend(bit_reader_t *br, int s) {
+	int v;
+
+	if (br->count < s) {
+		fill_bits(br);
+	}
+	v = (br->acc >> (br->count - s)) & ((1u << s) - 1);
+	br->count -= s;
+
+	return (v < (1 << (s - 1))) ? v - (1 << s) + 1 : v;
+}
+
+static int skip_restart_marker(bit_reader_t *br) {
+	br->acc   = 0;
+	br->count = 0;
+	while (br->ptr + 1 < br->end) {
+		if ((0xff == br->ptr[0]) && (0xd0 <= br->ptr[1]) && (br->ptr[1] <= 0xd7)) {
+			br->ptr += 2;
+			return 1;
+		}
+		++br->ptr;
+	}
+	return 0;
+}
+
+static int decode_block(bit_reader_t *br, huffman_table_t const *dc, huffman_table_t const *ac,
+	uint16_t const *qt, int *dc_pred, int32_t *coef) {
+	int k, t, rs, r, s;
+
+	memset(coef, 0, sizeof(int32_t) * 64);
+
+	t = decode_huffman(br, dc);
+	if ((t < 0) || (t > 11)) {
+		return MJPEG_CORRUPTED;
+	}
+	if (0 != t) {
+		*dc_pred = clamp_coef(*dc_pred + receive_extend(br, t));
+	}
+	coef[0] = dequantize(*dc_pred, qt[0]);
+
+	for (k = 1; k < 64; ) {
+		rs = decode_huffman(br, ac);
+		if (rs < 0) {
+			return MJPEG_CORRUPTED;
+		}
+		r = rs >> 4;
+		s = rs & 15;
+		if (0 == s) {
+			if (15 != r) {
+				break; // EOB
+			}
+			k += 16;
+			continue;
+		}
+		k += r;
+		if (k > 63) {
+			return MJPEG_CORRUPTED;
+		}
+		coef[JPEG_ZIGZAG[k]] = dequantize(receive_extend(br, s), qt[k]);
+		++k;
+	}
+
+	return MJPEG_NOERROR;
+}
+
+/* 8x8 inverse DCT (Loeffler, Ligtenberg and Moschytz), 13 bit fixed point. */
+static void idct_8x8(int32_t const *coef, uint8_t *out) {
+	int32_t ws[64];
+	int32_t tmp0, tmp1, tmp2, tmp3, tmp10, tmp11, tmp12, tmp13;
+	int32_t z1, z2, z3, z4, z5;
+	int32_t const *in;
+	int32_t *w;
+	int i;
+
+	for (i = 0, in = coef, w = ws; i < 8; ++i, ++in, ++w) {
+		if ((0 == in[8]) && (0 == in[16]) && (0 == in[24]) && (0 == in[32]) &&
+			(0 == in[40]) && (0 == in[48]) && (0 == in[56])) {
+			int32_t const dc = in[0] * (1 << PASS1_BITS);
+			w[0] = w[8] = w[16] = w[24] = w[32] = w[40] = w[48] = w[56] = dc;
+			continue;
+		}
+
+		z2 = in[16];
+		z3 = in[48];
+		z1 = (z2 + z3) * 4433;
+		tmp2 = z1 - z3 * 15137;
+		tmp3 = z1 + z2 * 6270;
+
+		tmp0 = (in[0] + in[32]) * (1 << CONST_BITS);
+		tmp1 = (in[0] - in[32]) * (1 << CONST_BITS);
+
+		tmp10 = tmp0 + tmp3;
+		tmp13 = tmp0 - tmp3;
+		tmp11 = tmp1 + tmp2;
+		tmp12 = tmp1 - tmp2;
+
+		tmp0 = in[56];
+		tmp1 = in[40];
+		tmp2 = in[24];
+		tmp3 = in[8];
+
+		z1 = tmp0 + tmp3;
+		z2 = tmp1 + tmp2;
+		z3 = tmp0 + tmp2;
+		z4 = tmp1 + tmp3;
+		z5 = (z3 + z4) * 9633;
+
+		tmp0 *= 2446;
+		tmp1 *= 16819;
+		tmp2 *= 25172;
+		tmp3 *= 12299;
+		z1 *= -7373;
+		z2 *= -20995;
+		z3 *= -16069;
+		z4 *= -3196;
+
+		z3 += z5;
+		z4 += z5;
+
+		tmp0 += z1 + z3;
+		tmp1 += z2 + z4;
+		tmp2 += z2 + z3;
+		tmp3 += z1 + z4;
+
+		w[0]  = DESCALE(tmp10 + tmp3, CONST_BITS - PASS1_BITS);
+		w[56] = DESCALE(tmp10 - tmp3, CONST_BITS - PASS1_BITS);
+		w[8]  = DESCALE(tmp11 + tmp2, CONST_BITS - PASS1_BITS);
+		w[48] = DESCALE(tmp11 - tmp2, CONST_BITS - PASS1_BITS);
+		w[16] = DESCALE(tmp12 + tmp1, CONST_BITS - PASS1_BITS);
+		w[40] = DESCALE(tmp12 - tmp1, CONST_BITS - PASS1_BITS);
+		w[24] = DESCALE(tmp13 + tmp0, CONST_BITS - PASS1_BITS);
+		w[32] = DESCALE(tmp13 - tmp0, CONST_BITS - PASS1_BITS);
+	}
+
+	for (i = 0, w = ws; i < 8; ++i, w += 8, out += 8) {
+		z2 = w[2];
+		z3 = w[6];
+		z1 = (z2 + z3) * 4433;
+		tmp2 = z1 - z3 * 15137;
+		tmp3 = z1 + z2 * 6270;
+
+		tmp0 = (w[0] + w[4]) * (1 << CONST_BITS);
+		tmp1 = (w[0] - w[4]) * (1 << CONST_BITS);
+
+		tmp10 = tmp0 + tmp3;
+		tmp13 = tmp0 - tmp3;
+		tmp11 = tmp1 + tmp2;
+		tmp12 = tmp1 - tmp2;
+
+		tmp0 = w[7];
+		tmp1 = w[5];
+		tmp2 = w[3];
+		tmp3 = w[1];
+
+		z1 = tmp0 + tmp3;
+		z2 = tmp1 + tmp2;
+		z3 = tmp0 + tmp2;
+		z4 = tmp1 + tmp3;
+		z5 = (z3 + z4) * 9633;
+
+		tmp0 *= 2446;
+		tmp1 *= 16819;
+		tmp2 *= 25172;
+		tmp3 *= 12299;
+		z1 *= -7373;
+		z2 *= -20995;
+		z3 *= -16069;
+		z4 *= -3196;
+
+		z3 += z5;
+		z4 += z5;
+
+		tmp0 += z1 + z3;
+		tmp1 += z2 + z4;
+		tmp2 += z2 + z3;
+		tmp3 += z1 + z4;
+
+		out[0] = clamp_sample(128 + DESCALE(tmp10 + tmp3, CONST_BITS + PASS1_BITS + 3));
+		out[7] = clamp_sample(128 + DESCALE(tmp10 - tmp3, CONST_BITS + PASS1_BITS + 3));
+		out[1] = clamp_sample(128 + DESCALE(tmp11 + tmp2, CONST_BITS + PASS1_BITS + 3));
+		out[6] = clamp_sample(128 + DESCALE(tmp11 - tmp2, CONST_BITS + PASS1_BITS + 3));
+		out[2] = clamp_sample(128 + DESCALE(tmp12 + tmp1, CONST_BITS + PASS1_BITS + 3));
+		out[5] = clamp_sample(128 + DESCALE(tmp12 - tmp1, CONST_BITS + PASS1_BITS + 3));
+		out[3] = clamp_sample(128 + DESCALE(tmp13 + tmp0, CONST_BITS + PASS1_BITS + 3));
+		out[4] = clamp_sample(128 + DESCALE(tmp13 - tmp0, CONST_BITS + PASS1_BITS + 3));
+	}
+}
+
+/* n x n inverse DCT of the low frequency coefficients (n = 4 or 2), a box filtered 8x8 result. */
+static void idct_reduced(int32_t const *coef, int32_t const *table, int n, uint8_t *out) {
+	int32_t ws[16];
+	int32_t sum;
+	int x, y, k;
+
+	for (k = 0; k < n; ++k) {
+		for (x = 0; x < n; ++x) {
+			sum = 0;
+			for (y = 0; y < n; ++y) {
+				sum += table[x * n + y] * coef[k * 8 + y];
+			}
+			ws[k * n + x] = DESCALE(sum, REDUCED_BITS - PASS1_BITS);
+		}
+	}
+
+	for (y = 0; y < n; ++y) {
+		for (x = 0; x < n; ++x) {
+			sum = 0;
+			for (k = 0; k < n; ++k) {
+				sum += table[y * n + k] * ws[k * n + x];
+			}
+			out[y * n + x] = clamp_sample(128 + DESCALE(sum, REDUCED_BITS + PASS1_BITS));
+		}
+	}
+}
+
+static inline void idct_scaled(int32_t const *coef, int block_size, uint8_t *out) {
+	switch (block_size) {
+	case 8:
+		idct_8x8(coef, out);
+		break;
+	case 4:
+		idct_reduced(coef, &reduced_table_4[0][0], 4, out);
+		break;
+	case 2:
+		idct_reduced(coef, &reduced_table_2[0][0], 2, out);
+		break;
+	default:
+		out[0] = clamp_sample(128 + DESCALE(coef[0], 3));
+		break;
+	}
+}
+
+static inline void store_block(component_t const *comp, int x0, int y0, uint8_t const *block, int block_size) {
+	int const w = (comp->width  - x0 < block_size) ? comp->width  - x0 : block_size;
+	int const h = (comp->height - y0 < block_size) ? comp->height - y0 : block_size;
+	uint8_t *dst;
+	int y;
+
+	if ((w <= 0) || (h <= 0)) {
+		return;
+	}
+
+	dst = comp->plane + y0 * comp->stride + x0;
+	for (y = 0; y < h; ++y) {
+		memcpy(dst, block + y * block_size, w);
+		dst += comp->stride;
+	}
+}
+
+static int decode_range(mjpeg_decoder_t *dec, uint8_t const *begin, uint8_t const *end, int mcu_begin, int mcu_end) {
+	bit_reader_t br;
+	int dc_pred[MAX_COMPONENTS];
+	int32_t coef[64];
+	uint8_t block[64];
+	int const ri = dec->restart_interval;
+	int const bs = dec->block_size;
+	int mcu, c, bx, by, mx, my;
+	int result;
+
+	br.ptr   = begin;
+	br.end   = end;
+	br.acc   = 0;
+	br.count = 0;
+	memset(dc_pred, 0, sizeof(dc_pred));
+
+	for (mcu = mcu_begin; mcu < mcu_end; ++mcu) {
+		if ((0 != ri) && (mcu != mcu_begin) && (0 == (mcu % ri))) {
+			if (!skip_restart_marker(&br)) {
+				return MJPEG_CORRUPTED;
+			}
+			memset(dc_pred, 0, sizeof(dc_pred));
+		}
+
+		mx = mcu % dec->mcus_x;
+		my = mcu / dec->mcus_x;
+
+		for (c = 0; c < dec->comp_count; ++c) {
+			component_t const *comp = &dec->comps[c];
+			for (by = 0; by < comp->v; ++by) {
+				for (bx = 0; bx < comp->h; ++bx) {
+					result = decode_block(&br, &dec->dc_tables[comp->td], &dec->ac_tables[comp->ta],
+						dec->qt[comp->tq], &dc_pred[c], coef);
+					if (MJPEG_NOERROR != result) {
+						return result;
+					}
+					idct_scaled(coef, bs, block);
+					store_block(comp, (mx * comp->h + bx) * bs, (my * comp->v + by) * bs, block, bs);
+				}
+			}
+		}
+	}
+
+	return MJPEG_NOERROR;
+}
+
+static void run_jobs_locked(mjpeg_decoder_t *dec) {
+	while (dec->next_job < dec->job_count) {
+		decode_job_t *job = &dec->jobs[dec->next_job++];
+		pthread_mutex_unlock(&dec->lock);
+		job->result = decode_range(dec, job->begin, job->end, job->mcu_begin, job->mcu_end);
+		pthread_mutex_lock(&dec->lock);
+		if (++dec->done_jobs == dec->job_count) {
+			pthread_cond_broadcast(&dec->done_cond);
+		}
+	}
+}
+
+static void *worker_main(void *arg) {
+	mjpeg_decoder_t *dec = (mjpeg_decoder_t*)arg;
+	unsigned generation = 0;
+
+	pthread_mutex_lock(&dec->lock);
+	dec->worker_tids[dec->started_count++] = uvcc_thread_self();
+	pthread_cond_broadcast(&dec->done_cond);
+	for (;;) {
+		while (!dec->quit && (generation == dec->generation)) {
+			pthread_cond_wait(&dec->start_cond, &dec->lock);
+		}
+		if (dec->quit) {
+			break;
+		}
+		generation = dec->generation;
+		run_jobs_locked(dec);
+	}
+	pthread_mutex_unlock(&dec->lock);
+
+	return NULL;
+}
+
+static int find_segments(mjpeg_decoder_t *dec, uint8_t const *begin, uint8_t const *end, int count) {
+	uint8_t const *p = begin;
+	int n = 1;
+
+	dec->segments[0] = begin;
+	while ((n < count) && (p + 1 < end)) {
+		p = memchr(p, 0xff, end - p - 1);
+		if (NULL == p) {
+			break;
+		}
+		if ((0xd0 <= p[1]) && (p[1] <= 0xd7)) {
+			dec->segments[n++] = p + 2;
+		} else if (0xd9 == p[1]) {
+			break;
+		} else if (0xff == p[1]) {
+			// fill bytes may precede a marker.
+			p += 1;
+			continue;
+		}
+		p += 2;
+	}
+
+	return n;
+}
+
+static int decode_scan(mjpeg_decoder_t *dec, uint8_t const *begin, uint8_t const *end) {
+	int const total = dec->mcus_x * dec->mcus_y;
+	int const ri = dec->restart_interval;
+	int segment_count, chunk_count;
+	int i, s0, s1;
+	int result = MJPEG_NOERROR;
+
+	if ((0 == dec->worker_count) || (0 == ri) || (total <= ri)) {
+		return decode_range(dec, begin, end, 0, total);
+	}
+
+	segment_count = (total + ri - 1) / ri;
+	if (segment_count > dec->segment_capacity) {
+		uint8_t const **segments = realloc(dec->segments, sizeof(uint8_t const*) * segment_count);
+		if (NULL == segments) {
+			return MJPEG_INSUFFICIENT_MEMORY;
+		}
+		dec->segments         = segments;
+		dec->segment_capacity = segment_count;
+	}
+
+	if (segment_count != find_segments(dec, begin, end, segment_count)) {
+		// truncated stream: decode as much as possible sequentially.
+		return decode_range(dec, begin, end, 0, total);
+	}
+
+	chunk_count = (dec->worker_count + 1) * 4;
+	if (chunk_count > segment_count) {
+		chunk_count = segment_count;
+	}
+	if (chunk_count > dec->job_capacity) {
+		decode_job_t *jobs = realloc(dec->jobs, sizeof(decode_job_t) * chunk_count);
+		if (NULL == jobs) {
+			return MJPEG_INSUFFICIENT_MEMORY;
+		}
+		dec->jobs         = jobs;
+		dec->job_capacity = chunk_count;
+	}
+
+	for (i = 0; i < chunk_count; ++i) {
+		decode_job_t *job = &dec->jobs[i];
+		s0 = (int)((int64_t)segment_count * i / chunk_count);
+		s1 = (int)((int64_t)segment_count * (i + 1) / chunk_count);
+		job->begin     = dec->segments[s0];
+		job->end       = (s1 < segment_count) ? dec->segments[s1] - 2 : end;
+		job->mcu_begin = s0 * ri;
+		job->mcu_end   = (s1 * ri < total) ? s1 * ri : total;
+		job->result    = MJPEG_NOERROR;
+	}
+
+	pthread_mutex_lock(&dec->lock);
+	dec->job_count = chunk_count;
+	dec->next_job  = 0;
+	dec->done_jobs = 0;
+	++dec->generation;
+	pthread_cond_broadcast(&dec->start_cond);
+	run_jobs_locked(dec);
+	while (dec->done_jobs < dec->job_count) {
+		pthread_cond_wait(&dec->done_cond, &dec->lock);
+	}
+	pthread_mutex_unlock(&dec->lock);
+
+	for (i = 0; i < chunk_count; ++i) {
+		if (MJPEG_NOERROR != dec->jobs[i].result) {
+			result = dec->jobs[i].result;
+		}
+	}
+
+	return result;
+}
+
+static inline int read_u16(uint8_t const *p) {
+	return (p[0] << 8) | p[1];
+}
+
+/* Advance to the next marker segment, 'seg' points to its payload. */
+static int next_segment(uint8_t const **ptr, uint8_t const *end, int *marker, uint8_t const **seg, int *seg_len) {
+	uint8_t const *p = *ptr;
+	int length;
+
+	for (;;) {
+		while ((p < end) && (0xff != *p)) {
+			++p;
+		}
+		while ((p < end) && (0xff == *p)) {
+			++p;
+		}
+		if (p >= end) {
+			return MJPEG_CORRUPTED;
+		}
+		*marker = *p++;
+		// standalone markers
+		if ((0x01 == *marker) || ((0xd0 <= *marker) && (*marker <= 0xd8))) {
+			continue;
+		}
+		if (0xd9 == *marker) {
+			return MJPEG_CORRUPTED;
+		}
+		break;
+	}
+
+	if (end - p < 2) {
+		return MJPEG_CORRUPTED;
+	}
+	length = read_u16(p);
+	if ((length < 2) || (end - p < length)) {
+		return MJPEG_CORRUPTED;
+	}
+
+	*seg     = p + 2;
+	*seg_len = length - 2;
+	*ptr     = p + length;
+
+	return MJPEG_NOERROR;
+}
+
+static int parse_sof(mjpeg_decoder_t *dec, uint8_t const *seg, int len) {
+	int i, ratio;
+
+	if ((len < 6) || (8 != seg[0])) {
+		return MJPEG_UNSUPPORTED;
+	}
+
+	dec->height     = read_u16(seg + 1);
+	dec->width      = read_u16(seg + 3);
+	dec->comp_count = seg[5];
+
+	if ((0 == dec->width) || (0 == dec->height)) {
+		return MJPEG_UNSUPPORTED;
+	}
+	if ((1 != dec->comp_count) && (3 != dec->comp_count)) {
+		return MJPEG_UNSUPPORTED;
+	}
+	if (len < 6 + 3 * dec->comp_count) {
+		return MJPEG_CORRUPTED;
+	}
+
+	dec->hmax = 1;
+	dec->vmax = 1;
+	for (i = 0; i < dec->comp_count; ++i) {
+		component_t *comp = &dec->comps[i];
+		comp->id = seg[6 + 3 * i];
+		comp->h  = seg[7 + 3 * i] >> 4;
+		comp->v  = seg[7 + 3 * i] & 15;
+		comp->tq = seg[8 + 3 * i];
+		if ((comp->h < 1) || (comp->h > 4) || (comp->v < 1) || (comp->v > 4) || (comp->tq > 3)) {
+			return MJPEG_CORRUPTED;
+		}
+		if (comp->h > dec->hmax) {
+			dec->hmax = comp->h;
+		}
+		if (comp->v > dec->vmax) {
+			dec->vmax = comp->v;
+		}
+	}
+
+	if (1 == dec->comp_count) {
+		// a single component scan is not interleaved.
+		dec->comps[0].h = dec->comps[0].v = 1;
+		dec->hmax = dec->vmax = 1;
+	}
+
+	for (i = 0; i < dec->comp_count; ++i) {
+		component_t const *comp = &dec->comps[i];
+		if ((0 != dec->hmax % comp->h) || (0 != dec->vmax % comp->v)) {
+			return MJPEG_UNSUPPORTED;
+		}
+		ratio = dec->hmax / comp->h;
+		if (3 == ratio) {
+			return MJPEG_UNSUPPORTED;
+		}
+		ratio = dec->vmax / comp->v;
+		if (3 == ratio) {
+			return MJPEG_UNSUPPORTED;
+		}
+	}
+
+	dec->mcus_x = (dec->width  + 8 * dec->hmax - 1) / (8 * dec->hmax);
+	dec->mcus_y = (dec->height + 8 * dec->vmax - 1) / (8 * dec->vmax);
+
+	return MJPEG_NOERROR;
+}
+
+static int parse_dht(mjpeg_decoder_t *dec, uint8_t const *seg, int len) {
+	int tc, th, n, i;
+	int result;
+
+	while (len > 0) {
+		if (len < 17) {
+			return MJPEG_CORRUPTED;
+		}
+		tc = seg[0] >> 4;
+		th = seg[0] & 15;
+		if ((tc > 1) || (th > 3)) {
+			return MJPEG_CORRUPTED;
+		}
+		for (i = 0, n = 0; i < 16; ++i) {
+			n += seg[1 + i];
+		}
+		if ((n > 256) || (len < 17 + n)) {
+			return MJPEG_CORRUPTED;
+		}
+		result = build_huffman_table((0 == tc) ? &dec->dc_tables[th] : &dec->ac_tables[th], seg + 1, seg + 17);
+		if (MJPEG_NOERROR != result) {
+			return result;
+		}
+		seg += 17 + n;
+		len -= 17 + n;
+	}
+
+	return MJPEG_NOERROR;
+}
+
+static int parse_dqt(mjpeg_decoder_t *dec, uint8_t const *seg, int len) {
+	int pq, tq, k;
+
+	while (len > 0) {
+		pq = seg[0] >> 4;
+		tq = seg[0] & 15;
+		if ((pq > 1) || (tq > 3) || (len < 1 + 64 * (pq + 1))) {
+			return MJPEG_CORRUPTED;
+		}
+		for (k = 0; k < 64; ++k) {
+			dec->qt[tq][k] = (0 == pq) ? seg[1 + k] : read_u16(seg + 1 + 2 * k);
+		}
+		seg += 1 + 64 * (pq + 1);
+		len -= 1 + 64 * (pq + 1);
+	}
+
+	return MJPEG_NOERROR;
+}
+
+static int parse_sos(mjpeg_decoder_t *dec, uint8_t const *seg, int len) {
+	int ns, i, c;
+
+	if (len < 1) {
+		return MJPEG_CORRUPTED;
+	}
+	ns = seg[0];
+	if (ns != dec->comp_count) {
+		// multi scan (non-interleaved) images are not used by MJPEG.
+		return MJPEG_UNSUPPORTED;
+	}
+	if (len < 1 + 2 * ns + 3) {
+		return MJPEG_CORRUPTED;
+	}
+
+	for (i = 0; i < ns; ++i) {
+		int const id = seg[1 + 2 * i];
+		int const td = seg[2 + 2 * i] >> 4;
+		int const ta = seg[2 + 2 * i] & 15;
+		if ((td > 3) || (ta > 3)) {
+			return MJPEG_CORRUPTED;
+		}
+		for (c = 0; c < dec->comp_count; ++c) {
+			if (dec->comps[c].id == id) {
+				break;
+			}
+		}
+		if (c == dec->comp_count) {
+			return MJPEG_CORRUPTED;
+		}
+		dec->comps[c].td = td;
+		dec->comps[c].ta = ta;
+	}
+
+	return MJPEG_NOERROR;
+}
+
+static int parse_headers(mjpeg_decoder_t *dec, uint8_t const *data, size_t size, uint8_t const **scan) {
+	uint8_t const *p = data;
+	uint8_t const *end = data + size;
+	uint8_t const *seg;
+	int marker, len;
+	int has_frame = 0;
+	int result;
+
+	if ((size < 4) || (0xff != data[0]) || (0xd8 != data[1])) {
+		return MJPEG_CORRUPTED;
+	}
+
+	// MJPEG frames usually omit DHT and rely on the typical tables.
+	dec->dc_tables[0] = dec->dc_tables[2] = default_dc_tables[0];
+	dec->dc_tables[1] = dec->dc_tables[3] = default_dc_tables[1];
+	dec->ac_tables[0] = dec->ac_tables[2] = default_ac_tables[0];
+	dec->ac_tables[1] = dec->ac_tables[3] = default_ac_tables[1];
+	dec->restart_interval = 0;
+
+	p += 2;
+	for (;;) {
+		result = next_segment(&p, end, &marker, &seg, &len);
+		if (MJPEG_NOERROR != result) {
+			return result;
+		}
+
+		switch (marker) {
+		case 0xc0: // baseline
+		case 0xc1: // extended sequential, Huffman
+			if (has_frame) {
+				// a second frame header could resize past the caller's planes.
+				return MJPEG_CORRUPTED;
+			}
+			result = parse_sof(dec, seg, len);
+			has_frame = 1;
+			break;
+		case 0xc2: case 0xc3: case 0xc5: case 0xc6: case 0xc7:
+		case 0xc9: case 0xca: case 0xcb: case 0xcd: case 0xce: case 0xcf:
+			return MJPEG_UNSUPPORTED;
+		case 0xc4:
+			result = parse_dht(dec, seg, len);
+			break;
+		case 0xdb:
+			result = parse_dqt(dec, seg, len);
+			break;
+		case 0xdd:
+			dec->restart_interval = (len >= 2) ? read_u16(seg) : 0;
+			break;
+		case 0xda:
+			if (!has_frame) {
+				return MJPEG_CORRUPTED;
+			}
+			result = parse_sos(dec, seg, len);
+			*scan = p;
+			return result;
+		default:
+			break;
+		}
+
+		if (MJPEG_NOERROR != result) {
+			return result;
+		}
+	}
+}
+
+static int ensure_scratch(mjpeg_decoder_t *dec, size_t size) {
+	uint8_t *scratch;
+
+	if (size <= dec->scratch_size) {
+		return MJPEG_NOERROR;
+	}
+
+	scratch = realloc(dec->scratch, size);
+	if (NULL == scratch) {
+		return MJPEG_INSUFFICIENT_MEMORY;
+	}
+	dec->scratch      = scratch;
+	dec->scratch_size = size;
+
+	return MJPEG_NOERROR;
+}
+
+static int log2_ratio(int ratio) {
+	return (4 == ratio) ? 2 : (2 == ratio) ? 1 : 0;
+}
+
+/* Downsample a chroma plane to 4:2:0 by averaging the four samples under each output sample. */
+static void resample_chroma(component_t const *comp, int sx, int sy, int out_w, int out_h,
+	uint8_t *dst, int dst_stride, int dst_step) {
+	int const cw = (out_w + 1) / 2;
+	int const ch = (out_h + 1) / 2;
+	int x, y;
+
+	for (y = 0; y < ch; ++y) {
+		int const y0 = 2 * y;
+		int const y1 = (2 * y + 1 < out_h) ? 2 * y + 1 : 2 * y;
+		uint8_t const *r0 = comp->plane + (y0 / sy) * comp->stride;
+		uint8_t const *r1 = comp->plane + (y1 / sy) * comp->stride;
+		uint8_t *d = dst + y * dst_stride;
+		for (x = 0; x < cw; ++x) {
+			int const x0 = (2 * x) / sx;
+			int const x1 = ((2 * x + 1 < out_w) ? 2 * x + 1 : 2 * x) / sx;
+			d[x * dst_step] = (uint8_t)((r0[x0] + r0[x1] + r1[x0] + r1[x1] + 2) >> 2);
+		}
+	}
+}
+
+#ifdef UVCC_USE_LIBJPEG_TURBO
+static int decode_turbo(mjpeg_decoder_t *dec, uint8_t const *data, size_t size, int out_w, int out_h,
+	uint8_t *rgba, int stride) {
+	if (NULL == dec->turbo) {
+		dec->turbo = tjInitDecompress();
+		if (NULL == dec->turbo) {
+			return MJPEG_INSUFFICIENT_MEMORY;
+		}
+	}
+	// 0xAARRGGBB words are stored as B, G, R, A on little endian targets.
+	if (0 != tjDecompress2(dec->turbo, (unsigned char*)data, size, rgba, out_w, stride, out_h, TJPF_BGRA, TJFLAG_FASTDCT)) {
+		return MJPEG_CORRUPTED;
+	}
+	return MJPEG_NOERROR;
+}
+#endif
+
+mjpeg_decoder_t *mjpeg_decoder_create(int threads) {
+	mjpeg_decoder_t *dec;
+	int i;
+
+	pthread_once(&tables_once, init_tables);
+
+	dec = (mjpeg_decoder_t*)malloc(sizeof(mjpeg_decoder_t));
+	if (NULL == dec) {
+		return NULL;
+	}
+	memset(dec, 0, sizeof(mjpeg_decoder_t));
+
+	pthread_mutex_init(&dec->lock, NULL);
+	pthread_cond_init(&dec->start_cond, NULL);
+	pthread_cond_init(&dec->done_cond, NULL);
+
+	if (threads > 1) {
+		dec->workers = (pthread_t*)malloc(sizeof(pthread_t) * (threads - 1));
+		dec->worker_tids = (pid_t*)malloc(sizeof(pid_t) * (threads - 1));
+		if ((NULL == dec->workers) || (NULL == dec->worker_tids)) {
+			mjpeg_decoder_destroy(dec);
+			return NULL;
+		}
+		for (i = 0; i < threads - 1; ++i) {
+			if (0 != pthread_create(&dec->workers[i], NULL, worker_main, dec)) {
+				break;
+			}
+			++dec->worker_count;
+		}
+		// nothing is decoded yet, done_cond only signals started workers here.
+		pthread_mutex_lock(&dec->lock);
+		while (dec->started_count < dec->worker_count) {
+			pthread_cond_wait(&dec->done_cond, &dec->lock);
+		}
+		pthread_mutex_unlock(&dec->lock);
+	}
+
+	return dec;
+}
+
+void mjpeg_decoder_destroy(mjpeg_decoder_t *dec) {
+	int i;
+
+	if (NULL == dec) {
+		return;
+	}
+
+	pthread_mutex_lock(&dec->lock);
+	dec->quit = 1;
+	pthread_cond_broadcast(&dec->start_cond);
+	pthread_mutex_unlock(&dec->lock);
+	for (i = 0; i < dec->worker_count; ++i) {
+		pthread_join(dec->workers[i], NULL);
+	}
+
+#ifdef UVCC_USE_LIBJPEG_TURBO
+	if (NULL != dec->turbo) {
+		tjDestroy(dec->turbo);
+	}
+#endif
+
+	pthread_cond_destroy(&dec->done_cond);
+	pthread_cond_destroy(&dec->start_cond);
+	pthread_mutex_destroy(&dec->lock);
+
+	free(dec->workers);
+	free(dec->worker_tids);
+	free(dec->jobs);
+	free(dec->segments);
+	free(dec->scratch);
+	free(dec);
+}
+
+int mjpeg_decoder_set_thread_policy(mjpeg_decoder_t *dec, uvcc_thread_policy_t const *policy, uvcc_thread_policy_t *applied) {
+	uvcc_thread_policy_t result;
+	int i;
+
+	if ((NULL == dec) || (NULL == policy) || (NULL == applied)) {
+		return MJPEG_INVALID_ARGUMENTS;
+	}
+
+	memset(applied, 0, sizeof(*applied));
+	for (i = 0; i < dec->started_count; ++i) {
+		uvcc_thread_apply(dec->worker_tids[i], policy, &result);
+		if (0 == i) {
+			*applied = result;
+		} else {
+			uvcc_thread_merge(applied, &result);
+		}
+	}
+	return MJPEG_NOERROR;
+}
+
+int mjpeg_get_size(uint8_t const *data, size_t size, int *width, int *height) {
+	uint8_t const *p = data;
+	uint8_t const *seg;
+	int marker, len;
+	int has_frame = 0;
+	int result;
+
+	if ((NULL == data) || (NULL == width) || (NULL == height)) {
+		return MJPEG_INVALID_ARGUMENTS;
+	}
+	if ((size < 4) || (0xff != data[0]) || (0xd8 != data[1])) {
+		return MJPEG_CORRUPTED;
+	}
+
+	p += 2;
+	for (;;) {
+		result = next_segment(&p, data + size, &marker, &seg, &len);
+		if (MJPEG_NOERROR != result) {
+			return result;
+		}
+		// walk up to the scan like parse_headers, so both agree on the frame.
+		if ((0xc0 <= marker) && (marker <= 0xcf) && (0xc4 != marker) && (0xc8 != marker) && (0xcc != marker)) {
+			if (has_frame || (len < 5)) {
+				return MJPEG_CORRUPTED;
+			}
+			*height = read_u16(seg + 1);
+			*width  = read_u16(seg + 3);
+			has_frame = 1;
+		}
+		if (0xda == marker) {
+			return has_frame ? MJPEG_NOERROR : MJPEG_CORRUPTED;
+		}
+	}
+}
+
+int mjpeg_decode(mjpeg_decoder_t *dec, uint8_t const *data, size_t size, int width, int height, int scale,
+	mjpeg_output_format_t format, uint8_t * const planes[3], int const strides[3]) {
+	uint8_t const *scan = NULL;
+	uint8_t *scratch;
+	size_t scratch_size = 0;
+	int out_w, out_h, bs;
+	int c, sx, sy;
+	int use_scratch[MAX_COMPONENTS];
+	int result;
+
+	if ((NULL == dec) || (NULL == data) || (NULL == planes) || (NULL == strides)) {
+		return MJPEG_INVALID_ARGUMENTS;
+	}
+	if ((1 != scale) && (2 != scale) && (4 != scale) && (8 != scale)) {
+		return MJPEG_INVALID_ARGUMENTS;
+	}
+
+	result = parse_headers(dec, data, size, &scan);
+	if (MJPEG_NOERROR != result) {
+		return result;
+	}
+	if ((dec->width != width) || (dec->height != height)) {
+		return MJPEG_CORRUPTED;
+	}
+
+	out_w = (dec->width  + scale - 1) / scale;
+	out_h = (dec->height + scale - 1) / scale;
+	bs    = 8 / scale;
+	dec->block_size = bs;
+
+#ifdef UVCC_USE_LIBJPEG_TURBO
+	if (MJPEG_OUTPUT_RGBA == format) {
+		return decode_turbo(dec, data, size, out_w, out_h, planes[0], strides[0]);
+	}
+#endif
+
+	if (3 == dec->comp_count) {
+		if ((dec->hmax / dec->comps[1].h != dec->hmax / dec->comps[2].h) ||
+			(dec->vmax / dec->comps[1].v != dec->vmax / dec->comps[2].v)) {
+			return MJPEG_UNSUPPORTED;
+		}
+	}
+
+	// route each component straight to the caller's plane when the layouts agree.
+	for (c = 0; c < dec->comp_count; ++c) {
+		component_t *comp = &dec->comps[c];
+		sx = dec->hmax / comp->h;
+		sy = dec->vmax / comp->v;
+		comp->width  = ((dec->width  + sx - 1) / sx + scale - 1) / scale;
+		comp->height = ((dec->height + sy - 1) / sy + scale - 1) / scale;
+		if (MJPEG_OUTPUT_RGBA == format) {
+			use_scratch[c] = 1;
+		} else if (0 == c) {
+			use_scratch[c] = (1 != sx) || (1 != sy);
+		} else {
+			use_scratch[c] = (MJPEG_OUTPUT_I420 != format) || (2 != sx) || (2 != sy);
+		}
+		if (use_scratch[c]) {
+			comp->stride = dec->mcus_x * comp->h * bs;
+			scratch_size += (size_t)comp->stride * dec->mcus_y * comp->v * bs;
+		} else {
+			comp->plane  = planes[c];
+			comp->stride = strides[c];
+		}
+	}
+	if ((1 == dec->comp_count) && (MJPEG_OUTPUT_RGBA == format)) {
+		// a neutral chroma row shared by every output row.
+		scratch_size += out_w;
+	}
+
+	result = ensure_scratch(dec, scratch_size);
+	if (MJPEG_NOERROR != result) {
+		return result;
+	}
+
+	scratch = dec->scratch;
+	for (c = 0; c < dec->comp_count; ++c) {
+		component_t *comp = &dec->comps[c];
+		if (use_scratch[c]) {
+			comp->plane = scratch;
+			scratch += (size_t)comp->stride * dec->mcus_y * comp->v * bs;
+		}
+	}
+
+	result = decode_scan(dec, scan, data + size);
+	if (MJPEG_NOERROR != result) {
+		return result;
+	}
+
+	if (MJPEG_OUTPUT_RGBA == format) {
+		uint8_t const *src[3];
+		int src_strides[3];
+		int hshift = 0;
+		int vshift = 0;
+
+		src[0]         = dec->comps[0].plane;
+		src_strides[0] = dec->comps[0].stride;
+		if (3 == dec->comp_count) {
+			for (c = 1; c < 3; ++c) {
+				src[c]         = dec->comps[c].plane;
+				src_strides[c] = dec->comps[c].stride;
+			}
+			hshift = log2_ratio(dec->hmax / dec->comps[1].h);
+			vshift = log2_ratio(dec->vmax / dec->comps[1].v);
+		} else {
+			memset(scratch, 128, out_w);
+			src[1] = src[2] = scratch;
+			src_strides[1] = src_strides[2] = 0;
+		}
+		cconv_yuv_planar_to_rgba(planes[0], strides[0], src, src_strides, hshift, vshift, out_w, out_h, CCONV_MATRIX_JFIF);
+		return MJPEG_NOERROR;
+	}
+
+	if (use_scratch[0]) {
+		component_t const *comp = &dec->comps[0];
+		int y;
+		for (y = 0; y < out_h; ++y) {
+			memcpy(planes[0] + y * strides[0], comp->plane + y * comp->stride, out_w);
+		}
+	}
+
+	if (1 == dec->comp_count) {
+		int const cw = (out_w + 1) / 2;
+		int const ch = (out_h + 1) / 2;
+		int y;
+		for (y = 0; y < ch; ++y) {
+			if (MJPEG_OUTPUT_NV12 == format) {
+				memset(planes[1] + y * strides[1], 128, cw * 2);
+			} else {
+				memset(planes[1] + y * strides[1], 128, cw);
+				memset(planes[2] + y * strides[2], 128, cw);
+			}
+		}
+		return MJPEG_NOERROR;
+	}
+
+	for (c = 1; c < 3; ++c) {
+		component_t const *comp = &dec->comps[c];
+		if (!use_scratch[c]) {
+			continue;
+		}
+		sx = dec->hmax / comp->h;
+		sy = dec->vmax / comp->v;
+		if (MJPEG_OUTPUT_NV12 == format) {
+			resample_chroma(comp, sx, sy, out_w, out_h, planes[1] + (c - 1), strides[1], 2);
+		} else {
+			resample_chroma(comp, sx, sy, out_w, out_h, planes[c], strides[c], 1);
+		}
+	}
+
+	return MJPEG_NOERROR;
+}
@@ -0,0 +1,61 @@
+#ifndef MJPEG_DECODER_H
+#define MJPEG_DECODER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "uvccthread.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum mjpeg_error_t {
+	MJPEG_NOERROR = 0,
+	MJPEG_INVALID_ARGUMENTS,
+	MJPEG_INSUFFICIENT_MEMORY,
+	MJPEG_UNSUPPORTED,
+	MJPEG_CORRUPTED,
+} mjpeg_error_t;
+
+/*
+ * Output layouts of the decoder. YUV outputs keep the full-range (JFIF)
+ * samples of the JPEG stream; RGBA is 0xAARRGGBB per pixel.
+ */
+typedef enum mjpeg_output_format_t {
+	MJPEG_OUTPUT_I420 = 0,
+	MJPEG_OUTPUT_NV12,
+	MJPEG_OUTPUT_RGBA,
+} mjpeg_output_format_t;
+
+typedef struct mjpeg_decoder_t_ mjpeg_decoder_t;
+
+/*
+ * 'threads' > 1 decodes restart intervals in parallel on a worker pool owned
+ * by the decoder. Decoding of a single decoder is not reentrant.
+ */
+extern mjpeg_decoder_t *mjpeg_decoder_create(int threads);
+extern void mjpeg_decoder_destroy(mjpeg_decoder_t *dec);
+/*
+ * Apply 'policy' to every worker of the pool, see uvcc_thread_apply.
+ * 'applied' is what all of them got, nothing without workers.
+ */
+extern int  mjpeg_decoder_set_thread_policy(mjpeg_decoder_t *dec, uvcc_thread_policy_t const *policy, uvcc_thread_policy_t *applied);
+
+extern int  mjpeg_get_size(uint8_t const *data, size_t size, int *width, int *height);
+
+/*
+ * Decode one frame scaled by 1/'scale' (1, 2, 4 or 8) into the caller's
+ * planes. The output is ceil(width / scale) x ceil(height / scale);
+ * strides are in bytes. 'width' x 'height' is the frame size the planes
+ * were laid out for (see mjpeg_get_size), a frame of any other size is
+ * rejected as corrupted.
+ */
+extern int  mjpeg_decode(mjpeg_decoder_t *dec, uint8_t const *data, size_t size, int width, int height, int scale,
+	mjpeg_output_format_t format, uint8_t * const planes[3], int const strides[3]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,469 @@
+#include "mjpegdec_jni.h"
+#include "mjpegdec.h"
+#include <stdint.h>
+
+static void throw_IllegalArgumentException(JNIEnv *env, char const * const message);
+static void throw_NullPointerException(JNIEnv *env, char const * const message);
+static void throw_RuntimeException(JNIEnv *env, char const * const message);
+static void throw_decode_error(JNIEnv *env, int err);
+static int  setup_planes(uint8_t *base, size_t capacity, int width, int height, int scale, int format, uint8_t *planes[3], int strides[3]);
+static int  get_planes(JNIEnv *env, jobjectArray buffers, jintArray stride_array, int width, int height, int scale, int format, uint8_t *planes[3], int strides[3]);
+static int  get_thread_policy(JNIEnv *env, jintArray array, uvcc_thread_policy_t *policy);
+static void set_thread_policy(JNIEnv *env, jintArray array, uvcc_thread_policy_t const *policy);
+
+#define TO_DECODER(h) ((mjpeg_decoder_t*)(intptr_t)h)
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_MjpegDecoder
+ * Method:    n_create
+ * Signature: (I)J
+ */
+JNIEXPORT jlong JNICALL Java_net_crimsonwoods_android_libs_uvccap_MjpegDecoder_n_1create
+  (JNIEnv *env, jclass cls, jint threads)
+{
+	mjpeg_decoder_t *dec = mjpeg_decoder_create(threads);
+	if (NULL == dec) {
+		throw_RuntimeException(env, "MJPEG decoder can't create.");
+	}
+	return (jlong)(intptr_t)dec;
+}
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_MjpegDecoder
+ * Method:    n_destroy
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_net_crimsonwoods_android_libs_uvccap_MjpegDecoder_n_1destroy
+  (JNIEnv *env, jclass cls, jlong handle)
+{
+	mjpeg_decoder_destroy(TO_DECODER(handle));
+}
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_MjpegDecoder
+ * Method:    n_setThreadPolicy
+ * Signature: (J[I[I)V
+ */
+JNIEXPORT void JNICALL Java_net_crimsonwoods_android_libs_uvccap_MjpegDecoder_n_1setThreadPolicy
+  (JNIEnv *env, jclass cls, jlong handle, jintArray policy_array, jintArray applied_array)
+{
+	uvcc_thread_policy_t policy;
+	uvcc_thread_policy_t applied;
+
+	if (!get_thread_policy(env, policy_array, &policy)) {
+		return;
+	}
+	if (MJPEG_NOERROR != mjpeg_decoder_set_thread_policy(TO_DECODER(handle), &policy, &applied)) {
+		throw_RuntimeException(env, "Thread policy can't be applied.");
+		return;
+	}
+	set_thread_policy(env, applied_array, &applied);
+}
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_MjpegDecoder
+ * Method:    n_getSize
+ * Signature: ([BI[I)Z
+ */
+JNIEXPORT jboolean JNICALL Java_net_crimsonwoods_android_libs_uvccap_MjpegDecoder_n_1getSize
+  (JNIEnv *env, jclass cls, jbyteArray jpeg, jint length, jintArray size)
+{
+	jboolean is_copy = JNI_FALSE;
+	jbyte *jpeg_ptr = NULL;
+	jint dims[2];
+	int result;
+
+	if ((NULL == jpeg) || (NULL == size)) {
+		throw_NullPointerException(env, "'jpeg' and 'size' have to be set not null.");
+		return JNI_FALSE;
+	}
+	if ((length < 0) || (length > (*env)->GetArrayLength(env, jpeg)) || ((*env)->GetArrayLength(env, size) < 2)) {
+		throw_IllegalArgumentException(env, "'length' or 'size' is out of range.");
+		return JNI_FALSE;
+	}
+
+	jpeg_ptr = (*env)->GetPrimitiveArrayCritical(env, jpeg, &is_copy);
+	result = mjpeg_get_size((uint8_t const*)jpeg_ptr, length, &dims[0], &dims[1]);
+	(*env)->ReleasePrimitiveArrayCritical(env, jpeg, jpeg_ptr, JNI_ABORT);
+
+	if (MJPEG_NOERROR != result) {
+		return JNI_FALSE;
+	}
+	(*env)->SetIntArrayRegion(env, size, 0, 2, dims);
+	return JNI_TRUE;
+}
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_MjpegDecoder
+ * Method:    n_decodeToRgba
+ * Signature: (J[I[BII)V
+ */
+JNIEXPORT void JNICALL Java_net_crimsonwoods_android_libs_uvccap_MjpegDecoder_n_1decodeToRgba
+  (JNIEnv *env, jclass cls, jlong handle, jintArray rgba, jbyteArray jpeg, jint length, jint scale)
+{
+	jint  *rgba_ptr = NULL;
+	jbyte *jpeg_ptr = NULL;
+	size_t rgba_size;
+	uint8_t *planes[3];
+	int strides[3];
+	int width, height;
+	int result;
+
+	if ((NULL == rgba) || (NULL == jpeg)) {
+		throw_NullPointerException(env, "'rgba' and 'jpeg' have to be set not null.");
+		return;
+	}
+	if ((length < 0) || (length > (*env)->GetArrayLength(env, jpeg))) {
+		throw_IllegalArgumentException(env, "'length' is out of range.");
+		return;
+	}
+	if ((1 != scale) && (2 != scale) && (4 != scale) && (8 != scale)) {
+		throw_IllegalArgumentException(env, "'scale' have to be 1, 2, 4 or 8.");
+		return;
+	}
+
+	// a decode takes a whole frame, far too long to hold the arrays in a critical region.
+	rgba_size = (size_t)(*env)->GetArrayLength(env, rgba) * sizeof(jint);
+	jpeg_ptr = (*env)->GetByteArrayElements(env, jpeg, NULL);
+	if (NULL == jpeg_ptr) {
+		return;
+	}
+	rgba_ptr = (*env)->GetIntArrayElements(env, rgba, NULL);
+	if (NULL == rgba_ptr) {
+		(*env)->ReleaseByteArrayElements(env, jpeg, jpeg_ptr, JNI_ABORT);
+		return;
+	}
+	result = mjpeg_get_size((uint8_t const*)jpeg_ptr, length, &width, &height);
+	if (MJPEG_NOERROR == result) {
+		result = setup_planes((uint8_t*)rgba_ptr, rgba_size, width, height, scale, MJPEG_OUTPUT_RGBA, planes, strides);
+	}
+	if (MJPEG_NOERROR == result) {
+		result = mjpeg_decode(TO_DECODER(handle), (uint8_t const*)jpeg_ptr, length, width, height, scale, MJPEG_OUTPUT_RGBA, planes, strides);
+	}
+	(*env)->ReleaseIntArrayElements(env, rgba, rgba_ptr, (MJPEG_NOERROR == result) ? 0 : JNI_ABORT);
+	(*env)->ReleaseByteArrayElements(env, jpeg, jpeg_ptr, JNI_ABORT);
+
+	if (MJPEG_NOERROR != result) {
+		throw_decode_error(env, result);
+	}
+}
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_MjpegDecoder
+ * Method:    n_decodeToYuv
+ * Signature: (J[B[BIII)V
+ */
+JNIEXPORT void JNICALL Java_net_crimsonwoods_android_libs_uvccap_MjpegDecoder_n_1decodeToYuv
+  (JNIEnv *env, jclass cls, jlong handle, jbyteArray yuv, jbyteArray jpeg, jint length, jint scale, jint format)
+{
+	jbyte *yuv_ptr  = NULL;
+	jbyte *jpeg_ptr = NULL;
+	size_t yuv_size;
+	uint8_t *planes[3];
+	int strides[3];
+	int width, height;
+	int result;
+
+	if ((NULL == yuv) || (NULL == jpeg)) {
+		throw_NullPointerException(env, "'yuv' and 'jpeg' have to be set not null.");
+		return;
+	}
+	if ((length < 0) || (length > (*env)->GetArrayLength(env, jpeg))) {
+		throw_IllegalArgumentException(env, "'length' is out of range.");
+		return;
+	}
+	if ((1 != scale) && (2 != scale) && (4 != scale) && (8 != scale)) {
+		throw_IllegalArgumentException(env, "'scale' have to be 1, 2, 4 or 8.");
+		return;
+	}
+	if ((MJPEG_OUTPUT_I420 != format) && (MJPEG_OUTPUT_NV12 != format)) {
+		throw_IllegalArgumentException(env, "'format' have to be I420 or NV12.");
+		return;
+	}
+
+	yuv_size = (size_t)(*env)->GetArrayLength(env, yuv);
+	jpeg_ptr = (*env)->GetByteArrayElements(env, jpeg, NULL);
+	if (NULL == jpeg_ptr) {
+		return;
+	}
+	yuv_ptr = (*env)->GetByteArrayElements(env, yuv, NULL);
+	if (NULL == yuv_ptr) {
+		(*env)->ReleaseByteArrayElements(env, jpeg, jpeg_ptr, JNI_ABORT);
+		return;
+	}
+	result = mjpeg_get_size((uint8_t const*)jpeg_ptr, length, &width, &height);
+	if (MJPEG_NOERROR == result) {
+		result = setup_planes((uint8_t*)yuv_ptr, yuv_size, width, height, scale, format, planes, strides);
+	}
+	if (MJPEG_NOERROR == result) {
+		result = mjpeg_decode(TO_DECODER(handle), (uint8_t const*)jpeg_ptr, length, width, height, scale, format, planes, strides);
+	}
+	(*env)->ReleaseByteArrayElements(env, yuv, yuv_ptr, (MJPEG_NOERROR == result) ? 0 : JNI_ABORT);
+	(*env)->ReleaseByteArrayElements(env, jpeg, jpeg_ptr, JNI_ABORT);
+
+	if (MJPEG_NOERROR != result) {
+		throw_decode_error(env, result);
+	}
+}
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_MjpegDecoder
+ * Method:    n_decodeDirect
+ * Signature: (JLjava/nio/ByteBuffer;Ljava/nio/ByteBuffer;III)V
+ */
+JNIEXPORT void JNICALL Java_net_crimsonwoods_android_libs_uvccap_MjpegDecoder_n_1decodeDirect
+  (JNIEnv *env, jclass cls, jlong handle, jobject dst, jobject jpeg, jint length, jint scale, jint format)
+{
+	uint8_t *dst_ptr;
+	uint8_t const *jpeg_ptr;
+	uint8_t *planes[3];
+	int strides[3];
+	int width, height;
+	int result;
+
+	if ((NULL == dst) || (NULL == jpeg)) {
+		throw_NullPointerException(env, "'dst' and 'jpeg' have to be set not null.");
+		return;
+	}
+
+	dst_ptr  = (*env)->GetDirectBufferAddress(env, dst);
+	jpeg_ptr = (*env)->GetDirectBufferAddress(env, jpeg);
+	if ((NULL == dst_ptr) || (NULL == jpeg_ptr)) {
+		throw_IllegalArgumentException(env, "Buffers have to be direct.");
+		return;
+	}
+	if ((length < 0) || (length > (*env)->GetDirectBufferCapacity(env, jpeg))) {
+		throw_IllegalArgumentException(env, "'length' is out of range.");
+		return;
+	}
+	if ((1 != scale) && (2 != scale) && (4 != scale) && (8 != scale)) {
+		throw_IllegalArgumentException(env, "'scale' have to be 1, 2, 4 or 8.");
+		return;
+	}
+
+	result = mjpeg_get_size(jpeg_ptr, length, &width, &height);
+	if (MJPEG_NOERROR == result) {
+		result = setup_planes(dst_ptr, (*env)->GetDirectBufferCapacity(env, dst), width, height, scale, format, planes, strides);
+	}
+	if (MJPEG_NOERROR == result) {
+		result = mjpeg_decode(TO_DECODER(handle), jpeg_ptr, length, width, height, scale, format, planes, strides);
+	}
+	if (MJPEG_NOERROR != result) {
+		throw_decode_error(env, result);
+	}
+}
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_MjpegDecoder
+ * Method:    n_decodePlanes
+ * Signature: (J[Ljava/nio/ByteBuffer;[ILjava/nio/ByteBuffer;III)V
+ */
+JNIEXPORT void JNICALL Java_net_crimsonwoods_android_libs_uvccap_MjpegDecoder_n_1decodePlanes
+  (JNIEnv *env, jclass cls, jlong handle, jobjectArray dst, jintArray dst_strides, jobject jpeg, jint length, jint scale, jint format)
+{
+	uint8_t const *jpeg_ptr;
+	uint8_t *planes[3];
+	int strides[3];
+	int width, height;
+	int result;
+
+	if ((NULL == dst) || (NULL == dst_strides) || (NULL == jpeg)) {
+		throw_NullPointerException(env, "'planes', 'strides' and 'jpeg' have to be set not null.");
+		return;
+	}
+
+	jpeg_ptr = (*env)->GetDirectBufferAddress(env, jpeg);
+	if (NULL == jpeg_ptr) {
+		throw_IllegalArgumentException(env, "Buffers have to be direct.");
+		return;
+	}
+	if ((length < 0) || (length > (*env)->GetDirectBufferCapacity(env, jpeg))) {
+		throw_IllegalArgumentException(env, "'length' is out of range.");
+		return;
+	}
+	if ((1 != scale) && (2 != scale) && (4 != scale) && (8 != scale)) {
+		throw_IllegalArgumentException(env, "'scale' have to be 1, 2, 4 or 8.");
+		return;
+	}
+
+	result = mjpeg_get_size(jpeg_ptr, length, &width, &height);
+	if (MJPEG_NOERROR == result) {
+		result = get_planes(env, dst, dst_strides, width, height, scale, format, planes, strides);
+	}
+	if (MJPEG_NOERROR == result) {
+		result = mjpeg_decode(TO_DECODER(handle), jpeg_ptr, length, width, height, scale, format, planes, strides);
+	}
+	if (MJPEG_NOERROR != result) {
+		throw_decode_error(env, result);
+	}
+}
+
+/* Direct buffers of the caller with their strides, each has to hold its plane. */
+static int get_planes(JNIEnv *env, jobjectArray buffers, jintArray stride_array, int width, int height, int scale, int format, uint8_t *planes[3], int strides[3])
+{
+	int const w  = (width  + scale - 1) / scale;
+	int const h  = (height + scale - 1) / scale;
+	int const cw = (w + 1) / 2;
+	int const ch = (h + 1) / 2;
+	int row_bytes[3] = { 0, 0, 0 };
+	int rows[3] = { h, ch, ch };
+	int count;
+	int i;
+
+	switch (format) {
+	case MJPEG_OUTPUT_RGBA:
+		count = 1;
+		row_bytes[0] = w * 4;
+		break;
+	case MJPEG_OUTPUT_NV12:
+		count = 2;
+		row_bytes[0] = w;
+		row_bytes[1] = cw * 2;
+		break;
+	case MJPEG_OUTPUT_I420:
+		count = 3;
+		row_bytes[0] = w;
+		row_bytes[1] = row_bytes[2] = cw;
+		break;
+	default:
+		return MJPEG_INVALID_ARGUMENTS;
+	}
+
+	if (((*env)->GetArrayLength(env, buffers) < count) || ((*env)->GetArrayLength(env, stride_array) < count)) {
+		return MJPEG_INVALID_ARGUMENTS;
+	}
+	(*env)->GetIntArrayRegion(env, stride_array, 0, count, strides);
+
+	planes[1] = planes[2] = NULL;
+	for (i = 0; i < count; ++i) {
+		jobject buffer = (*env)->GetObjectArrayElement(env, buffers, i);
+		if (NULL == buffer) {
+			return MJPEG_INVALID_ARGUMENTS;
+		}
+		planes[i] = (uint8_t*)(*env)->GetDirectBufferAddress(env, buffer);
+		jlong const capacity = (*env)->GetDirectBufferCapacity(env, buffer);
+		(*env)->DeleteLocalRef(env, buffer);
+		if ((NULL == planes[i]) || (strides[i] < row_bytes[i]) ||
+			(capacity < (jlong)strides[i] * (rows[i] - 1) + row_bytes[i])) {
+			return MJPEG_INVALID_ARGUMENTS;
+		}
+	}
+	return MJPEG_NOERROR;
+}
+
+static int setup_planes(uint8_t *base, size_t capacity, int width, int height, int scale, int format, uint8_t *planes[3], int strides[3])
+{
+	int const w  = (width  + scale - 1) / scale;
+	int const h  = (height + scale - 1) / scale;
+	int const cw = (w + 1) / 2;
+	int const ch = (h + 1) / 2;
+
+	planes[0]  = base;
+	planes[1]  = planes[2]  = NULL;
+	strides[1] = strides[2] = 0;
+
+	switch (format) {
+	case MJPEG_OUTPUT_RGBA:
+		if (capacity < (size_t)w * h * 4) {
+			return MJPEG_INVALID_ARGUMENTS;
+		}
+		strides[0] = w * 4;
+		break;
+	case MJPEG_OUTPUT_NV12:
+		if (capacity < (size_t)w * h + 2 * cw * ch) {
+			return MJPEG_INVALID_ARGUMENTS;
+		}
+		strides[0] = w;
+		planes[1]  = base + w * h;
+		strides[1] = cw * 2;
+		break;
+	case MJPEG_OUTPUT_I420:
+		if (capacity < (size_t)w * h + 2 * cw * ch) {
+			return MJPEG_INVALID_ARGUMENTS;
+		}
+		strides[0] = w;
+		planes[1]  = base + w * h;
+		planes[2]  = planes[1] + cw * ch;
+		strides[1] = strides[2] = cw;
+		break;
+	default:
+		return MJPEG_INVALID_ARGUMENTS;
+	}
+
+	return MJPEG_NOERROR;
+}
+
+// ThreadPolicy travels as {flags, cpuMask, fifoPriority, nice}.
+static int get_thread_policy(JNIEnv *env, jintArray array, uvcc_thread_policy_t *policy)
+{
+	jint values[4];
+
+	if ((NULL == array) || (4 > (*env)->GetArrayLength(env, array))) {
+		throw_IllegalArgumentException(env, "Thread policy have to be 4 values.");
+		return 0;
+	}
+	(*env)->GetIntArrayRegion(env, array, 0, 4, values);
+	policy->flags         = (uint32_t)values[0];
+	policy->cpu_mask      = (uint32_t)values[1];
+	policy->fifo_priority = values[2];
+	policy->nice          = values[3];
+	return 1;
+}
+
+static void set_thread_policy(JNIEnv *env, jintArray array, uvcc_thread_policy_t const *policy)
+{
+	jint values[4];
+
+	if ((NULL == array) || (4 > (*env)->GetArrayLength(env, array))) {
+		throw_IllegalArgumentException(env, "Thread policy have to be 4 values.");
+		return;
+	}
+	values[0] = (jint)policy->flags;
+	values[1] = (jint)policy->cpu_mask;
+	values[2] = policy->fifo_priority;
+	values[3] = policy->nice;
+	(*env)->SetIntArrayRegion(env, array, 0, 4, values);
+}
+
+static void throw_exception(JNIEnv *env, char const * const cls, char const * const message)
+{
+	jclass ioe_cls = (*env)->FindClass(env, cls);
+	if (NULL == ioe_cls) {
+		return;
+	}
+	(*env)->ThrowNew(env, ioe_cls, message);
+	(*env)->DeleteLocalRef(env, ioe_cls);
+}
+
+static void throw_IllegalArgumentException(JNIEnv *env, char const * const message)
+{
+	throw_exception(env, "java/lang/IllegalArgumentException", message);
+}
+
+static void throw_NullPointerException(JNIEnv *env, char const * const message)
+{
+	throw_exception(env, "java/lang/NullPointerException", message);
+}
+
+static void throw_RuntimeException(JNIEnv *env, char const * const message)
+{
+	throw_exception(env, "java/lang/RuntimeException", message);
+}
+
+static void throw_decode_error(JNIEnv *env, int err)
+{
+	switch (err) {
+	case MJPEG_INVALID_ARGUMENTS:
+		throw_IllegalArgumentException(env, "Output buffer or scale is invalid.");
+		break;
+	case MJPEG_UNSUPPORTED:
+		throw_RuntimeException(env, "Unsupported JPEG stream.");
+		break;
+	case MJPEG_INSUFFICIENT_MEMORY:
+		throw_RuntimeException(env, "Insufficient memory to decode.");
+		break;
+	default:
+		throw_RuntimeException(env, "Corrupted JPEG stream.");
+		break;
+	}
+}
@@ -0,0 +1,77 @@
+/* DO NOT EDIT THIS FILE - it is machine generated */
+#include <jni.h>
+/* Header for class net_crimsonwoods_android_libs_uvccap_MjpegDecoder */
+
+#ifndef _Included_net_crimsonwoods_android_libs_uvccap_MjpegDecoder
+#define _Included_net_crimsonwoods_android_libs_uvccap_MjpegDecoder
+#ifdef __cplusplus
+extern "C" {
+#endif
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_MjpegDecoder
+ * Method:    n_create
+ * Signature: (I)J
+ */
+JNIEXPORT jlong JNICALL Java_net_crimsonwoods_android_libs_uvccap_MjpegDecoder_n_1create
+  (JNIEnv *, jclass, jint);
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_MjpegDecoder
+ * Method:    n_destroy
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_net_crimsonwoods_android_libs_uvccap_MjpegDecoder_n_1destroy
+  (JNIEnv *, jclass, jlong);
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_MjpegDecoder
+ * Method:    n_setThreadPolicy
+ * Signature: (J[I[I)V
+ */
+JNIEXPORT void JNICALL Java_net_crimsonwoods_android_libs_uvccap_MjpegDecoder_n_1setThreadPolicy
+  (JNIEnv *, jclass, jlong, jintArray, jintArray);
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_MjpegDecoder
+ * Method:    n_getSize
+ * Signature: ([BI[I)Z
+ */
+JNIEXPORT jboolean JNICALL Java_net_crimsonwoods_android_libs_uvccap_MjpegDecoder_n_1getSize
+  (JNIEnv *, jclass, jbyteArray, jint, jintArray);
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_MjpegDecoder
+ * Method:    n_decodeToRgba
+ * Signature: (J[I[BII)V
+ */
+JNIEXPORT void JNICALL Java_net_crimsonwoods_android_libs_uvccap_MjpegDecoder_n_1decodeToRgba
+  (JNIEnv *, jclass, jlong, jintArray, jbyteArray, jint, jint);
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_MjpegDecoder
+ * Method:    n_decodeToYuv
+ * Signature: (J[B[BIII)V
+ */
+JNIEXPORT void JNICALL Java_net_crimsonwoods_android_libs_uvccap_MjpegDecoder_n_1decodeToYuv
+  (JNIEnv *, jclass, jlong, jbyteArray, jbyteArray, jint, jint, jint);
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_MjpegDecoder
+ * Method:    n_decodeDirect
+ * Signature: (JLjava/nio/ByteBuffer;Ljava/nio/ByteBuffer;III)V
+ */
+JNIEXPORT void JNICALL Java_net_crimsonwoods_android_libs_uvccap_MjpegDecoder_n_1decodeDirect
+  (JNIEnv *, jclass, jlong, jobject, jobject, jint, jint, jint);
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_MjpegDecoder
+ * Method:    n_decodePlanes
+ * Signature: (J[Ljava/nio/ByteBuffer;[ILjava/nio/ByteBuffer;III)V
+ */
+JNIEXPORT void JNICALL Java_net_crimsonwoods_android_libs_uvccap_MjpegDecoder_n_1decodePlanes
+  (JNIEnv *, jclass, jlong, jobjectArray, jintArray, jobject, jint, jint, jint);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,645 @@
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define SCALER_NEON 1
+#endif
+
+#include "scaler.h"
+
+// weights of a filter add up to WEIGHT_ONE.
+#define WEIGHT_BITS 12
+#define WEIGHT_ONE  (1 << WEIGHT_BITS)
+#define WEIGHT_HALF (1 << (WEIGHT_BITS - 1))
+
+#define MAX_DIMENSION 16384
+#define CACHE_SIZE    8
+
+#ifdef SCALER_NEON
+#define ROW_CACHE_SIZE 4
+#define GROUP_BYTES    8  // destination bytes filtered together
+#define WINDOW_BYTES   32 // source bytes one table lookup reaches
+#define WINDOW_TAPS    4  // wider filters never fit a window
+#endif
+
+/*
+ * Filter of one axis: output i is the weighted sum of 'taps' source
+ * samples from starts[i].
+ */
+typedef struct filter_t_ {
+	int            src_size;
+	int            dst_size;
+	scaler_mode_t  mode;
+	int            taps;
+	int           *starts;
+	uint16_t      *weights;
+	uint32_t       last_use; // 0 while the entry is free.
+} filter_t;
+
+/* Samples of a row that are filtered together: 'channels' bytes every 'step' bytes from 'offset'. */
+typedef struct component_t_ {
+	int offset;
+	int step;
+	int channels;
+	int src_width;
+	int dst_width;
+} component_t;
+
+#ifdef SCALER_NEON
+/*
+ * Horizontal pass of all the components of a row as one filter per
+ * destination byte, so packed layouts vectorize too. Bytes are filtered
+ * in groups of 8: per tap, 8 source offsets from bases[g] then 8 weights.
+ * A group whose samples all lie in the 32 bytes from its base gathers
+ * them with table lookups, the others are filtered byte by byte.
+ */
+typedef struct row_filter_t_ {
+	component_t    components[3];
+	int            count;
+	scaler_mode_t  mode;
+	int            src_bytes;
+	int            dst_bytes;
+	int            taps;
+	int            groups;
+	int           *bases;
+	uint8_t       *windowed;
+	uint16_t      *data;
+	uint32_t       last_use; // 0 while the entry is free.
+} row_filter_t;
+#endif
+
+struct scaler_t_ {
+	filter_t filters[CACHE_SIZE];
+#ifdef SCALER_NEON
+	row_filter_t row_filters[ROW_CACHE_SIZE];
+#endif
+	uint32_t clock;
+	uint8_t *row;
+	size_t   row_size;
+};
+
+static void set_component(component_t *c, int offset, int step, int channels, int src_width, int dst_width) {
+	c->offset = offset;
+	c->step = step;
+	c->channels = channels;
+	c->src_width = src_width;
+	c->dst_width = dst_width;
+}
+
+static void build_bilinear(filter_t *f) {
+	int64_t const src = f->src_size;
+	int64_t const dst = f->dst_size;
+	int64_t pos;
+	int i, x0, frac;
+
+	for (i = 0; i < f->dst_size; ++i) {
+		// centers of the pixels are aligned, in 16.16.
+		pos = ((2 * i + 1) * src * 32768) / dst - 32768;
+		pos = (pos < 0) ? 0 : pos;
+		x0 = (int)(pos >> 16);
+		frac = (int)((pos & 0xffff) >> (16 - WEIGHT_BITS));
+		if (x0 >= f->src_size - 1) {
+			x0 = f->src_size - 2;
+			frac = WEIGHT_ONE;
+		}
+		f->starts[i] = x0;
+		f->weights[i * 2]     = WEIGHT_ONE - frac;
+		f->weights[i * 2 + 1] = frac;
+	}
+}
+
+static void build_area(filter_t *f) {
+	int64_t const src = f->src_size;
+	int64_t const dst = f->dst_size;
+	uint16_t *w;
+	int64_t begin, end, lo, hi;
+	int i, k, j0, start;
+
+	for (i = 0; i < f->dst_size; ++i) {
+		// in units where source pixel j spans [j * dst, (j + 1) * dst).
+		begin = i * src;
+		end = begin + src;
+		j0 = (int)(begin / dst);
+		start = (j0 + f->taps > f->src_size) ? f->src_size - f->taps : j0;
+
+		/*
+		 * weights are differences of the rounded coverage up to each edge,
+		 * so they sum to exactly one and stay even when a tap gets less
+		 * than a unit, however large the reduction.
+		 */
+		w = f->weights + i * f->taps;
+		for (k = 0; k < f->taps; ++k) {
+			lo = (start + k) * dst;
+			hi = lo + dst;
+			lo = (lo < begin) ? begin : (lo > end) ? end : lo;
+			hi = (hi > end) ? end : (hi < begin) ? begin : hi;
+			w[k] = (uint16_t)((((hi - begin) * WEIGHT_ONE + src / 2) / src) - (((lo - begin) * WEIGHT_ONE + src / 2) / src));
+		}
+		f->starts[i] = start;
+	}
+}
+
+static int build_filter(filter_t *f, int src_size, int dst_size, scaler_mode_t mode) {
+	int taps;
+	int i;
+
+	if (src_size == dst_size) {
+		taps = 1;
+	} else if ((SCALER_MODE_AREA == mode) && (src_size > dst_size)) {
+		taps = (src_size + dst_size - 1) / dst_size + 1;
+	} else {
+		taps = 2;
+	}
+	taps = (taps > src_size) ? src_size : taps;
+
+	free(f->starts);
+	free(f->weights);
+	f->starts = (int*)malloc(sizeof(int) * dst_size);
+	f->weights = (uint16_t*)malloc(sizeof(uint16_t) * dst_size * taps);
+	if ((NULL == f->starts) || (NULL == f->weights)) {
+		free(f->starts);
+		free(f->weights);
+		f->starts = NULL;
+		f->weights = NULL;
+		f->last_use = 0;
+		return SCALER_INSUFFICIENT_MEMORY;
+	}
+	f->src_size = src_size;
+	f->dst_size = dst_size;
+	f->mode = mode;
+	f->taps = taps;
+
+	if (1 == taps) {
+		// same size, or a single source sample.
+		for (i = 0; i < dst_size; ++i) {
+			f->starts[i] = (src_size == dst_size) ? i : 0;
+			f->weights[i] = WEIGHT_ONE;
+		}
+	} else if ((SCALER_MODE_AREA == mode) && (src_size > dst_size)) {
+		build_area(f);
+	} else {
+		build_bilinear(f);
+	}
+	return SCALER_NOERROR;
+}
+
+/* Cached filter for the sizes, the least recently used one is rebuilt on a miss. */
+static int get_filter(scaler_t *scaler, int src_size, int dst_size, scaler_mode_t mode, filter_t const **filter) {
+	filter_t *victim = &scaler->filters[0];
+	filter_t *f;
+	int result;
+	int i;
+
+	++scaler->clock;
+	for (i = 0; i < CACHE_SIZE; ++i) {
+		f = &scaler->filters[i];
+		if ((0 != f->last_use) && (f->src_size == src_size) && (f->dst_size == dst_size) && (f->mode == mode)) {
+			f->last_use = scaler->clock;
+			*filter = f;
+			return SCALER_NOERROR;
+		}
+		if (f->last_use < victim->last_use) {
+			victim = f;
+		}
+	}
+
+	result = build_filter(victim, src_size, dst_size, mode);
+	if (SCALER_NOERROR != result) {
+		return result;
+	}
+	victim->last_use = scaler->clock;
+	*filter = victim;
+	return SCALER_NOERROR;
+}
+
+/* Vertical pass: weighted sum of 'taps' rows from 'src', 'size' bytes each. */
+static void filter_rows(uint8_t *dst, uint8_t const *src, int stride, uint16_t const *weights, int taps, int size) {
+	uint8_t const *s;
+	uint32_t acc;
+	int x = 0;
+	int k;
+
+#ifdef SCALER_NEON
+	for (; x + 8 <= size; x += 8) {
+		uint32x4_t lo = vdupq_n_u32(0);
+		uint32x4_t hi = vdupq_n_u32(0);
+		for (k = 0, s = src + x; k < taps; ++k, s += stride) {
+			uint16x8_t const v = vmovl_u8(vld1_u8(s));
+			lo = vmlal_n_u16(lo, vget_low_u16(v), weights[k]);
+			hi = vmlal_n_u16(hi, vget_high_u16(v), weights[k]);
+		}
+		vst1_u8(dst + x, vmovn_u16(vcombine_u16(vrshrn_n_u32(lo, WEIGHT_BITS), vrshrn_n_u32(hi, WEIGHT_BITS))));
+	}
+#endif
+	if (2 == taps) {
+		for (; x < size; ++x) {
+			dst[x] = (uint8_t)((src[x] * weights[0] + src[x + stride] * weights[1] + WEIGHT_HALF) >> WEIGHT_BITS);
+		}
+	}
+	for (; x < size; ++x) {
+		acc = WEIGHT_HALF;
+		for (k = 0, s = src + x; k < taps; ++k, s += stride) {
+			acc += *s * weights[k];
+		}
+		dst[x] = (uint8_t)(acc >> WEIGHT_BITS);
+	}
+}
+
+/* Horizontal pass of one component of a row. */
+static void filter_columns(uint8_t *dst, uint8_t const *src, component_t const *c, filter_t const *f) {
+	int const step = c->step;
+	uint16_t const *w = f->weights;
+	uint8_t const *s;
+	uint8_t *d;
+	uint32_t acc;
+	int i, ch, k;
+
+	if (2 == f->taps) {
+		for (i = 0; i < f->dst_size; ++i, w += 2) {
+			s = src + f->starts[i] * step;
+			d = dst + i * step;
+			for (ch = 0; ch < c->channels; ++ch) {
+				d[ch] = (uint8_t)((s[ch] * w[0] + s[ch + step] * w[1] + WEIGHT_HALF) >> WEIGHT_BITS);
+			}
+		}
+		return;
+	}
+
+	for (i = 0; i < f->dst_size; ++i, w += f->taps) {
+		s = src + f->starts[i] * step;
+		d = dst + i * step;
+		for (ch = 0; ch < c->channels; ++ch) {
+			acc = WEIGHT_HALF;
+			for (k = 0; k < f->taps; ++k) {
+				acc += s[k * step + ch] * w[k];
+			}
+			d[ch] = (uint8_t)(acc >> WEIGHT_BITS);
+		}
+	}
+}
+
+#ifdef SCALER_NEON
+static void release_row_filter(row_filter_t *rf) {
+	free(rf->bases);
+	free(rf->windowed);
+	free(rf->data);
+	rf->bases = NULL;
+	rf->windowed = NULL;
+	rf->data = NULL;
+	rf->last_use = 0;
+}
+
+static int build_row_filter(row_filter_t *rf, component_t const *components, int count, filter_t const * const *filters,
+	scaler_mode_t mode, int src_bytes, int dst_bytes) {
+	component_t const *c;
+	uint16_t *d;
+	int *offsets;
+	int taps = 1;
+	int i, j, k, ch, g, n, lo, hi, base, src_offset;
+
+	for (i = 0; i < count; ++i) {
+		taps = (filters[i]->taps > taps) ? filters[i]->taps : taps;
+	}
+
+	release_row_filter(rf);
+	rf->groups = (dst_bytes + GROUP_BYTES - 1) / GROUP_BYTES;
+	rf->bases = (int*)malloc(sizeof(int) * rf->groups);
+	rf->windowed = (uint8_t*)malloc(rf->groups);
+	rf->data = (uint16_t*)calloc((size_t)rf->groups * taps * GROUP_BYTES * 2, sizeof(uint16_t));
+	// absolute source offsets, made relative to the base of each group below.
+	offsets = (int*)calloc((size_t)rf->groups * GROUP_BYTES * taps, sizeof(int));
+	if ((NULL == rf->bases) || (NULL == rf->windowed) || (NULL == rf->data) || (NULL == offsets)) {
+		free(offsets);
+		release_row_filter(rf);
+		return SCALER_INSUFFICIENT_MEMORY;
+	}
+	memcpy(rf->components, components, sizeof(component_t) * count);
+	rf->count = count;
+	rf->mode = mode;
+	rf->src_bytes = src_bytes;
+	rf->dst_bytes = dst_bytes;
+	rf->taps = taps;
+
+	// taps a component does not have repeat its first sample with no weight.
+	for (i = 0; i < count; ++i) {
+		c = &components[i];
+		for (j = 0; j < c->dst_width; ++j) {
+			for (ch = 0; ch < c->channels; ++ch) {
+				n = c->offset + j * c->step + ch;
+				d = rf->data + (n / GROUP_BYTES) * taps * GROUP_BYTES * 2 + n % GROUP_BYTES;
+				for (k = 0; k < taps; ++k) {
+					src_offset = c->offset + (filters[i]->starts[j] + ((k < filters[i]->taps) ? k : 0)) * c->step + ch;
+					offsets[n * taps + k] = src_offset;
+					d[k * GROUP_BYTES * 2 + GROUP_BYTES] = (k < filters[i]->taps) ? filters[i]->weights[j * filters[i]->taps + k] : 0;
+				}
+			}
+		}
+	}
+
+	for (g = 0; g < rf->groups; ++g) {
+		n = (dst_bytes - g * GROUP_BYTES < GROUP_BYTES) ? dst_bytes - g * GROUP_BYTES : GROUP_BYTES;
+		lo = hi = offsets[g * GROUP_BYTES * taps];
+		for (j = 0; j < n * taps; ++j) {
+			lo = (offsets[g * GROUP_BYTES * taps + j] < lo) ? offsets[g * GROUP_BYTES * taps + j] : lo;
+			hi = (offsets[g * GROUP_BYTES * taps + j] > hi) ? offsets[g * GROUP_BYTES * taps + j] : hi;
+		}
+		// the window must not read past the row.
+		base = (lo + WINDOW_BYTES > src_bytes) ? src_bytes - WINDOW_BYTES : lo;
+		rf->windowed[g] = (GROUP_BYTES == n) && (0 <= base) && (hi < base + WINDOW_BYTES);
+		rf->bases[g] = rf->windowed[g] ? base : lo;
+		d = rf->data + g * taps * GROUP_BYTES * 2;
+		for (j = 0; j < n; ++j) {
+			for (k = 0; k < taps; ++k) {
+				d[k * GROUP_BYTES * 2 + j] = (uint16_t)(offsets[(g * GROUP_BYTES + j) * taps + k] - rf->bases[g]);
+			}
+		}
+	}
+	free(offsets);
+	return SCALER_NOERROR;
+}
+
+/* Cached row filter of the components, like get_filter. */
+static int get_row_filter(scaler_t *scaler, component_t const *components, int count, filter_t const * const *filters,
+	scaler_mode_t mode, int src_bytes, int dst_bytes, row_filter_t const **row_filter) {
+	row_filter_t *victim = &scaler->row_filters[0];
+	row_filter_t *rf;
+	int result;
+	int i;
+
+	++scaler->clock;
+	for (i = 0; i < ROW_CACHE_SIZE; ++i) {
+		rf = &scaler->row_filters[i];
+		if ((0 != rf->last_use) && (rf->count == count) && (rf->mode == mode) &&
+			(rf->src_bytes == src_bytes) && (rf->dst_bytes == dst_bytes) &&
+			(0 == memcmp(rf->components, components, sizeof(component_t) * count))) {
+			rf->last_use = scaler->clock;
+			*row_filter = rf;
+			return SCALER_NOERROR;
+		}
+		if (rf->last_use < victim->last_use) {
+			victim = rf;
+		}
+	}
+
+	result = build_row_filter(victim, components, count, filters, mode, src_bytes, dst_bytes);
+	if (SCALER_NOERROR != result) {
+		return result;
+	}
+	victim->last_use = scaler->clock;
+	*row_filter = victim;
+	return SCALER_NOERROR;
+}
+
+/* Horizontal pass of a whole row, see row_filter_t. */
+static void filter_row(uint8_t *dst, uint8_t const *src, row_filter_t const *rf) {
+	int const taps = rf->taps;
+	uint16_t const *d = rf->data;
+	uint8_t const *s;
+	uint32_t acc;
+	int g, j, k, n;
+
+	for (g = 0; g < rf->groups; ++g, d += taps * GROUP_BYTES * 2) {
+		s = src + rf->bases[g];
+		if (rf->windowed[g]) {
+			uint8x8x4_t window;
+			uint32x4_t lo = vdupq_n_u32(0);
+			uint32x4_t hi = vdupq_n_u32(0);
+			window.val[0] = vld1_u8(s);
+			window.val[1] = vld1_u8(s + 8);
+			window.val[2] = vld1_u8(s + 16);
+			window.val[3] = vld1_u8(s + 24);
+			for (k = 0; k < taps; ++k) {
+				uint16x8_t const v = vmovl_u8(vtbl4_u8(window, vmovn_u16(vld1q_u16(d + k * GROUP_BYTES * 2))));
+				uint16x8_t const w = vld1q_u16(d + k * GROUP_BYTES * 2 + GROUP_BYTES);
+				lo = vmlal_u16(lo, vget_low_u16(v), vget_low_u16(w));
+				hi = vmlal_u16(hi, vget_high_u16(v), vget_high_u16(w));
+			}
+			vst1_u8(dst + g * GROUP_BYTES, vmovn_u16(vcombine_u16(vrshrn_n_u32(lo, WEIGHT_BITS), vrshrn_n_u32(hi, WEIGHT_BITS))));
+			continue;
+		}
+
+		n = (rf->dst_bytes - g * GROUP_BYTES < GROUP_BYTES) ? rf->dst_bytes - g * GROUP_BYTES : GROUP_BYTES;
+		for (j = 0; j < n; ++j) {
+			acc = WEIGHT_HALF;
+			for (k = 0; k < taps; ++k) {
+				acc += s[d[k * GROUP_BYTES * 2 + j]] * d[k * GROUP_BYTES * 2 + GROUP_BYTES + j];
+			}
+			dst[g * GROUP_BYTES + j] = (uint8_t)(acc >> WEIGHT_BITS);
+		}
+	}
+}
+#endif
+
+/*
+ * Scale one plane made of 'count' components sharing its rows. Source
+ * rows are filtered vertically into a scratch row first, which is then
+ * filtered horizontally straight into the destination.
+ */
+static int scale_plane(scaler_t *scaler, scaler_mode_t mode,
+	uint8_t const *src, int src_stride, int src_height, uint8_t *dst, int dst_stride, int dst_height,
+	component_t const *components, int count, int src_row_bytes, int dst_row_bytes)
+{
+	filter_t const *hfilters[3];
+	filter_t const *vfilter;
+	uint8_t const *row;
+#ifdef SCALER_NEON
+	row_filter_t const *row_filter = NULL;
+	int taps = 1;
+#endif
+	int copy_rows = 1;
+	int result;
+	int i, y;
+
+	for (i = 0; i < count; ++i) {
+		result = get_filter(scaler, components[i].src_width, components[i].dst_width, mode, &hfilters[i]);
+		if (SCALER_NOERROR != result) {
+			return result;
+		}
+		copy_rows = copy_rows && (1 == hfilters[i]->taps) && (components[i].src_width == components[i].dst_width);
+#ifdef SCALER_NEON
+		taps = (hfilters[i]->taps > taps) ? hfilters[i]->taps : taps;
+#endif
+	}
+#ifdef SCALER_NEON
+	// built after the filters it copies, which it outlives in the cache.
+	if (!copy_rows && (taps <= WINDOW_TAPS) && (src_row_bytes >= WINDOW_BYTES)) {
+		result = get_row_filter(scaler, components, count, hfilters, mode, src_row_bytes, dst_row_bytes, &row_filter);
+		if (SCALER_NOERROR != result) {
+			return result;
+		}
+	}
+#endif
+	// at most four filters are in use at once, the cache never evicts one of them.
+	result = get_filter(scaler, src_height, dst_height, mode, &vfilter);
+	if (SCALER_NOERROR != result) {
+		return result;
+	}
+
+	if (scaler->row_size < (size_t)src_row_bytes) {
+		uint8_t *grown = (uint8_t*)realloc(scaler->row, src_row_bytes);
+		if (NULL == grown) {
+			return SCALER_INSUFFICIENT_MEMORY;
+		}
+		scaler->row = grown;
+		scaler->row_size = src_row_bytes;
+	}
+
+	for (y = 0; y < dst_height; ++y) {
+		if (1 == vfilter->taps) {
+			row = src + vfilter->starts[y] * src_stride;
+		} else {
+			filter_rows(scaler->row, src + vfilter->starts[y] * src_stride, src_stride,
+				vfilter->weights + y * vfilter->taps, vfilter->taps, src_row_bytes);
+			row = scaler->row;
+		}
+
+		if (copy_rows) {
+			memcpy(dst + y * dst_stride, row, dst_row_bytes);
+			continue;
+		}
+#ifdef SCALER_NEON
+		if (NULL != row_filter) {
+			filter_row(dst + y * dst_stride, row, row_filter);
+			continue;
+		}
+#endif
+		for (i = 0; i < count; ++i) {
+			filter_columns(dst + y * dst_stride + components[i].offset, row + components[i].offset, &components[i], hfilters[i]);
+		}
+	}
+	return SCALER_NOERROR;
+}
+
+size_t scaler_plane_size(scaler_format_t format, int width, int height, int plane, int stride) {
+	int const chroma_width = (width + 1) / 2;
+	int row_bytes, rows;
+
+	if ((0 >= width) || (0 >= height) || (MAX_DIMENSION < width) || (MAX_DIMENSION < height)) {
+		return 0;
+	}
+	switch (format) {
+	case SCALER_FORMAT_YUYV:
+	case SCALER_FORMAT_UYVY:
+		row_bytes = (0 == plane) ? width * 2 : 0;
+		rows = height;
+		break;
+	case SCALER_FORMAT_RGBA:
+		row_bytes = (0 == plane) ? width * 4 : 0;
+		rows = height;
+		break;
+	case SCALER_FORMAT_GREY:
+		row_bytes = (0 == plane) ? width : 0;
+		rows = height;
+		break;
+	case SCALER_FORMAT_NV12:
+		row_bytes = (0 == plane) ? width : ((1 == plane) ? chroma_width * 2 : 0);
+		rows = (0 == plane) ? height : (height + 1) / 2;
+		break;
+	case SCALER_FORMAT_I420:
+		row_bytes = (0 == plane) ? width : chroma_width;
+		rows = (0 == plane) ? height : (height + 1) / 2;
+		break;
+	case SCALER_FORMAT_YUV422P:
+		row_bytes = (0 == plane) ? width : chroma_width;
+		rows = height;
+		break;
+	default:
+		return 0;
+	}
+	if (0 == row_bytes) {
+		return 0;
+	}
+	return (size_t)stride * (rows - 1) + row_bytes;
+}
+
+scaler_t *scaler_create(void) {
+	return (scaler_t*)calloc(1, sizeof(scaler_t));
+}
+
+void scaler_destroy(scaler_t *scaler) {
+	int i;
+
+	if (NULL == scaler) {
+		return;
+	}
+	for (i = 0; i < CACHE_SIZE; ++i) {
+		free(scaler->filters[i].starts);
+		free(scaler->filters[i].weights);
+	}
+#ifdef SCALER_NEON
+	for (i = 0; i < ROW_CACHE_SIZE; ++i) {
+		release_row_filter(&scaler->row_filters[i]);
+	}
+#endif
+	free(scaler->row);
+	free(scaler);
+}
+
+int scaler_scale(scaler_t *scaler, scaler_format_t format, scaler_mode_t mode,
+	uint8_t const * const src[3], int const src_strides[3], int src_width, int src_height,
+	uint8_t * const dst[3], int const dst_strides[3], int dst_width, int dst_height)
+{
+	component_t components[3];
+	int const luma = (SCALER_FORMAT_UYVY == format) ? 1 : 0;
+	int const chroma = 1 - luma;
+	int sw = (src_width + 1) / 2;
+	int dw = (dst_width + 1) / 2;
+	int sh, dh;
+	int result;
+	int i;
+
+	if ((NULL == scaler) || (NULL == src) || (NULL == src_strides) || (NULL == dst) || (NULL == dst_strides) ||
+		(0 >= src_width) || (0 >= src_height) || (0 >= dst_width) || (0 >= dst_height) ||
+		(MAX_DIMENSION < src_width) || (MAX_DIMENSION < src_height) ||
+		(MAX_DIMENSION < dst_width) || (MAX_DIMENSION < dst_height) ||
+		((SCALER_MODE_BILINEAR != mode) && (SCALER_MODE_AREA != mode))) {
+		return SCALER_INVALID_ARGUMENTS;
+	}
+
+	switch (format) {
+	case SCALER_FORMAT_YUYV:
+	case SCALER_FORMAT_UYVY:
+		if ((0 != (src_width & 1)) || (0 != (dst_width & 1))) {
+			return SCALER_INVALID_ARGUMENTS;
+		}
+		set_component(&components[0], luma, 2, 1, src_width, dst_width);
+		set_component(&components[1], chroma, 4, 1, sw, dw);
+		set_component(&components[2], chroma + 2, 4, 1, sw, dw);
+		return scale_plane(scaler, mode, src[0], src_strides[0], src_height, dst[0], dst_strides[0], dst_height,
+			components, 3, src_width * 2, dst_width * 2);
+	case SCALER_FORMAT_RGBA:
+		set_component(&components[0], 0, 4, 4, src_width, dst_width);
+		return scale_plane(scaler, mode, src[0], src_strides[0], src_height, dst[0], dst_strides[0], dst_height,
+			components, 1, src_width * 4, dst_width * 4);
+	case SCALER_FORMAT_GREY:
+	case SCALER_FORMAT_I420:
+	case SCALER_FORMAT_YUV422P:
+	case SCALER_FORMAT_NV12:
+		break;
+	default:
+		return SCALER_INVALID_ARGUMENTS;
+	}
+
+	set_component(&components[0], 0, 1, 1, src_width, dst_width);
+	result = scale_plane(scaler, mode, src[0], src_strides[0], src_height, dst[0], dst_strides[0], dst_height,
+		components, 1, src_width, dst_width);
+	if ((SCALER_NOERROR != result) || (SCALER_FORMAT_GREY == format)) {
+		return result;
+	}
+
+	sh = (SCALER_FORMAT_YUV422P == format) ? src_height : (src_height + 1) / 2;
+	dh = (SCALER_FORMAT_YUV422P == format) ? dst_height : (dst_height + 1) / 2;
+	if (SCALER_FORMAT_NV12 == format) {
+		set_component(&components[0], 0, 2, 2, sw, dw);
+		return scale_plane(scaler, mode, src[1], src_strides[1], sh, dst[1], dst_strides[1], dh,
+			components, 1, sw * 2, dw * 2);
+	}
+
+	set_component(&components[0], 0, 1, 1, sw, dw);
+	for (i = 1; (i < 3) && (SCALER_NOERROR == result); ++i) {
+		result = scale_plane(scaler, mode, src[i], src_strides[i], sh, dst[i], dst_strides[i], dh,
+			components, 1, sw, dw);
+	}
+	return result;
+}
@@ -0,0 +1,59 @@
+#ifndef SCALER_H
+#define SCALER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum scaler_error_t {
+	SCALER_NOERROR = 0,
+	SCALER_INVALID_ARGUMENTS,
+	SCALER_INSUFFICIENT_MEMORY,
+} scaler_error_t;
+
+typedef enum scaler_mode_t {
+	SCALER_MODE_BILINEAR = 0, // two taps per axis, sharp and cheap.
+	SCALER_MODE_AREA,         // every source pixel weighted by the area it covers, for downscaling.
+} scaler_mode_t;
+
+/*
+ * Layouts the scaler works on, strides are in bytes. Packed YUV keeps its
+ * chroma pairs (the width has to stay even), chroma planes are scaled with
+ * their own size; NV12 also serves NV21.
+ */
+typedef enum scaler_format_t {
+	SCALER_FORMAT_YUYV = 0,
+	SCALER_FORMAT_UYVY,
+	SCALER_FORMAT_I420,
+	SCALER_FORMAT_YUV422P,
+	SCALER_FORMAT_NV12,
+	SCALER_FORMAT_RGBA,
+	SCALER_FORMAT_GREY,
+	SCALER_FORMAT_COUNT,
+} scaler_format_t;
+
+/*
+ * Fixed-point filter coefficients are computed once per source and
+ * destination size and kept by the scaler, so scaling a stream of frames
+ * of the same size only filters. A scaler is not reentrant.
+ */
+typedef struct scaler_t_ scaler_t;
+
+extern scaler_t *scaler_create(void);
+extern void scaler_destroy(scaler_t *scaler);
+
+/* Bytes of 'plane' a frame spans with 'stride', 0 if the format has no such plane. */
+extern size_t scaler_plane_size(scaler_format_t format, int width, int height, int plane, int stride);
+
+extern int scaler_scale(scaler_t *scaler, scaler_format_t format, scaler_mode_t mode,
+	uint8_t const * const src[3], int const src_strides[3], int src_width, int src_height,
+	uint8_t * const dst[3], int const dst_strides[3], int dst_width, int dst_height);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,149 @@
+#include "scaler_jni.h"
+#include "scaler.h"
+#include <stdint.h>
+
+static void throw_IllegalArgumentException(JNIEnv *env, char const * const message);
+static void throw_NullPointerException(JNIEnv *env, char const * const message);
+static void throw_RuntimeException(JNIEnv *env, char const * const message);
+static int  get_planes(JNIEnv *env, jobjectArray planes, jintArray strides,
+	int format, int width, int height, uint8_t *ptrs[3], int pitches[3]);
+
+#define TO_SCALER(h) ((scaler_t*)(intptr_t)h)
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_Scaler
+ * Method:    n_create
+ * Signature: ()J
+ */
+JNIEXPORT jlong JNICALL Java_net_crimsonwoods_android_libs_uvccap_Scaler_n_1create
+  (JNIEnv *env, jclass cls)
+{
+	scaler_t *scaler = scaler_create();
+	if (NULL == scaler) {
+		throw_RuntimeException(env, "Scaler can't create.");
+	}
+	return (jlong)(intptr_t)scaler;
+}
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_Scaler
+ * Method:    n_destroy
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_net_crimsonwoods_android_libs_uvccap_Scaler_n_1destroy
+  (JNIEnv *env, jclass cls, jlong handle)
+{
+	scaler_destroy(TO_SCALER(handle));
+}
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_Scaler
+ * Method:    n_scale
+ * Signature: (JII[Ljava/nio/ByteBuffer;[III[Ljava/nio/ByteBuffer;[III)V
+ */
+JNIEXPORT void JNICALL Java_net_crimsonwoods_android_libs_uvccap_Scaler_n_1scale
+  (JNIEnv *env, jclass cls, jlong handle, jint format, jint mode,
+   jobjectArray src, jintArray src_strides, jint src_width, jint src_height,
+   jobjectArray dst, jintArray dst_strides, jint dst_width, jint dst_height)
+{
+	uint8_t *src_ptrs[3];
+	uint8_t *dst_ptrs[3];
+	int src_pitches[3];
+	int dst_pitches[3];
+	int result;
+
+	if (!get_planes(env, src, src_strides, format, src_width, src_height, src_ptrs, src_pitches) ||
+		!get_planes(env, dst, dst_strides, format, dst_width, dst_height, dst_ptrs, dst_pitches)) {
+		return;
+	}
+
+	result = scaler_scale(TO_SCALER(handle), (scaler_format_t)format, (scaler_mode_t)mode,
+		(uint8_t const * const*)src_ptrs, src_pitches, src_width, src_height,
+		dst_ptrs, dst_pitches, dst_width, dst_height);
+	if (SCALER_INVALID_ARGUMENTS == result) {
+		throw_IllegalArgumentException(env, "Unsupported size or scaling ratio.");
+	} else if (SCALER_NOERROR != result) {
+		throw_RuntimeException(env, "Frame can't be scaled.");
+	}
+}
+
+static int get_planes(JNIEnv *env, jobjectArray planes, jintArray strides,
+	int format, int width, int height, uint8_t *ptrs[3], int pitches[3])
+{
+	jint values[3] = { 0, 0, 0 };
+	jobject plane;
+	jlong capacity;
+	size_t required;
+	jsize count;
+	int i;
+
+	if ((NULL == planes) || (NULL == strides)) {
+		throw_NullPointerException(env, "'planes' and 'strides' have to be set not null.");
+		return 0;
+	}
+	if (0 == scaler_plane_size((scaler_format_t)format, width, height, 0, 1)) {
+		throw_IllegalArgumentException(env, "Unsupported format or size.");
+		return 0;
+	}
+	count = (*env)->GetArrayLength(env, planes);
+	if ((3 < count) || ((*env)->GetArrayLength(env, strides) < count)) {
+		throw_IllegalArgumentException(env, "'planes' or 'strides' is out of range.");
+		return 0;
+	}
+	(*env)->GetIntArrayRegion(env, strides, 0, count, values);
+
+	for (i = 0; i < 3; ++i) {
+		ptrs[i] = NULL;
+		pitches[i] = values[i];
+		required = scaler_plane_size((scaler_format_t)format, width, height, i, values[i]);
+		if (0 == required) {
+			continue;
+		}
+		if ((i >= count) || (0 >= values[i])) {
+			throw_IllegalArgumentException(env, "Too few planes for the format.");
+			return 0;
+		}
+		plane = (*env)->GetObjectArrayElement(env, planes, i);
+		if (NULL == plane) {
+			throw_NullPointerException(env, "'planes' have to be set not null.");
+			return 0;
+		}
+		ptrs[i] = (uint8_t*)(*env)->GetDirectBufferAddress(env, plane);
+		capacity = (*env)->GetDirectBufferCapacity(env, plane);
+		(*env)->DeleteLocalRef(env, plane);
+		if (NULL == ptrs[i]) {
+			throw_IllegalArgumentException(env, "'planes' have to be direct buffers.");
+			return 0;
+		}
+		if ((0 > capacity) || ((size_t)capacity < required)) {
+			throw_IllegalArgumentException(env, "A plane is smaller than the frame.");
+			return 0;
+		}
+	}
+	return 1;
+}
+
+static void throw_exception(JNIEnv *env, char const * const cls, char const * const message)
+{
+	jclass ioe_cls = (*env)->FindClass(env, cls);
+	if (NULL == ioe_cls) {
+		return;
+	}
+	(*env)->ThrowNew(env, ioe_cls, message);
+	(*env)->DeleteLocalRef(env, ioe_cls);
+}
+
+static void throw_IllegalArgumentException(JNIEnv *env, char const * const message)
+{
+	throw_exception(env, "java/lang/IllegalArgumentException", message);
+}
+
+static void throw_NullPointerException(JNIEnv *env, char const * const message)
+{
+	throw_exception(env, "java/lang/NullPointerException", message);
+}
+
+static void throw_RuntimeException(JNIEnv *env, char const * const message)
+{
+	throw_exception(env, "java/lang/RuntimeException", message);
+}
@@ -0,0 +1,37 @@
+/* DO NOT EDIT THIS FILE - it is machine generated */
+#include <jni.h>
+/* Header for class net_crimsonwoods_android_libs_uvccap_Scaler */
+
+#ifndef _Included_net_crimsonwoods_android_libs_uvccap_Scaler
+#define _Included_net_crimsonwoods_android_libs_uvccap_Scaler
+#ifdef __cplusplus
+extern "C" {
+#endif
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_Scaler
+ * Method:    n_create
+ * Signature: ()J
+ */
+JNIEXPORT jlong JNICALL Java_net_crimsonwoods_android_libs_uvccap_Scaler_n_1create
+  (JNIEnv *, jclass);
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_Scaler
+ * Method:    n_destroy
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_net_crimsonwoods_android_libs_uvccap_Scaler_n_1destroy
+  (JNIEnv *, jclass, jlong);
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_Scaler
+ * Method:    n_scale
+ * Signature: (JII[Ljava/nio/ByteBuffer;[III[Ljava/nio/ByteBuffer;[III)V
+ */
+JNIEXPORT void JNICALL Java_net_crimsonwoods_android_libs_uvccap_Scaler_n_1scale
+  (JNIEnv *, jclass, jlong, jint, jint, jobjectArray, jintArray, jint, jint, jobjectArray, jintArray, jint, jint);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -1,20 +1,18 @@
+#include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
 #include <string.h>
 #include <errno.h>
 #include <assert.h>
 #include <fcntl.h>
+#include <time.h>
+#include <pthread.h>
 #include <sys/ioctl.h>
 #include <sys/mman.h>
 #include <linux/videodev.h>
 
-#include <android/log.h>
-
 #define LOG_TAG "uvccap"
-#define LOGE(fmt, ...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, fmt, ##__VA_ARGS__)
-#define LOGD(fmt, ...) __android_log_print(ANDROID_LOG_DEBUG, LOG_TAG, fmt, ##__VA_ARGS__)
-#define LOGI(fmt, ...) __android_log_print(ANDROID_LOG_INFO,  LOG_TAG, fmt, ##__VA_ARGS__)
-#define LOGW(fmt, ...) __android_log_print(ANDROID_LOG_WARN,  LOG_TAG, fmt, ##__VA_ARGS__)
+#include "uvcclog.h"
 
 #ifndef VIDIOC_ENUM_FRAMESIZES
 enum v4l2_frmsizetypes {
@@ -47,13 +45,42 @@ struct v4l2_frmsizeenum {
 #define VIDIOC_ENUM_FRAMESIZES  _IOWR('V', 74, struct v4l2_frmsizeenum)
 #endif
 
+#ifndef VIDIOC_ENUM_FRAMEINTERVALS
+enum v4l2_frmivaltypes {
+	V4L2_FRMIVAL_TYPE_DISCRETE   = 1,
+	V4L2_FRMIVAL_TYPE_CONTINUOUS = 2,
+	V4L2_FRMIVAL_TYPE_STEPWISE   = 3,
+};
+struct v4l2_frmival_stepwise {
+	struct v4l2_fract min;
+	struct v4l2_fract max;
+	struct v4l2_fract step;
+};
+struct v4l2_frmivalenum {
+	__u32 index;
+	__u32 pixel_format;
+	__u32 width;
+	__u32 height;
+	__u32 type;
+	union {
+		struct v4l2_fract            discrete;
+		struct v4l2_frmival_stepwise stepwise;
+	};
+	__u32 reserved[2];
+};
+#define VIDIOC_ENUM_FRAMEINTERVALS _IOWR('V', 75, struct v4l2_frmivalenum)
+#endif
+
 #include "uvccap.h"
+#include "uvcctrace.h"
+#include "uvcccache.h"
+#include "uvccstats.h"
+#include "uvcccopy.h"
+#include "uvccthread.h"
 
 #define CASESTR(x) case x: return #x
 
 /* Data structure and constant values */
-#define DEF_PIXEL_FORMAT UVCC_PIX_FMT_YUYV
-
 static uvcc_pixel_format_t const PIXEL_FORMATS[UVCC_PIX_FMT_COUNT + 1] = {
 	V4L2_PIX_FMT_RGB565,
 	V4L2_PIX_FMT_RGB32,
@@ -63,21 +90,80 @@ static uvcc_pixel_format_t const PIXEL_FORMATS[UVCC_PIX_FMT_COUNT + 1] = {
 	V4L2_PIX_FMT_YUV420,
 	V4L2_PIX_FMT_YUV410,
 	V4L2_PIX_FMT_YUV422P,
+	V4L2_PIX_FMT_NV12,
+	V4L2_PIX_FMT_NV21,
+	V4L2_PIX_FMT_MJPEG,
 	0, // sentinel
 };
 
+// directory of the capability cache, NULL disables the cache.
+static char *cache_directory = NULL;
+
+// multi-planar variants delivered by MPLANE drivers for the formats above.
+static uint32_t const PIXEL_FORMAT_ALIASES[][2] = {
+#ifdef V4L2_PIX_FMT_NV12M
+	{ V4L2_PIX_FMT_NV12M,   UVCC_PIX_FMT_NV12 },
+#endif
+#ifdef V4L2_PIX_FMT_NV21M
+	{ V4L2_PIX_FMT_NV21M,   UVCC_PIX_FMT_NV21 },
+#endif
+#ifdef V4L2_PIX_FMT_YUV420M
+	{ V4L2_PIX_FMT_YUV420M, UVCC_PIX_FMT_YUV420 },
+#endif
+	{ 0, 0 }, // sentinel
+};
+
+static uint32_t const BITS_PER_PIXEL[UVCC_PIX_FMT_COUNT] = {
+	16, // RGB565
+	32, // RGB32
+	32, // BGR32
+	16, // YUYV
+	16, // UYVY
+	12, // YUV420
+	9,  // YUV410
+	16, // YUV422P
+	12, // NV12
+	12, // NV21
+	3,  // MJPEG (typical compressed payload)
+};
+
+typedef enum pixel_format_family_t_ {
+	FAMILY_RGB = 0,
+	FAMILY_PACKED_YUV,
+	FAMILY_PLANAR_YUV,
+	FAMILY_SEMI_PLANAR_YUV,
+	FAMILY_COMPRESSED,
+	FAMILY_COUNT,
+} pixel_format_family_t;
+
+// conversion cost per pixel in quarter units (source family x output family).
+static uint32_t const CONVERSION_COST[FAMILY_COUNT][FAMILY_COUNT] = {
+	/*              RGB packed planar semi compressed */
+	/* RGB    */ {   4,    12,    12,  12,        64 },
+	/* packed */ {  24,     4,     6,   6,        56 },
+	/* planar */ {  24,     6,     4,   2,        48 },
+	/* semi   */ {  24,     6,     2,   4,        48 },
+	/* MJPEG  */ {  48,    36,    32,  34,         4 },
+};
+
 typedef union pixel_format_name_t_ {
 	uint32_t u;
 	char name[4];
 } pixel_format_name_t;
 
-typedef struct video_buf_t_ {
+typedef struct video_plane_t_ {
 	void    *addr;
 	uint32_t size;
+} video_plane_t;
+
+typedef struct video_buf_t_ {
+	video_plane_t planes[UVCC_MAX_PLANES];
+	uint32_t      plane_count;
 } video_buf_t;
 
 typedef struct video_dev_t_ {
 	int                    fd;
+	uint32_t               buf_type; // V4L2_BUF_TYPE_VIDEO_CAPTURE or its MPLANE variant.
 	struct v4l2_capability caps;
 	struct v4l2_cropcap    cropcaps;
 	struct v4l2_crop       crop;
@@ -85,6 +171,29 @@ typedef struct video_dev_t_ {
 	video_buf_t           *buffers;
 	int                    buffer_count;
 	int                    is_capture_started;
+	uint32_t              *formats; // ENUM_FMT results in driver order.
+	int                    format_count;
+	int                    format_capacity;
+	struct v4l2_frmsizeenum *frame_sizes;
+	int                    frame_size_count;
+	int                    frame_size_capacity;
+	uvcc_stream_mode_t    *modes;
+	int                    mode_count;
+	int                    mode_capacity;
+	int                    is_probed; // formats, frame sizes and modes are known.
+	uvcc_trace_t          *trace; // NULL unless tracing is enabled.
+	uint32_t               frame_size; // size of a frame of the current format, kept while suspended without buffers.
+	int64_t                resume_begin_us; // non zero until the first frame after a resume.
+	uvcc_idle_stats_t      idle_stats;
+	char                  *path; // node opened last, tried first when reconnecting.
+	struct v4l2_fract      interval; // frame interval set last, 0/0 if the driver default is used.
+	uint32_t               reconnect_timeout_ms; // 0 unless captures reconnect by themselves.
+	int64_t                lost_us; // when the device was found gone, 0 while it is connected.
+	int                    lost_streaming; // state to restore once the device is back.
+	int                    lost_buffer_count;
+	uvcc_reconnect_stats_t reconnect_stats;
+	pthread_mutex_t        stats_lock; // idle and reconnect stats are read while another thread captures.
+	int                    lock_buffers; // mlock the mapped buffers, again whenever they are mapped.
 } video_dev_t;
 
 /* Internal APIs */
@@ -94,36 +203,434 @@ static void print_frame_size(struct v4l2_frmsizeenum const *size);
 static uint32_t to_v4l2_pixel_format(uvcc_pixel_format_t format);
 static uint32_t from_v4l2_pixel_format(uint32_t format);
 static int init_buffer(video_dev_t *dev);
-static int read_frame(uint8_t * const buf, uint32_t buf_size, video_dev_t const *dev);
+static void unmap_buffers(video_buf_t *buffers, uint32_t count);
+static void release_buffer(video_dev_t *dev);
+static int read_frame(uint8_t * const buf, uint32_t buf_size, video_dev_t *dev, uvcc_frame_info_t *info, uvcc_frame_stats_t *stats);
+static int dequeue_frame(video_dev_t *dev, uvcc_frame_t *frame);
+static int queue_buffer(video_dev_t const *dev, uint32_t index);
+static int wait_for_frame(video_dev_t const *dev, int timeout_ms);
+static int probe_capabilities(video_dev_t *dev);
+static void release_capabilities(video_dev_t *dev);
+static int load_capability_cache(video_dev_t *dev);
+static int store_capability_cache(video_dev_t const *dev);
+static int select_best_mode(video_dev_t const *dev, uint32_t width, uint32_t height, uint32_t fps, uvcc_pixel_format_t output_format, uvcc_stream_mode_t *best);
+static int set_frame_interval(video_dev_t *dev, uint32_t numerator, uint32_t denominator);
+static int64_t now_us(void);
+
+#define TRACE(dev, event, arg) \
+	do { \
+		if (NULL != (dev)->trace) { \
+			uvcc_trace_record((dev)->trace, (event), (arg)); \
+		} \
+	} while (0)
+
+#ifdef V4L2_CAP_VIDEO_CAPTURE_MPLANE
+#define IS_MPLANE(dev) (V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE == (dev)->buf_type)
+typedef struct v4l2_plane v4l2_plane_t;
+#else
+#define IS_MPLANE(dev) 0
+typedef struct v4l2_plane_t_ { uint32_t unused; } v4l2_plane_t;
+#endif
 
-static int read_frame(uint8_t * const buf, uint32_t buf_size, video_dev_t const *dev) {
-	struct v4l2_buffer v4l2_buf;
-	int result = NOERROR;
-	uint32_t size;
+/* Errors of ioctls on a device that was unplugged or reset by the USB stack. */
+static int is_disconnect_error(int err) {
+	return (ENODEV == err) || (ENXIO == err) || (EIO == err) || (ESHUTDOWN == err);
+}
 
-	assert(NULL != buf);
-	assert(NULL != dev);
+static uint32_t get_format_width(video_dev_t const *dev) {
+#ifdef V4L2_CAP_VIDEO_CAPTURE_MPLANE
+	if (IS_MPLANE(dev)) {
+		return dev->format.fmt.pix_mp.width;
+	}
+#endif
+	return dev->format.fmt.pix.width;
+}
+
+static uint32_t get_format_height(video_dev_t const *dev) {
+#ifdef V4L2_CAP_VIDEO_CAPTURE_MPLANE
+	if (IS_MPLANE(dev)) {
+		return dev->format.fmt.pix_mp.height;
+	}
+#endif
+	return dev->format.fmt.pix.height;
+}
+
+static uint32_t get_format_pixelformat(video_dev_t const *dev) {
+#ifdef V4L2_CAP_VIDEO_CAPTURE_MPLANE
+	if (IS_MPLANE(dev)) {
+		return dev->format.fmt.pix_mp.pixelformat;
+	}
+#endif
+	return dev->format.fmt.pix.pixelformat;
+}
+
+static uint32_t get_format_stride(video_dev_t const *dev, uint32_t plane) {
+#ifdef V4L2_CAP_VIDEO_CAPTURE_MPLANE
+	if (IS_MPLANE(dev)) {
+		return dev->format.fmt.pix_mp.plane_fmt[plane].bytesperline;
+	}
+#endif
+	return dev->format.fmt.pix.bytesperline;
+}
+
+/*
+ * Initialize v4l2_buf for QBUF/DQBUF/QUERYBUF, 'planes' has to hold
+ * UVCC_MAX_PLANES entries and is used only by MPLANE devices.
+ */
+static void prepare_buffer(video_dev_t const *dev, struct v4l2_buffer *v4l2_buf, v4l2_plane_t *planes, uint32_t index) {
+	memset(v4l2_buf, 0, sizeof(*v4l2_buf));
+	v4l2_buf->type   = dev->buf_type;
+	v4l2_buf->memory = V4L2_MEMORY_MMAP;
+	v4l2_buf->index  = index;
+#ifdef V4L2_CAP_VIDEO_CAPTURE_MPLANE
+	if (IS_MPLANE(dev)) {
+		memset(planes, 0, sizeof(v4l2_plane_t) * UVCC_MAX_PLANES);
+		v4l2_buf->m.planes = planes;
+		v4l2_buf->length   = UVCC_MAX_PLANES;
+	}
+#endif
+}
+
+/*
+ * Chroma planes that follow the Y plane of a contiguous planar frame,
+ * returns 0 for formats that have none.
+ */
+static uint32_t get_chroma_layout(uint32_t pixel_format, uint32_t stride, uint32_t height, uint32_t *chroma_stride, uint32_t *chroma_height) {
+	switch (pixel_format) {
+	case V4L2_PIX_FMT_NV12:
+	case V4L2_PIX_FMT_NV21:
+		*chroma_stride = stride;
+		*chroma_height = (height + 1) / 2;
+		return 1;
+	case V4L2_PIX_FMT_YUV420:
+		*chroma_stride = stride / 2;
+		*chroma_height = (height + 1) / 2;
+		return 2;
+	case V4L2_PIX_FMT_YUV422P:
+		*chroma_stride = stride / 2;
+		*chroma_height = height;
+		return 2;
+	case V4L2_PIX_FMT_YUV410:
+		*chroma_stride = stride / 4;
+		*chroma_height = (height + 3) / 4;
+		return 2;
+	default:
+		return 0;
+	}
+}
+
+/* Split a contiguous planar frame into its Y and chroma planes. */
+static void split_planes(uvcc_frame_t *frame, uint32_t pixel_format, uint32_t height) {
+	uvcc_plane_t const whole = frame->planes[0];
+	uint32_t chroma_planes, chroma_stride, chroma_height;
+	uint32_t offset, size;
+	uint32_t i;
+
+	chroma_planes = get_chroma_layout(pixel_format, whole.stride, height, &chroma_stride, &chroma_height);
+	if (0 == chroma_planes) {
+		return;
+	}
 
-	memset(&v4l2_buf, 0, sizeof(v4l2_buf));
-	v4l2_buf.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-	v4l2_buf.memory = V4L2_MEMORY_MMAP;
+	offset = whole.stride * height;
+	size   = chroma_stride * chroma_height;
+	if ((0 == whole.stride) || (whole.bytesused < offset + size * chroma_planes)) {
+		return;
+	}
+
+	frame->planes[0].bytesused = offset;
+	for (i = 1; i <= chroma_planes; ++i) {
+		frame->planes[i].data      = whole.data + offset;
+		frame->planes[i].stride    = chroma_stride;
+		frame->planes[i].bytesused = size;
+		offset += size;
+	}
+	// trailing padding stays with the last plane.
+	frame->planes[chroma_planes].bytesused += whole.bytesused - offset;
+	frame->plane_count = chroma_planes + 1;
+}
+
+static void fill_frame(video_dev_t const *dev, struct v4l2_buffer const *v4l2_buf, uvcc_frame_t *frame) {
+	video_buf_t const *buf = &dev->buffers[v4l2_buf->index];
+	uint32_t used;
+
+	memset(frame, 0, sizeof(*frame));
+	frame->index             = v4l2_buf->index;
+	frame->info.sequence     = v4l2_buf->sequence;
+	frame->info.timestamp_us = (int64_t)v4l2_buf->timestamp.tv_sec * 1000000 + v4l2_buf->timestamp.tv_usec;
+
+#ifdef V4L2_CAP_VIDEO_CAPTURE_MPLANE
+	if (IS_MPLANE(dev)) {
+		uint32_t i;
+		for (i = 0; i < buf->plane_count; ++i) {
+			struct v4l2_plane const *plane = &v4l2_buf->m.planes[i];
+			used = (0 != plane->bytesused) ? plane->bytesused : buf->planes[i].size;
+			used = (used > plane->data_offset) ? used - plane->data_offset : 0;
+			frame->planes[i].data      = (uint8_t const*)buf->planes[i].addr + plane->data_offset;
+			frame->planes[i].stride    = get_format_stride(dev, i);
+			frame->planes[i].bytesused = used;
+			frame->info.bytesused     += used;
+		}
+		frame->plane_count = buf->plane_count;
+	} else
+#endif
+	{
+		// compressed frames fill only a part of the buffer.
+		used = (0 != v4l2_buf->bytesused) ? v4l2_buf->bytesused : buf->planes[0].size;
+		frame->planes[0].data      = (uint8_t const*)buf->planes[0].addr;
+		frame->planes[0].stride    = get_format_stride(dev, 0);
+		frame->planes[0].bytesused = used;
+		frame->info.bytesused      = used;
+		frame->plane_count         = 1;
+	}
+
+	if (1 == frame->plane_count) {
+		split_planes(frame, get_format_pixelformat(dev), get_format_height(dev));
+	}
+}
 
+static int dequeue_frame(video_dev_t *dev, uvcc_frame_t *frame) {
+	struct v4l2_buffer v4l2_buf;
+	v4l2_plane_t planes[UVCC_MAX_PLANES];
+	uint32_t latency;
+
+	prepare_buffer(dev, &v4l2_buf, planes, 0);
 	if (0 > ioctl(dev->fd, VIDIOC_DQBUF, &v4l2_buf)) {
 		LOGE("Failed to dequeueing buffer (%s).", strerror(errno));
-		return MEMORY_DEQUEUEING_FAILED;
+		return is_disconnect_error(errno) ? VIDEO_DEVICE_DISCONNECTED : MEMORY_DEQUEUEING_FAILED;
 	}
 
 	assert(v4l2_buf.index < dev->buffer_count);
 
-	size = buf_size < dev->buffers[v4l2_buf.index].size ? buf_size : dev->buffers[v4l2_buf.index].size;
-	memcpy(buf, dev->buffers[v4l2_buf.index].addr, size);
+	TRACE(dev, UVCC_TRACE_DQBUF, v4l2_buf.sequence);
+
+	if (0 != dev->resume_begin_us) {
+		latency = (uint32_t)(now_us() - dev->resume_begin_us);
+		dev->resume_begin_us = 0;
+		pthread_mutex_lock(&dev->stats_lock);
+		dev->idle_stats.last_resume_us = latency;
+		if (latency > dev->idle_stats.max_resume_us) {
+			dev->idle_stats.max_resume_us = latency;
+		}
+		pthread_mutex_unlock(&dev->stats_lock);
+		LOGI("First frame %u us after resume.", latency);
+	}
+
+	fill_frame(dev, &v4l2_buf, frame);
+
+	return NOERROR;
+}
+
+static int queue_buffer(video_dev_t const *dev, uint32_t index) {
+	struct v4l2_buffer v4l2_buf;
+	v4l2_plane_t planes[UVCC_MAX_PLANES];
 
+	prepare_buffer(dev, &v4l2_buf, planes, index);
 	if (0 > ioctl(dev->fd, VIDIOC_QBUF, &v4l2_buf)) {
 		LOGE("Failed to queueing buffer (%s).", strerror(errno));
-		result = MEMORY_QUEUEING_FAILED;
+		return is_disconnect_error(errno) ? VIDEO_DEVICE_DISCONNECTED : MEMORY_QUEUEING_FAILED;
 	}
 
-	return result;
+	TRACE(dev, UVCC_TRACE_QBUF, index);
+
+	return NOERROR;
+}
+
+/* Position of the luma samples in plane 0, 0 == step if the format has none. */
+static void get_luma_layout(uint32_t pixel_format, uint32_t *first, uint32_t *step) {
+	*first = 0;
+	switch (pixel_format) {
+	case V4L2_PIX_FMT_YUYV:
+		*step = 2;
+		break;
+	case V4L2_PIX_FMT_UYVY:
+		*first = 1;
+		*step = 2;
+		break;
+	case V4L2_PIX_FMT_YUV420:
+	case V4L2_PIX_FMT_YUV410:
+	case V4L2_PIX_FMT_YUV422P:
+	case V4L2_PIX_FMT_NV12:
+	case V4L2_PIX_FMT_NV21:
+		*step = 1;
+		break;
+	default:
+		*step = 0;
+		break;
+	}
+}
+
+/* Copy the luma plane row by row through the statistics kernel, returns bytes copied. */
+static uint32_t copy_luma_plane(uint8_t *dst, uint32_t dst_size, uvcc_plane_t const *plane, video_dev_t const *dev, uvcc_frame_stats_t *stats) {
+	uvcc_stats_acc_t acc;
+	uint32_t const width = get_format_width(dev);
+	uint32_t const stride = plane->stride;
+	uint32_t size = (dst_size < plane->bytesused) ? dst_size : plane->bytesused;
+	uint32_t first, step;
+	uint32_t copied = 0;
+
+	uvcc_stats_reset(&acc);
+	get_luma_layout(get_format_pixelformat(dev), &first, &step);
+	if ((0 != step) && (0 != stride) && (first + step * width <= stride)) {
+		for (; copied + stride <= size; copied += stride) {
+			uvcc_stats_copy_row(&acc, dst + copied, plane->data + copied, stride, first, step, width);
+		}
+	}
+	uvcc_copy(dst + copied, plane->data + copied, size - copied);
+	uvcc_stats_finish(&acc, stats);
+	return size;
+}
+
+/*
+ * Bytes of pixel data in each row of a plane and the number of rows,
+ * 0 if the format has no such plane or is not made of rows.
+ */
+static uint32_t get_plane_geometry(uvcc_pixel_format_t format, uint32_t width, uint32_t height, uint32_t plane, uint32_t *rows) {
+	uint32_t const chroma_width = (width + 1) / 2;
+
+	*rows = height;
+	if (0 == plane) {
+		switch (format) {
+		case UVCC_PIX_FMT_RGB565:
+		case UVCC_PIX_FMT_YUYV:
+		case UVCC_PIX_FMT_UYVY:
+			return width * 2;
+		case UVCC_PIX_FMT_RGB32:
+		case UVCC_PIX_FMT_BGR32:
+			return width * 4;
+		case UVCC_PIX_FMT_YUV420:
+		case UVCC_PIX_FMT_YUV410:
+		case UVCC_PIX_FMT_YUV422P:
+		case UVCC_PIX_FMT_NV12:
+		case UVCC_PIX_FMT_NV21:
+			return width;
+		default:
+			return 0;
+		}
+	}
+
+	switch (format) {
+	case UVCC_PIX_FMT_NV12:
+	case UVCC_PIX_FMT_NV21:
+		*rows = (height + 1) / 2;
+		return (1 == plane) ? chroma_width * 2 : 0;
+	case UVCC_PIX_FMT_YUV420:
+		*rows = (height + 1) / 2;
+		return (plane <= 2) ? chroma_width : 0;
+	case UVCC_PIX_FMT_YUV422P:
+		return (plane <= 2) ? chroma_width : 0;
+	case UVCC_PIX_FMT_YUV410:
+		*rows = (height + 3) / 4;
+		return (plane <= 2) ? (width + 3) / 4 : 0;
+	default:
+		return 0;
+	}
+}
+
+/*
+ * Copy the rows of each plane from the driver stride to the caller's one.
+ * Planes that are not made of rows (MJPEG) are copied as is.
+ */
+static int copy_planes(uvcc_frame_t const *frame, video_dev_t const *dev,
+	uint8_t * const planes[UVCC_MAX_PLANES], uint32_t const strides[UVCC_MAX_PLANES], uint32_t const sizes[UVCC_MAX_PLANES], uint32_t *copied) {
+	uvcc_pixel_format_t const format = from_v4l2_pixel_format(get_format_pixelformat(dev));
+	uvcc_plane_t const *src;
+	uint32_t row_bytes, rows;
+	uint32_t i, y;
+
+	*copied = 0;
+	for (i = 0; i < frame->plane_count; ++i) {
+		src = &frame->planes[i];
+		row_bytes = get_plane_geometry(format, get_format_width(dev), get_format_height(dev), i, &rows);
+		if ((0 == row_bytes) || (0 == src->stride)) {
+			if ((NULL == planes[i]) || (sizes[i] < src->bytesused)) {
+				return INVALID_ARGUMENTS;
+			}
+			uvcc_copy(planes[i], src->data, src->bytesused);
+			*copied += src->bytesused;
+			continue;
+		}
+
+		// drivers may deliver less than a whole frame after an error.
+		row_bytes = (row_bytes < src->stride) ? row_bytes : src->stride;
+		rows = (rows < src->bytesused / src->stride) ? rows : src->bytesused / src->stride;
+		if (0 == rows) {
+			continue;
+		}
+		if ((NULL == planes[i]) || (strides[i] < row_bytes) ||
+			((uint64_t)strides[i] * (rows - 1) + row_bytes > sizes[i])) {
+			return INVALID_ARGUMENTS;
+		}
+		if (strides[i] == src->stride) {
+			uvcc_copy(planes[i], src->data, src->stride * (rows - 1) + row_bytes);
+		} else {
+			for (y = 0; y < rows; ++y) {
+				uvcc_copy(planes[i] + strides[i] * y, src->data + src->stride * y, row_bytes);
+			}
+		}
+		*copied += row_bytes * rows;
+	}
+	return NOERROR;
+}
+
+/*
+ * Bytes from the start of a plane to the end of its last row at the driver
+ * stride, all of it for planes that are not made of rows (MJPEG).
+ */
+static uint32_t get_plane_span(video_dev_t const *dev, uvcc_plane_t const *plane, uint32_t index) {
+	uvcc_pixel_format_t const format = from_v4l2_pixel_format(get_format_pixelformat(dev));
+	uint32_t rows;
+
+	if ((0 == plane->stride) || (0 == get_plane_geometry(format, get_format_width(dev), get_format_height(dev), index, &rows))) {
+		return plane->bytesused;
+	}
+	return plane->stride * rows;
+}
+
+static int read_frame(uint8_t * const buf, uint32_t buf_size, video_dev_t *dev, uvcc_frame_info_t *info, uvcc_frame_stats_t *stats) {
+	uvcc_frame_t frame;
+	uvcc_plane_t plane;
+	uint32_t copied = 0;
+	uint32_t offset = 0;
+	uint32_t size, span;
+	uint32_t i;
+	int result;
+
+	assert(NULL != buf);
+	assert(NULL != dev);
+
+	result = dequeue_frame(dev, &frame);
+	if (NOERROR != result) {
+		return result;
+	}
+
+	/*
+	 * Planes follow each other at the driver stride like in a contiguous
+	 * buffer, whatever a multi-planar driver pads them with. A short plane
+	 * leaves a gap rather than moving the next one.
+	 */
+	for (i = 0; (i < frame.plane_count) && (offset < buf_size); ++i) {
+		plane = frame.planes[i];
+		span = get_plane_span(dev, &plane, i);
+		plane.bytesused = (plane.bytesused < span) ? plane.bytesused : span;
+		if ((0 == i) && (NULL != stats)) {
+			size = copy_luma_plane(buf, buf_size, &plane, dev, stats);
+		} else {
+			size = buf_size - offset;
+			size = (size < plane.bytesused) ? size : plane.bytesused;
+			uvcc_copy(buf + offset, plane.data, size);
+		}
+		copied = offset + size;
+		offset = (buf_size - offset < span) ? buf_size : offset + span;
+	}
+
+	TRACE(dev, UVCC_TRACE_COPY_DONE, copied);
+
+	if (NULL != info) {
+		*info = frame.info;
+		info->bytesused = copied;
+	}
+
+	return queue_buffer(dev, frame.index);
 }
 
 static void print_capability(struct v4l2_capability const *caps) {
@@ -131,10 +638,18 @@ static void print_capability(struct v4l2_capability const *caps) {
 
 	char flags[512];
 
+	if (!UVCC_LOG_ENABLED(ANDROID_LOG_INFO)) {
+		return;
+	}
+
 	memset(flags, 0, sizeof(flags));
 
 	if (0 != (V4L2_CAP_VIDEO_CAPTURE & caps->capabilities))
 		strcat(flags, "capture ");
+#ifdef V4L2_CAP_VIDEO_CAPTURE_MPLANE
+	if (0 != (V4L2_CAP_VIDEO_CAPTURE_MPLANE & caps->capabilities))
+		strcat(flags, "capture_mplane ");
+#endif
 	if (0 != (V4L2_CAP_VIDEO_OUTPUT & caps->capabilities))
 		strcat(flags, "output ");
 	if (0 != (V4L2_CAP_VIDEO_OVERLAY & caps->capabilities))
@@ -224,10 +739,11 @@ static void print_pixel_format(struct v4l2_pix_format const *fmt) {
 	LOGI("  private      : %u\n", fmt->priv);
 }
 
+// 0 for a value that names no format, callers must not fall back silently.
 static uint32_t to_v4l2_pixel_format(uvcc_pixel_format_t format) {
-	if (format >= UVCC_PIX_FMT_COUNT) {
-		return PIXEL_FORMATS[DEF_PIXEL_FORMAT];
-	}	
+	if ((uint32_t)format >= UVCC_PIX_FMT_COUNT) {
+		return 0;
+	}
 	return PIXEL_FORMATS[format];
 }
 
@@ -238,179 +754,729 @@ static uint32_t from_v4l2_pixel_format(uint32_t format) {
 			return i;
 		}
 	}
+	for (i = 0; PIXEL_FORMAT_ALIASES[i][0]; ++i) {
+		if (PIXEL_FORMAT_ALIASES[i][0] == format) {
+			return PIXEL_FORMAT_ALIASES[i][1];
+		}
+	}
 	return -1;
 }
 
-static int init_buffer(video_dev_t *dev) {
-	struct v4l2_requestbuffers req;
-	struct v4l2_buffer buf;
-	uint32_t i, count;
-	video_buf_t *buf_ptr;
-	int result = NOERROR;
+static pixel_format_family_t to_pixel_format_family(uvcc_pixel_format_t format) {
+	switch (format) {
+	case UVCC_PIX_FMT_RGB565:
+	case UVCC_PIX_FMT_RGB32:
+	case UVCC_PIX_FMT_BGR32:
+		return FAMILY_RGB;
+	case UVCC_PIX_FMT_YUYV:
+	case UVCC_PIX_FMT_UYVY:
+		return FAMILY_PACKED_YUV;
+	case UVCC_PIX_FMT_NV12:
+	case UVCC_PIX_FMT_NV21:
+		return FAMILY_SEMI_PLANAR_YUV;
+	case UVCC_PIX_FMT_MJPEG:
+		return FAMILY_COMPRESSED;
+	default:
+		return FAMILY_PLANAR_YUV;
+	}
+}
 
-	dev->buffers = NULL;
-	dev->buffer_count = 0;
+static uint32_t estimate_transfer_cost(uvcc_pixel_format_t format, uint32_t width, uint32_t height) {
+	return (uint32_t)(((uint64_t)width * height * BITS_PER_PIXEL[format]) / 8);
+}
 
-	memset(&req, 0, sizeof(req));
-	req.count = 4;
-	req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-	req.memory = V4L2_MEMORY_MMAP;
+static uint32_t estimate_conversion_cost(uvcc_pixel_format_t format, uvcc_pixel_format_t output_format, uint32_t width, uint32_t height) {
+	if (format == output_format) {
+		return 0;
+	}
+	return (uint32_t)(((uint64_t)width * height * CONVERSION_COST[to_pixel_format_family(format)][to_pixel_format_family(output_format)]) / 4);
+}
 
-	if (0 > ioctl(dev->fd, VIDIOC_REQBUFS, &req)) {
-		if (EBUSY == errno) {
-			LOGE("Buffer is already in progress.");
-			return VIDEO_DEVICE_BUSY;
-		}
-		if (EINVAL == errno) {
-			LOGE("Memory mapping is not supported.");
-			return IO_METHOD_NOT_SUPPORTED;
+static int append_element(void **array, int *count, int *capacity, void const *element, size_t size) {
+	void *grown;
+	int new_capacity;
+
+	if (*count == *capacity) {
+		new_capacity = (0 == *capacity) ? 16 : *capacity * 2;
+		grown = realloc(*array, size * new_capacity);
+		if (NULL == grown) {
+			LOGE("Insufficient memory in application.");
+			return INSUFFICIENT_MEMORY;
 		}
+		*array    = grown;
+		*capacity = new_capacity;
 	}
 
-	count = req.count;
+	memcpy((uint8_t*)*array + size * (*count)++, element, size);
 
-	if (count < 2) {
-		LOGE("Insufficient memory in video device driver.");
-		return INSUFFICIENT_MEMORY;
-	}
+	return NOERROR;
+}
 
-	buf_ptr = malloc(sizeof(video_buf_t) * count);
-	if (NULL == buf_ptr) {
-		LOGE("Insufficient memory in application.");
-		return INSUFFICIENT_MEMORY;
+static int add_mode(video_dev_t *dev, uint32_t pixel_format, uint32_t width, uint32_t height, struct v4l2_fract const *interval) {
+	uvcc_stream_mode_t mode;
+
+	memset(&mode, 0, sizeof(mode));
+	mode.pixel_format = from_v4l2_pixel_format(pixel_format);
+	mode.width        = width;
+	mode.height       = height;
+	if (NULL != interval) {
+		mode.interval_numerator   = interval->numerator;
+		mode.interval_denominator = interval->denominator;
 	}
 
-	for (i = 0; i < count; ++i) {
-		memset(&buf, 0, sizeof(buf));
-		buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-		buf.type = V4L2_MEMORY_MMAP;
-		buf.index = i;
+	return append_element((void**)&dev->modes, &dev->mode_count, &dev->mode_capacity, &mode, sizeof(mode));
+}
 
-		buf_ptr[i].size = 0;
-		buf_ptr[i].addr = MAP_FAILED;
+static int probe_frame_intervals(video_dev_t *dev, uint32_t pixel_format, uint32_t width, uint32_t height) {
+	struct v4l2_frmivalenum ival;
+	uint32_t i;
+	int result = NOERROR;
 
-		if (0 > ioctl(dev->fd, VIDIOC_QUERYBUF, &buf)) {
-			if (EINVAL == errno) {
-				break;
-			} else {
-				LOGE("Failed to query buffer (%s).", strerror(errno));
-				result = VIDEO_DEVICE_QUERY_BUFFER_FAILED;
-				break;
+	for (i = 0; NOERROR == result; ++i) {
+		memset(&ival, 0, sizeof(ival));
+		ival.index        = i;
+		ival.pixel_format = pixel_format;
+		ival.width        = width;
+		ival.height       = height;
+		if (0 > ioctl(dev->fd, VIDIOC_ENUM_FRAMEINTERVALS, &ival)) {
+			if (0 == i) {
+				// frame interval is not reported by the driver.
+				result = add_mode(dev, pixel_format, width, height, NULL);
 			}
-		}
-
-		buf_ptr[i].size = buf.length;
-		buf_ptr[i].addr = mmap(NULL, buf.length, PROT_READ, MAP_SHARED, dev->fd, buf.m.offset);
-
-		if (MAP_FAILED == buf_ptr[i].addr) {
-			LOGE("Failed to map the video memory (%s).", strerror(errno));
-			result = MEMORY_MAPPING_FAILED;
 			break;
 		}
-	}
-
-	if (NOERROR != result) {
-		for (i = 0; i < count; ++i) {
-			if (MAP_FAILED == buf_ptr[i].addr) {
-				break;
+		if (V4L2_FRMIVAL_TYPE_DISCRETE == ival.type) {
+			result = add_mode(dev, pixel_format, width, height, &ival.discrete);
+		} else {
+			// continuous or stepwise: register both ends of the range.
+			result = add_mode(dev, pixel_format, width, height, &ival.stepwise.min);
+			if (NOERROR == result) {
+				result = add_mode(dev, pixel_format, width, height, &ival.stepwise.max);
 			}
-			munmap(buf_ptr[i].addr, buf_ptr[i].size);
-			buf_ptr[i].size = 0;
-			buf_ptr[i].addr = NULL;
+			break;
 		}
-		free(buf_ptr);
-	} else {
-		dev->buffers      = buf_ptr;
-		dev->buffer_count = i;
 	}
 
 	return result;
 }
 
-int uvcc_open_video_device(uvcc_handle_t *handle, char const * const path) {
-	video_dev_t *dev = NULL;
-	uint32_t i;
+static int probe_capabilities(video_dev_t *dev) {
 	struct v4l2_fmtdesc desc;
+	struct v4l2_frmsizeenum frmsize;
+	uint32_t i, j;
+	int result = NOERROR;
 
-	if (NULL == handle) {
-		LOGE("'handle' parameter can not set to NULL.");
-		return INVALID_ARGUMENTS;
+	if (dev->is_probed) {
+		return NOERROR;
 	}
-	if (NULL == path) {
-		LOGE("'path' parameter can not set to NULL.");
-		return INVALID_ARGUMENTS;
+
+	for (i = 0; NOERROR == result; ++i) {
+		memset(&desc, 0, sizeof(desc));
+		desc.index = i;
+		desc.type  = dev->buf_type;
+		if (0 > ioctl(dev->fd, VIDIOC_ENUM_FMT, &desc)) {
+			break;
+		}
+		result = append_element((void**)&dev->formats, &dev->format_count, &dev->format_capacity, &desc.pixelformat, sizeof(desc.pixelformat));
+		if ((NOERROR != result) || ((uint32_t)-1 == from_v4l2_pixel_format(desc.pixelformat))) {
+			continue;
+		}
+		for (j = 0; NOERROR == result; ++j) {
+			memset(&frmsize, 0, sizeof(frmsize));
+			frmsize.index        = j;
+			frmsize.pixel_format = desc.pixelformat;
+			if (0 > ioctl(dev->fd, VIDIOC_ENUM_FRAMESIZES, &frmsize)) {
+				break;
+			}
+			result = append_element((void**)&dev->frame_sizes, &dev->frame_size_count, &dev->frame_size_capacity, &frmsize, sizeof(frmsize));
+			if (NOERROR != result) {
+				break;
+			}
+			if (V4L2_FRMSIZE_TYPE_DISCRETE != frmsize.type) {
+				LOGW("Non-discrete frame sizes are not probed.");
+				break;
+			}
+			result = probe_frame_intervals(dev, desc.pixelformat, frmsize.discrete.width, frmsize.discrete.height);
+		}
 	}
 
-	dev = (video_dev_t*)malloc(sizeof(video_dev_t));
-	if (NULL == dev) {
-		LOGE("Memory allocation failed.");
-		return INSUFFICIENT_MEMORY;
+	if (NOERROR != result) {
+		release_capabilities(dev);
+	} else {
+		dev->is_probed = 1;
 	}
 
-	memset(dev, 0, sizeof(video_dev_t));
+	return result;
+}
 
-	// set initial values.
-	dev->fd = -1;
-	dev->buffers = NULL;
-	dev->buffer_count = 0;
-	dev->is_capture_started = 0;
+static void release_capabilities(video_dev_t *dev) {
+	free(dev->formats);
+	dev->formats = NULL;
+	dev->format_count = 0;
+	dev->format_capacity = 0;
+
+	free(dev->frame_sizes);
+	dev->frame_sizes = NULL;
+	dev->frame_size_count = 0;
+	dev->frame_size_capacity = 0;
+
+	free(dev->modes);
+	dev->modes = NULL;
+	dev->mode_count = 0;
+	dev->mode_capacity = 0;
+
+	dev->is_probed = 0;
+}
+
+/* Identity of a device in the capability cache. */
+typedef struct capability_cache_key_t_ {
+	uint8_t  driver[16];
+	uint8_t  card[32];
+	uint8_t  bus_info[32];
+	uint32_t version;
+	uint32_t capabilities;
+	uint32_t buf_type;
+	uint32_t layout[3]; // sizes of the cached structures.
+} capability_cache_key_t;
+
+enum {
+	CACHE_SECTION_CROPCAP = 0,
+	CACHE_SECTION_FORMATS,
+	CACHE_SECTION_FRAME_SIZES,
+	CACHE_SECTION_MODES,
+	CACHE_SECTION_COUNT,
+};
+
+static void make_capability_cache_key(video_dev_t const *dev, capability_cache_key_t *key) {
+	memset(key, 0, sizeof(*key));
+	memcpy(key->driver,   dev->caps.driver,   sizeof(key->driver));
+	memcpy(key->card,     dev->caps.card,     sizeof(key->card));
+	memcpy(key->bus_info, dev->caps.bus_info, sizeof(key->bus_info));
+	key->version      = dev->caps.version;
+	key->capabilities = dev->caps.capabilities;
+	key->buf_type     = dev->buf_type;
+	key->layout[0]    = sizeof(struct v4l2_cropcap);
+	key->layout[1]    = sizeof(struct v4l2_frmsizeenum);
+	key->layout[2]    = sizeof(uvcc_stream_mode_t);
+}
+
+/*
+ * Restore cropcaps, formats, frame sizes and modes from the cache. The
+ * cached entry is checked against the driver by enumerating the first and
+ * one past the last pixel format.
+ */
+static int load_capability_cache(video_dev_t *dev) {
+	capability_cache_key_t key;
+	uvcc_cache_section_t sections[CACHE_SECTION_COUNT];
+	struct v4l2_fmtdesc desc;
+	int result;
+	int i;
+
+	if (NULL == cache_directory) {
+		return NO_MORE_DATA;
+	}
+
+	make_capability_cache_key(dev, &key);
+	result = uvcc_cache_load(cache_directory, &key, sizeof(key), sections, CACHE_SECTION_COUNT);
+	if (NOERROR != result) {
+		return result;
+	}
+
+	if ((sizeof(struct v4l2_cropcap) != sections[CACHE_SECTION_CROPCAP].size) ||
+	    (0 == sections[CACHE_SECTION_FORMATS].size) ||
+	    (0 != (sections[CACHE_SECTION_FORMATS].size % sizeof(uint32_t))) ||
+	    (0 != (sections[CACHE_SECTION_FRAME_SIZES].size % sizeof(struct v4l2_frmsizeenum))) ||
+	    (0 != (sections[CACHE_SECTION_MODES].size % sizeof(uvcc_stream_mode_t)))) {
+		result = IO_ERROR;
+	}
+
+	if (NOERROR == result) {
+		memset(&desc, 0, sizeof(desc));
+		desc.index = 0;
+		desc.type  = dev->buf_type;
+		if ((0 > ioctl(dev->fd, VIDIOC_ENUM_FMT, &desc)) || (desc.pixelformat != *(uint32_t const*)sections[CACHE_SECTION_FORMATS].data)) {
+			result = IO_ERROR;
+		}
+	}
+	if (NOERROR == result) {
+		memset(&desc, 0, sizeof(desc));
+		desc.index = sections[CACHE_SECTION_FORMATS].size / sizeof(uint32_t);
+		desc.type  = dev->buf_type;
+		if (0 == ioctl(dev->fd, VIDIOC_ENUM_FMT, &desc)) {
+			result = IO_ERROR;
+		}
+	}
+
+	if (NOERROR != result) {
+		LOGW("Capability cache is stale.");
+		for (i = 0; i < CACHE_SECTION_COUNT; ++i) {
+			free(sections[i].data);
+		}
+		return result;
+	}
+
+	release_capabilities(dev);
+
+	memcpy(&dev->cropcaps, sections[CACHE_SECTION_CROPCAP].data, sizeof(dev->cropcaps));
+	free(sections[CACHE_SECTION_CROPCAP].data);
+
+	dev->formats             = (uint32_t*)sections[CACHE_SECTION_FORMATS].data;
+	dev->format_count        = sections[CACHE_SECTION_FORMATS].size / sizeof(uint32_t);
+	dev->format_capacity     = dev->format_count;
+	dev->frame_sizes         = (struct v4l2_frmsizeenum*)sections[CACHE_SECTION_FRAME_SIZES].data;
+	dev->frame_size_count    = sections[CACHE_SECTION_FRAME_SIZES].size / sizeof(struct v4l2_frmsizeenum);
+	dev->frame_size_capacity = dev->frame_size_count;
+	dev->modes               = (uvcc_stream_mode_t*)sections[CACHE_SECTION_MODES].data;
+	dev->mode_count          = sections[CACHE_SECTION_MODES].size / sizeof(uvcc_stream_mode_t);
+	dev->mode_capacity       = dev->mode_count;
+	dev->is_probed           = 1;
+
+	return NOERROR;
+}
+
+static int store_capability_cache(video_dev_t const *dev) {
+	capability_cache_key_t key;
+	uvcc_cache_section_t sections[CACHE_SECTION_COUNT];
+	int result;
+
+	if ((NULL == cache_directory) || !dev->is_probed) {
+		return INVALID_STATUS;
+	}
+
+	sections[CACHE_SECTION_CROPCAP].data     = (void*)&dev->cropcaps;
+	sections[CACHE_SECTION_CROPCAP].size     = sizeof(dev->cropcaps);
+	sections[CACHE_SECTION_FORMATS].data     = dev->formats;
+	sections[CACHE_SECTION_FORMATS].size     = sizeof(uint32_t) * dev->format_count;
+	sections[CACHE_SECTION_FRAME_SIZES].data = dev->frame_sizes;
+	sections[CACHE_SECTION_FRAME_SIZES].size = sizeof(struct v4l2_frmsizeenum) * dev->frame_size_count;
+	sections[CACHE_SECTION_MODES].data       = dev->modes;
+	sections[CACHE_SECTION_MODES].size       = sizeof(uvcc_stream_mode_t) * dev->mode_count;
+
+	make_capability_cache_key(dev, &key);
+	result = uvcc_cache_store(cache_directory, &key, sizeof(key), sections, CACHE_SECTION_COUNT);
+	if (NOERROR != result) {
+		LOGW("Failed to write the capability cache.");
+	}
+
+	return result;
+}
+
+static int compare_mode_score(uint32_t const *lhs, uint32_t const *rhs, int count) {
+	int i;
+	for (i = 0; i < count; ++i) {
+		if (lhs[i] != rhs[i]) {
+			return (lhs[i] < rhs[i]) ? -1 : 1;
+		}
+	}
+	return 0;
+}
+
+static int select_best_mode(video_dev_t const *dev, uint32_t width, uint32_t height, uint32_t fps, uvcc_pixel_format_t output_format, uvcc_stream_mode_t *best) {
+	uint32_t best_score[4];
+	uint32_t score[4];
+	uint64_t rate;
+	uint64_t area;
+	uint64_t const target_area = (uint64_t)width * height;
+	int i;
+	int found = 0;
+
+	for (i = 0; i < dev->mode_count; ++i) {
+		uvcc_stream_mode_t mode = dev->modes[i];
+		uint32_t const num = mode.interval_numerator;
+		uint32_t const den = mode.interval_denominator;
+
+		mode.transfer_cost   = estimate_transfer_cost(mode.pixel_format, mode.width, mode.height);
+		mode.conversion_cost = estimate_conversion_cost(mode.pixel_format, output_format, mode.width, mode.height);
+
+		area = (uint64_t)mode.width * mode.height;
+
+		// 1st: frame rate shortfall (unknown rate is assumed to be sufficient).
+		score[0] = ((0 == num) || ((uint64_t)den >= (uint64_t)fps * num)) ? 0 : fps - (den / num);
+		// 2nd: exact size, larger size (scale down) and smaller size (scale up).
+		if ((mode.width == width) && (mode.height == height)) {
+			score[1] = 0;
+		} else if ((mode.width >= width) && (mode.height >= height)) {
+			score[1] = 1;
+		} else {
+			score[1] = 2;
+		}
+		// 3rd: distance to the requested area.
+		score[2] = (uint32_t)((area > target_area) ? area - target_area : target_area - area);
+		// 4th: bandwidth at the delivered frame rate plus conversion at the requested one.
+		rate = (0 == num) ? fps : ((uint64_t)den + num - 1) / num;
+		rate = (uint64_t)mode.transfer_cost * rate + (uint64_t)mode.conversion_cost * fps;
+		score[3] = (rate > UINT32_MAX) ? UINT32_MAX : (uint32_t)rate;
+
+		if (!found || (0 > compare_mode_score(score, best_score, 4))) {
+			memcpy(best_score, score, sizeof(score));
+			*best = mode;
+			found = 1;
+		}
+	}
+
+	return found ? NOERROR : STREAM_MODE_NOT_FOUND;
+}
+
+static int set_frame_interval(video_dev_t *dev, uint32_t numerator, uint32_t denominator) {
+	struct v4l2_streamparm parm;
+
+	memset(&parm, 0, sizeof(parm));
+	parm.type = dev->buf_type;
+	parm.parm.capture.timeperframe.numerator   = numerator;
+	parm.parm.capture.timeperframe.denominator = denominator;
+	if (0 > ioctl(dev->fd, VIDIOC_S_PARM, &parm)) {
+		LOGW("Failed to set frame interval (%s).", strerror(errno));
+		return IO_ERROR;
+	}
+	dev->interval = parm.parm.capture.timeperframe;
+
+	return NOERROR;
+}
+
+#define CALIBRATION_SOURCES 4
+
+/*
+ * Pick the copy variant on the first buffers mapped by the process, their
+ * memory type is what decides which one is fastest.
+ */
+static void calibrate_copy(video_buf_t const *bufs, int count) {
+	uint32_t rates[UVCC_COPY_VARIANT_COUNT];
+	void const *srcs[CALIBRATION_SOURCES];
+	size_t size;
+	uint32_t i, n;
+
+	n = 0;
+	size = 0;
+	for (i = 0; (i < (uint32_t)count) && (n < CALIBRATION_SOURCES); ++i) {
+		if (MAP_FAILED == bufs[i].planes[0].addr) {
+			continue;
+		}
+		if ((0 == size) || (bufs[i].planes[0].size < size)) {
+			size = bufs[i].planes[0].size;
+		}
+		srcs[n++] = bufs[i].planes[0].addr;
+	}
+	if (!uvcc_copy_calibrate(srcs, n, size) || !UVCC_LOG_ENABLED(ANDROID_LOG_INFO)) {
+		return;
+	}
+	uvcc_copy_get_rates(rates);
+	for (i = 0; i < UVCC_COPY_VARIANT_COUNT; ++i) {
+		if (0 != rates[i]) {
+			LOGI("Frame copy '%s': %u MB/s.", uvcc_copy_variant_name((uvcc_copy_variant_t)i), rates[i]);
+		}
+	}
+	LOGI("Frame copy uses '%s'.", uvcc_copy_variant_name(uvcc_copy_get_variant()));
+}
+
+// munmap unlocks the pages by itself, only a policy change needs the other way.
+static int lock_mapped_buffers(video_dev_t const *dev) {
+	uint32_t j;
+	int i;
+
+	for (i = 0; i < dev->buffer_count; ++i) {
+		for (j = 0; j < dev->buffers[i].plane_count; ++j) {
+			if (!uvcc_thread_lock_memory(dev->buffers[i].planes[j].addr, dev->buffers[i].planes[j].size)) {
+				return 0;
+			}
+		}
+	}
+	return 1;
+}
+
+static void unlock_mapped_buffers(video_dev_t const *dev) {
+	uint32_t j;
+	int i;
+
+	for (i = 0; i < dev->buffer_count; ++i) {
+		for (j = 0; j < dev->buffers[i].plane_count; ++j) {
+			uvcc_thread_unlock_memory(dev->buffers[i].planes[j].addr, dev->buffers[i].planes[j].size);
+		}
+	}
+}
+
+static void unmap_buffers(video_buf_t *buffers, uint32_t count) {
+	uint32_t i, j;
+
+	for (i = 0; i < count; ++i) {
+		for (j = 0; j < buffers[i].plane_count; ++j) {
+			if (MAP_FAILED != buffers[i].planes[j].addr) {
+				munmap(buffers[i].planes[j].addr, buffers[i].planes[j].size);
+			}
+			buffers[i].planes[j].addr = MAP_FAILED;
+			buffers[i].planes[j].size = 0;
+		}
+		buffers[i].plane_count = 0;
+	}
+}
+
+static int map_buffer(video_dev_t const *dev, struct v4l2_buffer const *v4l2_buf, video_buf_t *buf) {
+#ifdef V4L2_CAP_VIDEO_CAPTURE_MPLANE
+	uint32_t i;
+
+	if (IS_MPLANE(dev)) {
+		if (v4l2_buf->length > UVCC_MAX_PLANES) {
+			LOGE("Too many planes (%u).", v4l2_buf->length);
+			return IO_METHOD_NOT_SUPPORTED;
+		}
+		for (i = 0; i < v4l2_buf->length; ++i) {
+			buf->planes[i].size = v4l2_buf->m.planes[i].length;
+			buf->planes[i].addr = mmap(NULL, buf->planes[i].size, PROT_READ, MAP_SHARED, dev->fd, v4l2_buf->m.planes[i].m.mem_offset);
+			buf->plane_count = i + 1;
+			if (MAP_FAILED == buf->planes[i].addr) {
+				LOGE("Failed to map the video memory (%s).", strerror(errno));
+				return MEMORY_MAPPING_FAILED;
+			}
+		}
+		return NOERROR;
+	}
+#endif
+
+	buf->planes[0].size = v4l2_buf->length;
+	buf->planes[0].addr = mmap(NULL, v4l2_buf->length, PROT_READ, MAP_SHARED, dev->fd, v4l2_buf->m.offset);
+	buf->plane_count = 1;
+	if (MAP_FAILED == buf->planes[0].addr) {
+		LOGE("Failed to map the video memory (%s).", strerror(errno));
+		return MEMORY_MAPPING_FAILED;
+	}
+
+	return NOERROR;
+}
+
+/*
+ * Describe the frames of the current format in the mapped buffers, they may
+ * be larger than needed when kept across a format change.
+ */
+static void update_frame_size(video_dev_t *dev) {
+	video_buf_t const *buf = &dev->buffers[0];
+	uint32_t size;
+	uint32_t i;
+
+	dev->frame_size = 0;
+	for (i = 0; i < buf->plane_count; ++i) {
+		size = buf->planes[i].size;
+#ifdef V4L2_CAP_VIDEO_CAPTURE_MPLANE
+		if (IS_MPLANE(dev)) {
+			if ((0 != dev->format.fmt.pix_mp.plane_fmt[i].sizeimage) && (dev->format.fmt.pix_mp.plane_fmt[i].sizeimage < size)) {
+				size = dev->format.fmt.pix_mp.plane_fmt[i].sizeimage;
+			}
+		} else
+#endif
+		if ((0 != dev->format.fmt.pix.sizeimage) && (dev->format.fmt.pix.sizeimage < size)) {
+			size = dev->format.fmt.pix.sizeimage;
+		}
+		dev->frame_size += size;
+	}
+}
+
+static int init_buffer(video_dev_t *dev) {
+	struct v4l2_requestbuffers req;
+	struct v4l2_buffer buf;
+	v4l2_plane_t planes[UVCC_MAX_PLANES];
+	uint32_t i, count;
+	video_buf_t *buf_ptr;
+	int result = NOERROR;
+
+	dev->buffers = NULL;
+	dev->buffer_count = 0;
+
+	memset(&req, 0, sizeof(req));
+	req.count = 4;
+	req.type = dev->buf_type;
+	req.memory = V4L2_MEMORY_MMAP;
+
+	if (0 > ioctl(dev->fd, VIDIOC_REQBUFS, &req)) {
+		if (EBUSY == errno) {
+			LOGE("Buffer is already in progress.");
+			return VIDEO_DEVICE_BUSY;
+		}
+		if (EINVAL == errno) {
+			LOGE("Memory mapping is not supported.");
+			return IO_METHOD_NOT_SUPPORTED;
+		}
+		if (is_disconnect_error(errno)) {
+			LOGE("Video device is gone (%s).", strerror(errno));
+			return VIDEO_DEVICE_DISCONNECTED;
+		}
+	}
+
+	count = req.count;
+
+	if (count < 2) {
+		LOGE("Insufficient memory in video device driver.");
+		return INSUFFICIENT_MEMORY;
+	}
+
+	buf_ptr = calloc(count, sizeof(video_buf_t));
+	if (NULL == buf_ptr) {
+		LOGE("Insufficient memory in application.");
+		return INSUFFICIENT_MEMORY;
+	}
+
+	for (i = 0; i < count; ++i) {
+		prepare_buffer(dev, &buf, planes, i);
+
+		if (0 > ioctl(dev->fd, VIDIOC_QUERYBUF, &buf)) {
+			if (EINVAL == errno) {
+				break;
+			} else {
+				LOGE("Failed to query buffer (%s).", strerror(errno));
+				result = VIDEO_DEVICE_QUERY_BUFFER_FAILED;
+				break;
+			}
+		}
+
+		result = map_buffer(dev, &buf, &buf_ptr[i]);
+		if (NOERROR != result) {
+			break;
+		}
+	}
+
+	if (NOERROR != result) {
+		unmap_buffers(buf_ptr, count);
+		free(buf_ptr);
+	} else {
+		dev->buffers      = buf_ptr;
+		dev->buffer_count = i;
+		update_frame_size(dev);
+		calibrate_copy(buf_ptr, dev->buffer_count);
+		if (dev->lock_buffers && !lock_mapped_buffers(dev)) {
+			LOGW("Capture buffers can't be locked in memory (%s).", strerror(errno));
+		}
+	}
+
+	return result;
+}
+
+/* Undo a partial open, 'dev' is freed and 'result' passed through. */
+static int abort_open(video_dev_t *dev, int result) {
+	if (0 <= dev->fd) {
+		close(dev->fd);
+	}
+	release_capabilities(dev);
+	free(dev->path);
+	pthread_mutex_destroy(&dev->stats_lock);
+	free(dev);
+	return result;
+}
+
+int uvcc_open_video_device(uvcc_handle_t *handle, char const * const path) {
+	video_dev_t *dev = NULL;
+	uint32_t i;
+	struct v4l2_fmtdesc desc;
+
+	if (NULL == handle) {
+		LOGE("'handle' parameter can not set to NULL.");
+		return INVALID_ARGUMENTS;
+	}
+	if (NULL == path) {
+		LOGE("'path' parameter can not set to NULL.");
+		return INVALID_ARGUMENTS;
+	}
+
+	dev = (video_dev_t*)malloc(sizeof(video_dev_t));
+	if (NULL == dev) {
+		LOGE("Memory allocation failed.");
+		return INSUFFICIENT_MEMORY;
+	}
+
+	memset(dev, 0, sizeof(video_dev_t));
+	pthread_mutex_init(&dev->stats_lock, NULL);
+
+	// set initial values.
+	dev->fd = -1;
+	dev->buf_type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+	dev->buffers = NULL;
+	dev->buffer_count = 0;
+	dev->is_capture_started = 0;
+	dev->formats = NULL;
+	dev->format_count = 0;
+	dev->format_capacity = 0;
+	dev->frame_sizes = NULL;
+	dev->frame_size_count = 0;
+	dev->frame_size_capacity = 0;
+	dev->modes = NULL;
+	dev->mode_count = 0;
+	dev->mode_capacity = 0;
+	dev->is_probed = 0;
+	dev->trace = NULL;
+	dev->frame_size = 0;
+	dev->resume_begin_us = 0;
+	dev->lost_us = 0;
+	dev->path = strdup(path);
+	if (NULL == dev->path) {
+		LOGE("Memory allocation failed.");
+		return abort_open(dev, INSUFFICIENT_MEMORY);
+	}
 
 	dev->fd = open(path, O_RDONLY);
 	if (dev->fd < 0) {
 		LOGE("Can't open video devicie (%s).", path);
 		if (EBUSY == errno) {
 			LOGE("Vide device is busy.");
-			return VIDEO_DEVICE_BUSY;
+			return abort_open(dev, VIDEO_DEVICE_BUSY);
 		}
 		if (EPERM == errno) {
 			LOGE("Operation not permitted.");
-			return NOT_PERMITTED;
+			return abort_open(dev, NOT_PERMITTED);
 		}
 		LOGE("Unknown error (%s).", strerror(errno));
-		return VIDEO_DEVICE_OPEN_FAILED;
+		return abort_open(dev, VIDEO_DEVICE_OPEN_FAILED);
 	}
 
 	// get device capabilities
 	if (0 > ioctl(dev->fd, VIDIOC_QUERYCAP, &dev->caps)) {
 		LOGE("Video device capability can not get (%s).", strerror(errno));
-		close(dev->fd);
-		dev->fd = -1;
-		return VIDEO_DEVICE_NOCAPS;
+		return abort_open(dev, VIDEO_DEVICE_NOCAPS);
 	}
 
 	print_capability(&dev->caps);
 
-	if (0 == (dev->caps.capabilities & V4L2_CAP_VIDEO_CAPTURE)) {
+	if (0 != (dev->caps.capabilities & V4L2_CAP_VIDEO_CAPTURE)) {
+		dev->buf_type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+#ifdef V4L2_CAP_VIDEO_CAPTURE_MPLANE
+	} else if (0 != (dev->caps.capabilities & V4L2_CAP_VIDEO_CAPTURE_MPLANE)) {
+		dev->buf_type = V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE;
+#endif
+	} else {
 		LOGE("Capture is not supported.");
-		close(dev->fd);
-		dev->fd = -1;
-		return VIDEO_DEVICE_CAPTURE_NOT_SUPPORTED;
+		return abort_open(dev, VIDEO_DEVICE_CAPTURE_NOT_SUPPORTED);
+	}
+
+	if (NOERROR == load_capability_cache(dev)) {
+		LOGI("Capabilities are restored from the cache.");
+		*handle = dev;
+		return NOERROR;
 	}
 
 	// get cropping capabilities
 	memset(&dev->cropcaps, 0, sizeof(dev->cropcaps));
-	dev->cropcaps.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+	dev->cropcaps.type = dev->buf_type;
 	if (0 > ioctl(dev->fd, VIDIOC_CROPCAP, &dev->cropcaps)) {
 		LOGE("Video device crop capability can not get (%s).", strerror(errno));
-		return VIDEO_DEVICE_NOCROPCAPS;
+		return abort_open(dev, VIDEO_DEVICE_NOCROPCAPS);
 	}
 
 	// enumerate pixel formats
 	for (i = 0; ; ++i) {
 		memset(&desc, 0, sizeof(desc));
 		desc.index = i;
-		desc.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+		desc.type = dev->buf_type;
 		if (0 > ioctl(dev->fd, VIDIOC_ENUM_FMT, &desc)) {
 			if (EINVAL == errno) {
 				break;
 			} else {
 				LOGE("Failed to enumerate pixel formats (%s).", strerror(errno));
-				return VIDEO_DEVICE_ENUM_FORMAT_FAILED;
+				return abort_open(dev, VIDEO_DEVICE_ENUM_FORMAT_FAILED);
 			}
 		}
 		print_format_desc(&desc);
 	}
 
+	// probe everything once so that the next open can skip it.
+	if ((NULL != cache_directory) && (NOERROR == probe_capabilities(dev))) {
+		store_capability_cache(dev);
+	}
+
 	*handle = dev;
 
 	return NOERROR;
@@ -418,42 +1484,175 @@ int uvcc_open_video_device(uvcc_handle_t *handle, char const * const path) {
 
 void uvcc_close_video_device(uvcc_handle_t handle) {
 	video_dev_t *dev = (video_dev_t*)handle;
-	uint32_t i;
 
 	if (NULL == dev) {
 		return;
 	}
 
-	if (0 > dev->fd) {
+	// a device that did not come back after a reconnect has no node left.
+	if ((0 > dev->fd) && (0 == dev->lost_us)) {
 		return;
 	}
 
-	if (NULL != dev->buffers) {
-		for (i = 0; i < dev->buffer_count; ++i) {
-			if (MAP_FAILED == dev->buffers[i].addr) {
-				break;
-			}
-			munmap(dev->buffers[i].addr, dev->buffers[i].size);
+	if (0 <= dev->fd) {
+		if (dev->is_capture_started) {
+			uvcc_stop_capture(handle);
 		}
-		free(dev->buffers);
+		release_buffer(dev);
 	}
 
+	release_capabilities(dev);
+
+	uvcc_trace_destroy(dev->trace);
+	dev->trace = NULL;
+
+	free(dev->path);
+	dev->path = NULL;
+	dev->lost_us = 0;
+	pthread_mutex_destroy(&dev->stats_lock);
+
+	// retry only an interrupted close, other errors would spin forever on a dead device.
 	int ret = -1;
 	do {
-		ret = close(dev->fd);
-	} while (ret < 0);
+		ret = (0 <= dev->fd) ? close(dev->fd) : 0;
+	} while ((ret < 0) && (EINTR == errno));
 	dev->fd = -1;
 }
 
-int uvcc_init_video_device(uvcc_handle_t handle, uint32_t width, uint32_t height, uvcc_pixel_format_t pixel_format) {
+static int set_format(video_dev_t *dev, uint32_t width, uint32_t height, uvcc_pixel_format_t pixel_format) {
 	struct v4l2_format fmt;
-	video_dev_t *dev = (video_dev_t*)handle;
 
-	assert(NULL != dev);
+	if (0 == to_v4l2_pixel_format(pixel_format)) {
+		LOGE("Unknown pixel format (%d).", pixel_format);
+		return INVALID_FORMAT_ARGUMENTS;
+	}
 
-	// set cropping area
+	memset(&fmt, 0, sizeof(fmt));
+	fmt.type = dev->buf_type;
+#ifdef V4L2_CAP_VIDEO_CAPTURE_MPLANE
+	if (IS_MPLANE(dev)) {
+		fmt.fmt.pix_mp.width  = width;
+		fmt.fmt.pix_mp.height = height;
+		fmt.fmt.pix_mp.pixelformat = to_v4l2_pixel_format(pixel_format);
+		fmt.fmt.pix_mp.field = V4L2_FIELD_NONE;
+	} else
+#endif
+	{
+		fmt.fmt.pix.width  = width;
+		fmt.fmt.pix.height = height;
+		fmt.fmt.pix.pixelformat = to_v4l2_pixel_format(pixel_format);
+		fmt.fmt.pix.field = V4L2_FIELD_INTERLACED;
+	}
+	if (0 > ioctl(dev->fd, VIDIOC_S_FMT, &fmt)) {
+		if (EBUSY == errno) {
+			LOGW("Video format can not be changed at this time.");
+			return VIDEO_DEVICE_BUSY;
+		}
+		if (EINVAL == errno) {
+			LOGE("Invalid format argument are set.");
+			return INVALID_FORMAT_ARGUMENTS;
+		}
+	}
+	dev->format = fmt;
+
+	memset(&fmt, 0, sizeof(fmt));
+	fmt.type = dev->buf_type;
+	if (0 == ioctl(dev->fd, VIDIOC_G_FMT, &fmt)) {
+		dev->format = fmt;
+		if (!IS_MPLANE(dev)) {
+			print_pixel_format(&fmt.fmt.pix);
+		}
+	}
+
+	if (from_v4l2_pixel_format(get_format_pixelformat(dev)) != (uint32_t)pixel_format) {
+		LOGW("Pixel format is replaced by the driver.");
+	}
+
+	return NOERROR;
+}
+
+/* Unmap the buffers and hand them back to the driver. */
+static void release_buffer(video_dev_t *dev) {
+	struct v4l2_requestbuffers req;
+
+	if (NULL == dev->buffers) {
+		return;
+	}
+
+	unmap_buffers(dev->buffers, dev->buffer_count);
+	free(dev->buffers);
+	dev->buffers      = NULL;
+	dev->buffer_count = 0;
+	dev->frame_size   = 0;
+
+	memset(&req, 0, sizeof(req));
+	req.count  = 0;
+	req.type   = dev->buf_type;
+	req.memory = V4L2_MEMORY_MMAP;
+	if (0 > ioctl(dev->fd, VIDIOC_REQBUFS, &req)) {
+		LOGW("Failed to release buffers (%s).", strerror(errno));
+	}
+}
+
+/* Whether the mapped buffers are large enough for the current format. */
+static int is_buffer_reusable(video_dev_t const *dev) {
+	uint32_t i;
+
+	if ((NULL == dev->buffers) || (0 == dev->buffer_count)) {
+		return 0;
+	}
+#ifdef V4L2_CAP_VIDEO_CAPTURE_MPLANE
+	if (IS_MPLANE(dev)) {
+		if (dev->format.fmt.pix_mp.num_planes != dev->buffers[0].plane_count) {
+			return 0;
+		}
+		for (i = 0; i < dev->buffers[0].plane_count; ++i) {
+			if (dev->format.fmt.pix_mp.plane_fmt[i].sizeimage > dev->buffers[0].planes[i].size) {
+				return 0;
+			}
+		}
+		return 1;
+	}
+#endif
+	for (i = 0; i < dev->buffer_count; ++i) {
+		if (dev->format.fmt.pix.sizeimage > dev->buffers[i].planes[0].size) {
+			return 0;
+		}
+	}
+	return 0 != dev->format.fmt.pix.sizeimage;
+}
+
+static int64_t now_us(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+int uvcc_init_video_device(uvcc_handle_t handle, uint32_t width, uint32_t height, uvcc_pixel_format_t pixel_format) {
+	video_dev_t *dev = (video_dev_t*)handle;
+	int result;
+
+	assert(NULL != dev);
+
+	if (0 == to_v4l2_pixel_format(pixel_format)) {
+		LOGE("Unknown pixel format (%d).", pixel_format);
+		return INVALID_FORMAT_ARGUMENTS;
+	}
+
+	// re-initialization starts from scratch.
+	if (dev->is_capture_started) {
+		uvcc_stop_capture(handle);
+	}
+	release_buffer(dev);
+	memset(&dev->interval, 0, sizeof(dev->interval));
+	pthread_mutex_lock(&dev->stats_lock);
+	dev->idle_stats.is_suspended = 0;
+	dev->idle_stats.buffers_released = 0;
+	pthread_mutex_unlock(&dev->stats_lock);
+
+	// set cropping area
 	memset(&dev->crop, 0, sizeof(dev->crop));
-	dev->crop.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+	dev->crop.type = dev->buf_type;
 	dev->crop.c = dev->cropcaps.defrect;
 	if (0 > ioctl(dev->fd, VIDIOC_S_CROP, &dev->crop)) {
 		if (EINVAL == errno) {
@@ -464,171 +1663,733 @@ int uvcc_init_video_device(uvcc_handle_t handle, uint32_t width, uint32_t height
 		}
 	}
 
-	// set format
-	memset(&dev->format, 0, sizeof(dev->format));
-	dev->format.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-	dev->format.fmt.pix.width  = width;
-	dev->format.fmt.pix.height = height;
-	dev->format.fmt.pix.pixelformat = to_v4l2_pixel_format(pixel_format);
-	dev->format.fmt.pix.field = V4L2_FIELD_INTERLACED;
-	if (0 > ioctl(dev->fd, VIDIOC_S_FMT, &dev->format)) {
-		if (EBUSY == errno) {
-			LOGE("Video format can not be changed at this time.");
-			return VIDEO_DEVICE_BUSY;
-		}
-		if (EINVAL == errno) {
-			LOGE("Invalid format argument are set.");
-			return INVALID_FORMAT_ARGUMENTS;
-		}
+	// set format
+	result = set_format(dev, width, height, pixel_format);
+	if (NOERROR != result) {
+		return result;
+	}
+
+	return init_buffer(dev);
+}
+
+int uvcc_reconfigure(uvcc_handle_t handle, uint32_t width, uint32_t height, uvcc_pixel_format_t pixel_format, uvcc_reconfigure_stats_t *stats) {
+	video_dev_t *dev = (video_dev_t*)handle;
+	uvcc_reconfigure_stats_t local;
+	int const was_started = (NULL == dev) ? 0 : dev->is_capture_started;
+	int64_t const begin = now_us();
+	int64_t t0, t1;
+	int result;
+
+	if (NULL == dev) {
+		return INVALID_ARGUMENTS;
+	}
+	if (0 == to_v4l2_pixel_format(pixel_format)) {
+		LOGE("Unknown pixel format (%d).", pixel_format);
+		return INVALID_FORMAT_ARGUMENTS;
+	}
+	// a suspend may have released the buffers, they are mapped again for the new format.
+	if ((NULL == dev->buffers) && !dev->idle_stats.buffers_released) {
+		return INVALID_STATUS;
+	}
+
+	memset(&local, 0, sizeof(local));
+
+	if (was_started) {
+		uvcc_stop_capture(handle);
+	}
+	t0 = now_us();
+	local.stop_us = (uint32_t)(t0 - begin);
+
+	// try to keep the buffers, most drivers refuse S_FMT while they exist.
+	result = set_format(dev, width, height, pixel_format);
+	if (VIDEO_DEVICE_BUSY == result) {
+		release_buffer(dev);
+		result = set_format(dev, width, height, pixel_format);
+	}
+	if ((NOERROR == result) && !is_buffer_reusable(dev)) {
+		release_buffer(dev);
+	}
+	t1 = now_us();
+	local.format_us = (uint32_t)(t1 - t0);
+
+	if (NOERROR == result) {
+		if (NULL != dev->buffers) {
+			local.buffers_reused = 1;
+			update_frame_size(dev);
+		} else {
+			result = init_buffer(dev);
+			pthread_mutex_lock(&dev->stats_lock);
+			dev->idle_stats.buffers_released = 0;
+			pthread_mutex_unlock(&dev->stats_lock);
+		}
+	}
+	t0 = now_us();
+	local.buffer_us = (uint32_t)(t0 - t1);
+
+	// restart even on failure as long as buffers are left to stream into.
+	if (was_started && (NULL != dev->buffers)) {
+		int const started = uvcc_start_capture(handle);
+		if (NOERROR == result) {
+			result = started;
+		}
+	}
+	t1 = now_us();
+	local.start_us = (uint32_t)(t1 - t0);
+	local.total_us = (uint32_t)(t1 - begin);
+
+	LOGI("Reconfigured to %ux%u (format=%d) in %u us (stop=%u, format=%u, buffer=%u, start=%u, reused=%u).",
+		get_format_width(dev), get_format_height(dev), pixel_format, local.total_us,
+		local.stop_us, local.format_us, local.buffer_us, local.start_us, local.buffers_reused);
+
+	if (NULL != stats) {
+		*stats = local;
+	}
+
+	return result;
+}
+
+int uvcc_start_capture(uvcc_handle_t handle) {
+	video_dev_t *dev = (video_dev_t*)handle;
+	struct v4l2_buffer buf;
+	v4l2_plane_t planes[UVCC_MAX_PLANES];
+	uint32_t i;
+	uint32_t count;
+	int64_t const begin = now_us();
+	int retry;
+	int result = NOERROR;
+	enum v4l2_buf_type type;
+
+	assert(NULL != dev);
+
+	if (dev->is_capture_started) {
+		return NOERROR;
+	}
+	if (0 > dev->fd) {
+		return VIDEO_DEVICE_DISCONNECTED;
+	}
+
+	// warm resume: the format is still set, only the buffers are mapped again.
+	if (dev->idle_stats.buffers_released) {
+		result = init_buffer(dev);
+		if (NOERROR != result) {
+			return result;
+		}
+		pthread_mutex_lock(&dev->stats_lock);
+		dev->idle_stats.buffers_released = 0;
+		pthread_mutex_unlock(&dev->stats_lock);
+	}
+	count = dev->buffer_count;
+
+	for (i = 0; i < count; ++i) {
+		for (retry = 0; retry < 5; ++retry) {
+			prepare_buffer(dev, &buf, planes, i);
+
+			if (0 == ioctl(dev->fd, VIDIOC_QBUF, &buf)) {
+				break;
+			}
+
+			switch (errno) {
+			case EINVAL:
+				LOGE("Non-blocking I/O has been selected and no buffer (index=%d).", i);
+				result = MEMORY_QUEUEING_FAILED;
+				break;
+			case EIO:
+			case ENODEV:
+				LOGE("Video device is gone (%s).", strerror(errno));
+				result = VIDEO_DEVICE_DISCONNECTED;
+				break;
+			case ENOMEM:
+			case EAGAIN:
+				usleep(10000);
+				break;
+			default:
+				LOGE("Failed to queueing the buffer to start (%s, index=%d).", strerror(errno), i);
+				result = MEMORY_QUEUEING_FAILED;
+				break;
+			}
+
+			if (NOERROR != result) {
+				break;
+			}
+		}
+
+		if (retry >= 5) {
+			LOGE("Retry failed.");
+			result = MEMORY_QUEUEING_FAILED;
+		}
+
+		if (NOERROR != result) {
+			break;
+		}
+	}
+
+	if (NOERROR != result) {
+		return result;
+	}
+
+	type = dev->buf_type;
+
+	if (0 > ioctl(dev->fd, VIDIOC_STREAMON, &type)) {
+		LOGE("Failed to start streaming (%s).", strerror(errno));
+		result = is_disconnect_error(errno) ? VIDEO_DEVICE_DISCONNECTED : VIDEO_DEVICE_STREAMING_FAILED;
+	}
+
+	if (NOERROR == result) {
+		dev->is_capture_started = 1;
+		if (dev->idle_stats.is_suspended) {
+			pthread_mutex_lock(&dev->stats_lock);
+			dev->idle_stats.is_suspended = 0;
+			++dev->idle_stats.resume_count;
+			pthread_mutex_unlock(&dev->stats_lock);
+			dev->resume_begin_us = begin;
+		}
+	}
+
+	return result;
+}
+
+void uvcc_stop_capture(uvcc_handle_t handle) {
+	enum v4l2_buf_type type;
+	video_dev_t *dev = (video_dev_t*)handle;
+
+	assert(NULL != dev);
+
+	type = dev->buf_type;
+	if (0 > ioctl(dev->fd, VIDIOC_STREAMOFF, &type)) {
+		LOGW("Failed to stop streaming (%s).", strerror(errno));
+	}
+	// STREAMOFF dequeues every buffer.
+	dev->is_capture_started = 0;
+}
+
+int uvcc_suspend_capture(uvcc_handle_t handle, int release_buffers) {
+	video_dev_t *dev = (video_dev_t*)handle;
+
+	if (NULL == dev) {
+		return INVALID_ARGUMENTS;
+	}
+	if (!dev->is_capture_started) {
+		return INVALID_STATUS;
+	}
+
+	uvcc_stop_capture(handle);
+	if (release_buffers) {
+		uint32_t const frame_size = dev->frame_size;
+		release_buffer(dev);
+		// the same buffers are mapped again on resume.
+		dev->frame_size = frame_size;
+	}
+	pthread_mutex_lock(&dev->stats_lock);
+	if (release_buffers) {
+		dev->idle_stats.buffers_released = 1;
+	}
+	dev->idle_stats.is_suspended = 1;
+	++dev->idle_stats.suspend_count;
+	pthread_mutex_unlock(&dev->stats_lock);
+	dev->resume_begin_us = 0;
+
+	LOGI("Capture suspended (buffers %s).", release_buffers ? "released" : "kept");
+	return NOERROR;
+}
+
+int uvcc_get_idle_stats(uvcc_handle_t handle, uvcc_idle_stats_t *stats) {
+	video_dev_t *dev = (video_dev_t*)handle;
+
+	if ((NULL == dev) || (NULL == stats)) {
+		return INVALID_ARGUMENTS;
+	}
+	pthread_mutex_lock(&dev->stats_lock);
+	*stats = dev->idle_stats;
+	pthread_mutex_unlock(&dev->stats_lock);
+	return NOERROR;
+}
+
+// polls for the device while a reconnect waits for it.
+#define RECONNECT_RETRY_US 50000
+#define MAX_VIDEO_NODES    64
+
+/* Open 'path' if it is the device on 'bus_info'. */
+static int open_matching_node(char const *path, char const *bus_info, struct v4l2_capability *caps) {
+	int const fd = open(path, O_RDONLY);
+
+	if (0 > fd) {
+		return -1;
+	}
+	if ((0 == ioctl(fd, VIDIOC_QUERYCAP, caps)) &&
+		(0 == strncmp((char const*)caps->bus_info, bus_info, sizeof(caps->bus_info)))) {
+		return fd;
+	}
+	close(fd);
+	return -1;
+}
+
+/* Find the node of the device again, the last path first. */
+static int open_same_device(video_dev_t *dev, struct v4l2_capability *caps) {
+	char const *bus_info = (char const*)dev->caps.bus_info;
+	char node[32];
+	char *found;
+	int fd;
+	int i;
+
+	fd = open_matching_node(dev->path, bus_info, caps);
+	// without a bus there is nothing to tell the nodes apart.
+	if ((0 <= fd) || ('\0' == bus_info[0])) {
+		return fd;
+	}
+	for (i = 0; i < MAX_VIDEO_NODES; ++i) {
+		snprintf(node, sizeof(node), "/dev/video%d", i);
+		if (0 == strcmp(node, dev->path)) {
+			continue;
+		}
+		fd = open_matching_node(node, bus_info, caps);
+		if (0 <= fd) {
+			LOGI("Video device moved from %s to %s.", dev->path, node);
+			found = strdup(node);
+			if (NULL != found) {
+				free(dev->path);
+				dev->path = found;
+			}
+			return fd;
+		}
+	}
+	return -1;
+}
+
+static int reconnect_device(video_dev_t *dev, uint32_t timeout_ms) {
+	struct v4l2_capability caps;
+	uint32_t const width = get_format_width(dev);
+	uint32_t const height = get_format_height(dev);
+	uint32_t const pixel_format = from_v4l2_pixel_format(get_format_pixelformat(dev));
+	int64_t const deadline = now_us() + (int64_t)timeout_ms * 1000;
+	uint32_t downtime;
+	int result;
+	int fd;
+
+	// a reconnect that gave up leaves the state of the first failure to restore.
+	if (0 == dev->lost_us) {
+		dev->lost_us = now_us();
+		dev->lost_streaming = dev->is_capture_started;
+		dev->lost_buffer_count = (NULL != dev->buffers) ? dev->buffer_count : 0;
+	}
+
+	// buffers of the old node can only be unmapped, the driver has dropped them.
+	if (NULL != dev->buffers) {
+		unmap_buffers(dev->buffers, dev->buffer_count);
+		free(dev->buffers);
+		dev->buffers = NULL;
+		dev->buffer_count = 0;
+	}
+	dev->is_capture_started = 0;
+	if (0 <= dev->fd) {
+		close(dev->fd);
+		dev->fd = -1;
+	}
+
+	for (; ; ) {
+		fd = open_same_device(dev, &caps);
+		if ((0 <= fd) || (now_us() >= deadline)) {
+			break;
+		}
+		usleep(RECONNECT_RETRY_US);
+	}
+	if (0 > fd) {
+		LOGE("Video device on %s did not come back.", dev->caps.bus_info);
+		pthread_mutex_lock(&dev->stats_lock);
+		++dev->reconnect_stats.failed_count;
+		pthread_mutex_unlock(&dev->stats_lock);
+		return VIDEO_DEVICE_DISCONNECTED;
+	}
+	dev->fd = fd;
+	dev->caps = caps;
+
+	// the format is known already, nothing is probed again.
+	result = set_format(dev, width, height, pixel_format);
+	if ((NOERROR == result) && (0 != dev->interval.denominator)) {
+		set_frame_interval(dev, dev->interval.numerator, dev->interval.denominator);
+	}
+	if ((NOERROR == result) && (0 != dev->lost_buffer_count)) {
+		result = init_buffer(dev);
+		if ((NOERROR == result) && (dev->lost_buffer_count != dev->buffer_count)) {
+			LOGW("Driver gave %d buffers instead of %d.", dev->buffer_count, dev->lost_buffer_count);
+		}
+	}
+	if ((NOERROR == result) && dev->lost_streaming) {
+		result = uvcc_start_capture(dev);
+	}
+	if (NOERROR != result) {
+		pthread_mutex_lock(&dev->stats_lock);
+		++dev->reconnect_stats.failed_count;
+		pthread_mutex_unlock(&dev->stats_lock);
+		return result;
+	}
+
+	downtime = (uint32_t)(now_us() - dev->lost_us);
+	dev->lost_us = 0;
+	pthread_mutex_lock(&dev->stats_lock);
+	++dev->reconnect_stats.reconnect_count;
+	dev->reconnect_stats.last_downtime_us = downtime;
+	dev->reconnect_stats.total_downtime_us += downtime;
+	if (downtime > dev->reconnect_stats.max_downtime_us) {
+		dev->reconnect_stats.max_downtime_us = downtime;
+	}
+	pthread_mutex_unlock(&dev->stats_lock);
+	LOGI("Reconnected to %s after %u us.", dev->path, downtime);
+	return NOERROR;
+}
+
+/* Whether a capture that failed with 'result' reconnects and retries. */
+static int should_reconnect(video_dev_t *dev, int result) {
+	if ((VIDEO_DEVICE_DISCONNECTED != result) || (0 == dev->reconnect_timeout_ms)) {
+		return 0;
+	}
+	return NOERROR == reconnect_device(dev, dev->reconnect_timeout_ms);
+}
+
+int uvcc_reconnect(uvcc_handle_t handle, uint32_t timeout_ms) {
+	video_dev_t *dev = (video_dev_t*)handle;
+
+	if ((NULL == dev) || (NULL == dev->path)) {
+		return INVALID_ARGUMENTS;
+	}
+	return reconnect_device(dev, timeout_ms);
+}
+
+int uvcc_set_auto_reconnect(uvcc_handle_t handle, uint32_t timeout_ms) {
+	video_dev_t *dev = (video_dev_t*)handle;
+
+	if (NULL == dev) {
+		return INVALID_ARGUMENTS;
+	}
+	dev->reconnect_timeout_ms = timeout_ms;
+	return NOERROR;
+}
+
+int uvcc_set_buffer_locking(uvcc_handle_t handle, int enable, int *locked) {
+	video_dev_t *dev = (video_dev_t*)handle;
+
+	if ((NULL == dev) || (NULL == locked)) {
+		return INVALID_ARGUMENTS;
+	}
+	dev->lock_buffers = enable;
+	*locked = 0;
+	if (!enable) {
+		unlock_mapped_buffers(dev);
+		return NOERROR;
+	}
+	if (NULL == dev->buffers) {
+		// locked when they are mapped.
+		*locked = 1;
+		return NOERROR;
+	}
+	*locked = lock_mapped_buffers(dev);
+	if (!*locked) {
+		LOGW("Capture buffers can't be locked in memory (%s).", strerror(errno));
+		unlock_mapped_buffers(dev);
+	}
+	return NOERROR;
+}
+
+int uvcc_get_reconnect_stats(uvcc_handle_t handle, uvcc_reconnect_stats_t *stats) {
+	video_dev_t *dev = (video_dev_t*)handle;
+
+	if ((NULL == dev) || (NULL == stats)) {
+		return INVALID_ARGUMENTS;
+	}
+	pthread_mutex_lock(&dev->stats_lock);
+	*stats = dev->reconnect_stats;
+	pthread_mutex_unlock(&dev->stats_lock);
+	return NOERROR;
+}
+
+int uvcc_capture(uvcc_handle_t handle, uint8_t * const buf, size_t buf_size) {
+	return uvcc_capture_frame(handle, buf, buf_size, NULL);
+}
+
+static int wait_for_frame(video_dev_t const *dev, int timeout_ms) {
+	fd_set rfds;
+	struct timeval tv;
+	int64_t const deadline = (0 > timeout_ms) ? -1 : now_us() + (int64_t)timeout_ms * 1000;
+	int64_t remain;
+	int n;
+
+	if (0 > dev->fd) {
+		return VIDEO_DEVICE_DISCONNECTED;
+	}
+
+	TRACE(dev, UVCC_TRACE_WAIT_BEGIN, 0);
+
+	for (; ; ) {
+		FD_ZERO(&rfds);
+		FD_SET(dev->fd, &rfds);
+
+		tv.tv_sec = 0;
+		tv.tv_usec = 40000;
+		if (0 <= deadline) {
+			remain = deadline - now_us();
+			if (0 > remain) {
+				remain = 0;
+			}
+			if (remain < tv.tv_usec) {
+				tv.tv_usec = remain;
+			}
+		}
+
+		n = select(dev->fd + 1, &rfds, NULL, NULL, &tv);
+
+		if (n < 0) {
+			if ((ETIMEDOUT == errno) || (EINTR == errno)) {
+				continue;
+			}
+			LOGE("Failed to wait for capturable frame (%s).", strerror(errno));
+			return IO_ERROR;
+		}
+
+		if (FD_ISSET(dev->fd, &rfds)) {
+			return NOERROR;
+		}
+
+		if ((0 <= deadline) && (now_us() >= deadline)) {
+			return NO_MORE_DATA;
+		}
+	}
+}
+
+int uvcc_wait_frames(uvcc_handle_t const *handles, uint32_t count, int timeout_ms, uint32_t *ready) {
+	video_dev_t const *dev;
+	fd_set rfds;
+	struct timeval tv;
+	int max_fd = -1;
+	uint32_t i;
+	int n;
+
+	if ((NULL == handles) || (0 == count) || (32 < count) || (NULL == ready)) {
+		return INVALID_ARGUMENTS;
+	}
+
+	FD_ZERO(&rfds);
+	for (i = 0; i < count; ++i) {
+		dev = (video_dev_t const*)handles[i];
+		if (NULL == dev) {
+			return INVALID_ARGUMENTS;
+		}
+		if (0 > dev->fd) {
+			return VIDEO_DEVICE_DISCONNECTED;
+		}
+		FD_SET(dev->fd, &rfds);
+		if (dev->fd > max_fd) {
+			max_fd = dev->fd;
+		}
+		TRACE(dev, UVCC_TRACE_WAIT_BEGIN, 0);
+	}
+
+	tv.tv_sec = timeout_ms / 1000;
+	tv.tv_usec = (timeout_ms % 1000) * 1000;
+	n = select(max_fd + 1, &rfds, NULL, NULL, (0 > timeout_ms) ? NULL : &tv);
+	if (n < 0) {
+		if (EINTR == errno) {
+			return NO_MORE_DATA;
+		}
+		LOGE("Failed to wait for capturable frames (%s).", strerror(errno));
+		return IO_ERROR;
+	}
+	if (0 == n) {
+		return NO_MORE_DATA;
+	}
+
+	*ready = 0;
+	for (i = 0; i < count; ++i) {
+		if (FD_ISSET(((video_dev_t const*)handles[i])->fd, &rfds)) {
+			*ready |= 1u << i;
+		}
+	}
+	return NOERROR;
+}
+
+int uvcc_capture_frame(uvcc_handle_t handle, uint8_t * const buf, size_t buf_size, uvcc_frame_info_t *info) {
+	return uvcc_capture_frame_stats(handle, buf, buf_size, info, NULL);
+}
+
+static int capture_frame(video_dev_t *dev, uint8_t * const buf, size_t buf_size, uvcc_frame_info_t *info, uvcc_frame_stats_t *stats) {
+	int result = IO_ERROR;
+
+	if (!dev->is_capture_started) {
+		result = uvcc_start_capture(dev);
+		if (NOERROR != result) {
+			return result;
+		}
+	}
+
+	// capture!
+	result = wait_for_frame(dev, -1);
+	if (NOERROR == result) {
+		result = read_frame(buf, buf_size, dev, info, stats);
 	}
 
-	memset(&fmt, 0, sizeof(fmt));
-	fmt.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-	if (0 == ioctl(dev->fd, VIDIOC_G_FMT, &fmt)) {
-		print_pixel_format(&fmt.fmt.pix);
-		dev->format = fmt;
+	if (!dev->is_capture_started) {
+		uvcc_stop_capture(dev);
 	}
 
-	return init_buffer(dev);
+	return result;
 }
 
-int uvcc_start_capture(uvcc_handle_t handle) {
+int uvcc_capture_frame_stats(uvcc_handle_t handle, uint8_t * const buf, size_t buf_size, uvcc_frame_info_t *info, uvcc_frame_stats_t *stats) {
 	video_dev_t *dev = (video_dev_t*)handle;
-	struct v4l2_buffer buf;
-	uint32_t i;
-	uint32_t const count = (NULL == dev) ? 0 : dev->buffer_count;
-	int retry;
-	int result = NOERROR;
-	enum v4l2_buf_type type;
+	int result;
 
 	assert(NULL != dev);
 
-	if (dev->is_capture_started) {
-		return NOERROR;
+	result = capture_frame(dev, buf, buf_size, info, stats);
+	if (should_reconnect(dev, result)) {
+		result = capture_frame(dev, buf, buf_size, info, stats);
 	}
+	return result;
+}
 
-	for (i = 0; i < count; ++i) {
-		for (retry = 0; retry < 5; ++retry) {
-			memset(&buf, 0, sizeof(buf));
-			buf.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-			buf.memory = V4L2_MEMORY_MMAP;
-			buf.index  = i;
-
-			if (0 == ioctl(dev->fd, VIDIOC_QBUF, &buf)) {
-				break;
-			}
-
-			switch (errno) {
-			case EINVAL:
-				LOGE("Non-blocking I/O has been selected and no buffer (index=%d).", i);
-				result = MEMORY_QUEUEING_FAILED;
-				break;
-			case EIO:
-				LOGE("Internal I/O error in video device.");
-				result = IO_ERROR;
-				break;
-			case ENOMEM:
-			case EAGAIN:
-				usleep(10000);
-				break;
-			default:
-				LOGE("Failed to queueing the buffer to start (%s, index=%d).", strerror(errno), i);
-				result = MEMORY_QUEUEING_FAILED;
-				break;
-			}
-
-			if (NOERROR != result) {
-				break;
-			}
-		}
-
-		if (retry >= 5) {
-			LOGE("Retry failed.");
-			result = MEMORY_QUEUEING_FAILED;
-		}
+int uvcc_capture_frame_planes(uvcc_handle_t handle, uint8_t * const planes[UVCC_MAX_PLANES],
+	uint32_t const strides[UVCC_MAX_PLANES], uint32_t const sizes[UVCC_MAX_PLANES], uvcc_frame_info_t *info) {
+	video_dev_t *dev = (video_dev_t*)handle;
+	uvcc_frame_t frame;
+	uint32_t copied = 0;
+	int result;
 
-		if (NOERROR != result) {
-			break;
-		}
+	if ((NULL == dev) || (NULL == planes) || (NULL == strides) || (NULL == sizes)) {
+		return INVALID_ARGUMENTS;
 	}
 
+	result = uvcc_dequeue_frame(handle, &frame);
+	if (should_reconnect(dev, result)) {
+		result = uvcc_dequeue_frame(handle, &frame);
+	}
 	if (NOERROR != result) {
 		return result;
 	}
 
-	type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+	result = copy_planes(&frame, dev, planes, strides, sizes, &copied);
+	TRACE(dev, UVCC_TRACE_COPY_DONE, copied);
 
-	if (0 > ioctl(dev->fd, VIDIOC_STREAMON, &type)) {
-		LOGE("Failed to start streaming (%s).", strerror(errno));
-		result = VIDEO_DEVICE_STREAMING_FAILED;
+	if (NULL != info) {
+		*info = frame.info;
+		info->bytesused = copied;
 	}
 
 	if (NOERROR == result) {
-		dev->is_capture_started = 1;
+		result = queue_buffer(dev, frame.index);
+	} else {
+		queue_buffer(dev, frame.index);
 	}
-
 	return result;
 }
 
-void uvcc_stop_capture(uvcc_handle_t handle) {
-	enum v4l2_buf_type type;
+int uvcc_capture_frame_packed(uvcc_handle_t handle, uint8_t *buf, size_t buf_size,
+	uint32_t const strides[UVCC_MAX_PLANES], uvcc_frame_info_t *info) {
 	video_dev_t const *dev = (video_dev_t const*)handle;
+	uint8_t *planes[UVCC_MAX_PLANES] = { NULL, NULL, NULL };
+	uint32_t sizes[UVCC_MAX_PLANES] = { 0, 0, 0 };
+	uvcc_pixel_format_t format;
+	uint64_t offset = 0;
+	uint32_t rows;
+	uint32_t i;
 
-	assert(NULL != dev);
+	if ((NULL == dev) || (NULL == buf) || (NULL == strides)) {
+		return INVALID_ARGUMENTS;
+	}
 
-	type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-	if (0 > ioctl(dev->fd, VIDIOC_STREAMOFF, &type)) {
-		LOGW("Failed to stop streaming (%s).", strerror(errno));
+	// planes without rows (MJPEG) take the whole buffer.
+	format = from_v4l2_pixel_format(get_format_pixelformat(dev));
+	for (i = 0; (i < UVCC_MAX_PLANES) && (offset < buf_size); ++i) {
+		planes[i] = buf + offset;
+		sizes[i]  = (buf_size - offset < UINT32_MAX) ? (uint32_t)(buf_size - offset) : UINT32_MAX;
+		if (0 == get_plane_geometry(format, get_format_width(dev), get_format_height(dev), i, &rows)) {
+			break;
+		}
+		offset += (uint64_t)strides[i] * rows;
 	}
+
+	return uvcc_capture_frame_planes(handle, planes, strides, sizes, info);
 }
 
-int uvcc_capture(uvcc_handle_t handle, uint8_t * const buf, size_t buf_size) {
-	video_dev_t const *dev = (video_dev_t const*)handle;
+int uvcc_capture_burst(uvcc_handle_t handle, uint8_t *buf, size_t buf_size, uint32_t count, uvcc_burst_frame_t *frames) {
+	video_dev_t *dev = (video_dev_t*)handle;
+	uint32_t const slot = uvcc_get_burst_slot_size(handle);
+	uint32_t delta;
+	uint32_t i;
+	int reconnected = 0;
 	int result;
-	fd_set rfds;
-	struct timeval tv;
-	int n;
 
-	assert(NULL != dev);
+	if ((NULL == dev) || (NULL == buf) || (NULL == frames) || (0 == slot) || (0 == count) ||
+		(buf_size / slot < count)) {
+		return INVALID_ARGUMENTS;
+	}
 
 	if (!dev->is_capture_started) {
 		result = uvcc_start_capture(handle);
+		if (should_reconnect(dev, result)) {
+			result = uvcc_start_capture(handle);
+		}
 		if (NOERROR != result) {
 			return result;
 		}
 	}
 
-	// capture!
-	for (; ; ) {
-		FD_ZERO(&rfds);
-		FD_SET(dev->fd, &rfds);
+	// DQBUF blocks on the device until the next frame is done.
+	for (i = 0; i < count; ++i) {
+		TRACE(dev, UVCC_TRACE_WAIT_BEGIN, 0);
+		result = read_frame(buf + (size_t)slot * i, slot, dev, &frames[i].info, NULL);
+		if (should_reconnect(dev, result)) {
+			reconnected = 1;
+			result = read_frame(buf + (size_t)slot * i, slot, dev, &frames[i].info, NULL);
+		}
+		if (NOERROR != result) {
+			return result;
+		}
+		frames[i].gap = 0;
+		// sequence numbers start over on a reconnected device.
+		if ((0 < i) && !reconnected) {
+			// drivers that do not count frames leave the sequence at 0.
+			delta = frames[i].info.sequence - frames[i - 1].info.sequence;
+			frames[i].gap = ((0 == delta) || (0x80000000u <= delta)) ? 0 : delta - 1;
+		}
+		reconnected = 0;
+	}
 
-		tv.tv_sec = 0;
-		tv.tv_usec = 40000;
+	return NOERROR;
+}
 
-		n = select(dev->fd + 1, &rfds, NULL, NULL, &tv);
+int uvcc_dequeue_frame(uvcc_handle_t handle, uvcc_frame_t *frame) {
+	return uvcc_poll_frame(handle, frame, -1);
+}
 
-		if (n < 0) {
-			if (ETIMEDOUT == errno) {
-				continue;
-			}
-			LOGE("Failed to wait for capturable frame (%s).", strerror(errno));
-			break;
-		}
+int uvcc_poll_frame(uvcc_handle_t handle, uvcc_frame_t *frame, int timeout_ms) {
+	video_dev_t *dev = (video_dev_t*)handle;
+	int result;
 
-		if (!FD_ISSET(dev->fd, &rfds)) {
-			continue;
+	if ((NULL == dev) || (NULL == frame)) {
+		return INVALID_ARGUMENTS;
+	}
+
+	if (!dev->is_capture_started) {
+		result = uvcc_start_capture(handle);
+		if (NOERROR != result) {
+			return result;
 		}
+	}
 
-		result = read_frame(buf, buf_size, dev);
-		break;
+	result = wait_for_frame(dev, timeout_ms);
+	if (NOERROR != result) {
+		return result;
 	}
 
-	if (!dev->is_capture_started) {
-		uvcc_stop_capture(handle);
+	return dequeue_frame(dev, frame);
+}
+
+int uvcc_release_frame(uvcc_handle_t handle, uvcc_frame_t const *frame) {
+	video_dev_t const *dev = (video_dev_t const*)handle;
+
+	if ((NULL == dev) || (NULL == frame) || (frame->index >= dev->buffer_count)) {
+		return INVALID_ARGUMENTS;
 	}
 
-	return result;
+	return queue_buffer(dev, frame->index);
 }
 
 uint32_t uvcc_get_frame_size(uvcc_handle_t handle) {
@@ -636,10 +2397,51 @@ uint32_t uvcc_get_frame_size(uvcc_handle_t handle) {
 	if (NULL == dev) {
 		return -1;
 	}
-	if ((0 == dev->buffer_count) || (NULL == dev->buffers)) {
+	// kept while a suspend has released the buffers.
+	if (0 == dev->frame_size) {
 		return -1;
 	}
-	return dev->buffers[0].size;
+	return dev->frame_size;
+}
+
+uint32_t uvcc_get_buffer_count(uvcc_handle_t handle) {
+	video_dev_t const *dev = (video_dev_t const*)handle;
+	if (NULL == dev) {
+		return 0;
+	}
+	return dev->buffer_count;
+}
+
+uint32_t uvcc_get_burst_slot_size(uvcc_handle_t handle) {
+	video_dev_t const *dev = (video_dev_t const*)handle;
+	uint32_t size;
+
+	if ((NULL == dev) || (0 == dev->frame_size)) {
+		return 0;
+	}
+	size = uvcc_get_frame_size(handle);
+	return (size + UVCC_BURST_ALIGNMENT - 1) & ~(uint32_t)(UVCC_BURST_ALIGNMENT - 1);
+}
+
+uint32_t uvcc_get_frame_stride(uvcc_handle_t handle, uint32_t plane) {
+	video_dev_t const *dev = (video_dev_t const*)handle;
+	uint32_t chroma_stride, chroma_height;
+
+	if ((NULL == dev) || (UVCC_MAX_PLANES <= plane)) {
+		return 0;
+	}
+#ifdef V4L2_CAP_VIDEO_CAPTURE_MPLANE
+	if (IS_MPLANE(dev) && (1 < dev->format.fmt.pix_mp.num_planes)) {
+		return (plane < dev->format.fmt.pix_mp.num_planes) ? get_format_stride(dev, plane) : 0;
+	}
+#endif
+	if (0 == plane) {
+		return get_format_stride(dev, 0);
+	}
+	if (plane > get_chroma_layout(get_format_pixelformat(dev), get_format_stride(dev, 0), get_format_height(dev), &chroma_stride, &chroma_height)) {
+		return 0;
+	}
+	return chroma_stride;
 }
 
 uint32_t uvcc_get_frame_width(uvcc_handle_t handle) {
@@ -647,7 +2449,7 @@ uint32_t uvcc_get_frame_width(uvcc_handle_t handle) {
 	if (NULL == dev) {
 		return -1;
 	}
-	return dev->format.fmt.pix.width;
+	return get_format_width(dev);
 }
 
 uint32_t uvcc_get_frame_height(uvcc_handle_t handle) {
@@ -655,7 +2457,7 @@ uint32_t uvcc_get_frame_height(uvcc_handle_t handle) {
 	if (NULL == dev) {
 		return -1;
 	}
-	return dev->format.fmt.pix.height;
+	return get_format_height(dev);
 }
 
 uint32_t uvcc_get_pixel_format(uvcc_handle_t handle) {
@@ -663,13 +2465,14 @@ uint32_t uvcc_get_pixel_format(uvcc_handle_t handle) {
 	if (NULL == dev) {
 		return -1;
 	}
-	return from_v4l2_pixel_format(dev->format.fmt.pix.pixelformat);
+	return from_v4l2_pixel_format(get_format_pixelformat(dev));
 }
 
 int uvcc_enum_preview_size(uvcc_handle_t handle, int index, uvcc_pixel_format_t pixel_format, uvcc_preview_size_t *size)
 {
 	video_dev_t const *dev = (video_dev_t const*)handle;
 	int err = 0;
+	int i;
 	struct v4l2_frmsizeenum frmsize;
 
 	if (NULL == dev) {
@@ -680,7 +2483,20 @@ int uvcc_enum_preview_size(uvcc_handle_t handle, int index, uvcc_pixel_format_t
 
 	frmsize.index = index;
 	frmsize.pixel_format = to_v4l2_pixel_format(pixel_format);
-	if (0 != ioctl(dev->fd, VIDIOC_ENUM_FRAMESIZES, &frmsize)) {
+	if (0 == frmsize.pixel_format) {
+		return INVALID_FORMAT_ARGUMENTS;
+	}
+	if (dev->is_probed) {
+		for (i = 0; i < dev->frame_size_count; ++i) {
+			if ((dev->frame_sizes[i].pixel_format == frmsize.pixel_format) && (dev->frame_sizes[i].index == (uint32_t)index)) {
+				break;
+			}
+		}
+		if (i == dev->frame_size_count) {
+			return NO_MORE_DATA;
+		}
+		frmsize = dev->frame_sizes[i];
+	} else if (0 != ioctl(dev->fd, VIDIOC_ENUM_FRAMESIZES, &frmsize)) {
 		err = errno;
 		LOGW("Cannot enumerate framesize (index:%d) (%s).", index, strerror(err));
 		switch (err) {
@@ -712,3 +2528,146 @@ int uvcc_enum_preview_size(uvcc_handle_t handle, int index, uvcc_pixel_format_t
 	return NOERROR;
 }
 
+
+int uvcc_init_best_video_device(uvcc_handle_t handle, uint32_t width, uint32_t height, uint32_t fps, uvcc_pixel_format_t output_format, uvcc_stream_mode_t *mode)
+{
+	video_dev_t *dev = (video_dev_t*)handle;
+	uvcc_stream_mode_t best;
+	uint32_t pixel_format;
+	int result;
+
+	if ((NULL == dev) || (NULL == mode)) {
+		return INVALID_ARGUMENTS;
+	}
+	if (0 == to_v4l2_pixel_format(output_format)) {
+		LOGE("Unknown output pixel format (%d).", output_format);
+		return INVALID_FORMAT_ARGUMENTS;
+	}
+
+	result = probe_capabilities(dev);
+	if (NOERROR != result) {
+		return result;
+	}
+
+	result = select_best_mode(dev, width, height, fps, output_format, &best);
+	if (NOERROR != result) {
+		LOGE("No stream mode is available.");
+		return result;
+	}
+
+	LOGI("Selected stream mode (format=%d, %ux%u, interval=%u/%u, cost=%u+%u).",
+		best.pixel_format, best.width, best.height,
+		best.interval_numerator, best.interval_denominator,
+		best.transfer_cost, best.conversion_cost);
+
+	result = uvcc_init_video_device(handle, best.width, best.height, best.pixel_format);
+	if (NOERROR != result) {
+		return result;
+	}
+
+	if (0 != best.interval_numerator) {
+		result = set_frame_interval(dev, best.interval_numerator, best.interval_denominator);
+		if (NOERROR != result) {
+			LOGE("Frame interval %u/%u is not accepted.", best.interval_numerator, best.interval_denominator);
+			return result;
+		}
+	}
+
+	// report the mode accepted by the driver.
+	pixel_format = from_v4l2_pixel_format(get_format_pixelformat(dev));
+	if (pixel_format >= UVCC_PIX_FMT_COUNT) {
+		LOGE("Driver selected an unknown pixel format.");
+		return INVALID_FORMAT_ARGUMENTS;
+	}
+	best.pixel_format         = (uvcc_pixel_format_t)pixel_format;
+	best.width                = get_format_width(dev);
+	best.height               = get_format_height(dev);
+	best.interval_numerator   = dev->interval.numerator;
+	best.interval_denominator = dev->interval.denominator;
+	*mode = best;
+
+	return NOERROR;
+}
+
+int uvcc_enable_trace(uvcc_handle_t handle, uint32_t capacity)
+{
+	video_dev_t *dev = (video_dev_t*)handle;
+
+	if ((NULL == dev) || (0 == capacity)) {
+		return INVALID_ARGUMENTS;
+	}
+	if ((NULL != dev->trace) || dev->is_capture_started) {
+		return INVALID_STATUS;
+	}
+
+	dev->trace = uvcc_trace_create(capacity);
+	if (NULL == dev->trace) {
+		LOGE("Insufficient memory in application.");
+		return INSUFFICIENT_MEMORY;
+	}
+
+	return NOERROR;
+}
+
+void uvcc_trace_event(uvcc_handle_t handle, uvcc_trace_event_t event, uint32_t arg)
+{
+	video_dev_t const *dev = (video_dev_t const*)handle;
+
+	if ((NULL == dev) || (event >= UVCC_TRACE_EVENT_COUNT)) {
+		return;
+	}
+
+	TRACE(dev, event, arg);
+}
+
+int uvcc_dump_trace(uvcc_handle_t handle, char const *path)
+{
+	video_dev_t const *dev = (video_dev_t const*)handle;
+
+	if ((NULL == dev) || (NULL == path)) {
+		return INVALID_ARGUMENTS;
+	}
+	if (NULL == dev->trace) {
+		return INVALID_STATUS;
+	}
+
+	return uvcc_trace_dump(dev->trace, path);
+}
+
+int uvcc_set_cache_directory(char const *path)
+{
+	char *dir = NULL;
+
+	if (NULL != path) {
+		dir = strdup(path);
+		if (NULL == dir) {
+			return INSUFFICIENT_MEMORY;
+		}
+	}
+
+	free(cache_directory);
+	cache_directory = dir;
+
+	return NOERROR;
+}
+
+int uvcc_invalidate_capability_cache(uvcc_handle_t handle)
+{
+	video_dev_t *dev = (video_dev_t*)handle;
+	capability_cache_key_t key;
+	int result = NOERROR;
+
+	if (NULL == dev) {
+		return INVALID_ARGUMENTS;
+	}
+
+	if (NULL != cache_directory) {
+		make_capability_cache_key(dev, &key);
+		result = uvcc_cache_remove(cache_directory, &key, sizeof(key));
+	}
+
+	// the next query goes to the driver again.
+	release_capabilities(dev);
+
+	return result;
+}
@@ -31,6 +31,9 @@ typedef enum uvcc_error_t {
     NOT_PERMITTED,
 	NO_MORE_DATA,
 	PREVIEW_SIZE_NOT_SUPPORTED,
+	STREAM_MODE_NOT_FOUND,
+	FRAME_OVERWRITTEN,
+	VIDEO_DEVICE_DISCONNECTED, // unplugged or reset, the handle can be reconnected.
 } uvcc_error_t;
 
 typedef enum uvcc_pixel_format_t {
@@ -42,6 +45,9 @@ typedef enum uvcc_pixel_format_t {
 	UVCC_PIX_FMT_YUV420,
 	UVCC_PIX_FMT_YUV410,
 	UVCC_PIX_FMT_YUV422P,
+	UVCC_PIX_FMT_NV12,
+	UVCC_PIX_FMT_NV21,
+	UVCC_PIX_FMT_MJPEG,
 	UVCC_PIX_FMT_COUNT, // count of pixel formats.
 } uvcc_pixel_format_t;
 
@@ -50,19 +56,235 @@ typedef struct uvcc_preview_size_t {
 	uint32_t height;
 } uvcc_preview_size_t;
 
+/*
+ * Native stream mode (format, size and frame interval) of a video device.
+ * Costs are estimated per frame in units of one byte moved through memory:
+ * 'transfer_cost' is the payload over USB, 'conversion_cost' is the work to
+ * turn it into the requested output format.
+ */
+typedef struct uvcc_stream_mode_t {
+	uvcc_pixel_format_t pixel_format;
+	uint32_t width;
+	uint32_t height;
+	uint32_t interval_numerator;   // 0 if the driver does not report frame intervals.
+	uint32_t interval_denominator;
+	uint32_t transfer_cost;
+	uint32_t conversion_cost;
+} uvcc_stream_mode_t;
+
+/* Metadata of a captured frame. */
+typedef struct uvcc_frame_info_t {
+	uint32_t bytesused; // payload size, smaller than the buffer for compressed formats.
+	uint32_t sequence;
+	int64_t  timestamp_us;
+} uvcc_frame_info_t;
+
+#define UVCC_MAX_PLANES 3
+
+/* One plane of a dequeued frame. */
+typedef struct uvcc_plane_t {
+	uint8_t const *data;
+	uint32_t stride;    // bytes per line, 0 for compressed formats.
+	uint32_t bytesused; // valid bytes from 'data'.
+} uvcc_plane_t;
+
+/*
+ * Frame borrowed from the driver. Multi-planar formats expose one entry per
+ * plane (Y, then U/V or interleaved UV) whether the driver delivers them in
+ * separate buffers or in a single one. The planes stay valid until the frame
+ * is handed back by uvcc_release_frame.
+ */
+typedef struct uvcc_frame_t {
+	uint32_t          index; // driver buffer index.
+	uint32_t          plane_count;
+	uvcc_plane_t      planes[UVCC_MAX_PLANES];
+	uvcc_frame_info_t info;
+} uvcc_frame_t;
+
+/* Events recorded into the trace ring of a handle. */
+typedef enum uvcc_trace_event_t {
+	UVCC_TRACE_WAIT_BEGIN = 0,
+	UVCC_TRACE_DQBUF,        // arg: frame sequence.
+	UVCC_TRACE_COPY_DONE,    // arg: bytes copied.
+	UVCC_TRACE_QBUF,         // arg: buffer index.
+	UVCC_TRACE_CONVERT_DONE, // recorded by the caller through uvcc_trace_event.
+	UVCC_TRACE_EVENT_COUNT,
+} uvcc_trace_event_t;
+
+/* Time spent in each step of uvcc_reconfigure, in microseconds. */
+typedef struct uvcc_reconfigure_stats_t {
+	uint32_t stop_us;        // STREAMOFF.
+	uint32_t format_us;      // S_FMT/G_FMT, including release of buffers that do not fit.
+	uint32_t buffer_us;      // REQBUFS and mmap of new buffers.
+	uint32_t start_us;       // QBUF and STREAMON.
+	uint32_t total_us;
+	uint32_t buffers_reused; // non zero if the mapped buffers were kept.
+} uvcc_reconfigure_stats_t;
+
+/*
+ * Suspend and resume counters of a handle. The resume latency runs from
+ * the start of the stream that follows a suspend to the first frame
+ * dequeued after it, including the remap of released buffers.
+ */
+typedef struct uvcc_idle_stats_t {
+	uint32_t suspend_count;
+	uint32_t resume_count;
+	uint32_t last_resume_us;
+	uint32_t max_resume_us;
+	uint32_t is_suspended;     // non zero until the stream is started again.
+	uint32_t buffers_released; // non zero if the suspend gave the buffers back to the driver.
+} uvcc_idle_stats_t;
+
+/* Reconnects of a handle, the downtime runs from the failed call to the restored stream. */
+typedef struct uvcc_reconnect_stats_t {
+	uint32_t reconnect_count;
+	uint32_t failed_count; // reconnects that gave up before the device came back.
+	uint32_t last_downtime_us;
+	uint32_t max_downtime_us;
+	uint64_t total_downtime_us;
+} uvcc_reconnect_stats_t;
+
+/* One frame of a burst, the payload starts at 'index' * slot size. */
+typedef struct uvcc_burst_frame_t {
+	uvcc_frame_info_t info;
+	uint32_t          gap; // frames the driver dropped since the previous one of the burst.
+} uvcc_burst_frame_t;
+
+/* Slots of a burst are rounded up to this many bytes. */
+#define UVCC_BURST_ALIGNMENT 64
+
+#define UVCC_STATS_BINS 256
+
+/*
+ * Luma statistics of a frame. 'clip_low' and 'clip_high' are set by the
+ * caller, samples at or beyond them are counted as clipped; the other
+ * fields are filled by the capture. 'samples' is 0 for formats without a
+ * luma plane (RGB and MJPEG).
+ */
+typedef struct uvcc_frame_stats_t {
+	uint32_t histogram[UVCC_STATS_BINS];
+	uint32_t samples;
+	uint32_t mean_q8; // mean luma in 1/256 steps.
+	uint32_t min;
+	uint32_t max;
+	uint32_t clipped;
+	uint8_t  clip_low;
+	uint8_t  clip_high;
+} uvcc_frame_stats_t;
+
 typedef void const* uvcc_handle_t;
 
 extern int  uvcc_open_video_device(uvcc_handle_t *handle, char const * const path);
 extern void uvcc_close_video_device(uvcc_handle_t handle);
 extern int  uvcc_init_video_device(uvcc_handle_t handle, uint32_t width, uint32_t height, uvcc_pixel_format_t pixel_format);
+/*
+ * Switch an initialized device to another size or format. Streaming is
+ * stopped and restarted if it was running; the mapped buffers are kept when
+ * the driver accepts the new format with them and the new frame fits.
+ * 'stats' may be NULL.
+ */
+extern int  uvcc_reconfigure(uvcc_handle_t handle, uint32_t width, uint32_t height, uvcc_pixel_format_t pixel_format, uvcc_reconfigure_stats_t *stats);
 extern int  uvcc_start_capture(uvcc_handle_t dev);
 extern void uvcc_stop_capture(uvcc_handle_t dev);
+/*
+ * Stop an idle stream, and unmap its buffers if 'release_buffers' is non
+ * zero. The negotiated format is kept, so the next start (explicit or by a
+ * capture) only maps buffers again and restarts streaming.
+ */
+extern int  uvcc_suspend_capture(uvcc_handle_t handle, int release_buffers);
+extern int  uvcc_get_idle_stats(uvcc_handle_t handle, uvcc_idle_stats_t *stats);
+/*
+ * Reopen a device that failed with VIDEO_DEVICE_DISCONNECTED. The node is
+ * looked up by the bus of the device (it may come back under another
+ * /dev/video path) until 'timeout_ms' passes; the format, frame interval
+ * and buffers are restored and streaming resumes if it was running.
+ * Frames dequeued before the failure must not be released afterwards.
+ */
+extern int  uvcc_reconnect(uvcc_handle_t handle, uint32_t timeout_ms);
+/*
+ * Let the copying captures (uvcc_capture_frame*, uvcc_capture_burst)
+ * reconnect by themselves and retry, waiting up to 'timeout_ms' for the
+ * device; 0 disables it. uvcc_dequeue_frame and uvcc_poll_frame always
+ * report the disconnection to the caller.
+ */
+extern int  uvcc_set_auto_reconnect(uvcc_handle_t handle, uint32_t timeout_ms);
+/*
+ * mlock the mapped capture buffers so frames never wait for a page fault,
+ * again whenever the buffers are mapped anew. 'locked' tells whether the
+ * buffers are locked now (or will be once mapped); RLIMIT_MEMLOCK often
+ * refuses, in which case they stay unlocked.
+ */
+extern int  uvcc_set_buffer_locking(uvcc_handle_t handle, int enable, int *locked);
+extern int  uvcc_get_reconnect_stats(uvcc_handle_t handle, uvcc_reconnect_stats_t *stats);
 extern int  uvcc_capture(uvcc_handle_t handle, uint8_t * const buf, size_t buf_size);
+extern int  uvcc_capture_frame(uvcc_handle_t handle, uint8_t * const buf, size_t buf_size, uvcc_frame_info_t *info);
+/* Same as uvcc_capture_frame, the luma statistics are gathered during the copy. */
+extern int  uvcc_capture_frame_stats(uvcc_handle_t handle, uint8_t * const buf, size_t buf_size, uvcc_frame_info_t *info, uvcc_frame_stats_t *stats);
+/*
+ * Capture into separate planes laid out with the caller's strides (in
+ * bytes), padding rows of the driver are dropped on the way. 'sizes' are
+ * the capacities of the planes. Formats without rows (MJPEG) are copied
+ * as is into planes[0].
+ */
+extern int  uvcc_capture_frame_planes(uvcc_handle_t handle, uint8_t * const planes[UVCC_MAX_PLANES],
+	uint32_t const strides[UVCC_MAX_PLANES], uint32_t const sizes[UVCC_MAX_PLANES], uvcc_frame_info_t *info);
+/*
+ * uvcc_capture_frame_planes into one buffer: plane i + 1 starts right
+ * after the last row of plane i, 'strides[i]' bytes apart. The other
+ * copying captures use the same layout with the driver strides.
+ */
+extern int  uvcc_capture_frame_packed(uvcc_handle_t handle, uint8_t *buf, size_t buf_size,
+	uint32_t const strides[UVCC_MAX_PLANES], uvcc_frame_info_t *info);
+/*
+ * Capture 'count' consecutive frames into 'buf', one slot of
+ * uvcc_get_burst_slot_size bytes each. Frames are dequeued back to back
+ * without waiting in select; 'frames' receives their metadata.
+ */
+extern int  uvcc_capture_burst(uvcc_handle_t handle, uint8_t *buf, size_t buf_size, uint32_t count, uvcc_burst_frame_t *frames);
+extern uint32_t uvcc_get_burst_slot_size(uvcc_handle_t handle);
+extern int  uvcc_dequeue_frame(uvcc_handle_t handle, uvcc_frame_t *frame);
+extern int  uvcc_release_frame(uvcc_handle_t handle, uvcc_frame_t const *frame);
+/*
+ * uvcc_dequeue_frame that gives up after 'timeout_ms' (negative waits
+ * forever) with NO_MORE_DATA.
+ */
+extern int  uvcc_poll_frame(uvcc_handle_t handle, uvcc_frame_t *frame, int timeout_ms);
+extern uint32_t uvcc_get_buffer_count(uvcc_handle_t handle);
+/*
+ * Wait until at least one of up to 32 started devices has a frame. Bit i
+ * of 'ready' is set when handles[i] can be dequeued without blocking.
+ */
+extern int  uvcc_wait_frames(uvcc_handle_t const *handles, uint32_t count, int timeout_ms, uint32_t *ready);
+/*
+ * The getters below read state set by init and reconfigure without locking,
+ * they must not race those calls. Idle and reconnect stats may be read from
+ * any thread while another one captures.
+ */
 extern uint32_t uvcc_get_frame_size(uvcc_handle_t handle);
+/* Bytes per line of a plane as delivered by the driver, 0 if there is no such plane. */
+extern uint32_t uvcc_get_frame_stride(uvcc_handle_t handle, uint32_t plane);
 extern uint32_t uvcc_get_frame_width(uvcc_handle_t handle);
 extern uint32_t uvcc_get_frame_height(uvcc_handle_t handle);
 extern uint32_t uvcc_get_pixel_format(uvcc_handle_t handle);
 extern int  uvcc_enum_preview_size(uvcc_handle_t handle, int index, uvcc_pixel_format_t pixel_format, uvcc_preview_size_t *size);
+extern int  uvcc_init_best_video_device(uvcc_handle_t handle, uint32_t width, uint32_t height, uint32_t fps, uvcc_pixel_format_t output_format, uvcc_stream_mode_t *mode);
+
+/*
+ * Capabilities (crop bounds, formats, frame sizes and intervals) probed at
+ * open are stored under 'path', keyed by driver, card, bus and version, and
+ * reused by the next open of the same device. Set it before opening devices;
+ * NULL disables the cache.
+ */
+extern int  uvcc_set_cache_directory(char const *path);
+extern int  uvcc_invalidate_capability_cache(uvcc_handle_t handle);
+
+/*
+ * Tracing is off until enabled. Enable it before capture starts, the ring
+ * lives until the device is closed.
+ */
+extern int  uvcc_enable_trace(uvcc_handle_t handle, uint32_t capacity);
+extern void uvcc_trace_event(uvcc_handle_t handle, uvcc_trace_event_t event, uint32_t arg);
+extern int  uvcc_dump_trace(uvcc_handle_t handle, char const *path);
 
 #ifdef __cplusplus
 }
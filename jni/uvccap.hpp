@@ -0,0 +1,584 @@
+#ifndef UVC_CAPTURE_HPP
+#define UVC_CAPTURE_HPP
+
+/*
+ * C++ layer over uvccap.h, header only. Devices and borrowed frames are
+ * move-only owners of their native resources, errors are thrown as
+ * uvcc::Error. Color conversions are templates on the source format, the
+ * destination format and the matrix, so each pair compiles into its own
+ * loop; uvcc::convert() picks one of them at runtime for callers that only
+ * know the formats then.
+ */
+
+#if __cplusplus < 201103L
+#error "uvccap.hpp requires C++11."
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdexcept>
+#include <utility>
+#include "uvccap.h"
+#include "cconv.h"
+
+namespace uvcc {
+
+class Error : public std::runtime_error {
+public:
+	Error(char const *what, int code) : std::runtime_error(what), code_(code) {}
+
+	int code() const { return code_; }
+	// the device can be brought back with Device::reconnect.
+	bool disconnected() const { return VIDEO_DEVICE_DISCONNECTED == code_; }
+
+private:
+	int code_;
+};
+
+namespace detail {
+
+inline void check(int result, char const *what) {
+	if (NOERROR != result) {
+		throw Error(what, result);
+	}
+}
+
+} // namespace detail
+
+/* Formats the conversions work on. */
+enum Format {
+	FORMAT_YUYV = 0,
+	FORMAT_UYVY,
+	FORMAT_I420,
+	FORMAT_NV12,
+	FORMAT_NV21,
+	FORMAT_RGBA, // one native-endian 0xAARRGGBB word per pixel, as written by cconv.
+	FORMAT_COUNT,
+};
+
+/* FORMAT_COUNT if frames of the pixel format can not be converted. */
+inline Format format_of(uvcc_pixel_format_t format) {
+	switch (format) {
+	case UVCC_PIX_FMT_YUYV:   return FORMAT_YUYV;
+	case UVCC_PIX_FMT_UYVY:   return FORMAT_UYVY;
+	case UVCC_PIX_FMT_YUV420: return FORMAT_I420;
+	case UVCC_PIX_FMT_NV12:   return FORMAT_NV12;
+	case UVCC_PIX_FMT_NV21:   return FORMAT_NV21;
+	default:                  return FORMAT_COUNT;
+	}
+}
+
+/* Planes an image of the format is made of, 0 for FORMAT_COUNT. */
+inline uint32_t plane_count_of(Format format) {
+	switch (format) {
+	case FORMAT_YUYV:
+	case FORMAT_UYVY:
+	case FORMAT_RGBA: return 1;
+	case FORMAT_NV12:
+	case FORMAT_NV21: return 2;
+	case FORMAT_I420: return 3;
+	default:          return 0;
+	}
+}
+
+/* Planes of an image in the layout of its format, strides in bytes. */
+struct SrcImage {
+	uint8_t const *data[UVCC_MAX_PLANES];
+	int            stride[UVCC_MAX_PLANES];
+	int            width;
+	int            height;
+};
+
+struct DstImage {
+	uint8_t *data[UVCC_MAX_PLANES];
+	int      stride[UVCC_MAX_PLANES];
+};
+
+/*
+ * Frame borrowed from the driver, its buffer is queued again when the
+ * frame is destroyed. A frame must not outlive its device, and a frame
+ * dequeued before a disconnection has to be abandoned instead.
+ */
+class Frame {
+public:
+	Frame() : handle_(NULL), frame_(), format_(UVCC_PIX_FMT_COUNT), width_(0), height_(0) {}
+	~Frame() { release(); }
+
+	Frame(Frame &&other) noexcept : handle_(NULL) { take(other); }
+	Frame &operator=(Frame &&other) noexcept {
+		if (this != &other) {
+			release();
+			take(other);
+		}
+		return *this;
+	}
+
+	Frame(Frame const&) = delete;
+	Frame &operator=(Frame const&) = delete;
+
+	explicit operator bool() const { return NULL != handle_; }
+
+	/* Hand the buffer back to the driver now. */
+	void release() {
+		if (NULL != handle_) {
+			uvcc_release_frame(handle_, &frame_);
+			handle_ = NULL;
+		}
+	}
+
+	/* Forget the buffer without queueing it, for frames of a lost device. */
+	void abandon() { handle_ = NULL; }
+
+	uint32_t plane_count() const { return frame_.plane_count; }
+	uvcc_plane_t const &plane(uint32_t index) const { return frame_.planes[index]; }
+	uvcc_frame_info_t const &info() const { return frame_.info; }
+	uint32_t sequence() const { return frame_.info.sequence; }
+	int64_t timestamp_us() const { return frame_.info.timestamp_us; }
+	uvcc_pixel_format_t pixel_format() const { return format_; }
+	uint32_t width() const { return width_; }
+	uint32_t height() const { return height_; }
+
+	SrcImage image() const {
+		SrcImage image;
+		for (uint32_t i = 0; i < UVCC_MAX_PLANES; ++i) {
+			image.data[i] = (i < frame_.plane_count) ? frame_.planes[i].data : NULL;
+			image.stride[i] = (i < frame_.plane_count) ? (int)frame_.planes[i].stride : 0;
+		}
+		image.width = (int)width_;
+		image.height = (int)height_;
+		return image;
+	}
+
+private:
+	friend class Device;
+
+	void take(Frame &other) {
+		handle_ = other.handle_;
+		frame_ = other.frame_;
+		format_ = other.format_;
+		width_ = other.width_;
+		height_ = other.height_;
+		other.handle_ = NULL;
+	}
+
+	uvcc_handle_t       handle_; // NULL unless the frame holds a buffer.
+	uvcc_frame_t        frame_;
+	uvcc_pixel_format_t format_;
+	uint32_t            width_;
+	uint32_t            height_;
+};
+
+/*
+ * Opened video device, closed when destroyed. Like the handle it wraps, a
+ * device is used by one capturing thread; metadata and stats may be read
+ * from others as long as init and reconfigure are not running.
+ */
+class Device {
+public:
+	Device() : handle_(NULL) {}
+	explicit Device(char const *path) : handle_(NULL) {
+		detail::check(uvcc_open_video_device(&handle_, path), "Failed to open video device.");
+	}
+	~Device() { close(); }
+
+	Device(Device &&other) noexcept : handle_(other.handle_) { other.handle_ = NULL; }
+	Device &operator=(Device &&other) noexcept {
+		if (this != &other) {
+			close();
+			handle_ = other.handle_;
+			other.handle_ = NULL;
+		}
+		return *this;
+	}
+
+	Device(Device const&) = delete;
+	Device &operator=(Device const&) = delete;
+
+	explicit operator bool() const { return NULL != handle_; }
+	uvcc_handle_t native_handle() const { return handle_; }
+
+	/* Frames still borrowed from the device have to be released before. */
+	void close() {
+		if (NULL != handle_) {
+			uvcc_close_video_device(handle_);
+			handle_ = NULL;
+		}
+	}
+
+	void init(uint32_t width, uint32_t height, uvcc_pixel_format_t format) {
+		detail::check(uvcc_init_video_device(handle_, width, height, format), "Failed to initialize video device.");
+	}
+
+	uvcc_stream_mode_t init_best(uint32_t width, uint32_t height, uint32_t fps, uvcc_pixel_format_t output_format) {
+		uvcc_stream_mode_t mode;
+		detail::check(uvcc_init_best_video_device(handle_, width, height, fps, output_format, &mode), "No stream mode found.");
+		return mode;
+	}
+
+	uvcc_reconfigure_stats_t reconfigure(uint32_t width, uint32_t height, uvcc_pixel_format_t format) {
+		uvcc_reconfigure_stats_t stats;
+		detail::check(uvcc_reconfigure(handle_, width, height, format, &stats), "Failed to reconfigure video device.");
+		return stats;
+	}
+
+	void start() {
+		detail::check(uvcc_start_capture(handle_), "Failed to start capture.");
+	}
+
+	void stop() {
+		uvcc_stop_capture(handle_);
+	}
+
+	void suspend(bool release_buffers) {
+		detail::check(uvcc_suspend_capture(handle_, release_buffers ? 1 : 0), "Failed to suspend capture.");
+	}
+
+	/* Copy the next frame into buf, returns the bytes written. */
+	uint32_t capture(uint8_t *buf, size_t size, uvcc_frame_info_t *info = NULL) {
+		uvcc_frame_info_t local;
+		uvcc_frame_info_t *const out = (NULL != info) ? info : &local;
+		detail::check(uvcc_capture_frame(handle_, buf, size, out), "Capture failed.");
+		return out->bytesused;
+	}
+
+	/* Borrow the next frame without copying it, starting the stream if needed. */
+	Frame dequeue() {
+		Frame frame;
+		detail::check(uvcc_dequeue_frame(handle_, &frame.frame_), "Capture failed.");
+		adopt(frame);
+		return frame;
+	}
+
+	/* dequeue that gives up after timeout_ms, frame is left as it was then. */
+	bool poll(Frame &frame, int timeout_ms) {
+		Frame next;
+		int const result = uvcc_poll_frame(handle_, &next.frame_, timeout_ms);
+		if (NO_MORE_DATA == result) {
+			return false;
+		}
+		detail::check(result, "Capture failed.");
+		adopt(next);
+		frame = std::move(next);
+		return true;
+	}
+
+	void reconnect(uint32_t timeout_ms) {
+		detail::check(uvcc_reconnect(handle_, timeout_ms), "Video device did not come back.");
+	}
+
+	void set_auto_reconnect(uint32_t timeout_ms) {
+		detail::check(uvcc_set_auto_reconnect(handle_, timeout_ms), "Failed to set auto reconnect.");
+	}
+
+	uvcc_idle_stats_t idle_stats() const {
+		uvcc_idle_stats_t stats;
+		detail::check(uvcc_get_idle_stats(handle_, &stats), "Failed to get idle stats.");
+		return stats;
+	}
+
+	uvcc_reconnect_stats_t reconnect_stats() const {
+		uvcc_reconnect_stats_t stats;
+		detail::check(uvcc_get_reconnect_stats(handle_, &stats), "Failed to get reconnect stats.");
+		return stats;
+	}
+
+	uint32_t width() const { return uvcc_get_frame_width(handle_); }
+	uint32_t height() const { return uvcc_get_frame_height(handle_); }
+	uvcc_pixel_format_t pixel_format() const { return (uvcc_pixel_format_t)uvcc_get_pixel_format(handle_); }
+	uint32_t frame_size() const { return uvcc_get_frame_size(handle_); }
+	uint32_t stride(uint32_t plane) const { return uvcc_get_frame_stride(handle_, plane); }
+
+private:
+	void adopt(Frame &frame) const {
+		frame.handle_ = handle_;
+		frame.format_ = pixel_format();
+		frame.width_ = width();
+		frame.height_ = height();
+	}
+
+	uvcc_handle_t handle_;
+};
+
+/*
+ * Format tags. Each one reads rows of its layout (luma and the chroma that
+ * covers a pixel) and, for the 4:2:0 layouts, writes them.
+ */
+namespace fmt {
+
+template <int Y0, int U, int Y1, int V>
+struct Packed422 {
+	static bool const chroma_per_row = true;
+
+	struct Row {
+		uint8_t const *p;
+		uint8_t luma(int x) const { return p[(x >> 1) * 4 + ((x & 1) ? Y1 : Y0)]; }
+		uint8_t cb(int x) const { return p[(x >> 1) * 4 + U]; }
+		uint8_t cr(int x) const { return p[(x >> 1) * 4 + V]; }
+		void pair(int i, int &y0, int &y1, int &u, int &v) const {
+			uint8_t const *const q = p + i * 4;
+			y0 = q[Y0];
+			y1 = q[Y1];
+			u = q[U];
+			v = q[V];
+		}
+	};
+
+	static Row row(SrcImage const &src, int y) {
+		Row row = { src.data[0] + y * src.stride[0] };
+		return row;
+	}
+};
+
+template <int U, int V>
+struct SemiPlanar420 {
+	static bool const chroma_per_row = false;
+
+	struct Row {
+		uint8_t const *y;
+		uint8_t const *c;
+		uint8_t luma(int x) const { return y[x]; }
+		uint8_t cb(int x) const { return c[(x >> 1) * 2 + U]; }
+		uint8_t cr(int x) const { return c[(x >> 1) * 2 + V]; }
+		void pair(int i, int &y0, int &y1, int &u, int &v) const {
+			y0 = y[i * 2];
+			y1 = y[i * 2 + 1];
+			u = c[i * 2 + U];
+			v = c[i * 2 + V];
+		}
+	};
+
+	struct Chroma {
+		uint8_t *c;
+		void store(int i, uint8_t cb, uint8_t cr) const {
+			c[i * 2 + U] = cb;
+			c[i * 2 + V] = cr;
+		}
+	};
+
+	static Row row(SrcImage const &src, int y) {
+		Row row = { src.data[0] + y * src.stride[0], src.data[1] + (y >> 1) * src.stride[1] };
+		return row;
+	}
+
+	static Chroma chroma(DstImage const &dst, int cy) {
+		Chroma chroma = { dst.data[1] + cy * dst.stride[1] };
+		return chroma;
+	}
+};
+
+struct YUYV : Packed422<0, 1, 2, 3> { static Format const id = FORMAT_YUYV; };
+struct UYVY : Packed422<1, 0, 3, 2> { static Format const id = FORMAT_UYVY; };
+struct NV12 : SemiPlanar420<0, 1> { static Format const id = FORMAT_NV12; };
+struct NV21 : SemiPlanar420<1, 0> { static Format const id = FORMAT_NV21; };
+
+struct I420 {
+	static Format const id = FORMAT_I420;
+	static bool const chroma_per_row = false;
+
+	struct Row {
+		uint8_t const *y;
+		uint8_t const *u;
+		uint8_t const *v;
+		uint8_t luma(int x) const { return y[x]; }
+		uint8_t cb(int x) const { return u[x >> 1]; }
+		uint8_t cr(int x) const { return v[x >> 1]; }
+		void pair(int i, int &y0, int &y1, int &cb, int &cr) const {
+			y0 = y[i * 2];
+			y1 = y[i * 2 + 1];
+			cb = u[i];
+			cr = v[i];
+		}
+	};
+
+	struct Chroma {
+		uint8_t *u;
+		uint8_t *v;
+		void store(int i, uint8_t cb, uint8_t cr) const {
+			u[i] = cb;
+			v[i] = cr;
+		}
+	};
+
+	static Row row(SrcImage const &src, int y) {
+		Row row = {
+			src.data[0] + y * src.stride[0],
+			src.data[1] + (y >> 1) * src.stride[1],
+			src.data[2] + (y >> 1) * src.stride[2],
+		};
+		return row;
+	}
+
+	static Chroma chroma(DstImage const &dst, int cy) {
+		Chroma chroma = { dst.data[1] + cy * dst.stride[1], dst.data[2] + cy * dst.stride[2] };
+		return chroma;
+	}
+};
+
+struct RGBA {
+	static Format const id = FORMAT_RGBA;
+};
+
+} // namespace fmt
+
+/* Matrices of the RGBA output, with the fixed-point math of cconv. */
+namespace matrix {
+
+struct BT601 {
+	static cconv_matrix_t const id = CCONV_MATRIX_BT601;
+
+	static uint32_t to_rgba(int y, int u, int v) {
+		int const iy = 1192 * ((y < 16) ? 0 : y - 16);
+		int const iu = u - 128;
+		int const iv = v - 128;
+		return pack(iy + 1634 * iv, iy - 833 * iv - 400 * iu, iy + 2066 * iu);
+	}
+
+	static uint32_t pack(int32_t r, int32_t g, int32_t b) {
+		r = (r < 0) ? 0 : (r > 262143) ? 262143 : r;
+		g = (g < 0) ? 0 : (g > 262143) ? 262143 : g;
+		b = (b < 0) ? 0 : (b > 262143) ? 262143 : b;
+		return 0xff000000 | ((r << 6) & 0xff0000) | ((g >> 2) & 0xff00) | ((b >> 10) & 0xff);
+	}
+};
+
+struct JFIF {
+	static cconv_matrix_t const id = CCONV_MATRIX_JFIF;
+
+	static uint32_t to_rgba(int y, int u, int v) {
+		int const iy = 1024 * y + 512;
+		int const iu = u - 128;
+		int const iv = v - 128;
+		return BT601::pack(iy + 1436 * iv, iy - 731 * iv - 352 * iu, iy + 1815 * iu);
+	}
+};
+
+} // namespace matrix
+
+namespace detail {
+
+template <class Src, class Dst, class Matrix>
+struct Kernel {
+	// any 4:2:0 layout: luma is copied, chroma of packed rows is averaged (rounded up).
+	static void run(SrcImage const &src, DstImage const &dst) {
+		int const pairs = (src.width + 1) / 2;
+		for (int y = 0; y < src.height; y += 2) {
+			int const y1 = (y + 1 < src.height) ? y + 1 : y;
+			typename Src::Row const r0 = Src::row(src, y);
+			typename Src::Row const r1 = Src::row(src, y1);
+			uint8_t *const d0 = dst.data[0] + y * dst.stride[0];
+			uint8_t *const d1 = dst.data[0] + y1 * dst.stride[0];
+			typename Dst::Chroma const c = Dst::chroma(dst, y / 2);
+
+			for (int x = 0; x < src.width; ++x) {
+				d0[x] = r0.luma(x);
+				d1[x] = r1.luma(x);
+			}
+			for (int i = 0; i < pairs; ++i) {
+				if (Src::chroma_per_row) {
+					c.store(i, (uint8_t)((r0.cb(i * 2) + r1.cb(i * 2) + 1) >> 1),
+						(uint8_t)((r0.cr(i * 2) + r1.cr(i * 2) + 1) >> 1));
+				} else {
+					c.store(i, r0.cb(i * 2), r0.cr(i * 2));
+				}
+			}
+		}
+	}
+};
+
+template <class Src, class Matrix>
+struct Kernel<Src, fmt::RGBA, Matrix> {
+	static void run(SrcImage const &src, DstImage const &dst) {
+		for (int y = 0; y < src.height; ++y) {
+			typename Src::Row const r = Src::row(src, y);
+			uint32_t *const d = (uint32_t*)(dst.data[0] + y * dst.stride[0]);
+			int const pairs = src.width / 2;
+
+			for (int i = 0; i < pairs; ++i) {
+				int y0, y1, u, v;
+				r.pair(i, y0, y1, u, v);
+				d[i * 2]     = Matrix::to_rgba(y0, u, v);
+				d[i * 2 + 1] = Matrix::to_rgba(y1, u, v);
+			}
+			if (src.width & 1) {
+				int const x = src.width - 1;
+				d[x] = Matrix::to_rgba(r.luma(x), r.cb(x), r.cr(x));
+			}
+		}
+	}
+};
+
+} // namespace detail
+
+/*
+ * Convert src into dst, both laid out as their format tag says. The matrix
+ * only matters for RGBA output, the 4:2:0 outputs keep the samples as they
+ * are. Odd widths are supported by the planar sources only.
+ */
+template <class Src, class Dst, class Matrix = matrix::BT601>
+inline void convert(SrcImage const &src, DstImage const &dst) {
+	detail::Kernel<Src, Dst, Matrix>::run(src, dst);
+}
+
+typedef void (*ConvertFunction)(SrcImage const &src, DstImage const &dst);
+
+namespace detail {
+
+template <class Src, class Dst>
+inline ConvertFunction pick(cconv_matrix_t matrix) {
+	if (CCONV_MATRIX_JFIF == matrix) {
+		return &convert<Src, Dst, matrix::JFIF>;
+	}
+	return &convert<Src, Dst, matrix::BT601>;
+}
+
+template <class Src>
+inline ConvertFunction pick(Format dst, cconv_matrix_t matrix) {
+	switch (dst) {
+	case FORMAT_I420: return pick<Src, fmt::I420>(matrix);
+	case FORMAT_NV12: return pick<Src, fmt::NV12>(matrix);
+	case FORMAT_NV21: return pick<Src, fmt::NV21>(matrix);
+	case FORMAT_RGBA: return pick<Src, fmt::RGBA>(matrix);
+	default:          return NULL;
+	}
+}
+
+} // namespace detail
+
+/* Instantiated kernel for the pair, NULL if it is not supported. */
+inline ConvertFunction find_converter(Format src, Format dst, cconv_matrix_t matrix = CCONV_MATRIX_BT601) {
+	switch (src) {
+	case FORMAT_YUYV: return detail::pick<fmt::YUYV>(dst, matrix);
+	case FORMAT_UYVY: return detail::pick<fmt::UYVY>(dst, matrix);
+	case FORMAT_I420: return detail::pick<fmt::I420>(dst, matrix);
+	case FORMAT_NV12: return detail::pick<fmt::NV12>(dst, matrix);
+	case FORMAT_NV21: return detail::pick<fmt::NV21>(dst, matrix);
+	default:          return NULL;
+	}
+}
+
+/* Runtime dispatch, for a single image; look the kernel up once for a stream. */
+inline void convert(Format src_format, SrcImage const &src, Format dst_format, DstImage const &dst,
+	cconv_matrix_t matrix = CCONV_MATRIX_BT601) {
+	ConvertFunction const function = find_converter(src_format, dst_format, matrix);
+	if (NULL == function) {
+		throw Error("Unsupported conversion.", INVALID_FORMAT_ARGUMENTS);
+	}
+	function(src, dst);
+}
+
+/*
+ * A planar frame too short to hold all of its planes is delivered as one
+ * plane by the device and is refused here rather than read past its end.
+ */
+inline void convert(Frame const &frame, Format dst_format, DstImage const &dst,
+	cconv_matrix_t matrix = CCONV_MATRIX_BT601) {
+	Format const src_format = format_of(frame.pixel_format());
+	if ((FORMAT_COUNT != src_format) && (frame.plane_count() < plane_count_of(src_format))) {
+		throw Error("Frame is missing planes of its format.", INVALID_ARGUMENTS);
+	}
+	convert(src_format, frame.image(), dst_format, dst, matrix);
+}
+
+} // namespace uvcc
+
+#endif
@@ -1,14 +1,20 @@
 #include "uvccap_jni.h"
 #include "uvccap.h"
+#include "uvccpump.h"
+#include "uvccshm.h"
+#include "uvccthread.h"
 #include <stdint.h>
-#include <android/log.h>
+#include <stdlib.h>
 
 #define LOG_TAG "libuvccap"
-
-#define LOGD(fmt, ...) __android_log_print(ANDROID_LOG_DEBUG, LOG_TAG, fmt, ##__VA_ARGS__);
+#include "uvcclog.h"
 
 static void throw_RuntimeException(JNIEnv *env, char const * const message);
 static void throw_IOException(JNIEnv *env, char const * const message); 
+static void throw_IllegalArgumentException(JNIEnv *env, char const * const message);
+static void throw_capture_error(JNIEnv *env, int result);
+static int  get_thread_policy(JNIEnv *env, jintArray array, uvcc_thread_policy_t *policy);
+static void set_thread_policy(JNIEnv *env, jintArray array, uvcc_thread_policy_t const *policy);
 
 #define TO_HANDLE(h) ((uvcc_handle_t)(intptr_t)h)
 
@@ -56,6 +62,20 @@ JNIEXPORT jint JNICALL Java_net_crimsonwoods_android_libs_uvccap_UVCCamera_n_1ge
 	return uvcc_get_frame_height(TO_HANDLE(handle));
 }
 
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_UVCCamera
+ * Method:    n_getStride
+ * Signature: (JI)I
+ */
+JNIEXPORT jint JNICALL Java_net_crimsonwoods_android_libs_uvccap_UVCCamera_n_1getStride
+  (JNIEnv *env, jobject thiz, jlong handle, jint plane)
+{
+	if (0 > plane) {
+		return 0;
+	}
+	return uvcc_get_frame_stride(TO_HANDLE(handle), plane);
+}
+
 /*
  * Class:     net_crimsonwoods_android_libs_uvccap_UVCCamera
  * Method:    n_open
@@ -111,32 +131,336 @@ JNIEXPORT void JNICALL Java_net_crimsonwoods_android_libs_uvccap_UVCCamera_n_1cl
 /*
  * Class:     net_crimsonwoods_android_libs_uvccap_UVCCamera
  * Method:    n_capture
- * Signature: (J[B)V
+ * Signature: (J[B)I
  */
-JNIEXPORT void JNICALL Java_net_crimsonwoods_android_libs_uvccap_UVCCamera_n_1capture
+JNIEXPORT jint JNICALL Java_net_crimsonwoods_android_libs_uvccap_UVCCamera_n_1capture
   (JNIEnv *env, jobject thiz, jlong handle, jbyteArray buf)
 {
-	jboolean isCopy = JNI_FALSE;
-	void *ptr = NULL;
+	jbyte *ptr = NULL;
 	jsize size = 0;
 	int result = NOERROR;
+	uvcc_frame_info_t info;
 
 	if (NULL == buf) {
-		return;
+		return 0;
 	}
 
+	// the capture waits for a frame, far too long to hold the array in a critical region.
 	size = (*env)->GetArrayLength(env, buf);
-	ptr = (*env)->GetPrimitiveArrayCritical(env, buf, &isCopy);
+	ptr = (*env)->GetByteArrayElements(env, buf, NULL);
+	if (NULL == ptr) {
+		return 0;
+	}
+	result = uvcc_capture_frame(TO_HANDLE(handle), (uint8_t*)ptr, size, &info);
+	(*env)->ReleaseByteArrayElements(env, buf, ptr, (NOERROR == result) ? 0 : JNI_ABORT);
+	if (NOERROR != result) {
+		throw_capture_error(env, result);
+		return 0;
+	}
+	return info.bytesused;
+}
 
-	result = uvcc_capture(TO_HANDLE(handle), ptr, size);
-	if ((NOERROR == result) && (JNI_FALSE != isCopy)) {
-		(*env)->ReleasePrimitiveArrayCritical(env, buf, ptr, JNI_COMMIT);
-	} else {
-		(*env)->ReleasePrimitiveArrayCritical(env, buf, ptr, 0);
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_UVCCamera
+ * Method:    n_captureDirect
+ * Signature: (JLjava/nio/ByteBuffer;)I
+ */
+JNIEXPORT jint JNICALL Java_net_crimsonwoods_android_libs_uvccap_UVCCamera_n_1captureDirect
+  (JNIEnv *env, jobject thiz, jlong handle, jobject pixels)
+{
+	void *ptr = NULL;
+	jlong size = 0;
+	uvcc_frame_info_t info;
+	int result;
+
+	if (NULL == pixels) {
+		return 0;
+	}
+
+	ptr  = (*env)->GetDirectBufferAddress(env, pixels);
+	size = (*env)->GetDirectBufferCapacity(env, pixels);
+	if ((NULL == ptr) || (size < 0)) {
+		throw_IllegalArgumentException(env, "'pixels' have to be direct buffer.");
+		return 0;
 	}
+
+	result = uvcc_capture_frame(TO_HANDLE(handle), ptr, (size_t)size, &info);
 	if (NOERROR != result) {
-		throw_RuntimeException(env, "Capture failed.");
+		throw_capture_error(env, result);
+		return 0;
+	}
+	return info.bytesused;
+}
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_UVCCamera
+ * Method:    n_captureDirectStats
+ * Signature: (JLjava/nio/ByteBuffer;Lnet/crimsonwoods/android/libs/uvccap/FrameStats;)I
+ */
+JNIEXPORT jint JNICALL Java_net_crimsonwoods_android_libs_uvccap_UVCCamera_n_1captureDirectStats
+  (JNIEnv *env, jobject thiz, jlong handle, jobject pixels, jobject stats)
+{
+	uvcc_frame_stats_t frame_stats;
+	uvcc_frame_info_t info;
+	void *ptr = NULL;
+	jlong size = 0;
+	int result;
+
+	if ((NULL == pixels) || (NULL == stats)) {
+		return 0;
+	}
+
+	ptr  = (*env)->GetDirectBufferAddress(env, pixels);
+	size = (*env)->GetDirectBufferCapacity(env, pixels);
+	if ((NULL == ptr) || (size < 0)) {
+		throw_IllegalArgumentException(env, "'pixels' have to be direct buffer.");
+		return 0;
+	}
+
+	jclass stats_cls = (*env)->GetObjectClass(env, stats);
+	jfieldID field_histogram  = (*env)->GetFieldID(env, stats_cls, "histogram", "[I");
+	jfieldID field_samples    = (*env)->GetFieldID(env, stats_cls, "samples", "I");
+	jfieldID field_mean       = (*env)->GetFieldID(env, stats_cls, "meanQ8", "I");
+	jfieldID field_min        = (*env)->GetFieldID(env, stats_cls, "min", "I");
+	jfieldID field_max        = (*env)->GetFieldID(env, stats_cls, "max", "I");
+	jfieldID field_clipped    = (*env)->GetFieldID(env, stats_cls, "clipped", "I");
+	jfieldID field_clip_low   = (*env)->GetFieldID(env, stats_cls, "clipLow", "I");
+	jfieldID field_clip_high  = (*env)->GetFieldID(env, stats_cls, "clipHigh", "I");
+	(*env)->DeleteLocalRef(env, stats_cls);
+	if (!field_histogram || !field_samples || !field_mean || !field_min || !field_max ||
+		!field_clipped || !field_clip_low || !field_clip_high) {
+		// NoSuchFieldError will throw by JVM.
+		return 0;
+	}
+
+	jintArray histogram = (jintArray)(*env)->GetObjectField(env, stats, field_histogram);
+	if ((NULL == histogram) || ((*env)->GetArrayLength(env, histogram) < UVCC_STATS_BINS)) {
+		throw_IllegalArgumentException(env, "'histogram' of stats is too short.");
+		return 0;
+	}
+
+	frame_stats.clip_low  = (uint8_t)(*env)->GetIntField(env, stats, field_clip_low);
+	frame_stats.clip_high = (uint8_t)(*env)->GetIntField(env, stats, field_clip_high);
+	result = uvcc_capture_frame_stats(TO_HANDLE(handle), ptr, (size_t)size, &info, &frame_stats);
+	if (NOERROR != result) {
+		(*env)->DeleteLocalRef(env, histogram);
+		throw_capture_error(env, result);
+		return 0;
+	}
+
+	(*env)->SetIntArrayRegion(env, histogram, 0, UVCC_STATS_BINS, (jint const*)frame_stats.histogram);
+	(*env)->DeleteLocalRef(env, histogram);
+	(*env)->SetIntField(env, stats, field_samples, frame_stats.samples);
+	(*env)->SetIntField(env, stats, field_mean,    frame_stats.mean_q8);
+	(*env)->SetIntField(env, stats, field_min,     frame_stats.min);
+	(*env)->SetIntField(env, stats, field_max,     frame_stats.max);
+	(*env)->SetIntField(env, stats, field_clipped, frame_stats.clipped);
+	return info.bytesused;
+}
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_UVCCamera
+ * Method:    n_captureStrided
+ * Signature: (J[B[I)I
+ */
+JNIEXPORT jint JNICALL Java_net_crimsonwoods_android_libs_uvccap_UVCCamera_n_1captureStrided
+  (JNIEnv *env, jobject thiz, jlong handle, jbyteArray buf, jintArray stride_array)
+{
+	uint32_t strides[UVCC_MAX_PLANES] = { 0, 0, 0 };
+	jint values[UVCC_MAX_PLANES];
+	uvcc_frame_info_t info;
+	jbyte *ptr;
+	jsize size, count;
+	jsize i;
+	int result;
+
+	if ((NULL == buf) || (NULL == stride_array)) {
+		throw_IllegalArgumentException(env, "'pixels' and 'strides' have to be set not null.");
+		return 0;
+	}
+	count = (*env)->GetArrayLength(env, stride_array);
+	count = (UVCC_MAX_PLANES < count) ? UVCC_MAX_PLANES : count;
+	(*env)->GetIntArrayRegion(env, stride_array, 0, count, values);
+	for (i = 0; i < count; ++i) {
+		if (0 > values[i]) {
+			throw_IllegalArgumentException(env, "'strides' have to be positive.");
+			return 0;
+		}
+		strides[i] = values[i];
+	}
+
+	// the capture waits for a frame, far too long to hold the array in a critical region.
+	size = (*env)->GetArrayLength(env, buf);
+	ptr = (*env)->GetByteArrayElements(env, buf, NULL);
+	if (NULL == ptr) {
+		return 0;
+	}
+	result = uvcc_capture_frame_packed(TO_HANDLE(handle), (uint8_t*)ptr, size, strides, &info);
+	(*env)->ReleaseByteArrayElements(env, buf, ptr, (NOERROR == result) ? 0 : JNI_ABORT);
+
+	if (INVALID_ARGUMENTS == result) {
+		throw_IllegalArgumentException(env, "'pixels' is too small or a stride is shorter than a row.");
+		return 0;
+	} else if (NOERROR != result) {
+		throw_capture_error(env, result);
+		return 0;
+	}
+	return info.bytesused;
+}
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_UVCCamera
+ * Method:    n_capturePlanes
+ * Signature: (J[Ljava/nio/ByteBuffer;[I)I
+ */
+JNIEXPORT jint JNICALL Java_net_crimsonwoods_android_libs_uvccap_UVCCamera_n_1capturePlanes
+  (JNIEnv *env, jobject thiz, jlong handle, jobjectArray buffers, jintArray stride_array)
+{
+	uint8_t *planes[UVCC_MAX_PLANES] = { NULL, NULL, NULL };
+	uint32_t strides[UVCC_MAX_PLANES] = { 0, 0, 0 };
+	uint32_t sizes[UVCC_MAX_PLANES] = { 0, 0, 0 };
+	jint values[UVCC_MAX_PLANES];
+	uvcc_frame_info_t info;
+	jsize count;
+	jsize i;
+	int result;
+
+	if ((NULL == buffers) || (NULL == stride_array)) {
+		throw_IllegalArgumentException(env, "'planes' and 'strides' have to be set not null.");
+		return 0;
+	}
+	count = (*env)->GetArrayLength(env, buffers);
+	if ((UVCC_MAX_PLANES < count) || ((*env)->GetArrayLength(env, stride_array) < count)) {
+		throw_IllegalArgumentException(env, "'planes' or 'strides' is out of range.");
+		return 0;
+	}
+	(*env)->GetIntArrayRegion(env, stride_array, 0, count, values);
+
+	for (i = 0; i < count; ++i) {
+		jobject buffer = (*env)->GetObjectArrayElement(env, buffers, i);
+		if (NULL == buffer) {
+			continue;
+		}
+		planes[i] = (uint8_t*)(*env)->GetDirectBufferAddress(env, buffer);
+		jlong const capacity = (*env)->GetDirectBufferCapacity(env, buffer);
+		(*env)->DeleteLocalRef(env, buffer);
+		if ((NULL == planes[i]) || (0 > capacity) || (0 > values[i])) {
+			throw_IllegalArgumentException(env, "'planes' have to be direct buffers.");
+			return 0;
+		}
+		strides[i] = values[i];
+		sizes[i] = (capacity < UINT32_MAX) ? (uint32_t)capacity : UINT32_MAX;
+	}
+
+	result = uvcc_capture_frame_planes(TO_HANDLE(handle), planes, strides, sizes, &info);
+	if (INVALID_ARGUMENTS == result) {
+		throw_IllegalArgumentException(env, "A plane is missing or too small for the frame.");
+		return 0;
+	} else if (NOERROR != result) {
+		throw_capture_error(env, result);
+		return 0;
+	}
+	return info.bytesused;
+}
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_UVCCamera
+ * Method:    n_captureBurst
+ * Signature: (JLjava/nio/ByteBuffer;I[Lnet/crimsonwoods/android/libs/uvccap/FrameInfo;)I
+ */
+JNIEXPORT jint JNICALL Java_net_crimsonwoods_android_libs_uvccap_UVCCamera_n_1captureBurst
+  (JNIEnv *env, jobject thiz, jlong handle, jobject dst, jint count, jobjectArray infos)
+{
+	uvcc_burst_frame_t *frames;
+	uint32_t const slot = uvcc_get_burst_slot_size(TO_HANDLE(handle));
+	void *ptr;
+	jlong size;
+	jint gaps = 0;
+	jint i;
+	int result;
+
+	if ((NULL == dst) || (NULL == infos)) {
+		throw_IllegalArgumentException(env, "'dst' and 'infos' have to be set not null.");
+		return 0;
+	}
+	if ((0 >= count) || ((*env)->GetArrayLength(env, infos) < count)) {
+		throw_IllegalArgumentException(env, "'count' is out of range.");
+		return 0;
+	}
+	ptr  = (*env)->GetDirectBufferAddress(env, dst);
+	size = (*env)->GetDirectBufferCapacity(env, dst);
+	if ((NULL == ptr) || (size < 0)) {
+		throw_IllegalArgumentException(env, "'dst' have to be direct buffer.");
+		return 0;
+	}
+	if (size < (jlong)slot * count) {
+		throw_IllegalArgumentException(env, "'dst' is smaller than count slots.");
+		return 0;
+	}
+
+	jclass info_cls = (*env)->FindClass(env, "net/crimsonwoods/android/libs/uvccap/FrameInfo");
+	if (NULL == info_cls) {
+		// ClassNotFoundException will throw by JVM.
+		return 0;
+	}
+	jmethodID ctor = (*env)->GetMethodID(env, info_cls, "<init>", "()V");
+	jfieldID field_offset    = (*env)->GetFieldID(env, info_cls, "offset", "I");
+	jfieldID field_length    = (*env)->GetFieldID(env, info_cls, "length", "I");
+	jfieldID field_sequence  = (*env)->GetFieldID(env, info_cls, "sequence", "I");
+	jfieldID field_timestamp = (*env)->GetFieldID(env, info_cls, "timestampUs", "J");
+	jfieldID field_gap       = (*env)->GetFieldID(env, info_cls, "gap", "I");
+	if (!ctor || !field_offset || !field_length || !field_sequence || !field_timestamp || !field_gap) {
+		(*env)->DeleteLocalRef(env, info_cls);
+		return 0;
+	}
+
+	frames = (uvcc_burst_frame_t*)malloc(sizeof(uvcc_burst_frame_t) * count);
+	if (NULL == frames) {
+		(*env)->DeleteLocalRef(env, info_cls);
+		throw_RuntimeException(env, "Insufficient memory.");
+		return 0;
+	}
+
+	result = uvcc_capture_burst(TO_HANDLE(handle), (uint8_t*)ptr, (size_t)size, count, frames);
+	if (NOERROR != result) {
+		free(frames);
+		(*env)->DeleteLocalRef(env, info_cls);
+		throw_capture_error(env, result);
+		return 0;
 	}
+
+	for (i = 0; i < count; ++i) {
+		jobject info = (*env)->GetObjectArrayElement(env, infos, i);
+		if (NULL == info) {
+			info = (*env)->NewObject(env, info_cls, ctor);
+			if (NULL == info) {
+				break;
+			}
+			(*env)->SetObjectArrayElement(env, infos, i, info);
+		}
+		(*env)->SetIntField(env, info, field_offset, (jint)(slot * i));
+		(*env)->SetIntField(env, info, field_length, frames[i].info.bytesused);
+		(*env)->SetIntField(env, info, field_sequence, frames[i].info.sequence);
+		(*env)->SetLongField(env, info, field_timestamp, frames[i].info.timestamp_us);
+		(*env)->SetIntField(env, info, field_gap, frames[i].gap);
+		(*env)->DeleteLocalRef(env, info);
+		gaps += frames[i].gap;
+	}
+
+	free(frames);
+	(*env)->DeleteLocalRef(env, info_cls);
+	return gaps;
+}
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_UVCCamera
+ * Method:    n_getBurstSlotSize
+ * Signature: (J)I
+ */
+JNIEXPORT jint JNICALL Java_net_crimsonwoods_android_libs_uvccap_UVCCamera_n_1getBurstSlotSize
+  (JNIEnv *env, jobject thiz, jlong handle)
+{
+	return uvcc_get_burst_slot_size(TO_HANDLE(handle));
 }
 
 /*
@@ -201,6 +525,491 @@ JNIEXPORT jobject JNICALL Java_net_crimsonwoods_android_libs_uvccap_UVCCamera_n_
 	return ret;
 }
 
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_UVCCamera
+ * Method:    n_initBest
+ * Signature: (JIIII)Lnet/crimsonwoods/android/libs/uvccap/UVCCamera/StreamMode;
+ */
+JNIEXPORT jobject JNICALL Java_net_crimsonwoods_android_libs_uvccap_UVCCamera_n_1initBest
+  (JNIEnv *env, jobject thiz, jlong handle, jint width, jint height, jint fps, jint pixfmt)
+{
+	uvcc_stream_mode_t mode;
+	int result = NOERROR;
+	LOGD("initBest(width=%d, height=%d, fps=%d, pixfmt=%d)", width, height, fps, pixfmt);
+	result = uvcc_init_best_video_device(TO_HANDLE(handle), width, height, fps, pixfmt, &mode);
+	if (NOERROR != result) {
+		throw_RuntimeException(env, "Video device can't init.");
+		return NULL;
+	}
+	jclass cls = (*env)->FindClass(env, "net/crimsonwoods/android/libs/uvccap/UVCCamera$StreamMode");
+	if (NULL == cls) {
+		// ClassNotFoundException will throw by JVM.
+		return NULL;
+	}
+	jmethodID ctor = (*env)->GetMethodID(env, cls, "<init>", "()V");
+	if (NULL == ctor) {
+		(*env)->DeleteLocalRef(env, cls);
+		return NULL;
+	}
+	jfieldID field_fmt = (*env)->GetFieldID(env, cls, "format", "I");
+	jfieldID field_w   = (*env)->GetFieldID(env, cls, "width", "I");
+	jfieldID field_h   = (*env)->GetFieldID(env, cls, "height", "I");
+	jfieldID field_num = (*env)->GetFieldID(env, cls, "intervalNumerator", "I");
+	jfieldID field_den = (*env)->GetFieldID(env, cls, "intervalDenominator", "I");
+	jfieldID field_tc  = (*env)->GetFieldID(env, cls, "transferCost", "I");
+	jfieldID field_cc  = (*env)->GetFieldID(env, cls, "conversionCost", "I");
+	if (!field_fmt || !field_w || !field_h || !field_num || !field_den || !field_tc || !field_cc) {
+		(*env)->DeleteLocalRef(env, cls);
+		return NULL;
+	}
+	jobject ret = (*env)->NewObject(env, cls, ctor);
+	if (NULL != ret) {
+		(*env)->SetIntField(env, ret, field_fmt, mode.pixel_format);
+		(*env)->SetIntField(env, ret, field_w,   mode.width);
+		(*env)->SetIntField(env, ret, field_h,   mode.height);
+		(*env)->SetIntField(env, ret, field_num, mode.interval_numerator);
+		(*env)->SetIntField(env, ret, field_den, mode.interval_denominator);
+		(*env)->SetIntField(env, ret, field_tc,  mode.transfer_cost);
+		(*env)->SetIntField(env, ret, field_cc,  mode.conversion_cost);
+	}
+	return ret;
+}
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_UVCCamera
+ * Method:    n_reconfigure
+ * Signature: (JIII)Lnet/crimsonwoods/android/libs/uvccap/UVCCamera/ReconfigureStats;
+ */
+JNIEXPORT jobject JNICALL Java_net_crimsonwoods_android_libs_uvccap_UVCCamera_n_1reconfigure
+  (JNIEnv *env, jobject thiz, jlong handle, jint width, jint height, jint pixfmt)
+{
+	uvcc_reconfigure_stats_t stats;
+	int result = NOERROR;
+	LOGD("reconfigure(width=%d, height=%d, pixfmt=%d)", width, height, pixfmt);
+	result = uvcc_reconfigure(TO_HANDLE(handle), width, height, pixfmt, &stats);
+	if (NOERROR != result) {
+		throw_RuntimeException(env, "Video device can't be reconfigured.");
+		return NULL;
+	}
+	jclass cls = (*env)->FindClass(env, "net/crimsonwoods/android/libs/uvccap/UVCCamera$ReconfigureStats");
+	if (NULL == cls) {
+		// ClassNotFoundException will throw by JVM.
+		return NULL;
+	}
+	jmethodID ctor = (*env)->GetMethodID(env, cls, "<init>", "()V");
+	if (NULL == ctor) {
+		(*env)->DeleteLocalRef(env, cls);
+		return NULL;
+	}
+	jfieldID field_stop   = (*env)->GetFieldID(env, cls, "stopMicros", "I");
+	jfieldID field_format = (*env)->GetFieldID(env, cls, "formatMicros", "I");
+	jfieldID field_buffer = (*env)->GetFieldID(env, cls, "bufferMicros", "I");
+	jfieldID field_start  = (*env)->GetFieldID(env, cls, "startMicros", "I");
+	jfieldID field_total  = (*env)->GetFieldID(env, cls, "totalMicros", "I");
+	jfieldID field_reused = (*env)->GetFieldID(env, cls, "buffersReused", "Z");
+	if (!field_stop || !field_format || !field_buffer || !field_start || !field_total || !field_reused) {
+		(*env)->DeleteLocalRef(env, cls);
+		return NULL;
+	}
+	jobject ret = (*env)->NewObject(env, cls, ctor);
+	if (NULL != ret) {
+		(*env)->SetIntField(env, ret, field_stop,   stats.stop_us);
+		(*env)->SetIntField(env, ret, field_format, stats.format_us);
+		(*env)->SetIntField(env, ret, field_buffer, stats.buffer_us);
+		(*env)->SetIntField(env, ret, field_start,  stats.start_us);
+		(*env)->SetIntField(env, ret, field_total,  stats.total_us);
+		(*env)->SetBooleanField(env, ret, field_reused, (0 != stats.buffers_reused) ? JNI_TRUE : JNI_FALSE);
+	}
+	return ret;
+}
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_UVCCamera
+ * Method:    n_suspend
+ * Signature: (JZ)V
+ */
+JNIEXPORT void JNICALL Java_net_crimsonwoods_android_libs_uvccap_UVCCamera_n_1suspend
+  (JNIEnv *env, jobject thiz, jlong handle, jboolean release_buffers)
+{
+	if (NOERROR != uvcc_suspend_capture(TO_HANDLE(handle), JNI_FALSE != release_buffers)) {
+		throw_RuntimeException(env, "Capture can't be suspended.");
+	}
+}
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_UVCCamera
+ * Method:    n_getIdleStats
+ * Signature: (J)Lnet/crimsonwoods/android/libs/uvccap/UVCCamera/IdleStats;
+ */
+JNIEXPORT jobject JNICALL Java_net_crimsonwoods_android_libs_uvccap_UVCCamera_n_1getIdleStats
+  (JNIEnv *env, jobject thiz, jlong handle)
+{
+	uvcc_idle_stats_t stats;
+	if (NOERROR != uvcc_get_idle_stats(TO_HANDLE(handle), &stats)) {
+		throw_IllegalArgumentException(env, "Invalid handle.");
+		return NULL;
+	}
+	jclass cls = (*env)->FindClass(env, "net/crimsonwoods/android/libs/uvccap/UVCCamera$IdleStats");
+	if (NULL == cls) {
+		// ClassNotFoundException will throw by JVM.
+		return NULL;
+	}
+	jmethodID ctor = (*env)->GetMethodID(env, cls, "<init>", "()V");
+	if (NULL == ctor) {
+		(*env)->DeleteLocalRef(env, cls);
+		return NULL;
+	}
+	jfieldID field_suspends  = (*env)->GetFieldID(env, cls, "suspendCount", "I");
+	jfieldID field_resumes   = (*env)->GetFieldID(env, cls, "resumeCount", "I");
+	jfieldID field_last      = (*env)->GetFieldID(env, cls, "lastResumeMicros", "I");
+	jfieldID field_max       = (*env)->GetFieldID(env, cls, "maxResumeMicros", "I");
+	jfieldID field_suspended = (*env)->GetFieldID(env, cls, "suspended", "Z");
+	jfieldID field_released  = (*env)->GetFieldID(env, cls, "buffersReleased", "Z");
+	if (!field_suspends || !field_resumes || !field_last || !field_max || !field_suspended || !field_released) {
+		(*env)->DeleteLocalRef(env, cls);
+		return NULL;
+	}
+	jobject ret = (*env)->NewObject(env, cls, ctor);
+	if (NULL != ret) {
+		(*env)->SetIntField(env, ret, field_suspends, stats.suspend_count);
+		(*env)->SetIntField(env, ret, field_resumes,  stats.resume_count);
+		(*env)->SetIntField(env, ret, field_last,     stats.last_resume_us);
+		(*env)->SetIntField(env, ret, field_max,      stats.max_resume_us);
+		(*env)->SetBooleanField(env, ret, field_suspended, (0 != stats.is_suspended) ? JNI_TRUE : JNI_FALSE);
+		(*env)->SetBooleanField(env, ret, field_released,  (0 != stats.buffers_released) ? JNI_TRUE : JNI_FALSE);
+	}
+	return ret;
+}
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_UVCCamera
+ * Method:    n_reconnect
+ * Signature: (JI)V
+ */
+JNIEXPORT void JNICALL Java_net_crimsonwoods_android_libs_uvccap_UVCCamera_n_1reconnect
+  (JNIEnv *env, jobject thiz, jlong handle, jint timeout)
+{
+	if (0 > timeout) {
+		throw_IllegalArgumentException(env, "'timeout' have to be 0 or positive.");
+		return;
+	}
+	if (NOERROR != uvcc_reconnect(TO_HANDLE(handle), timeout)) {
+		throw_IOException(env, "Video device can't be reconnected.");
+	}
+}
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_UVCCamera
+ * Method:    n_setAutoReconnect
+ * Signature: (JI)V
+ */
+JNIEXPORT void JNICALL Java_net_crimsonwoods_android_libs_uvccap_UVCCamera_n_1setAutoReconnect
+  (JNIEnv *env, jobject thiz, jlong handle, jint timeout)
+{
+	if (0 > timeout) {
+		throw_IllegalArgumentException(env, "'timeout' have to be 0 or positive.");
+		return;
+	}
+	uvcc_set_auto_reconnect(TO_HANDLE(handle), timeout);
+}
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_UVCCamera
+ * Method:    n_getReconnectStats
+ * Signature: (J)Lnet/crimsonwoods/android/libs/uvccap/UVCCamera/ReconnectStats;
+ */
+JNIEXPORT jobject JNICALL Java_net_crimsonwoods_android_libs_uvccap_UVCCamera_n_1getReconnectStats
+  (JNIEnv *env, jobject thiz, jlong handle)
+{
+	uvcc_reconnect_stats_t stats;
+	if (NOERROR != uvcc_get_reconnect_stats(TO_HANDLE(handle), &stats)) {
+		throw_IllegalArgumentException(env, "Invalid handle.");
+		return NULL;
+	}
+	jclass cls = (*env)->FindClass(env, "net/crimsonwoods/android/libs/uvccap/UVCCamera$ReconnectStats");
+	if (NULL == cls) {
+		// ClassNotFoundException will throw by JVM.
+		return NULL;
+	}
+	jmethodID ctor = (*env)->GetMethodID(env, cls, "<init>", "()V");
+	if (NULL == ctor) {
+		(*env)->DeleteLocalRef(env, cls);
+		return NULL;
+	}
+	jfieldID field_count = (*env)->GetFieldID(env, cls, "reconnectCount", "I");
+	jfieldID field_failed = (*env)->GetFieldID(env, cls, "failedCount", "I");
+	jfieldID field_last  = (*env)->GetFieldID(env, cls, "lastDowntimeMicros", "I");
+	jfieldID field_max   = (*env)->GetFieldID(env, cls, "maxDowntimeMicros", "I");
+	jfieldID field_total = (*env)->GetFieldID(env, cls, "totalDowntimeMicros", "J");
+	if (!field_count || !field_failed || !field_last || !field_max || !field_total) {
+		(*env)->DeleteLocalRef(env, cls);
+		return NULL;
+	}
+	jobject ret = (*env)->NewObject(env, cls, ctor);
+	if (NULL != ret) {
+		(*env)->SetIntField(env, ret, field_count,  stats.reconnect_count);
+		(*env)->SetIntField(env, ret, field_failed, stats.failed_count);
+		(*env)->SetIntField(env, ret, field_last,   stats.last_downtime_us);
+		(*env)->SetIntField(env, ret, field_max,    stats.max_downtime_us);
+		(*env)->SetLongField(env, ret, field_total, (jlong)stats.total_downtime_us);
+	}
+	return ret;
+}
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_UVCCamera
+ * Method:    n_enableTrace
+ * Signature: (JI)V
+ */
+JNIEXPORT void JNICALL Java_net_crimsonwoods_android_libs_uvccap_UVCCamera_n_1enableTrace
+  (JNIEnv *env, jobject thiz, jlong handle, jint capacity)
+{
+	if (capacity <= 0) {
+		throw_IllegalArgumentException(env, "'capacity' have to be positive.");
+		return;
+	}
+	if (NOERROR != uvcc_enable_trace(TO_HANDLE(handle), capacity)) {
+		throw_RuntimeException(env, "Trace can't be enabled.");
+	}
+}
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_UVCCamera
+ * Method:    n_traceConvertDone
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_net_crimsonwoods_android_libs_uvccap_UVCCamera_n_1traceConvertDone
+  (JNIEnv *env, jobject thiz, jlong handle)
+{
+	uvcc_trace_event(TO_HANDLE(handle), UVCC_TRACE_CONVERT_DONE, 0);
+}
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_UVCCamera
+ * Method:    n_dumpTrace
+ * Signature: (JLjava/lang/String;)V
+ */
+JNIEXPORT void JNICALL Java_net_crimsonwoods_android_libs_uvccap_UVCCamera_n_1dumpTrace
+  (JNIEnv *env, jobject thiz, jlong handle, jstring path)
+{
+	char const *nativePath = NULL;
+	int result = NOERROR;
+
+	if (NULL == path) {
+		throw_IllegalArgumentException(env, "'path' have to be set not null.");
+		return;
+	}
+
+	nativePath = (*env)->GetStringUTFChars(env, path, 0);
+
+	result = uvcc_dump_trace(TO_HANDLE(handle), nativePath);
+
+	(*env)->ReleaseStringUTFChars(env, path, nativePath);
+
+	if (INVALID_STATUS == result) {
+		throw_RuntimeException(env, "Trace is not enabled.");
+	} else if (NOERROR != result) {
+		throw_IOException(env, "Trace can't be written.");
+	}
+}
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_UVCCamera
+ * Method:    n_setCacheDirectory
+ * Signature: (Ljava/lang/String;)V
+ */
+JNIEXPORT void JNICALL Java_net_crimsonwoods_android_libs_uvccap_UVCCamera_n_1setCacheDirectory
+  (JNIEnv *env, jclass cls, jstring path)
+{
+	char const *nativePath = NULL;
+	int result = NOERROR;
+
+	if (NULL == path) {
+		uvcc_set_cache_directory(NULL);
+		return;
+	}
+
+	nativePath = (*env)->GetStringUTFChars(env, path, 0);
+
+	result = uvcc_set_cache_directory(nativePath);
+
+	(*env)->ReleaseStringUTFChars(env, path, nativePath);
+
+	if (NOERROR != result) {
+		throw_RuntimeException(env, "Cache directory can't be set.");
+	}
+}
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_UVCCamera
+ * Method:    n_invalidateCapabilityCache
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_net_crimsonwoods_android_libs_uvccap_UVCCamera_n_1invalidateCapabilityCache
+  (JNIEnv *env, jobject thiz, jlong handle)
+{
+	if (NOERROR != uvcc_invalidate_capability_cache(TO_HANDLE(handle))) {
+		LOGW("Capability cache can't be removed.");
+	}
+}
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_UVCCamera
+ * Method:    n_createPump
+ * Signature: (J)J
+ */
+JNIEXPORT jlong JNICALL Java_net_crimsonwoods_android_libs_uvccap_UVCCamera_n_1createPump
+  (JNIEnv *env, jobject thiz, jlong handle)
+{
+	uvcc_pump_t *pump = NULL;
+	if (NOERROR != uvcc_pump_create(TO_HANDLE(handle), &pump)) {
+		throw_RuntimeException(env, "Frame pump can't be created.");
+		return 0;
+	}
+	return (jlong)(intptr_t)pump;
+}
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_UVCCamera
+ * Method:    n_destroyPump
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_net_crimsonwoods_android_libs_uvccap_UVCCamera_n_1destroyPump
+  (JNIEnv *env, jobject thiz, jlong pump)
+{
+	uvcc_pump_destroy((uvcc_pump_t*)(intptr_t)pump);
+}
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_UVCCamera
+ * Method:    n_subscribe
+ * Signature: (JIII)J
+ */
+JNIEXPORT jlong JNICALL Java_net_crimsonwoods_android_libs_uvccap_UVCCamera_n_1subscribe
+  (JNIEnv *env, jobject thiz, jlong pump, jint policy, jint interval, jint depth)
+{
+	uvcc_subscriber_t *sub = NULL;
+	int result;
+	if ((0 >= depth) || (0 > interval)) {
+		throw_IllegalArgumentException(env, "'depth' and 'interval' have to be positive.");
+		return 0;
+	}
+	result = uvcc_pump_subscribe((uvcc_pump_t*)(intptr_t)pump, (uvcc_delivery_policy_t)policy, interval, depth, &sub);
+	if (INVALID_ARGUMENTS == result) {
+		throw_IllegalArgumentException(env, "Unsupported delivery policy.");
+		return 0;
+	} else if (NOERROR != result) {
+		throw_RuntimeException(env, "Subscriber can't be created.");
+		return 0;
+	}
+	return (jlong)(intptr_t)sub;
+}
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_UVCCamera
+ * Method:    n_unsubscribe
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_net_crimsonwoods_android_libs_uvccap_UVCCamera_n_1unsubscribe
+  (JNIEnv *env, jobject thiz, jlong sub)
+{
+	uvcc_pump_unsubscribe((uvcc_subscriber_t*)(intptr_t)sub);
+}
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_UVCCamera
+ * Method:    n_publish
+ * Signature: (JJ)I
+ */
+JNIEXPORT jint JNICALL Java_net_crimsonwoods_android_libs_uvccap_UVCCamera_n_1publish
+  (JNIEnv *env, jobject thiz, jlong handle, jlong ring)
+{
+	uvcc_shm_publisher_t *pub = (uvcc_shm_publisher_t*)(intptr_t)ring;
+	uvcc_frame_t frame;
+	int result;
+
+	result = uvcc_dequeue_frame(TO_HANDLE(handle), &frame);
+	if (NOERROR != result) {
+		throw_capture_error(env, result);
+		return -1;
+	}
+	result = uvcc_shm_publish(pub, &frame,
+		uvcc_get_frame_width(TO_HANDLE(handle)),
+		uvcc_get_frame_height(TO_HANDLE(handle)),
+		uvcc_get_pixel_format(TO_HANDLE(handle)));
+	uvcc_release_frame(TO_HANDLE(handle), &frame);
+	if (NOERROR != result) {
+		throw_IllegalArgumentException(env, "Frame does not fit in the ring slots.");
+		return -1;
+	}
+	return frame.info.sequence;
+}
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_UVCCamera
+ * Method:    n_setPumpThreadPolicy
+ * Signature: (J[I[I)V
+ */
+JNIEXPORT void JNICALL Java_net_crimsonwoods_android_libs_uvccap_UVCCamera_n_1setPumpThreadPolicy
+  (JNIEnv *env, jobject thiz, jlong pump, jintArray policy_array, jintArray applied_array)
+{
+	uvcc_thread_policy_t policy;
+	uvcc_thread_policy_t applied;
+
+	if (!get_thread_policy(env, policy_array, &policy)) {
+		return;
+	}
+	// a pump stopped by an error reports nothing applied, its subscribers see the error.
+	uvcc_pump_set_thread_policy((uvcc_pump_t*)(intptr_t)pump, &policy, &applied);
+	set_thread_policy(env, applied_array, &applied);
+}
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_UVCCamera
+ * Method:    n_setBufferLocking
+ * Signature: (JZ)Z
+ */
+JNIEXPORT jboolean JNICALL Java_net_crimsonwoods_android_libs_uvccap_UVCCamera_n_1setBufferLocking
+  (JNIEnv *env, jobject thiz, jlong handle, jboolean enable)
+{
+	int locked = 0;
+	if (NOERROR != uvcc_set_buffer_locking(TO_HANDLE(handle), enable ? 1 : 0, &locked)) {
+		throw_RuntimeException(env, "Buffer locking can't be changed.");
+		return JNI_FALSE;
+	}
+	return locked ? JNI_TRUE : JNI_FALSE;
+}
+
+// ThreadPolicy travels as {flags, cpuMask, fifoPriority, nice}.
+static int get_thread_policy(JNIEnv *env, jintArray array, uvcc_thread_policy_t *policy) {
+	jint values[4];
+
+	if ((NULL == array) || (4 > (*env)->GetArrayLength(env, array))) {
+		throw_IllegalArgumentException(env, "Thread policy have to be 4 values.");
+		return 0;
+	}
+	(*env)->GetIntArrayRegion(env, array, 0, 4, values);
+	policy->flags         = (uint32_t)values[0];
+	policy->cpu_mask      = (uint32_t)values[1];
+	policy->fifo_priority = values[2];
+	policy->nice          = values[3];
+	return 1;
+}
+
+static void set_thread_policy(JNIEnv *env, jintArray array, uvcc_thread_policy_t const *policy) {
+	jint values[4];
+
+	if ((NULL == array) || (4 > (*env)->GetArrayLength(env, array))) {
+		throw_IllegalArgumentException(env, "Thread policy have to be 4 values.");
+		return;
+	}
+	values[0] = (jint)policy->flags;
+	values[1] = (jint)policy->cpu_mask;
+	values[2] = policy->fifo_priority;
+	values[3] = policy->nice;
+	(*env)->SetIntArrayRegion(env, array, 0, 4, values);
+}
+
 static void throw_exception(JNIEnv *env, char const * const cls, char const * const message) {
 	jclass ioe_cls = (*env)->FindClass(env, cls);
 	if (NULL == ioe_cls) {
@@ -218,3 +1027,15 @@ static void throw_RuntimeException(JNIEnv *env, char const * const message) {
 	throw_exception(env, "java/lang/RuntimeException", message);
 }
 
+static void throw_IllegalArgumentException(JNIEnv *env, char const * const message) {
+	throw_exception(env, "java/lang/IllegalArgumentException", message);
+}
+
+static void throw_capture_error(JNIEnv *env, int result) {
+	if (VIDEO_DEVICE_DISCONNECTED == result) {
+		throw_exception(env, "net/crimsonwoods/android/libs/uvccap/DeviceDisconnectedException", "Video device is disconnected.");
+	} else {
+		throw_RuntimeException(env, "Capture failed.");
+	}
+}
+
@@ -39,6 +39,14 @@ JNIEXPORT jint JNICALL Java_net_crimsonwoods_android_libs_uvccap_UVCCamera_n_1ge
 JNIEXPORT jint JNICALL Java_net_crimsonwoods_android_libs_uvccap_UVCCamera_n_1getHeight
   (JNIEnv *, jobject, jlong);
 
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_UVCCamera
+ * Method:    n_getStride
+ * Signature: (JI)I
+ */
+JNIEXPORT jint JNICALL Java_net_crimsonwoods_android_libs_uvccap_UVCCamera_n_1getStride
+  (JNIEnv *, jobject, jlong, jint);
+
 /*
  * Class:     net_crimsonwoods_android_libs_uvccap_UVCCamera
  * Method:    n_open
@@ -66,11 +74,59 @@ JNIEXPORT void JNICALL Java_net_crimsonwoods_android_libs_uvccap_UVCCamera_n_1cl
 /*
  * Class:     net_crimsonwoods_android_libs_uvccap_UVCCamera
  * Method:    n_capture
- * Signature: (J[B)V
+ * Signature: (J[B)I
  */
-JNIEXPORT void JNICALL Java_net_crimsonwoods_android_libs_uvccap_UVCCamera_n_1capture
+JNIEXPORT jint JNICALL Java_net_crimsonwoods_android_libs_uvccap_UVCCamera_n_1capture
   (JNIEnv *, jobject, jlong, jbyteArray);
 
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_UVCCamera
+ * Method:    n_captureDirect
+ * Signature: (JLjava/nio/ByteBuffer;)I
+ */
+JNIEXPORT jint JNICALL Java_net_crimsonwoods_android_libs_uvccap_UVCCamera_n_1captureDirect
+  (JNIEnv *, jobject, jlong, jobject);
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_UVCCamera
+ * Method:    n_captureDirectStats
+ * Signature: (JLjava/nio/ByteBuffer;Lnet/crimsonwoods/android/libs/uvccap/FrameStats;)I
+ */
+JNIEXPORT jint JNICALL Java_net_crimsonwoods_android_libs_uvccap_UVCCamera_n_1captureDirectStats
+  (JNIEnv *, jobject, jlong, jobject, jobject);
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_UVCCamera
+ * Method:    n_captureStrided
+ * Signature: (J[B[I)I
+ */
+JNIEXPORT jint JNICALL Java_net_crimsonwoods_android_libs_uvccap_UVCCamera_n_1captureStrided
+  (JNIEnv *, jobject, jlong, jbyteArray, jintArray);
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_UVCCamera
+ * Method:    n_capturePlanes
+ * Signature: (J[Ljava/nio/ByteBuffer;[I)I
+ */
+JNIEXPORT jint JNICALL Java_net_crimsonwoods_android_libs_uvccap_UVCCamera_n_1capturePlanes
+  (JNIEnv *, jobject, jlong, jobjectArray, jintArray);
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_UVCCamera
+ * Method:    n_captureBurst
+ * Signature: (JLjava/nio/ByteBuffer;I[Lnet/crimsonwoods/android/libs/uvccap/FrameInfo;)I
+ */
+JNIEXPORT jint JNICALL Java_net_crimsonwoods_android_libs_uvccap_UVCCamera_n_1captureBurst
+  (JNIEnv *, jobject, jlong, jobject, jint, jobjectArray);
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_UVCCamera
+ * Method:    n_getBurstSlotSize
+ * Signature: (J)I
+ */
+JNIEXPORT jint JNICALL Java_net_crimsonwoods_android_libs_uvccap_UVCCamera_n_1getBurstSlotSize
+  (JNIEnv *, jobject, jlong);
+
 /*
  * Class:     net_crimsonwoods_android_libs_uvccap_UVCCamera
  * Method:    n_start
@@ -95,6 +151,158 @@ JNIEXPORT void JNICALL Java_net_crimsonwoods_android_libs_uvccap_UVCCamera_n_1st
 JNIEXPORT jobject JNICALL Java_net_crimsonwoods_android_libs_uvccap_UVCCamera_n_1enumFrameSize
   (JNIEnv *, jobject, jlong, jint, jint);
 
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_UVCCamera
+ * Method:    n_initBest
+ * Signature: (JIIII)Lnet/crimsonwoods/android/libs/uvccap/UVCCamera/StreamMode;
+ */
+JNIEXPORT jobject JNICALL Java_net_crimsonwoods_android_libs_uvccap_UVCCamera_n_1initBest
+  (JNIEnv *, jobject, jlong, jint, jint, jint, jint);
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_UVCCamera
+ * Method:    n_reconfigure
+ * Signature: (JIII)Lnet/crimsonwoods/android/libs/uvccap/UVCCamera/ReconfigureStats;
+ */
+JNIEXPORT jobject JNICALL Java_net_crimsonwoods_android_libs_uvccap_UVCCamera_n_1reconfigure
+  (JNIEnv *, jobject, jlong, jint, jint, jint);
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_UVCCamera
+ * Method:    n_suspend
+ * Signature: (JZ)V
+ */
+JNIEXPORT void JNICALL Java_net_crimsonwoods_android_libs_uvccap_UVCCamera_n_1suspend
+  (JNIEnv *, jobject, jlong, jboolean);
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_UVCCamera
+ * Method:    n_getIdleStats
+ * Signature: (J)Lnet/crimsonwoods/android/libs/uvccap/UVCCamera/IdleStats;
+ */
+JNIEXPORT jobject JNICALL Java_net_crimsonwoods_android_libs_uvccap_UVCCamera_n_1getIdleStats
+  (JNIEnv *, jobject, jlong);
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_UVCCamera
+ * Method:    n_reconnect
+ * Signature: (JI)V
+ */
+JNIEXPORT void JNICALL Java_net_crimsonwoods_android_libs_uvccap_UVCCamera_n_1reconnect
+  (JNIEnv *, jobject, jlong, jint);
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_UVCCamera
+ * Method:    n_setAutoReconnect
+ * Signature: (JI)V
+ */
+JNIEXPORT void JNICALL Java_net_crimsonwoods_android_libs_uvccap_UVCCamera_n_1setAutoReconnect
+  (JNIEnv *, jobject, jlong, jint);
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_UVCCamera
+ * Method:    n_getReconnectStats
+ * Signature: (J)Lnet/crimsonwoods/android/libs/uvccap/UVCCamera/ReconnectStats;
+ */
+JNIEXPORT jobject JNICALL Java_net_crimsonwoods_android_libs_uvccap_UVCCamera_n_1getReconnectStats
+  (JNIEnv *, jobject, jlong);
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_UVCCamera
+ * Method:    n_enableTrace
+ * Signature: (JI)V
+ */
+JNIEXPORT void JNICALL Java_net_crimsonwoods_android_libs_uvccap_UVCCamera_n_1enableTrace
+  (JNIEnv *, jobject, jlong, jint);
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_UVCCamera
+ * Method:    n_traceConvertDone
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_net_crimsonwoods_android_libs_uvccap_UVCCamera_n_1traceConvertDone
+  (JNIEnv *, jobject, jlong);
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_UVCCamera
+ * Method:    n_dumpTrace
+ * Signature: (JLjava/lang/String;)V
+ */
+JNIEXPORT void JNICALL Java_net_crimsonwoods_android_libs_uvccap_UVCCamera_n_1dumpTrace
+  (JNIEnv *, jobject, jlong, jstring);
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_UVCCamera
+ * Method:    n_setCacheDirectory
+ * Signature: (Ljava/lang/String;)V
+ */
+JNIEXPORT void JNICALL Java_net_crimsonwoods_android_libs_uvccap_UVCCamera_n_1setCacheDirectory
+  (JNIEnv *, jclass, jstring);
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_UVCCamera
+ * Method:    n_invalidateCapabilityCache
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_net_crimsonwoods_android_libs_uvccap_UVCCamera_n_1invalidateCapabilityCache
+  (JNIEnv *, jobject, jlong);
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_UVCCamera
+ * Method:    n_createPump
+ * Signature: (J)J
+ */
+JNIEXPORT jlong JNICALL Java_net_crimsonwoods_android_libs_uvccap_UVCCamera_n_1createPump
+  (JNIEnv *, jobject, jlong);
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_UVCCamera
+ * Method:    n_destroyPump
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_net_crimsonwoods_android_libs_uvccap_UVCCamera_n_1destroyPump
+  (JNIEnv *, jobject, jlong);
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_UVCCamera
+ * Method:    n_subscribe
+ * Signature: (JIII)J
+ */
+JNIEXPORT jlong JNICALL Java_net_crimsonwoods_android_libs_uvccap_UVCCamera_n_1subscribe
+  (JNIEnv *, jobject, jlong, jint, jint, jint);
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_UVCCamera
+ * Method:    n_unsubscribe
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_net_crimsonwoods_android_libs_uvccap_UVCCamera_n_1unsubscribe
+  (JNIEnv *, jobject, jlong);
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_UVCCamera
+ * Method:    n_publish
+ * Signature: (JJ)I
+ */
+JNIEXPORT jint JNICALL Java_net_crimsonwoods_android_libs_uvccap_UVCCamera_n_1publish
+  (JNIEnv *, jobject, jlong, jlong);
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_UVCCamera
+ * Method:    n_setPumpThreadPolicy
+ * Signature: (J[I[I)V
+ */
+JNIEXPORT void JNICALL Java_net_crimsonwoods_android_libs_uvccap_UVCCamera_n_1setPumpThreadPolicy
+  (JNIEnv *, jobject, jlong, jintArray, jintArray);
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_UVCCamera
+ * Method:    n_setBufferLocking
+ * Signature: (JZ)Z
+ */
+JNIEXPORT jboolean JNICALL Java_net_crimsonwoods_android_libs_uvccap_UVCCamera_n_1setBufferLocking
+  (JNIEnv *, jobject, jlong, jboolean);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,228 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+
+#include "uvccap.h"
+#include "uvcccache.h"
+
+#define CACHE_MAGIC   0x43435655 // "UVCC"
+#define CACHE_VERSION 1
+
+#define FNV_OFFSET 2166136261u
+#define FNV_PRIME  16777619u
+
+static uint32_t fnv1a(uint32_t hash, void const *data, size_t size) {
+	uint8_t const *p = (uint8_t const*)data;
+	size_t i;
+	for (i = 0; i < size; ++i) {
+		hash = (hash ^ p[i]) * FNV_PRIME;
+	}
+	return hash;
+}
+
+static int make_path(char *path, size_t size, char const *dir, void const *key, uint32_t key_size) {
+	int n = snprintf(path, size, "%s/uvcc-%08x.cache", dir, fnv1a(FNV_OFFSET, key, key_size));
+	return ((n < 0) || ((size_t)n >= size)) ? INVALID_ARGUMENTS : NOERROR;
+}
+
+static int read_u32(FILE *fp, uint32_t *value, uint32_t *hash) {
+	if (1 != fread(value, sizeof(*value), 1, fp)) {
+		return IO_ERROR;
+	}
+	*hash = fnv1a(*hash, value, sizeof(*value));
+	return NOERROR;
+}
+
+static int write_block(FILE *fp, void const *data, uint32_t size, uint32_t *hash) {
+	if ((0 != size) && (1 != fwrite(data, size, 1, fp))) {
+		return IO_ERROR;
+	}
+	*hash = fnv1a(*hash, data, size);
+	return NOERROR;
+}
+
+int uvcc_cache_load(char const *dir, void const *key, uint32_t key_size, uvcc_cache_section_t *sections, int count) {
+	char path[512];
+	FILE *fp;
+	void *stored_key = NULL;
+	uint32_t hash = FNV_OFFSET;
+	uint32_t value, checksum;
+	int result;
+	int i;
+
+	if ((NULL == dir) || (NULL == key) || (NULL == sections) || (0 > count)) {
+		return INVALID_ARGUMENTS;
+	}
+	for (i = 0; i < count; ++i) {
+		sections[i].data = NULL;
+		sections[i].size = 0;
+	}
+
+	result = make_path(path, sizeof(path), dir, key, key_size);
+	if (NOERROR != result) {
+		return result;
+	}
+
+	fp = fopen(path, "rb");
+	if (NULL == fp) {
+		return NO_MORE_DATA;
+	}
+
+	result = read_u32(fp, &value, &hash);
+	if ((NOERROR == result) && (CACHE_MAGIC != value)) {
+		result = IO_ERROR;
+	}
+	if (NOERROR == result) {
+		result = read_u32(fp, &value, &hash);
+		if ((NOERROR == result) && (CACHE_VERSION != value)) {
+			result = IO_ERROR;
+		}
+	}
+	if (NOERROR == result) {
+		result = read_u32(fp, &value, &hash);
+		if ((NOERROR == result) && (key_size != value)) {
+			result = IO_ERROR;
+		}
+	}
+	if (NOERROR == result) {
+		stored_key = malloc(key_size);
+		if (NULL == stored_key) {
+			result = INSUFFICIENT_MEMORY;
+		} else if ((1 != fread(stored_key, key_size, 1, fp)) || (0 != memcmp(stored_key, key, key_size))) {
+			result = IO_ERROR;
+		} else {
+			hash = fnv1a(hash, stored_key, key_size);
+		}
+	}
+	if (NOERROR == result) {
+		result = read_u32(fp, &value, &hash);
+		if ((NOERROR == result) && ((uint32_t)count != value)) {
+			result = IO_ERROR;
+		}
+	}
+	for (i = 0; (NOERROR == result) && (i < count); ++i) {
+		result = read_u32(fp, &sections[i].size, &hash);
+		if ((NOERROR != result) || (0 == sections[i].size)) {
+			continue;
+		}
+		if (sections[i].size > (1u << 24)) {
+			result = IO_ERROR;
+			break;
+		}
+		sections[i].data = malloc(sections[i].size);
+		if (NULL == sections[i].data) {
+			result = INSUFFICIENT_MEMORY;
+		} else if (1 != fread(sections[i].data, sections[i].size, 1, fp)) {
+			result = IO_ERROR;
+		} else {
+			hash = fnv1a(hash, sections[i].data, sections[i].size);
+		}
+	}
+	if (NOERROR == result) {
+		if ((1 != fread(&checksum, sizeof(checksum), 1, fp)) || (checksum != hash)) {
+			result = IO_ERROR;
+		}
+	}
+
+	fclose(fp);
+	free(stored_key);
+
+	if (NOERROR != result) {
+		for (i = 0; i < count; ++i) {
+			free(sections[i].data);
+			sections[i].data = NULL;
+			sections[i].size = 0;
+		}
+	}
+
+	return result;
+}
+
+int uvcc_cache_store(char const *dir, void const *key, uint32_t key_size, uvcc_cache_section_t const *sections, int count) {
+	char path[512];
+	char temp[520];
+	FILE *fp;
+	uint32_t hash = FNV_OFFSET;
+	uint32_t value;
+	int result;
+	int i;
+
+	if ((NULL == dir) || (NULL == key) || (NULL == sections) || (0 > count)) {
+		return INVALID_ARGUMENTS;
+	}
+
+	result = make_path(path, sizeof(path), dir, key, key_size);
+	if (NOERROR != result) {
+		return result;
+	}
+	snprintf(temp, sizeof(temp), "%s.tmp", path);
+
+	fp = fopen(temp, "wb");
+	if (NULL == fp) {
+		return IO_FILE_NOT_CREATED;
+	}
+
+	value = CACHE_MAGIC;
+	result = write_block(fp, &value, sizeof(value), &hash);
+	if (NOERROR == result) {
+		value = CACHE_VERSION;
+		result = write_block(fp, &value, sizeof(value), &hash);
+	}
+	if (NOERROR == result) {
+		result = write_block(fp, &key_size, sizeof(key_size), &hash);
+	}
+	if (NOERROR == result) {
+		result = write_block(fp, key, key_size, &hash);
+	}
+	if (NOERROR == result) {
+		value = count;
+		result = write_block(fp, &value, sizeof(value), &hash);
+	}
+	for (i = 0; (NOERROR == result) && (i < count); ++i) {
+		result = write_block(fp, &sections[i].size, sizeof(sections[i].size), &hash);
+		if (NOERROR == result) {
+			result = write_block(fp, sections[i].data, sections[i].size, &hash);
+		}
+	}
+	if (NOERROR == result) {
+		value = hash;
+		result = write_block(fp, &value, sizeof(value), &hash);
+	}
+
+	if ((0 != fclose(fp)) && (NOERROR == result)) {
+		result = IO_ERROR;
+	}
+
+	// replace the old file only by a complete one.
+	if ((NOERROR == result) && (0 != rename(temp, path))) {
+		result = IO_ERROR;
+	}
+	if (NOERROR != result) {
+		unlink(temp);
+	}
+
+	return result;
+}
+
+int uvcc_cache_remove(char const *dir, void const *key, uint32_t key_size) {
+	char path[512];
+	int result;
+
+	if ((NULL == dir) || (NULL == key)) {
+		return INVALID_ARGUMENTS;
+	}
+
+	result = make_path(path, sizeof(path), dir, key, key_size);
+	if (NOERROR != result) {
+		return result;
+	}
+
+	if ((0 != unlink(path)) && (ENOENT != errno)) {
+		return IO_ERROR;
+	}
+
+	return NOERROR;
+}
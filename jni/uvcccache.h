@@ -0,0 +1,29 @@
+#ifndef UVCC_CACHE_H
+#define UVCC_CACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Small on-disk cache of opaque sections identified by a binary key.
+ * A file holds the key, the sections and a checksum; a file whose key or
+ * checksum does not match is treated as a miss.
+ */
+typedef struct uvcc_cache_section_t {
+	void    *data; // malloc'ed by uvcc_cache_load, release with free().
+	uint32_t size;
+} uvcc_cache_section_t;
+
+extern int uvcc_cache_load(char const *dir, void const *key, uint32_t key_size, uvcc_cache_section_t *sections, int count);
+extern int uvcc_cache_store(char const *dir, void const *key, uint32_t key_size, uvcc_cache_section_t const *sections, int count);
+extern int uvcc_cache_remove(char const *dir, void const *key, uint32_t key_size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
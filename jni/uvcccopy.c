@@ -0,0 +1,259 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define UVCC_COPY_NEON 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define UVCC_COPY_SSE2 1
+#endif
+
+#include "uvcccopy.h"
+
+// below this the setup of a wide loop costs more than it saves.
+#define SMALL_COPY_SIZE     256
+// copies this large do not fit the L2 cache of the boards we run on anyway.
+#define STREAM_COPY_SIZE    (256 * 1024)
+#define PREFETCH_DISTANCE   256
+// the destinations rotate through a pool larger than the caches of the boards we run on.
+#define CALIBRATION_POOL_SIZE  (8 * 1024 * 1024)
+#define CALIBRATION_ROUNDS     3
+
+typedef void (*copy_func_t)(uint8_t *dst, uint8_t const *src, size_t size);
+
+static void copy_memcpy(uint8_t *dst, uint8_t const *src, size_t size);
+static void copy_wide(uint8_t *dst, uint8_t const *src, size_t size);
+static void copy_prefetch(uint8_t *dst, uint8_t const *src, size_t size);
+#if defined(__aarch64__) || defined(UVCC_COPY_SSE2)
+#define UVCC_COPY_HAS_STREAM 1
+static void copy_stream(uint8_t *dst, uint8_t const *src, size_t size);
+#endif
+
+static copy_func_t const copy_funcs[UVCC_COPY_VARIANT_COUNT] = {
+	copy_memcpy,
+	copy_wide,
+	copy_prefetch,
+#ifdef UVCC_COPY_HAS_STREAM
+	copy_stream,
+#else
+	NULL, // ARMv7 has no non-temporal stores.
+#endif
+};
+
+static char const * const variant_names[UVCC_COPY_VARIANT_COUNT] = {
+	"memcpy", "wide", "prefetch", "stream",
+};
+
+static pthread_mutex_t calibration_lock = PTHREAD_MUTEX_INITIALIZER;
+static int             is_calibrated = 0;
+static uint32_t        calibrated_rates[UVCC_COPY_VARIANT_COUNT];
+static uvcc_copy_variant_t volatile selected = UVCC_COPY_MEMCPY;
+
+void uvcc_copy(void *dst, void const *src, size_t size) {
+	if (size < SMALL_COPY_SIZE) {
+		memcpy(dst, src, size);
+		return;
+	}
+	copy_funcs[selected]((uint8_t*)dst, (uint8_t const*)src, size);
+}
+
+static void copy_memcpy(uint8_t *dst, uint8_t const *src, size_t size) {
+	memcpy(dst, src, size);
+}
+
+static inline void copy64(uint8_t *dst, uint8_t const *src) {
+#if defined(UVCC_COPY_NEON)
+	uint8x16_t const v0 = vld1q_u8(src);
+	uint8x16_t const v1 = vld1q_u8(src + 16);
+	uint8x16_t const v2 = vld1q_u8(src + 32);
+	uint8x16_t const v3 = vld1q_u8(src + 48);
+	vst1q_u8(dst,      v0);
+	vst1q_u8(dst + 16, v1);
+	vst1q_u8(dst + 32, v2);
+	vst1q_u8(dst + 48, v3);
+#elif defined(UVCC_COPY_SSE2)
+	__m128i const v0 = _mm_loadu_si128((__m128i const*)src);
+	__m128i const v1 = _mm_loadu_si128((__m128i const*)(src + 16));
+	__m128i const v2 = _mm_loadu_si128((__m128i const*)(src + 32));
+	__m128i const v3 = _mm_loadu_si128((__m128i const*)(src + 48));
+	_mm_storeu_si128((__m128i*)dst,        v0);
+	_mm_storeu_si128((__m128i*)(dst + 16), v1);
+	_mm_storeu_si128((__m128i*)(dst + 32), v2);
+	_mm_storeu_si128((__m128i*)(dst + 48), v3);
+#else
+	uint64_t w[8];
+	memcpy(w, src, sizeof(w));
+	memcpy(dst, w, sizeof(w));
+#endif
+}
+
+static void copy_wide(uint8_t *dst, uint8_t const *src, size_t size) {
+	size_t n;
+
+	for (n = 0; n + 64 <= size; n += 64) {
+		copy64(dst + n, src + n);
+	}
+	memcpy(dst + n, src + n, size - n);
+}
+
+static void copy_prefetch(uint8_t *dst, uint8_t const *src, size_t size) {
+	size_t n;
+
+	for (n = 0; n + PREFETCH_DISTANCE + 64 <= size; n += 64) {
+		__builtin_prefetch(src + n + PREFETCH_DISTANCE, 0, 0);
+		copy64(dst + n, src + n);
+	}
+	copy_wide(dst + n, src + n, size - n);
+}
+
+#ifdef UVCC_COPY_HAS_STREAM
+static void copy_stream(uint8_t *dst, uint8_t const *src, size_t size) {
+	size_t n;
+
+	if (size < STREAM_COPY_SIZE) {
+		copy_prefetch(dst, src, size);
+		return;
+	}
+
+#if defined(__aarch64__)
+	// LDNP/STNP keep both sides of the copy out of the caches.
+	for (n = 0; n + PREFETCH_DISTANCE + 64 <= size; n += 64) {
+		__builtin_prefetch(src + n + PREFETCH_DISTANCE, 0, 0);
+		__asm__ volatile(
+			"ldnp q0, q1, [%1]\n\t"
+			"ldnp q2, q3, [%1, #32]\n\t"
+			"stnp q0, q1, [%0]\n\t"
+			"stnp q2, q3, [%0, #32]\n\t"
+			:
+			: "r"(dst + n), "r"(src + n)
+			: "v0", "v1", "v2", "v3", "memory");
+	}
+#else
+	// non-temporal stores have to be aligned, the head goes through the cache.
+	n = (size_t)(-(uintptr_t)dst & 15);
+	memcpy(dst, src, n);
+	for (; n + PREFETCH_DISTANCE + 64 <= size; n += 64) {
+		__m128i const v0 = _mm_loadu_si128((__m128i const*)(src + n));
+		__m128i const v1 = _mm_loadu_si128((__m128i const*)(src + n + 16));
+		__m128i const v2 = _mm_loadu_si128((__m128i const*)(src + n + 32));
+		__m128i const v3 = _mm_loadu_si128((__m128i const*)(src + n + 48));
+		_mm_prefetch((char const*)(src + n + PREFETCH_DISTANCE), _MM_HINT_NTA);
+		_mm_stream_si128((__m128i*)(dst + n),      v0);
+		_mm_stream_si128((__m128i*)(dst + n + 16), v1);
+		_mm_stream_si128((__m128i*)(dst + n + 32), v2);
+		_mm_stream_si128((__m128i*)(dst + n + 48), v3);
+	}
+	_mm_sfence();
+#endif
+	copy_wide(dst + n, src + n, size - n);
+}
+#endif
+
+static int64_t get_time_ns(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+int uvcc_copy_calibrate(void const * const *srcs, uint32_t count, size_t size) {
+	uvcc_copy_variant_t best = UVCC_COPY_MEMCPY;
+	int64_t best_ns = 0;
+	int64_t begin, elapsed, fastest;
+	uint8_t *pool;
+	size_t regions;
+	uint32_t i, round, turn;
+
+	if ((NULL == srcs) || (0 == count) || (0 == size)) {
+		return 0;
+	}
+	for (i = 0; i < count; ++i) {
+		if (NULL == srcs[i]) {
+			return 0;
+		}
+	}
+
+	pthread_mutex_lock(&calibration_lock);
+	if (is_calibrated) {
+		pthread_mutex_unlock(&calibration_lock);
+		return 0;
+	}
+
+	size = (size < (CALIBRATION_POOL_SIZE / 2)) ? size : (CALIBRATION_POOL_SIZE / 2);
+	regions = CALIBRATION_POOL_SIZE / size;
+	pool = NULL;
+	if (0 != posix_memalign((void**)&pool, 64, CALIBRATION_POOL_SIZE)) {
+		pthread_mutex_unlock(&calibration_lock);
+		return 0;
+	}
+	// fault the pool in up front, its head is evicted again by the time it is reused.
+	memset(pool, 0, CALIBRATION_POOL_SIZE);
+
+	// every copy reads the next capture buffer and writes the next pool region,
+	// so no round finds its source or destination still warm from the one before.
+	turn = 0;
+	for (i = 0; i < UVCC_COPY_VARIANT_COUNT; ++i) {
+		calibrated_rates[i] = 0;
+		if (NULL == copy_funcs[i]) {
+			continue;
+		}
+		fastest = 0;
+		for (round = 0; round < CALIBRATION_ROUNDS; ++round, ++turn) {
+			uint8_t *dst = pool + (turn % regions) * size;
+			uint8_t const *src = (uint8_t const*)srcs[turn % count];
+			begin = get_time_ns();
+			copy_funcs[i](dst, src, size);
+			elapsed = get_time_ns() - begin;
+			if ((0 == fastest) || (elapsed < fastest)) {
+				fastest = (0 < elapsed) ? elapsed : 1;
+			}
+		}
+		calibrated_rates[i] = (uint32_t)(((uint64_t)size * 1000) / (uint64_t)fastest);
+		if ((0 == best_ns) || (fastest < best_ns)) {
+			best_ns = fastest;
+			best = (uvcc_copy_variant_t)i;
+		}
+	}
+	free(pool);
+
+	selected = best;
+	is_calibrated = 1;
+	pthread_mutex_unlock(&calibration_lock);
+	return 1;
+}
+
+void uvcc_copy_get_rates(uint32_t rates[UVCC_COPY_VARIANT_COUNT]) {
+	pthread_mutex_lock(&calibration_lock);
+	memcpy(rates, calibrated_rates, sizeof(calibrated_rates));
+	pthread_mutex_unlock(&calibration_lock);
+}
+
+uvcc_copy_variant_t uvcc_copy_get_variant(void) {
+	return selected;
+}
+
+int uvcc_copy_set_variant(uvcc_copy_variant_t variant) {
+	if (!uvcc_copy_is_available(variant)) {
+		return 0;
+	}
+	pthread_mutex_lock(&calibration_lock);
+	selected = variant;
+	// a forced variant is not replaced by a later calibration.
+	is_calibrated = 1;
+	pthread_mutex_unlock(&calibration_lock);
+	return 1;
+}
+
+int uvcc_copy_is_available(uvcc_copy_variant_t variant) {
+	return ((uint32_t)variant < UVCC_COPY_VARIANT_COUNT) && (NULL != copy_funcs[variant]);
+}
+
+char const *uvcc_copy_variant_name(uvcc_copy_variant_t variant) {
+	if ((uint32_t)variant >= UVCC_COPY_VARIANT_COUNT) {
+		return "unknown";
+	}
+	return variant_names[variant];
+}
@@ -0,0 +1,50 @@
+#ifndef UVCC_COPY_H
+#define UVCC_COPY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Copies out of the mapped capture buffers. Those are often uncached or
+ * write-combined on ARM, where memcpy reads them far below the memory
+ * bandwidth, and a large frame pulled through the cache evicts the working
+ * set of whoever consumes it. The variants below are timed on a real
+ * capture buffer by uvcc_copy_calibrate and uvcc_copy uses the fastest one
+ * from then on; memcpy is used until then.
+ */
+typedef enum uvcc_copy_variant_t {
+	UVCC_COPY_MEMCPY = 0,
+	UVCC_COPY_WIDE,     // 64 bytes per iteration through NEON or SSE2 registers.
+	UVCC_COPY_PREFETCH, // wide, the source is prefetched a few lines ahead.
+	UVCC_COPY_STREAM,   // prefetching, large copies bypass the cache with non-temporal accesses.
+	UVCC_COPY_VARIANT_COUNT,
+} uvcc_copy_variant_t;
+
+extern void uvcc_copy(void *dst, void const *src, size_t size);
+
+/*
+ * Time every available variant copying whole frames of 'size' bytes out of
+ * the 'count' buffers in 'srcs' and select the fastest. The buffers are
+ * taken in turn so that the measurements are not served from the cache.
+ * Only the first call of a process measures, later ones return 0 at once.
+ */
+extern int uvcc_copy_calibrate(void const * const *srcs, uint32_t count, size_t size);
+
+/* MB/s of each variant measured by the calibration, 0 if it was not run. */
+extern void uvcc_copy_get_rates(uint32_t rates[UVCC_COPY_VARIANT_COUNT]);
+
+extern uvcc_copy_variant_t uvcc_copy_get_variant(void);
+/* Force a variant, returns 0 if it is not built for this CPU. */
+extern int uvcc_copy_set_variant(uvcc_copy_variant_t variant);
+extern int uvcc_copy_is_available(uvcc_copy_variant_t variant);
+extern char const *uvcc_copy_variant_name(uvcc_copy_variant_t variant);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
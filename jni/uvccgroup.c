@@ -0,0 +1,248 @@
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "uvccap.h"
+#include "uvccgroup.h"
+
+#define LOG_TAG "uvccgroup"
+#include "uvcclog.h"
+
+#define GROUP_MAX_DEPTH 8
+
+typedef struct frame_queue_t_ {
+	uvcc_frame_t frames[GROUP_MAX_DEPTH];
+	uint32_t     head;
+	uint32_t     count;
+} frame_queue_t;
+
+struct uvcc_group_t_ {
+	uvcc_handle_t      handles[UVCC_GROUP_MAX_DEVICES];
+	frame_queue_t      queues[UVCC_GROUP_MAX_DEVICES];
+	uvcc_frame_t       set[UVCC_GROUP_MAX_DEVICES];
+	uint32_t           count;
+	uint32_t           depth;
+	int64_t            tolerance_us;
+	int                has_set;
+	uvcc_group_stats_t stats;
+	uint64_t           skew_sum_us;
+};
+
+static int64_t now_ms(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static uvcc_frame_t *queue_head(frame_queue_t *q) {
+	return &q->frames[q->head];
+}
+
+static void drop_head(uvcc_group_t *group, uint32_t i) {
+	frame_queue_t *q = &group->queues[i];
+
+	uvcc_release_frame(group->handles[i], queue_head(q));
+	q->head = (q->head + 1) % GROUP_MAX_DEPTH;
+	--q->count;
+	++group->stats.dropped;
+}
+
+static void push_frame(uvcc_group_t *group, uint32_t i, uvcc_frame_t const *frame) {
+	frame_queue_t *q = &group->queues[i];
+
+	if (q->count >= group->depth) {
+		drop_head(group, i);
+	}
+	q->frames[(q->head + q->count) % GROUP_MAX_DEPTH] = *frame;
+	++q->count;
+}
+
+// pops a set when the oldest frame of every device is within the tolerance.
+static int match_set(uvcc_group_t *group, uvcc_frame_t *frames) {
+	int64_t newest, oldest, ts;
+	uint32_t skew;
+	uint32_t i;
+
+	for (; ; ) {
+		newest = INT64_MIN;
+		oldest = INT64_MAX;
+		for (i = 0; i < group->count; ++i) {
+			if (0 == group->queues[i].count) {
+				return 0;
+			}
+			ts = queue_head(&group->queues[i])->info.timestamp_us;
+			newest = (ts > newest) ? ts : newest;
+			oldest = (ts < oldest) ? ts : oldest;
+		}
+
+		if (newest - oldest <= group->tolerance_us) {
+			break;
+		}
+
+		// frames arrive in order, a head this old will never find a partner.
+		for (i = 0; i < group->count; ++i) {
+			while ((0 < group->queues[i].count) &&
+				(queue_head(&group->queues[i])->info.timestamp_us < newest - group->tolerance_us)) {
+				drop_head(group, i);
+			}
+		}
+	}
+
+	for (i = 0; i < group->count; ++i) {
+		frame_queue_t *q = &group->queues[i];
+		group->set[i] = *queue_head(q);
+		frames[i] = group->set[i];
+		q->head = (q->head + 1) % GROUP_MAX_DEPTH;
+		--q->count;
+	}
+	group->has_set = 1;
+
+	skew = (uint32_t)(newest - oldest);
+	++group->stats.sets;
+	group->stats.last_skew_us = skew;
+	if (skew > group->stats.max_skew_us) {
+		group->stats.max_skew_us = skew;
+	}
+	group->skew_sum_us += skew;
+	group->stats.mean_skew_us = (uint32_t)(group->skew_sum_us / group->stats.sets);
+	return 1;
+}
+
+int uvcc_group_create(uvcc_handle_t const *handles, uint32_t count, uint32_t tolerance_us, uint32_t depth, uvcc_group_t **group) {
+	uvcc_group_t *g;
+	uint32_t buffers;
+	uint32_t i, j;
+	int result;
+
+	if ((NULL == handles) || (0 == count) || (UVCC_GROUP_MAX_DEVICES < count) || (0 == depth) || (NULL == group)) {
+		return INVALID_ARGUMENTS;
+	}
+
+	// every device is checked before any is started, so a bad one leaves them all as they were.
+	depth = (GROUP_MAX_DEPTH < depth) ? GROUP_MAX_DEPTH : depth;
+	for (i = 0; i < count; ++i) {
+		if (NULL == handles[i]) {
+			return INVALID_ARGUMENTS;
+		}
+		for (j = 0; j < i; ++j) {
+			if (handles[j] == handles[i]) {
+				return INVALID_ARGUMENTS;
+			}
+		}
+		// one buffer for the returned set and one left to the driver.
+		buffers = uvcc_get_buffer_count(handles[i]);
+		if (3 > buffers) {
+			LOGE("At least 3 buffers are needed per device (%u).", buffers);
+			return INVALID_STATUS;
+		}
+		if (depth > buffers - 2) {
+			depth = buffers - 2;
+		}
+	}
+
+	g = (uvcc_group_t*)calloc(1, sizeof(uvcc_group_t));
+	if (NULL == g) {
+		return INSUFFICIENT_MEMORY;
+	}
+	g->count = count;
+	g->tolerance_us = tolerance_us;
+	g->depth = depth;
+
+	for (i = 0; i < count; ++i) {
+		g->handles[i] = handles[i];
+		result = uvcc_start_capture(handles[i]);
+		if (NOERROR != result) {
+			// do not leave the devices before it streaming with nothing to take their frames.
+			while (0 < i) {
+				uvcc_stop_capture(handles[--i]);
+			}
+			free(g);
+			return result;
+		}
+	}
+
+	*group = g;
+	return NOERROR;
+}
+
+void uvcc_group_destroy(uvcc_group_t *group) {
+	uint32_t i;
+
+	if (NULL == group) {
+		return;
+	}
+	uvcc_group_release(group);
+	for (i = 0; i < group->count; ++i) {
+		while (0 < group->queues[i].count) {
+			drop_head(group, i);
+		}
+	}
+	free(group);
+}
+
+int uvcc_group_capture(uvcc_group_t *group, uvcc_frame_t *frames, int timeout_ms) {
+	int64_t const deadline = (0 > timeout_ms) ? -1 : now_ms() + timeout_ms;
+	uvcc_frame_t frame;
+	uint32_t ready;
+	uint32_t i;
+	int remain = -1;
+	int result;
+
+	if ((NULL == group) || (NULL == frames)) {
+		return INVALID_ARGUMENTS;
+	}
+	if (group->has_set) {
+		return INVALID_STATUS;
+	}
+
+	while (!match_set(group, frames)) {
+		if (0 <= deadline) {
+			remain = (int)(deadline - now_ms());
+			if (0 > remain) {
+				return NO_MORE_DATA;
+			}
+		}
+		result = uvcc_wait_frames(group->handles, group->count, remain, &ready);
+		if (NO_MORE_DATA == result) {
+			continue;
+		}
+		if (NOERROR != result) {
+			return result;
+		}
+		for (i = 0; i < group->count; ++i) {
+			if (0 == (ready & (1u << i))) {
+				continue;
+			}
+			result = uvcc_poll_frame(group->handles[i], &frame, 0);
+			if (NOERROR == result) {
+				push_frame(group, i, &frame);
+			} else if (NO_MORE_DATA != result) {
+				return result;
+			}
+		}
+	}
+	return NOERROR;
+}
+
+int uvcc_group_release(uvcc_group_t *group) {
+	uint32_t i;
+
+	if (NULL == group) {
+		return INVALID_ARGUMENTS;
+	}
+	if (!group->has_set) {
+		return NOERROR;
+	}
+	for (i = 0; i < group->count; ++i) {
+		uvcc_release_frame(group->handles[i], &group->set[i]);
+	}
+	group->has_set = 0;
+	return NOERROR;
+}
+
+void uvcc_group_get_stats(uvcc_group_t const *group, uvcc_group_stats_t *stats) {
+	if ((NULL == group) || (NULL == stats)) {
+		return;
+	}
+	*stats = group->stats;
+}
@@ -0,0 +1,55 @@
+#ifndef UVCC_GROUP_H
+#define UVCC_GROUP_H
+
+#include <stdint.h>
+
+#include "uvccap.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Captures matched sets of frames from several started devices, one frame
+ * per device, paired by the driver timestamps of VIDIOC_DQBUF. Frames are
+ * held until a frame of every device lies within the skew tolerance; a
+ * frame too old to be matched any more, or pushed out of a full queue, is
+ * handed back to the driver and counted as dropped.
+ *
+ * A group is used from one thread at a time, and the devices must not be
+ * captured from by other means while it exists.
+ */
+typedef struct uvcc_group_t_ uvcc_group_t;
+
+#define UVCC_GROUP_MAX_DEVICES 8
+
+typedef struct uvcc_group_stats_t {
+	uint32_t sets;         // matched sets returned.
+	uint32_t dropped;      // frames returned to the driver unmatched.
+	uint32_t last_skew_us; // between the oldest and the newest frame of a set.
+	uint32_t max_skew_us;
+	uint32_t mean_skew_us;
+} uvcc_group_stats_t;
+
+/*
+ * Starts capture on every device. 'depth' bounds the frames held per
+ * device; it is lowered so that every device keeps buffers queued in the
+ * driver. On failure no device is left started by the call.
+ */
+extern int  uvcc_group_create(uvcc_handle_t const *handles, uint32_t count, uint32_t tolerance_us, uint32_t depth, uvcc_group_t **group);
+extern void uvcc_group_destroy(uvcc_group_t *group);
+
+/*
+ * Wait up to 'timeout_ms' (negative waits forever) for the next matched
+ * set, NO_MORE_DATA on timeout. 'frames' receives one frame per device in
+ * the order of creation; they stay valid until uvcc_group_release.
+ */
+extern int  uvcc_group_capture(uvcc_group_t *group, uvcc_frame_t *frames, int timeout_ms);
+extern int  uvcc_group_release(uvcc_group_t *group);
+extern void uvcc_group_get_stats(uvcc_group_t const *group, uvcc_group_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
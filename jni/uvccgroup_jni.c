@@ -0,0 +1,188 @@
+#include "uvccgroup_jni.h"
+#include "uvccap.h"
+#include "uvccgroup.h"
+#include "uvcccopy.h"
+#include <string.h>
+#include <stdint.h>
+
+static void throw_IllegalArgumentException(JNIEnv *env, char const * const message);
+static void throw_RuntimeException(JNIEnv *env, char const * const message);
+
+#define TO_GROUP(h) ((uvcc_group_t*)(intptr_t)h)
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_CaptureGroup
+ * Method:    n_create
+ * Signature: ([JII)J
+ */
+JNIEXPORT jlong JNICALL Java_net_crimsonwoods_android_libs_uvccap_CaptureGroup_n_1create
+  (JNIEnv *env, jclass cls, jlongArray cameras, jint tolerance_us, jint depth)
+{
+	jlong values[UVCC_GROUP_MAX_DEVICES];
+	uvcc_handle_t handles[UVCC_GROUP_MAX_DEVICES];
+	uvcc_group_t *group = NULL;
+	jsize count;
+	jsize i;
+	int result;
+
+	count = (*env)->GetArrayLength(env, cameras);
+	if ((0 >= count) || (UVCC_GROUP_MAX_DEVICES < count) || (0 > tolerance_us) || (0 >= depth)) {
+		throw_IllegalArgumentException(env, "Invalid group parameters.");
+		return 0;
+	}
+	(*env)->GetLongArrayRegion(env, cameras, 0, count, values);
+	for (i = 0; i < count; ++i) {
+		handles[i] = (uvcc_handle_t)(intptr_t)values[i];
+	}
+
+	result = uvcc_group_create(handles, count, tolerance_us, depth, &group);
+	if (NOERROR != result) {
+		throw_RuntimeException(env, "Capture group can't be created.");
+		return 0;
+	}
+	return (jlong)(intptr_t)group;
+}
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_CaptureGroup
+ * Method:    n_destroy
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_net_crimsonwoods_android_libs_uvccap_CaptureGroup_n_1destroy
+  (JNIEnv *env, jclass cls, jlong handle)
+{
+	uvcc_group_destroy(TO_GROUP(handle));
+}
+
+// planes are copied back to back, as uvcc_capture does.
+static jboolean copy_frame(JNIEnv *env, jobject dst, uvcc_frame_t const *frame)
+{
+	uint8_t *ptr;
+	jlong capacity;
+	size_t size = 0;
+	uint32_t i;
+
+	ptr = (uint8_t*)(*env)->GetDirectBufferAddress(env, dst);
+	capacity = (*env)->GetDirectBufferCapacity(env, dst);
+	if ((NULL == ptr) || (0 > capacity)) {
+		throw_IllegalArgumentException(env, "'frames' have to be direct buffers.");
+		return JNI_FALSE;
+	}
+	for (i = 0; i < frame->plane_count; ++i) {
+		size += frame->planes[i].bytesused;
+	}
+	if ((size_t)capacity < size) {
+		throw_IllegalArgumentException(env, "A buffer of 'frames' is smaller than the frame.");
+		return JNI_FALSE;
+	}
+	for (i = 0; i < frame->plane_count; ++i) {
+		uvcc_copy(ptr, frame->planes[i].data, frame->planes[i].bytesused);
+		ptr += frame->planes[i].bytesused;
+	}
+	return JNI_TRUE;
+}
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_CaptureGroup
+ * Method:    n_capture
+ * Signature: (J[Ljava/nio/ByteBuffer;[JI)Z
+ */
+JNIEXPORT jboolean JNICALL Java_net_crimsonwoods_android_libs_uvccap_CaptureGroup_n_1capture
+  (JNIEnv *env, jclass cls, jlong handle, jobjectArray frames, jlongArray timestamps, jint timeout_ms)
+{
+	uvcc_frame_t set[UVCC_GROUP_MAX_DEVICES];
+	jlong values[UVCC_GROUP_MAX_DEVICES];
+	jobject dst;
+	jsize count;
+	jsize i;
+	jboolean copied = JNI_TRUE;
+	int result;
+
+	count = (*env)->GetArrayLength(env, frames);
+	if ((UVCC_GROUP_MAX_DEVICES < count) || ((NULL != timestamps) && ((*env)->GetArrayLength(env, timestamps) < count))) {
+		throw_IllegalArgumentException(env, "'frames' or 'timestamps' is out of range.");
+		return JNI_FALSE;
+	}
+
+	result = uvcc_group_capture(TO_GROUP(handle), set, timeout_ms);
+	if (NO_MORE_DATA == result) {
+		return JNI_FALSE;
+	} else if (NOERROR != result) {
+		throw_RuntimeException(env, "Capture failed.");
+		return JNI_FALSE;
+	}
+
+	for (i = 0; (i < count) && copied; ++i) {
+		dst = (*env)->GetObjectArrayElement(env, frames, i);
+		copied = copy_frame(env, dst, &set[i]);
+		(*env)->DeleteLocalRef(env, dst);
+		values[i] = set[i].info.timestamp_us;
+	}
+	uvcc_group_release(TO_GROUP(handle));
+
+	if (copied && (NULL != timestamps)) {
+		(*env)->SetLongArrayRegion(env, timestamps, 0, count, values);
+	}
+	return copied;
+}
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_CaptureGroup
+ * Method:    n_getStats
+ * Signature: (J)Lnet/crimsonwoods/android/libs/uvccap/CaptureGroup/Stats;
+ */
+JNIEXPORT jobject JNICALL Java_net_crimsonwoods_android_libs_uvccap_CaptureGroup_n_1getStats
+  (JNIEnv *env, jclass cls, jlong handle)
+{
+	uvcc_group_stats_t stats;
+	uvcc_group_get_stats(TO_GROUP(handle), &stats);
+	jclass stats_cls = (*env)->FindClass(env, "net/crimsonwoods/android/libs/uvccap/CaptureGroup$Stats");
+	if (NULL == stats_cls) {
+		// ClassNotFoundException will throw by JVM.
+		return NULL;
+	}
+	jmethodID ctor = (*env)->GetMethodID(env, stats_cls, "<init>", "()V");
+	if (NULL == ctor) {
+		(*env)->DeleteLocalRef(env, stats_cls);
+		return NULL;
+	}
+	jfieldID field_sets    = (*env)->GetFieldID(env, stats_cls, "sets", "I");
+	jfieldID field_dropped = (*env)->GetFieldID(env, stats_cls, "dropped", "I");
+	jfieldID field_last    = (*env)->GetFieldID(env, stats_cls, "lastSkewMicros", "I");
+	jfieldID field_max     = (*env)->GetFieldID(env, stats_cls, "maxSkewMicros", "I");
+	jfieldID field_mean    = (*env)->GetFieldID(env, stats_cls, "meanSkewMicros", "I");
+	if (!field_sets || !field_dropped || !field_last || !field_max || !field_mean) {
+		(*env)->DeleteLocalRef(env, stats_cls);
+		return NULL;
+	}
+	jobject ret = (*env)->NewObject(env, stats_cls, ctor);
+	if (NULL != ret) {
+		(*env)->SetIntField(env, ret, field_sets,    stats.sets);
+		(*env)->SetIntField(env, ret, field_dropped, stats.dropped);
+		(*env)->SetIntField(env, ret, field_last,    stats.last_skew_us);
+		(*env)->SetIntField(env, ret, field_max,     stats.max_skew_us);
+		(*env)->SetIntField(env, ret, field_mean,    stats.mean_skew_us);
+	}
+	(*env)->DeleteLocalRef(env, stats_cls);
+	return ret;
+}
+
+static void throw_exception(JNIEnv *env, char const * const cls, char const * const message)
+{
+	jclass ioe_cls = (*env)->FindClass(env, cls);
+	if (NULL == ioe_cls) {
+		return;
+	}
+	(*env)->ThrowNew(env, ioe_cls, message);
+	(*env)->DeleteLocalRef(env, ioe_cls);
+}
+
+static void throw_IllegalArgumentException(JNIEnv *env, char const * const message)
+{
+	throw_exception(env, "java/lang/IllegalArgumentException", message);
+}
+
+static void throw_RuntimeException(JNIEnv *env, char const * const message)
+{
+	throw_exception(env, "java/lang/RuntimeException", message);
+}
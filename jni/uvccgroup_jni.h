@@ -0,0 +1,45 @@
+/* DO NOT EDIT THIS FILE - it is machine generated */
+#include <jni.h>
+/* Header for class net_crimsonwoods_android_libs_uvccap_CaptureGroup */
+
+#ifndef _Included_net_crimsonwoods_android_libs_uvccap_CaptureGroup
+#define _Included_net_crimsonwoods_android_libs_uvccap_CaptureGroup
+#ifdef __cplusplus
+extern "C" {
+#endif
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_CaptureGroup
+ * Method:    n_create
+ * Signature: ([JII)J
+ */
+JNIEXPORT jlong JNICALL Java_net_crimsonwoods_android_libs_uvccap_CaptureGroup_n_1create
+  (JNIEnv *, jclass, jlongArray, jint, jint);
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_CaptureGroup
+ * Method:    n_destroy
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_net_crimsonwoods_android_libs_uvccap_CaptureGroup_n_1destroy
+  (JNIEnv *, jclass, jlong);
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_CaptureGroup
+ * Method:    n_capture
+ * Signature: (J[Ljava/nio/ByteBuffer;[JI)Z
+ */
+JNIEXPORT jboolean JNICALL Java_net_crimsonwoods_android_libs_uvccap_CaptureGroup_n_1capture
+  (JNIEnv *, jclass, jlong, jobjectArray, jlongArray, jint);
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_CaptureGroup
+ * Method:    n_getStats
+ * Signature: (J)Lnet/crimsonwoods/android/libs/uvccap/CaptureGroup/Stats;
+ */
+JNIEXPORT jobject JNICALL Java_net_crimsonwoods_android_libs_uvccap_CaptureGroup_n_1getStats
+  (JNIEnv *, jclass, jlong);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
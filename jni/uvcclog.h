@@ -0,0 +1,33 @@
+#ifndef UVCC_LOG_H
+#define UVCC_LOG_H
+
+#include <android/log.h>
+
+/*
+ * Log macros shared by the native sources. Define LOG_TAG before including.
+ * Messages below UVCC_LOG_LEVEL (an ANDROID_LOG_* priority) are compiled
+ * out together with their arguments.
+ */
+#ifndef UVCC_LOG_LEVEL
+#ifdef NDEBUG
+#define UVCC_LOG_LEVEL ANDROID_LOG_WARN
+#else
+#define UVCC_LOG_LEVEL ANDROID_LOG_DEBUG
+#endif
+#endif
+
+#define UVCC_LOG_ENABLED(prio) ((prio) >= UVCC_LOG_LEVEL)
+
+#define UVCC_LOG(prio, fmt, ...) \
+	do { \
+		if (UVCC_LOG_ENABLED(prio)) { \
+			__android_log_print(prio, LOG_TAG, fmt, ##__VA_ARGS__); \
+		} \
+	} while (0)
+
+#define LOGE(fmt, ...) UVCC_LOG(ANDROID_LOG_ERROR, fmt, ##__VA_ARGS__)
+#define LOGW(fmt, ...) UVCC_LOG(ANDROID_LOG_WARN,  fmt, ##__VA_ARGS__)
+#define LOGI(fmt, ...) UVCC_LOG(ANDROID_LOG_INFO,  fmt, ##__VA_ARGS__)
+#define LOGD(fmt, ...) UVCC_LOG(ANDROID_LOG_DEBUG, fmt, ##__VA_ARGS__)
+
+#endif
@@ -0,0 +1,474 @@
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/time.h>
+
+#include "uvccap.h"
+#include "uvccpump.h"
+#include "uvccthread.h"
+
+#define LOG_TAG "uvccpump"
+#include "uvcclog.h"
+
+// the poll timeout bounds how long destroy waits for the pump thread.
+#define PUMP_POLL_TIMEOUT_MS 100
+
+struct uvcc_subscriber_t_ {
+	uvcc_pump_t            *pump;
+	uvcc_subscriber_t      *next;
+	uvcc_delivery_policy_t  policy;
+	uint32_t                interval;
+	uint32_t                counter;
+	uint32_t                depth;
+	uint32_t               *queue;    // buffer indices waiting to be acquired.
+	uint32_t                head;
+	uint32_t                count;
+	uint32_t                acquired; // number of bits set in 'acquired_mask'.
+	uint32_t                acquired_mask;
+	uint32_t                dropped;
+	int                     closed;
+	pthread_cond_t          cond;
+};
+
+struct uvcc_pump_t_ {
+	uvcc_handle_t      handle;
+	pthread_t          thread;
+	pid_t              tid;     // 0 until the pump thread runs and after it stopped.
+	pthread_cond_t     started;
+	pthread_mutex_t    lock;
+	int                running;
+	int                error;
+	uvcc_subscriber_t *subscribers;
+	uint32_t           buffer_count;
+	uint32_t           held;       // buffers referenced by at least one subscriber.
+	uint32_t           held_limit; // at least one buffer is left to the driver.
+	uvcc_frame_t       frames[UVCC_PUMP_MAX_BUFFERS];
+	uint32_t           refs[UVCC_PUMP_MAX_BUFFERS];
+};
+
+// called with the pump lock held.
+static void ref_buffer(uvcc_pump_t *pump, uint32_t index) {
+	if (0 == pump->refs[index]++) {
+		++pump->held;
+	}
+}
+
+// called with the pump lock held.
+static void unref_buffer(uvcc_pump_t *pump, uint32_t index) {
+	int result;
+
+	if (0 != --pump->refs[index]) {
+		return;
+	}
+	--pump->held;
+	result = uvcc_release_frame(pump->handle, &pump->frames[index]);
+	if (NOERROR != result) {
+		LOGW("Failed to queue buffer %u back (%d).", index, result);
+	}
+}
+
+// called with the pump lock held.
+static void drop_oldest(uvcc_subscriber_t *sub) {
+	uint32_t const index = sub->queue[sub->head];
+
+	sub->head = (sub->head + 1) % sub->depth;
+	--sub->count;
+	++sub->dropped;
+	unref_buffer(sub->pump, index);
+}
+
+// called with the pump lock held.
+static void drop_all(uvcc_subscriber_t *sub) {
+	uint32_t i;
+
+	while (0 < sub->count) {
+		drop_oldest(sub);
+	}
+	for (i = 0; sub->acquired_mask; ++i) {
+		if (sub->acquired_mask & (1u << i)) {
+			sub->acquired_mask &= ~(1u << i);
+			unref_buffer(sub->pump, i);
+		}
+	}
+	sub->acquired = 0;
+}
+
+static int wants_frame(uvcc_subscriber_t *sub) {
+	if (sub->closed) {
+		return 0;
+	}
+	if (UVCC_DELIVERY_EVERY_NTH == sub->policy) {
+		return 0 == (sub->counter++ % sub->interval);
+	}
+	return 1;
+}
+
+// reclaim frames nobody has acquired yet from the longest queue.
+static int reclaim_buffer(uvcc_pump_t *pump) {
+	uvcc_subscriber_t *sub;
+	uvcc_subscriber_t *slowest = NULL;
+	uint32_t const held = pump->held;
+
+	while (held == pump->held) {
+		slowest = NULL;
+		for (sub = pump->subscribers; NULL != sub; sub = sub->next) {
+			if ((0 < sub->count) && ((NULL == slowest) || (sub->count > slowest->count))) {
+				slowest = sub;
+			}
+		}
+		if (NULL == slowest) {
+			return 0;
+		}
+		drop_oldest(slowest);
+	}
+	return 1;
+}
+
+static void dispatch_frame(uvcc_pump_t *pump, uvcc_frame_t const *frame) {
+	uvcc_subscriber_t *sub;
+	uint32_t const index = frame->index;
+	int deliverable;
+
+	pthread_mutex_lock(&pump->lock);
+
+	pump->frames[index] = *frame;
+	deliverable = (pump->held < pump->held_limit) || reclaim_buffer(pump);
+
+	for (sub = pump->subscribers; NULL != sub; sub = sub->next) {
+		if (!wants_frame(sub)) {
+			continue;
+		}
+		if (!deliverable) {
+			++sub->dropped;
+			continue;
+		}
+		if (sub->count + sub->acquired >= sub->depth) {
+			if ((UVCC_DELIVERY_LATEST_ONLY != sub->policy) || (0 == sub->count)) {
+				++sub->dropped;
+				continue;
+			}
+			drop_oldest(sub);
+		}
+		sub->queue[(sub->head + sub->count) % sub->depth] = index;
+		++sub->count;
+		ref_buffer(pump, index);
+		pthread_cond_signal(&sub->cond);
+	}
+
+	// nobody took it.
+	if ((0 == pump->refs[index]) && (NOERROR != uvcc_release_frame(pump->handle, frame))) {
+		LOGW("Failed to queue buffer %u back.", index);
+	}
+
+	pthread_mutex_unlock(&pump->lock);
+}
+
+static int is_running(uvcc_pump_t *pump) {
+	int running;
+
+	pthread_mutex_lock(&pump->lock);
+	running = pump->running;
+	pthread_mutex_unlock(&pump->lock);
+
+	return running;
+}
+
+static void *pump_main(void *arg) {
+	uvcc_pump_t *pump = (uvcc_pump_t*)arg;
+	uvcc_subscriber_t *sub;
+	uvcc_frame_t frame;
+	int result = NOERROR;
+
+	pthread_mutex_lock(&pump->lock);
+	pump->tid = uvcc_thread_self();
+	pthread_cond_signal(&pump->started);
+	pthread_mutex_unlock(&pump->lock);
+
+	while (is_running(pump)) {
+		result = uvcc_poll_frame(pump->handle, &frame, PUMP_POLL_TIMEOUT_MS);
+		if (NO_MORE_DATA == result) {
+			continue;
+		}
+		if (NOERROR != result) {
+			LOGE("Failed to dequeue frame (%d), pump stopped.", result);
+			break;
+		}
+		if (frame.index >= pump->buffer_count) {
+			LOGW("Unexpected buffer index %u.", frame.index);
+			continue;
+		}
+		dispatch_frame(pump, &frame);
+	}
+
+	pthread_mutex_lock(&pump->lock);
+	pump->tid = 0;
+	pump->error = (NOERROR != result) ? result : INVALID_STATUS;
+	for (sub = pump->subscribers; NULL != sub; sub = sub->next) {
+		pthread_cond_broadcast(&sub->cond);
+	}
+	pthread_mutex_unlock(&pump->lock);
+
+	return NULL;
+}
+
+int uvcc_pump_create(uvcc_handle_t handle, uvcc_pump_t **pump) {
+	uvcc_pump_t *p;
+	uint32_t buffer_count;
+
+	if ((NULL == handle) || (NULL == pump)) {
+		return INVALID_ARGUMENTS;
+	}
+
+	buffer_count = uvcc_get_buffer_count(handle);
+	if ((0 == buffer_count) || (UVCC_PUMP_MAX_BUFFERS < buffer_count)) {
+		LOGE("Unsupported buffer count %u.", buffer_count);
+		return INVALID_STATUS;
+	}
+
+	p = (uvcc_pump_t*)calloc(1, sizeof(uvcc_pump_t));
+	if (NULL == p) {
+		return INSUFFICIENT_MEMORY;
+	}
+	p->handle = handle;
+	p->error = NOERROR;
+	p->buffer_count = buffer_count;
+	p->held_limit = (1 < buffer_count) ? buffer_count - 1 : 1;
+	p->running = 1;
+	pthread_mutex_init(&p->lock, NULL);
+	pthread_cond_init(&p->started, NULL);
+
+	if (0 != pthread_create(&p->thread, NULL, pump_main, p)) {
+		LOGE("Failed to start pump thread.");
+		pthread_cond_destroy(&p->started);
+		pthread_mutex_destroy(&p->lock);
+		free(p);
+		return INSUFFICIENT_MEMORY;
+	}
+
+	// a thread policy can be applied as soon as the pump is returned.
+	pthread_mutex_lock(&p->lock);
+	while ((0 == p->tid) && (NOERROR == p->error)) {
+		pthread_cond_wait(&p->started, &p->lock);
+	}
+	pthread_mutex_unlock(&p->lock);
+
+	*pump = p;
+	return NOERROR;
+}
+
+void uvcc_pump_destroy(uvcc_pump_t *pump) {
+	uvcc_subscriber_t *sub;
+
+	if (NULL == pump) {
+		return;
+	}
+
+	pthread_mutex_lock(&pump->lock);
+	pump->running = 0;
+	pthread_mutex_unlock(&pump->lock);
+	pthread_join(pump->thread, NULL);
+
+	while (NULL != pump->subscribers) {
+		sub = pump->subscribers;
+		uvcc_pump_unsubscribe(sub);
+	}
+
+	pthread_cond_destroy(&pump->started);
+	pthread_mutex_destroy(&pump->lock);
+	free(pump);
+}
+
+int uvcc_pump_subscribe(uvcc_pump_t *pump, uvcc_delivery_policy_t policy, uint32_t interval, uint32_t depth, uvcc_subscriber_t **sub) {
+	uvcc_subscriber_t *s;
+
+	if ((NULL == pump) || (NULL == sub) || (0 == depth)) {
+		return INVALID_ARGUMENTS;
+	}
+	switch (policy) {
+	case UVCC_DELIVERY_EVERY_FRAME:
+	case UVCC_DELIVERY_LATEST_ONLY:
+		interval = 1;
+		break;
+	case UVCC_DELIVERY_EVERY_NTH:
+		if (0 == interval) {
+			return INVALID_ARGUMENTS;
+		}
+		break;
+	default:
+		return INVALID_ARGUMENTS;
+	}
+	if (UVCC_PUMP_MAX_BUFFERS < depth) {
+		depth = UVCC_PUMP_MAX_BUFFERS;
+	}
+
+	s = (uvcc_subscriber_t*)calloc(1, sizeof(uvcc_subscriber_t));
+	if (NULL == s) {
+		return INSUFFICIENT_MEMORY;
+	}
+	s->queue = (uint32_t*)malloc(sizeof(uint32_t) * depth);
+	if (NULL == s->queue) {
+		free(s);
+		return INSUFFICIENT_MEMORY;
+	}
+	s->pump = pump;
+	s->policy = policy;
+	s->interval = interval;
+	s->depth = depth;
+	pthread_cond_init(&s->cond, NULL);
+
+	pthread_mutex_lock(&pump->lock);
+	s->next = pump->subscribers;
+	pump->subscribers = s;
+	pthread_mutex_unlock(&pump->lock);
+
+	*sub = s;
+	return NOERROR;
+}
+
+void uvcc_pump_close_subscriber(uvcc_subscriber_t *sub) {
+	if (NULL == sub) {
+		return;
+	}
+	pthread_mutex_lock(&sub->pump->lock);
+	sub->closed = 1;
+	pthread_cond_broadcast(&sub->cond);
+	pthread_mutex_unlock(&sub->pump->lock);
+}
+
+void uvcc_pump_unsubscribe(uvcc_subscriber_t *sub) {
+	uvcc_pump_t *pump;
+	uvcc_subscriber_t **p;
+
+	if (NULL == sub) {
+		return;
+	}
+	pump = sub->pump;
+
+	pthread_mutex_lock(&pump->lock);
+	for (p = &pump->subscribers; NULL != *p; p = &(*p)->next) {
+		if (sub == *p) {
+			*p = sub->next;
+			break;
+		}
+	}
+	sub->closed = 1;
+	drop_all(sub);
+	pthread_mutex_unlock(&pump->lock);
+
+	pthread_cond_destroy(&sub->cond);
+	free(sub->queue);
+	free(sub);
+}
+
+static void to_abstime(int timeout_ms, struct timespec *ts) {
+	struct timeval now;
+
+	gettimeofday(&now, NULL);
+	ts->tv_sec = now.tv_sec + timeout_ms / 1000;
+	ts->tv_nsec = now.tv_usec * 1000L + (timeout_ms % 1000) * 1000000L;
+	if (1000000000L <= ts->tv_nsec) {
+		ts->tv_nsec -= 1000000000L;
+		++ts->tv_sec;
+	}
+}
+
+int uvcc_pump_acquire(uvcc_subscriber_t *sub, uvcc_frame_t *frame, int timeout_ms) {
+	uvcc_pump_t *pump;
+	struct timespec deadline;
+	uint32_t index;
+	int result = NOERROR;
+
+	if ((NULL == sub) || (NULL == frame)) {
+		return INVALID_ARGUMENTS;
+	}
+	pump = sub->pump;
+
+	if (0 <= timeout_ms) {
+		to_abstime(timeout_ms, &deadline);
+	}
+
+	pthread_mutex_lock(&pump->lock);
+	while ((0 == sub->count) && !sub->closed && (NOERROR == pump->error)) {
+		if (0 > timeout_ms) {
+			pthread_cond_wait(&sub->cond, &pump->lock);
+		} else if (ETIMEDOUT == pthread_cond_timedwait(&sub->cond, &pump->lock, &deadline)) {
+			break;
+		}
+	}
+
+	if (sub->closed) {
+		result = INVALID_STATUS;
+	} else if (0 < sub->count) {
+		index = sub->queue[sub->head];
+		sub->head = (sub->head + 1) % sub->depth;
+		--sub->count;
+		++sub->acquired;
+		sub->acquired_mask |= 1u << index;
+		*frame = pump->frames[index];
+	} else if (NOERROR != pump->error) {
+		result = pump->error;
+	} else {
+		result = NO_MORE_DATA;
+	}
+	pthread_mutex_unlock(&pump->lock);
+
+	return result;
+}
+
+int uvcc_pump_release(uvcc_subscriber_t *sub, uvcc_frame_t const *frame) {
+	uvcc_pump_t *pump;
+	int result = NOERROR;
+
+	if ((NULL == sub) || (NULL == frame) || (UVCC_PUMP_MAX_BUFFERS <= frame->index)) {
+		return INVALID_ARGUMENTS;
+	}
+	pump = sub->pump;
+
+	pthread_mutex_lock(&pump->lock);
+	if (sub->acquired_mask & (1u << frame->index)) {
+		sub->acquired_mask &= ~(1u << frame->index);
+		--sub->acquired;
+		unref_buffer(pump, frame->index);
+	} else {
+		result = INVALID_ARGUMENTS;
+	}
+	pthread_mutex_unlock(&pump->lock);
+
+	return result;
+}
+
+uint32_t uvcc_pump_dropped(uvcc_subscriber_t const *sub) {
+	uint32_t dropped;
+
+	if (NULL == sub) {
+		return 0;
+	}
+
+	pthread_mutex_lock(&sub->pump->lock);
+	dropped = sub->dropped;
+	pthread_mutex_unlock(&sub->pump->lock);
+
+	return dropped;
+}
+
+int uvcc_pump_set_thread_policy(uvcc_pump_t *pump, uvcc_thread_policy_t const *policy, uvcc_thread_policy_t *applied) {
+	if ((NULL == pump) || (NULL == policy) || (NULL == applied)) {
+		return INVALID_ARGUMENTS;
+	}
+
+	pthread_mutex_lock(&pump->lock);
+	if (0 == pump->tid) {
+		pthread_mutex_unlock(&pump->lock);
+		memset(applied, 0, sizeof(*applied));
+		return INVALID_STATUS;
+	}
+	uvcc_thread_apply(pump->tid, policy, applied);
+	pthread_mutex_unlock(&pump->lock);
+
+	if ((policy->flags & ~UVCC_THREAD_MLOCK) != (applied->flags & ~UVCC_THREAD_MLOCK)) {
+		LOGW("Pump thread policy partially applied (asked 0x%x, got 0x%x).", policy->flags, applied->flags);
+	}
+	return NOERROR;
+}
@@ -0,0 +1,72 @@
+#ifndef UVCC_PUMP_H
+#define UVCC_PUMP_H
+
+#include <stdint.h>
+
+#include "uvccap.h"
+#include "uvccthread.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Fans the frames of one device out to several subscribers without copying.
+ * A thread owned by the pump dequeues the driver buffers; each buffer is
+ * shared by every subscriber it is delivered to and queued back to the
+ * driver once all of them have released it.
+ *
+ * A subscriber never stalls the others: a frame it has no room for is
+ * skipped (counted as dropped), and when the driver is about to run out of
+ * buffers the oldest frames still waiting in the longest queue are
+ * reclaimed. Frames acquired by a subscriber are never reclaimed.
+ *
+ * The device must be initialized before the pump is created and must not be
+ * captured from, reconfigured or stopped while the pump exists.
+ */
+typedef struct uvcc_pump_t_ uvcc_pump_t;
+typedef struct uvcc_subscriber_t_ uvcc_subscriber_t;
+
+typedef enum uvcc_delivery_policy_t {
+	UVCC_DELIVERY_EVERY_FRAME = 0, // queue every frame up to 'depth'.
+	UVCC_DELIVERY_LATEST_ONLY,     // a new frame replaces the oldest waiting one.
+	UVCC_DELIVERY_EVERY_NTH,       // one frame out of 'interval'.
+} uvcc_delivery_policy_t;
+
+#define UVCC_PUMP_MAX_BUFFERS 32
+
+extern int  uvcc_pump_create(uvcc_handle_t handle, uvcc_pump_t **pump);
+extern void uvcc_pump_destroy(uvcc_pump_t *pump);
+
+/*
+ * 'depth' bounds the frames queued for and acquired by the subscriber.
+ * 'interval' is only used by UVCC_DELIVERY_EVERY_NTH.
+ */
+extern int  uvcc_pump_subscribe(uvcc_pump_t *pump, uvcc_delivery_policy_t policy, uint32_t interval, uint32_t depth, uvcc_subscriber_t **sub);
+/*
+ * Wakes up and fails every pending and later acquire with INVALID_STATUS.
+ * Call it before uvcc_pump_unsubscribe when other threads may be waiting.
+ */
+extern void uvcc_pump_close_subscriber(uvcc_subscriber_t *sub);
+/* Releases every frame the subscriber still holds and frees it. */
+extern void uvcc_pump_unsubscribe(uvcc_subscriber_t *sub);
+
+/*
+ * Wait up to 'timeout_ms' (negative waits forever) for the next frame,
+ * NO_MORE_DATA on timeout. The planes stay valid until uvcc_pump_release.
+ */
+extern int  uvcc_pump_acquire(uvcc_subscriber_t *sub, uvcc_frame_t *frame, int timeout_ms);
+extern int  uvcc_pump_release(uvcc_subscriber_t *sub, uvcc_frame_t const *frame);
+extern uint32_t uvcc_pump_dropped(uvcc_subscriber_t const *sub);
+
+/*
+ * Apply 'policy' to the pump thread, see uvcc_thread_apply. INVALID_STATUS
+ * with nothing applied once the thread has stopped after an error.
+ */
+extern int  uvcc_pump_set_thread_policy(uvcc_pump_t *pump, uvcc_thread_policy_t const *policy, uvcc_thread_policy_t *applied);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,153 @@
+#include "uvccpump_jni.h"
+#include "uvccap.h"
+#include "uvccpump.h"
+#include <stdint.h>
+
+static void throw_IllegalStateException(JNIEnv *env, char const * const message);
+static void throw_RuntimeException(JNIEnv *env, char const * const message);
+static jboolean set_frame(JNIEnv *env, jobject obj, uvcc_frame_t const *frame);
+
+#define TO_SUBSCRIBER(h) ((uvcc_subscriber_t*)(intptr_t)h)
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_FrameSubscriber
+ * Method:    n_acquire
+ * Signature: (JILnet/crimsonwoods/android/libs/uvccap/FrameSubscriber/SharedFrame;)Z
+ */
+JNIEXPORT jboolean JNICALL Java_net_crimsonwoods_android_libs_uvccap_FrameSubscriber_n_1acquire
+  (JNIEnv *env, jclass cls, jlong handle, jint timeout_ms, jobject obj)
+{
+	uvcc_frame_t frame;
+	int result;
+
+	result = uvcc_pump_acquire(TO_SUBSCRIBER(handle), &frame, timeout_ms);
+	switch (result) {
+	case NOERROR:
+		break;
+	case NO_MORE_DATA:
+		return JNI_FALSE;
+	case INVALID_STATUS:
+		throw_IllegalStateException(env, "Subscriber is closed.");
+		return JNI_FALSE;
+	default:
+		throw_RuntimeException(env, "Capture failed.");
+		return JNI_FALSE;
+	}
+
+	if (!set_frame(env, obj, &frame)) {
+		uvcc_pump_release(TO_SUBSCRIBER(handle), &frame);
+		return JNI_FALSE;
+	}
+	return JNI_TRUE;
+}
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_FrameSubscriber
+ * Method:    n_release
+ * Signature: (JI)V
+ */
+JNIEXPORT void JNICALL Java_net_crimsonwoods_android_libs_uvccap_FrameSubscriber_n_1release
+  (JNIEnv *env, jclass cls, jlong handle, jint index)
+{
+	uvcc_frame_t frame;
+	frame.index = index;
+	if (NOERROR != uvcc_pump_release(TO_SUBSCRIBER(handle), &frame)) {
+		throw_IllegalStateException(env, "Frame is not held by the subscriber.");
+	}
+}
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_FrameSubscriber
+ * Method:    n_close
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_net_crimsonwoods_android_libs_uvccap_FrameSubscriber_n_1close
+  (JNIEnv *env, jclass cls, jlong handle)
+{
+	uvcc_pump_close_subscriber(TO_SUBSCRIBER(handle));
+}
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_FrameSubscriber
+ * Method:    n_getDropped
+ * Signature: (J)I
+ */
+JNIEXPORT jint JNICALL Java_net_crimsonwoods_android_libs_uvccap_FrameSubscriber_n_1getDropped
+  (JNIEnv *env, jclass cls, jlong handle)
+{
+	return uvcc_pump_dropped(TO_SUBSCRIBER(handle));
+}
+
+static jboolean set_frame(JNIEnv *env, jobject obj, uvcc_frame_t const *frame)
+{
+	jint strides[UVCC_MAX_PLANES];
+	jobjectArray planes;
+	jintArray stride_array;
+	jobject plane;
+	jclass buffer_cls;
+	jclass cls;
+	uint32_t i;
+
+	cls = (*env)->GetObjectClass(env, obj);
+	jfieldID field_index     = (*env)->GetFieldID(env, cls, "index", "I");
+	jfieldID field_sequence  = (*env)->GetFieldID(env, cls, "sequence", "I");
+	jfieldID field_timestamp = (*env)->GetFieldID(env, cls, "timestampUs", "J");
+	jfieldID field_planes    = (*env)->GetFieldID(env, cls, "planes", "[Ljava/nio/ByteBuffer;");
+	jfieldID field_strides   = (*env)->GetFieldID(env, cls, "strides", "[I");
+	(*env)->DeleteLocalRef(env, cls);
+	if (!field_index || !field_sequence || !field_timestamp || !field_planes || !field_strides) {
+		return JNI_FALSE;
+	}
+
+	buffer_cls = (*env)->FindClass(env, "java/nio/ByteBuffer");
+	if (NULL == buffer_cls) {
+		return JNI_FALSE;
+	}
+	planes = (*env)->NewObjectArray(env, frame->plane_count, buffer_cls, NULL);
+	(*env)->DeleteLocalRef(env, buffer_cls);
+	if (NULL == planes) {
+		return JNI_FALSE;
+	}
+	for (i = 0; i < frame->plane_count; ++i) {
+		// the planes are read through the driver mapping, no copy is made.
+		plane = (*env)->NewDirectByteBuffer(env, (void*)frame->planes[i].data, frame->planes[i].bytesused);
+		if (NULL == plane) {
+			return JNI_FALSE;
+		}
+		(*env)->SetObjectArrayElement(env, planes, i, plane);
+		(*env)->DeleteLocalRef(env, plane);
+		strides[i] = frame->planes[i].stride;
+	}
+	stride_array = (*env)->NewIntArray(env, frame->plane_count);
+	if (NULL == stride_array) {
+		return JNI_FALSE;
+	}
+	(*env)->SetIntArrayRegion(env, stride_array, 0, frame->plane_count, strides);
+
+	(*env)->SetIntField(env, obj, field_index, frame->index);
+	(*env)->SetIntField(env, obj, field_sequence, frame->info.sequence);
+	(*env)->SetLongField(env, obj, field_timestamp, frame->info.timestamp_us);
+	(*env)->SetObjectField(env, obj, field_planes, planes);
+	(*env)->SetObjectField(env, obj, field_strides, stride_array);
+	return JNI_TRUE;
+}
+
+static void throw_exception(JNIEnv *env, char const * const cls, char const * const message)
+{
+	jclass ioe_cls = (*env)->FindClass(env, cls);
+	if (NULL == ioe_cls) {
+		return;
+	}
+	(*env)->ThrowNew(env, ioe_cls, message);
+	(*env)->DeleteLocalRef(env, ioe_cls);
+}
+
+static void throw_IllegalStateException(JNIEnv *env, char const * const message)
+{
+	throw_exception(env, "java/lang/IllegalStateException", message);
+}
+
+static void throw_RuntimeException(JNIEnv *env, char const * const message)
+{
+	throw_exception(env, "java/lang/RuntimeException", message);
+}
@@ -0,0 +1,51 @@
+/* DO NOT EDIT THIS FILE - it is machine generated */
+#include <jni.h>
+/* Header for class net_crimsonwoods_android_libs_uvccap_FrameSubscriber */
+
+#ifndef _Included_net_crimsonwoods_android_libs_uvccap_FrameSubscriber
+#define _Included_net_crimsonwoods_android_libs_uvccap_FrameSubscriber
+#ifdef __cplusplus
+extern "C" {
+#endif
+#undef net_crimsonwoods_android_libs_uvccap_FrameSubscriber_EVERY_FRAME
+#define net_crimsonwoods_android_libs_uvccap_FrameSubscriber_EVERY_FRAME 0L
+#undef net_crimsonwoods_android_libs_uvccap_FrameSubscriber_LATEST_ONLY
+#define net_crimsonwoods_android_libs_uvccap_FrameSubscriber_LATEST_ONLY 1L
+#undef net_crimsonwoods_android_libs_uvccap_FrameSubscriber_EVERY_NTH
+#define net_crimsonwoods_android_libs_uvccap_FrameSubscriber_EVERY_NTH 2L
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_FrameSubscriber
+ * Method:    n_acquire
+ * Signature: (JILnet/crimsonwoods/android/libs/uvccap/FrameSubscriber/SharedFrame;)Z
+ */
+JNIEXPORT jboolean JNICALL Java_net_crimsonwoods_android_libs_uvccap_FrameSubscriber_n_1acquire
+  (JNIEnv *, jclass, jlong, jint, jobject);
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_FrameSubscriber
+ * Method:    n_release
+ * Signature: (JI)V
+ */
+JNIEXPORT void JNICALL Java_net_crimsonwoods_android_libs_uvccap_FrameSubscriber_n_1release
+  (JNIEnv *, jclass, jlong, jint);
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_FrameSubscriber
+ * Method:    n_close
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_net_crimsonwoods_android_libs_uvccap_FrameSubscriber_n_1close
+  (JNIEnv *, jclass, jlong);
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_FrameSubscriber
+ * Method:    n_getDropped
+ * Signature: (J)I
+ */
+JNIEXPORT jint JNICALL Java_net_crimsonwoods_android_libs_uvccap_FrameSubscriber_n_1getDropped
+  (JNIEnv *, jclass, jlong);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
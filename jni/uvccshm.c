@@ -0,0 +1,348 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/ioctl.h>
+#ifdef __ANDROID__
+#include <linux/ashmem.h>
+#endif
+
+#include "uvccap.h"
+#include "uvccshm.h"
+#include "uvcccopy.h"
+
+#define SHM_MAGIC   0x4d534355 // "UCSM"
+#define SHM_VERSION 1
+#define SHM_ALIGN   64
+
+#ifndef MFD_CLOEXEC
+#define MFD_CLOEXEC       0x0001U
+#define MFD_ALLOW_SEALING 0x0002U
+#endif
+#ifndef F_ADD_SEALS
+#define F_ADD_SEALS  (1024 + 9)
+#define F_SEAL_SHRINK 0x0002
+#define F_SEAL_GROW   0x0004
+#endif
+
+typedef struct shm_header_t_ {
+	uint32_t          magic;
+	uint32_t          version;
+	uint32_t          slot_count;
+	uint32_t          slot_size;   // bytes of frame data per slot.
+	uint32_t          slot_stride; // bytes from one slot to the next, header included.
+	volatile uint32_t head;        // number of frames published.
+} shm_header_t;
+
+typedef struct shm_plane_t_ {
+	uint32_t offset; // from the data of the slot.
+	uint32_t stride;
+	uint32_t bytesused;
+} shm_plane_t;
+
+typedef struct shm_slot_t_ {
+	volatile uint32_t stamp; // 2 * index + 1 while written, 2 * index + 2 once complete.
+	uint32_t          width;
+	uint32_t          height;
+	uint32_t          pixel_format;
+	uint32_t          plane_count;
+	uint32_t          sequence;
+	int64_t           timestamp_us;
+	shm_plane_t       planes[UVCC_MAX_PLANES];
+} shm_slot_t;
+
+#define ALIGN_UP(v, a) (((v) + (a) - 1) & ~((a) - 1))
+#define HEADER_SIZE    ALIGN_UP(sizeof(shm_header_t), SHM_ALIGN)
+#define SLOT_HEADER_SIZE ALIGN_UP(sizeof(shm_slot_t), SHM_ALIGN)
+
+struct uvcc_shm_publisher_t_ {
+	int           fd;
+	size_t        size;
+	shm_header_t *header;
+};
+
+struct uvcc_shm_reader_t_ {
+	size_t              size;
+	shm_header_t const *header;
+	uint32_t            slot_count;
+	uint32_t            slot_size;
+	uint32_t            slot_stride;
+};
+
+static shm_slot_t *slot_at(shm_header_t const *header, uint32_t stride, uint32_t count, uint32_t index) {
+	return (shm_slot_t*)((uint8_t*)header + HEADER_SIZE + (size_t)stride * (index % count));
+}
+
+static int create_memory(char const *name, size_t size) {
+	int fd = -1;
+
+#ifdef __NR_memfd_create
+	fd = syscall(__NR_memfd_create, name, MFD_CLOEXEC | MFD_ALLOW_SEALING);
+	if (0 <= fd) {
+		if (0 > ftruncate(fd, size)) {
+			close(fd);
+			return -1;
+		}
+		// readers can not be hit by SIGBUS from a shrinking ring.
+		fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW);
+		return fd;
+	}
+#endif
+#ifdef __ANDROID__
+	fd = open("/dev/ashmem", O_RDWR | O_CLOEXEC);
+	if (0 <= fd) {
+		ioctl(fd, ASHMEM_SET_NAME, name);
+		if (0 > ioctl(fd, ASHMEM_SET_SIZE, size)) {
+			close(fd);
+			return -1;
+		}
+	}
+#endif
+	return fd;
+}
+
+int uvcc_shm_publisher_create(char const *name, uint32_t slot_size, uint32_t slot_count, uvcc_shm_publisher_t **pub) {
+	uvcc_shm_publisher_t *p;
+	uint32_t stride;
+
+	if ((NULL == pub) || (0 == slot_size) || (0 == slot_count)) {
+		return INVALID_ARGUMENTS;
+	}
+	if (SIZE_MAX / slot_count < (size_t)slot_size + SLOT_HEADER_SIZE + SHM_ALIGN) {
+		return INVALID_ARGUMENTS;
+	}
+	stride = ALIGN_UP(slot_size, SHM_ALIGN) + SLOT_HEADER_SIZE;
+
+	p = (uvcc_shm_publisher_t*)calloc(1, sizeof(uvcc_shm_publisher_t));
+	if (NULL == p) {
+		return INSUFFICIENT_MEMORY;
+	}
+	p->size = HEADER_SIZE + (size_t)stride * slot_count;
+	p->fd = create_memory((NULL != name) ? name : "uvcc-frames", p->size);
+	if (0 > p->fd) {
+		free(p);
+		return IO_FILE_NOT_CREATED;
+	}
+	p->header = (shm_header_t*)mmap(NULL, p->size, PROT_READ | PROT_WRITE, MAP_SHARED, p->fd, 0);
+	if (MAP_FAILED == p->header) {
+		close(p->fd);
+		free(p);
+		return MEMORY_MAPPING_FAILED;
+	}
+
+	p->header->version = SHM_VERSION;
+	p->header->slot_count = slot_count;
+	p->header->slot_size = slot_size;
+	p->header->slot_stride = stride;
+	p->header->head = 0;
+	__sync_synchronize();
+	p->header->magic = SHM_MAGIC;
+
+	*pub = p;
+	return NOERROR;
+}
+
+void uvcc_shm_publisher_destroy(uvcc_shm_publisher_t *pub) {
+	if (NULL == pub) {
+		return;
+	}
+	munmap(pub->header, pub->size);
+	close(pub->fd);
+	free(pub);
+}
+
+int uvcc_shm_publisher_fd(uvcc_shm_publisher_t const *pub) {
+	return (NULL != pub) ? pub->fd : -1;
+}
+
+int uvcc_shm_publish(uvcc_shm_publisher_t *pub, uvcc_frame_t const *frame, uint32_t width, uint32_t height, uint32_t pixel_format) {
+	shm_header_t *header;
+	shm_slot_t *slot;
+	uint8_t *data;
+	uint32_t index;
+	uint32_t offset = 0;
+	uint32_t i;
+
+	if ((NULL == pub) || (NULL == frame) || (UVCC_MAX_PLANES < frame->plane_count)) {
+		return INVALID_ARGUMENTS;
+	}
+	header = pub->header;
+	for (i = 0; i < frame->plane_count; ++i) {
+		offset += frame->planes[i].bytesused;
+	}
+	if (offset > header->slot_size) {
+		return INVALID_ARGUMENTS;
+	}
+
+	index = header->head;
+	slot = slot_at(header, header->slot_stride, header->slot_count, index);
+	data = (uint8_t*)slot + SLOT_HEADER_SIZE;
+
+	slot->stamp = 2 * index + 1;
+	__sync_synchronize();
+
+	slot->width = width;
+	slot->height = height;
+	slot->pixel_format = pixel_format;
+	slot->plane_count = frame->plane_count;
+	slot->sequence = frame->info.sequence;
+	slot->timestamp_us = frame->info.timestamp_us;
+	offset = 0;
+	for (i = 0; i < frame->plane_count; ++i) {
+		slot->planes[i].offset = offset;
+		slot->planes[i].stride = frame->planes[i].stride;
+		slot->planes[i].bytesused = frame->planes[i].bytesused;
+		uvcc_copy(data + offset, frame->planes[i].data, frame->planes[i].bytesused);
+		offset += frame->planes[i].bytesused;
+	}
+
+	__sync_synchronize();
+	slot->stamp = 2 * index + 2;
+	__sync_synchronize();
+	header->head = index + 1;
+
+	return NOERROR;
+}
+
+int uvcc_shm_reader_open(int fd, uvcc_shm_reader_t **reader) {
+	uvcc_shm_reader_t *r;
+	shm_header_t const *header;
+	shm_header_t h;
+	struct stat st;
+	size_t size;
+
+	if ((0 > fd) || (NULL == reader)) {
+		return INVALID_ARGUMENTS;
+	}
+
+	header = (shm_header_t const*)mmap(NULL, HEADER_SIZE, PROT_READ, MAP_SHARED, fd, 0);
+	if (MAP_FAILED == header) {
+		return MEMORY_MAPPING_FAILED;
+	}
+	memcpy(&h, header, sizeof(h));
+	munmap((void*)header, HEADER_SIZE);
+
+	if ((SHM_MAGIC != h.magic) || (SHM_VERSION != h.version) || (0 == h.slot_count) ||
+		(h.slot_stride < ALIGN_UP(h.slot_size, SHM_ALIGN) + SLOT_HEADER_SIZE) ||
+		((SIZE_MAX - HEADER_SIZE) / h.slot_count < h.slot_stride)) {
+		return INVALID_FORMAT_ARGUMENTS;
+	}
+	size = HEADER_SIZE + (size_t)h.slot_stride * h.slot_count;
+	// ashmem reports no size.
+	if ((0 == fstat(fd, &st)) && (0 < st.st_size) && ((size_t)st.st_size < size)) {
+		return INVALID_FORMAT_ARGUMENTS;
+	}
+
+	r = (uvcc_shm_reader_t*)calloc(1, sizeof(uvcc_shm_reader_t));
+	if (NULL == r) {
+		return INSUFFICIENT_MEMORY;
+	}
+	r->header = (shm_header_t const*)mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+	if (MAP_FAILED == r->header) {
+		free(r);
+		return MEMORY_MAPPING_FAILED;
+	}
+	// the geometry is taken once, the publisher can not change it under us.
+	r->size = size;
+	r->slot_count = h.slot_count;
+	r->slot_size = h.slot_size;
+	r->slot_stride = h.slot_stride;
+
+	*reader = r;
+	return NOERROR;
+}
+
+void uvcc_shm_reader_close(uvcc_shm_reader_t *reader) {
+	if (NULL == reader) {
+		return;
+	}
+	munmap((void*)reader->header, reader->size);
+	free(reader);
+}
+
+uint32_t uvcc_shm_reader_head(uvcc_shm_reader_t const *reader) {
+	uint32_t head;
+	if (NULL == reader) {
+		return 0;
+	}
+	head = reader->header->head;
+	__sync_synchronize();
+	return head;
+}
+
+int uvcc_shm_read(uvcc_shm_reader_t const *reader, uint32_t index, uvcc_shm_frame_t *frame) {
+	shm_slot_t const *slot;
+	uint8_t const *data;
+	uint32_t head;
+	uint32_t stamp;
+	uint32_t i;
+
+	if ((NULL == reader) || (NULL == frame)) {
+		return INVALID_ARGUMENTS;
+	}
+
+	head = uvcc_shm_reader_head(reader);
+	if (UVCC_SHM_LATEST == index) {
+		if (0 == head) {
+			return NO_MORE_DATA;
+		}
+		index = head - 1;
+	}
+	if (0 <= (int32_t)(index - head)) {
+		return NO_MORE_DATA;
+	}
+	if (head - index > reader->slot_count) {
+		return FRAME_OVERWRITTEN;
+	}
+
+	slot = slot_at(reader->header, reader->slot_stride, reader->slot_count, index);
+	data = (uint8_t const*)slot + SLOT_HEADER_SIZE;
+
+	stamp = slot->stamp;
+	__sync_synchronize();
+	if (2 * index + 2 != stamp) {
+		return FRAME_OVERWRITTEN;
+	}
+
+	frame->index = index;
+	frame->width = slot->width;
+	frame->height = slot->height;
+	frame->pixel_format = slot->pixel_format;
+	frame->plane_count = slot->plane_count;
+	frame->info.sequence = slot->sequence;
+	frame->info.timestamp_us = slot->timestamp_us;
+	frame->info.bytesused = 0;
+	frame->stamp = stamp;
+	if (UVCC_MAX_PLANES < frame->plane_count) {
+		return FRAME_OVERWRITTEN;
+	}
+	for (i = 0; i < frame->plane_count; ++i) {
+		shm_plane_t const p = slot->planes[i];
+		// never point outside the slot, whatever is in the shared memory.
+		if ((p.offset > reader->slot_size) || (p.bytesused > reader->slot_size - p.offset)) {
+			return FRAME_OVERWRITTEN;
+		}
+		frame->planes[i].data = data + p.offset;
+		frame->planes[i].stride = p.stride;
+		frame->planes[i].bytesused = p.bytesused;
+		frame->info.bytesused += p.bytesused;
+	}
+
+	return uvcc_shm_validate(reader, frame);
+}
+
+int uvcc_shm_validate(uvcc_shm_reader_t const *reader, uvcc_shm_frame_t const *frame) {
+	shm_slot_t const *slot;
+
+	if ((NULL == reader) || (NULL == frame)) {
+		return INVALID_ARGUMENTS;
+	}
+	slot = slot_at(reader->header, reader->slot_stride, reader->slot_count, frame->index);
+	__sync_synchronize();
+	return (frame->stamp == slot->stamp) ? NOERROR : FRAME_OVERWRITTEN;
+}
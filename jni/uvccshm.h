@@ -0,0 +1,68 @@
+#ifndef UVCC_SHM_H
+#define UVCC_SHM_H
+
+#include <stdint.h>
+
+#include "uvccap.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Ring of frames in shared memory (memfd, or ashmem on kernels without
+ * memfd) for readers in other processes. The publisher copies each frame
+ * once into the next slot; readers map the same memory read-only and use
+ * the frames in place.
+ *
+ * Nothing is locked: every slot carries a sequence word that is odd while
+ * the publisher writes it (seqlock). A reader checks the word before using
+ * a frame and again with uvcc_shm_validate when done; a frame the publisher
+ * overwrote in between has to be discarded. A slow reader never blocks the
+ * publisher, it only loses frames.
+ *
+ * The ring is handed to readers as a file descriptor, over a unix socket
+ * (SCM_RIGHTS) or binder. Readers only need this header and uvccshm.c.
+ */
+typedef struct uvcc_shm_publisher_t_ uvcc_shm_publisher_t;
+typedef struct uvcc_shm_reader_t_ uvcc_shm_reader_t;
+
+/* Frame read in place from the ring. */
+typedef struct uvcc_shm_frame_t {
+	uint32_t          index; // number of the frame since the ring was created.
+	uint32_t          width;
+	uint32_t          height;
+	uint32_t          pixel_format; // uvcc_pixel_format_t
+	uint32_t          plane_count;
+	uvcc_plane_t      planes[UVCC_MAX_PLANES];
+	uvcc_frame_info_t info;
+	uint32_t          stamp; // slot sequence word seen by uvcc_shm_read.
+} uvcc_shm_frame_t;
+
+#define UVCC_SHM_LATEST ((uint32_t)-1)
+
+/* 'slot_size' is the largest frame in bytes, all planes together. */
+extern int  uvcc_shm_publisher_create(char const *name, uint32_t slot_size, uint32_t slot_count, uvcc_shm_publisher_t **pub);
+extern void uvcc_shm_publisher_destroy(uvcc_shm_publisher_t *pub);
+/* Owned by the publisher, dup it to keep it beyond the publisher. */
+extern int  uvcc_shm_publisher_fd(uvcc_shm_publisher_t const *pub);
+extern int  uvcc_shm_publish(uvcc_shm_publisher_t *pub, uvcc_frame_t const *frame, uint32_t width, uint32_t height, uint32_t pixel_format);
+
+/* The reader maps the ring and keeps no reference to 'fd'. */
+extern int  uvcc_shm_reader_open(int fd, uvcc_shm_reader_t **reader);
+extern void uvcc_shm_reader_close(uvcc_shm_reader_t *reader);
+/* Index of the next frame to be published. */
+extern uint32_t uvcc_shm_reader_head(uvcc_shm_reader_t const *reader);
+/*
+ * Locate frame 'index' (UVCC_SHM_LATEST for the newest one). NO_MORE_DATA
+ * if it is not published yet, FRAME_OVERWRITTEN if it is already gone.
+ */
+extern int  uvcc_shm_read(uvcc_shm_reader_t const *reader, uint32_t index, uvcc_shm_frame_t *frame);
+/* NOERROR if the frame was not overwritten since uvcc_shm_read. */
+extern int  uvcc_shm_validate(uvcc_shm_reader_t const *reader, uvcc_shm_frame_t const *frame);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,87 @@
+#include "uvccshm_jni.h"
+#include "uvccap.h"
+#include "uvccshm.h"
+#include <stdint.h>
+
+static void throw_IllegalArgumentException(JNIEnv *env, char const * const message);
+static void throw_IOException(JNIEnv *env, char const * const message);
+
+#define TO_PUBLISHER(h) ((uvcc_shm_publisher_t*)(intptr_t)h)
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_FrameRing
+ * Method:    n_create
+ * Signature: (Ljava/lang/String;II)J
+ */
+JNIEXPORT jlong JNICALL Java_net_crimsonwoods_android_libs_uvccap_FrameRing_n_1create
+  (JNIEnv *env, jclass cls, jstring name, jint slot_size, jint slot_count)
+{
+	uvcc_shm_publisher_t *pub = NULL;
+	char const *name_chars = NULL;
+	int result;
+
+	if ((0 >= slot_size) || (0 >= slot_count)) {
+		throw_IllegalArgumentException(env, "'slotSize' and 'slotCount' have to be positive.");
+		return 0;
+	}
+	if (NULL != name) {
+		name_chars = (*env)->GetStringUTFChars(env, name, NULL);
+		if (NULL == name_chars) {
+			return 0;
+		}
+	}
+	result = uvcc_shm_publisher_create(name_chars, slot_size, slot_count, &pub);
+	if (NULL != name_chars) {
+		(*env)->ReleaseStringUTFChars(env, name, name_chars);
+	}
+	if (INVALID_ARGUMENTS == result) {
+		throw_IllegalArgumentException(env, "Frame ring is too large.");
+		return 0;
+	} else if (NOERROR != result) {
+		throw_IOException(env, "Shared memory can't be created.");
+		return 0;
+	}
+	return (jlong)(intptr_t)pub;
+}
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_FrameRing
+ * Method:    n_destroy
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_net_crimsonwoods_android_libs_uvccap_FrameRing_n_1destroy
+  (JNIEnv *env, jclass cls, jlong handle)
+{
+	uvcc_shm_publisher_destroy(TO_PUBLISHER(handle));
+}
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_FrameRing
+ * Method:    n_getFd
+ * Signature: (J)I
+ */
+JNIEXPORT jint JNICALL Java_net_crimsonwoods_android_libs_uvccap_FrameRing_n_1getFd
+  (JNIEnv *env, jclass cls, jlong handle)
+{
+	return uvcc_shm_publisher_fd(TO_PUBLISHER(handle));
+}
+
+static void throw_exception(JNIEnv *env, char const * const cls, char const * const message)
+{
+	jclass ioe_cls = (*env)->FindClass(env, cls);
+	if (NULL == ioe_cls) {
+		return;
+	}
+	(*env)->ThrowNew(env, ioe_cls, message);
+	(*env)->DeleteLocalRef(env, ioe_cls);
+}
+
+static void throw_IllegalArgumentException(JNIEnv *env, char const * const message)
+{
+	throw_exception(env, "java/lang/IllegalArgumentException", message);
+}
+
+static void throw_IOException(JNIEnv *env, char const * const message)
+{
+	throw_exception(env, "java/io/IOException", message);
+}
@@ -0,0 +1,37 @@
+/* DO NOT EDIT THIS FILE - it is machine generated */
+#include <jni.h>
+/* Header for class net_crimsonwoods_android_libs_uvccap_FrameRing */
+
+#ifndef _Included_net_crimsonwoods_android_libs_uvccap_FrameRing
+#define _Included_net_crimsonwoods_android_libs_uvccap_FrameRing
+#ifdef __cplusplus
+extern "C" {
+#endif
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_FrameRing
+ * Method:    n_create
+ * Signature: (Ljava/lang/String;II)J
+ */
+JNIEXPORT jlong JNICALL Java_net_crimsonwoods_android_libs_uvccap_FrameRing_n_1create
+  (JNIEnv *, jclass, jstring, jint, jint);
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_FrameRing
+ * Method:    n_destroy
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_net_crimsonwoods_android_libs_uvccap_FrameRing_n_1destroy
+  (JNIEnv *, jclass, jlong);
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_FrameRing
+ * Method:    n_getFd
+ * Signature: (J)I
+ */
+JNIEXPORT jint JNICALL Java_net_crimsonwoods_android_libs_uvccap_FrameRing_n_1getFd
+  (JNIEnv *, jclass, jlong);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
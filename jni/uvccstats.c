@@ -0,0 +1,154 @@
+#include <string.h>
+#include <stdint.h>
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define UVCC_STATS_NEON 1
+#endif
+
+#include "uvccstats.h"
+#include "uvcccopy.h"
+
+// the loads below assume a little endian CPU, as every Android ABI is.
+#define BIN_BYTES8(bins, w) \
+	do { \
+		++(bins)[0][(w)         & 0xff]; \
+		++(bins)[1][((w) >>  8) & 0xff]; \
+		++(bins)[2][((w) >> 16) & 0xff]; \
+		++(bins)[3][((w) >> 24) & 0xff]; \
+		++(bins)[0][((w) >> 32) & 0xff]; \
+		++(bins)[1][((w) >> 40) & 0xff]; \
+		++(bins)[2][((w) >> 48) & 0xff]; \
+		++(bins)[3][((w) >> 56)]; \
+	} while (0)
+
+// every other byte of w, starting at the lowest.
+#define BIN_BYTES4(bins, w) \
+	do { \
+		++(bins)[0][(w)         & 0xff]; \
+		++(bins)[1][((w) >> 16) & 0xff]; \
+		++(bins)[2][((w) >> 32) & 0xff]; \
+		++(bins)[3][((w) >> 48) & 0xff]; \
+	} while (0)
+
+static inline uint64_t load64(uint8_t const *p) {
+	uint64_t w;
+	memcpy(&w, p, sizeof(w));
+	return w;
+}
+
+void uvcc_stats_reset(uvcc_stats_acc_t *acc) {
+	memset(acc, 0, sizeof(*acc));
+}
+
+// copy and count 16 samples at a time, the rest is left to the caller.
+static inline size_t copy_planar(uint32_t (*bins)[UVCC_STATS_BINS], uint8_t *dst, uint8_t const *src, uint32_t samples) {
+	uint64_t w0, w1;
+	uint32_t n;
+
+	for (n = 0; n + 16 <= samples; n += 16) {
+#ifdef UVCC_STATS_NEON
+		uint8x16_t const v = vld1q_u8(src + n);
+		vst1q_u8(dst + n, v);
+		w0 = vgetq_lane_u64(vreinterpretq_u64_u8(v), 0);
+		w1 = vgetq_lane_u64(vreinterpretq_u64_u8(v), 1);
+#else
+		w0 = load64(src + n);
+		w1 = load64(src + n + 8);
+		memcpy(dst + n, &w0, sizeof(w0));
+		memcpy(dst + n + 8, &w1, sizeof(w1));
+#endif
+		BIN_BYTES8(bins, w0);
+		BIN_BYTES8(bins, w1);
+	}
+	return n;
+}
+
+// 16 samples are the even or odd bytes of 32 packed YUYV or UYVY bytes.
+static inline size_t copy_packed(uint32_t (*bins)[UVCC_STATS_BINS], uint8_t *dst, uint8_t const *src, uint32_t first, uint32_t samples) {
+	uint64_t w0, w1;
+	uint32_t n;
+
+	for (n = 0; n + 16 <= samples; n += 16) {
+		uint8_t const *s = src + n * 2;
+		uint8_t *d = dst + n * 2;
+#ifdef UVCC_STATS_NEON
+		uint8x16x2_t const v = vld2q_u8(s);
+		vst2q_u8(d, v);
+		w0 = vgetq_lane_u64(vreinterpretq_u64_u8(v.val[first]), 0);
+		w1 = vgetq_lane_u64(vreinterpretq_u64_u8(v.val[first]), 1);
+		BIN_BYTES8(bins, w0);
+		BIN_BYTES8(bins, w1);
+#else
+		uint32_t i;
+		for (i = 0; i < 32; i += 16) {
+			w0 = load64(s + i);
+			w1 = load64(s + i + 8);
+			memcpy(d + i, &w0, sizeof(w0));
+			memcpy(d + i + 8, &w1, sizeof(w1));
+			w0 >>= first * 8;
+			w1 >>= first * 8;
+			BIN_BYTES4(bins, w0);
+			BIN_BYTES4(bins, w1);
+		}
+#endif
+	}
+	return n;
+}
+
+void uvcc_stats_copy_row(uvcc_stats_acc_t *acc, uint8_t *dst, uint8_t const *src, size_t size,
+	uint32_t first, uint32_t step, uint32_t samples)
+{
+	size_t const end = first + (size_t)step * samples;
+	size_t copied;
+	size_t n;
+
+	if ((0 == step) || (2 < step) || (first >= step) || (end > size)) {
+		uvcc_copy(dst, src, size);
+		return;
+	}
+
+	if (1 == step) {
+		n = copy_planar(acc->bins, dst, src, samples);
+	} else {
+		n = copy_packed(acc->bins, dst, src, first, samples);
+	}
+	copied = n * step;
+	for (; n < samples; ++n) {
+		++acc->bins[n & 3][src[first + n * step]];
+	}
+	uvcc_copy(dst + copied, src + copied, size - copied);
+}
+
+void uvcc_stats_finish(uvcc_stats_acc_t const *acc, uvcc_frame_stats_t *stats) {
+	uint64_t sum = 0;
+	uint32_t count;
+	uint32_t i;
+
+	stats->samples = 0;
+	stats->min     = UVCC_STATS_BINS - 1;
+	stats->max     = 0;
+	stats->clipped = 0;
+	for (i = 0; i < UVCC_STATS_BINS; ++i) {
+		count = acc->bins[0][i] + acc->bins[1][i] + acc->bins[2][i] + acc->bins[3][i];
+		stats->histogram[i] = count;
+		if (0 == count) {
+			continue;
+		}
+		stats->samples += count;
+		sum += (uint64_t)count * i;
+		if (i < stats->min) {
+			stats->min = i;
+		}
+		stats->max = i;
+		if ((i <= stats->clip_low) || (i >= stats->clip_high)) {
+			stats->clipped += count;
+		}
+	}
+	if (0 == stats->samples) {
+		stats->min     = 0;
+		stats->mean_q8 = 0;
+		return;
+	}
+	stats->mean_q8 = (uint32_t)((sum * 256 + stats->samples / 2) / stats->samples);
+}
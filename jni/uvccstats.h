@@ -0,0 +1,37 @@
+#ifndef UVCC_STATS_H
+#define UVCC_STATS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "uvccap.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Luma statistics gathered while a frame is copied out of the driver
+ * buffer, so the pixels are read only once. Consecutive samples are
+ * counted into interleaved histograms, which keeps increments of the same
+ * bin from waiting on each other; they are summed up by finish.
+ */
+typedef struct uvcc_stats_acc_t {
+	uint32_t bins[4][UVCC_STATS_BINS];
+} uvcc_stats_acc_t;
+
+extern void uvcc_stats_reset(uvcc_stats_acc_t *acc);
+/*
+ * Copy 'size' bytes of a row and count 'samples' luma bytes of it, 'step'
+ * (1 or 2) bytes apart from 'first'. Padding after them is only copied.
+ */
+extern void uvcc_stats_copy_row(uvcc_stats_acc_t *acc, uint8_t *dst, uint8_t const *src, size_t size,
+	uint32_t first, uint32_t step, uint32_t samples);
+/* Fill the histogram, mean, min, max and clipped count of 'stats'. */
+extern void uvcc_stats_finish(uvcc_stats_acc_t const *acc, uvcc_frame_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,131 @@
+#include <string.h>
+#include <errno.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+
+#include "uvccthread.h"
+
+#define MAX_CPUS 32
+
+pid_t uvcc_thread_self(void) {
+	return (pid_t)syscall(__NR_gettid);
+}
+
+// raw syscalls, cpu_set_t is missing from the older platform headers.
+static int set_affinity(pid_t tid, uint32_t cpu_mask) {
+	unsigned long mask = cpu_mask;
+	return (int)syscall(__NR_sched_setaffinity, tid, sizeof(mask), &mask);
+}
+
+static uint32_t get_affinity(pid_t tid) {
+	unsigned long mask = 0;
+	if (0 > syscall(__NR_sched_getaffinity, tid, sizeof(mask), &mask)) {
+		return 0;
+	}
+	return (uint32_t)mask;
+}
+
+static uint32_t get_present_cpus(void) {
+	long const count = sysconf(_SC_NPROCESSORS_CONF);
+	if ((0 >= count) || (MAX_CPUS <= count)) {
+		return 0xffffffffu;
+	}
+	return (1u << count) - 1;
+}
+
+static void apply_affinity(pid_t tid, uint32_t cpu_mask, uvcc_thread_policy_t *applied) {
+	uint32_t const mask = cpu_mask & get_present_cpus();
+
+	if ((0 != mask) && (0 == set_affinity(tid, mask))) {
+		applied->flags |= UVCC_THREAD_AFFINITY;
+	}
+}
+
+static int apply_fifo(pid_t tid, int32_t priority) {
+	struct sched_param param;
+
+	if ((priority < sched_get_priority_min(SCHED_FIFO)) || (priority > sched_get_priority_max(SCHED_FIFO))) {
+		return 0;
+	}
+	memset(&param, 0, sizeof(param));
+	param.sched_priority = priority;
+	return 0 == sched_setscheduler(tid, SCHED_FIFO, &param);
+}
+
+// a thread left SCHED_FIFO by an earlier policy goes back to time sharing.
+static void apply_other(pid_t tid) {
+	struct sched_param param;
+
+	if (SCHED_OTHER == sched_getscheduler(tid)) {
+		return;
+	}
+	memset(&param, 0, sizeof(param));
+	sched_setscheduler(tid, SCHED_OTHER, &param);
+}
+
+static int apply_nice(pid_t tid, int32_t nice) {
+	if ((-20 > nice) || (19 < nice)) {
+		return 0;
+	}
+	return 0 == setpriority(PRIO_PROCESS, tid, nice);
+}
+
+void uvcc_thread_apply(pid_t tid, uvcc_thread_policy_t const *policy, uvcc_thread_policy_t *applied) {
+	struct sched_param param;
+	int nice;
+
+	memset(applied, 0, sizeof(*applied));
+	if (0 == tid) {
+		tid = uvcc_thread_self();
+	}
+
+	if (policy->flags & UVCC_THREAD_AFFINITY) {
+		apply_affinity(tid, policy->cpu_mask, applied);
+	}
+
+	if ((policy->flags & UVCC_THREAD_FIFO) && apply_fifo(tid, policy->fifo_priority)) {
+		applied->flags |= UVCC_THREAD_FIFO;
+	} else {
+		apply_other(tid);
+		if ((policy->flags & UVCC_THREAD_NICE) && apply_nice(tid, policy->nice)) {
+			applied->flags |= UVCC_THREAD_NICE;
+		}
+	}
+
+	// report what the thread runs with, whatever was asked.
+	applied->cpu_mask = get_affinity(tid);
+	if ((SCHED_FIFO == sched_getscheduler(tid)) && (0 == sched_getparam(tid, &param))) {
+		applied->fifo_priority = param.sched_priority;
+	}
+	errno = 0;
+	nice = getpriority(PRIO_PROCESS, tid);
+	applied->nice = (0 == errno) ? nice : 0;
+}
+
+void uvcc_thread_merge(uvcc_thread_policy_t *applied, uvcc_thread_policy_t const *other) {
+	applied->flags    &= other->flags;
+	applied->cpu_mask |= other->cpu_mask;
+	if (other->fifo_priority < applied->fifo_priority) {
+		applied->fifo_priority = other->fifo_priority;
+	}
+	if (other->nice > applied->nice) {
+		applied->nice = other->nice;
+	}
+}
+
+int uvcc_thread_lock_memory(void const *addr, size_t size) {
+	if ((NULL == addr) || (0 == size)) {
+		return 0;
+	}
+	return 0 == mlock(addr, size);
+}
+
+void uvcc_thread_unlock_memory(void const *addr, size_t size) {
+	if ((NULL == addr) || (0 == size)) {
+		return;
+	}
+	munlock(addr, size);
+}
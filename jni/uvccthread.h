@@ -0,0 +1,54 @@
+#ifndef UVCC_THREAD_H
+#define UVCC_THREAD_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Scheduling of the threads the library owns: the pump thread, the MJPEG
+ * decoder workers and whoever calls uvcc_thread_apply on itself. On
+ * big.LITTLE boards they otherwise migrate to little cores and get
+ * preempted by background work.
+ */
+#define UVCC_THREAD_AFFINITY 0x01 // run only on the CPUs of 'cpu_mask'.
+#define UVCC_THREAD_FIFO     0x02 // SCHED_FIFO at 'fifo_priority', needs CAP_SYS_NICE.
+#define UVCC_THREAD_NICE     0x04 // 'nice' under SCHED_OTHER, also used when SCHED_FIFO is refused.
+#define UVCC_THREAD_MLOCK    0x08 // keep the buffers of the owner resident.
+
+typedef struct uvcc_thread_policy_t {
+	uint32_t flags;         // UVCC_THREAD_* asked for, or the ones that took effect.
+	uint32_t cpu_mask;      // bit n allows CPU n.
+	int32_t  fifo_priority; // 1 to 99.
+	int32_t  nice;          // -20 to 19.
+} uvcc_thread_policy_t;
+
+extern pid_t uvcc_thread_self(void);
+
+/*
+ * Apply what the system permits of 'policy' to thread 'tid', settings that
+ * are refused are left as they are. 'applied' receives the settings the
+ * thread ends up with, its flags tell which of the requested ones took
+ * effect. UVCC_THREAD_MLOCK is left to the owner of the buffers.
+ */
+extern void uvcc_thread_apply(pid_t tid, uvcc_thread_policy_t const *policy, uvcc_thread_policy_t *applied);
+
+/*
+ * Combine the results of several threads: the flags all of them got, the
+ * CPUs any of them may run on and the weakest priority.
+ */
+extern void uvcc_thread_merge(uvcc_thread_policy_t *applied, uvcc_thread_policy_t const *other);
+
+/* Returns non zero if the pages are locked, RLIMIT_MEMLOCK often refuses. */
+extern int  uvcc_thread_lock_memory(void const *addr, size_t size);
+extern void uvcc_thread_unlock_memory(void const *addr, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,68 @@
+#include "uvccthread_jni.h"
+#include "uvccthread.h"
+#include <stdint.h>
+
+static void throw_IllegalArgumentException(JNIEnv *env, char const * const message);
+static int  get_thread_policy(JNIEnv *env, jintArray array, uvcc_thread_policy_t *policy);
+static void set_thread_policy(JNIEnv *env, jintArray array, uvcc_thread_policy_t const *policy);
+
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_ThreadPolicy
+ * Method:    n_applyToCurrentThread
+ * Signature: ([I[I)V
+ */
+JNIEXPORT void JNICALL Java_net_crimsonwoods_android_libs_uvccap_ThreadPolicy_n_1applyToCurrentThread
+  (JNIEnv *env, jclass cls, jintArray policy_array, jintArray applied_array)
+{
+	uvcc_thread_policy_t policy;
+	uvcc_thread_policy_t applied;
+
+	if (!get_thread_policy(env, policy_array, &policy)) {
+		return;
+	}
+	uvcc_thread_apply(0, &policy, &applied);
+	set_thread_policy(env, applied_array, &applied);
+}
+
+// ThreadPolicy travels as {flags, cpuMask, fifoPriority, nice}.
+static int get_thread_policy(JNIEnv *env, jintArray array, uvcc_thread_policy_t *policy) {
+	jint values[4];
+
+	if ((NULL == array) || (4 > (*env)->GetArrayLength(env, array))) {
+		throw_IllegalArgumentException(env, "Thread policy have to be 4 values.");
+		return 0;
+	}
+	(*env)->GetIntArrayRegion(env, array, 0, 4, values);
+	policy->flags         = (uint32_t)values[0];
+	policy->cpu_mask      = (uint32_t)values[1];
+	policy->fifo_priority = values[2];
+	policy->nice          = values[3];
+	return 1;
+}
+
+static void set_thread_policy(JNIEnv *env, jintArray array, uvcc_thread_policy_t const *policy) {
+	jint values[4];
+
+	if ((NULL == array) || (4 > (*env)->GetArrayLength(env, array))) {
+		throw_IllegalArgumentException(env, "Thread policy have to be 4 values.");
+		return;
+	}
+	values[0] = (jint)policy->flags;
+	values[1] = (jint)policy->cpu_mask;
+	values[2] = policy->fifo_priority;
+	values[3] = policy->nice;
+	(*env)->SetIntArrayRegion(env, array, 0, 4, values);
+}
+
+static void throw_exception(JNIEnv *env, char const * const cls, char const * const message) {
+	jclass ioe_cls = (*env)->FindClass(env, cls);
+	if (NULL == ioe_cls) {
+		return;
+	}
+	(*env)->ThrowNew(env, ioe_cls, message);
+	(*env)->DeleteLocalRef(env, ioe_cls);
+}
+
+static void throw_IllegalArgumentException(JNIEnv *env, char const * const message) {
+	throw_exception(env, "java/lang/IllegalArgumentException", message);
+}
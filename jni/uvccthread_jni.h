@@ -0,0 +1,29 @@
+/* DO NOT EDIT THIS FILE - it is machine generated */
+#include <jni.h>
+/* Header for class net_crimsonwoods_android_libs_uvccap_ThreadPolicy */
+
+#ifndef _Included_net_crimsonwoods_android_libs_uvccap_ThreadPolicy
+#define _Included_net_crimsonwoods_android_libs_uvccap_ThreadPolicy
+#ifdef __cplusplus
+extern "C" {
+#endif
+#undef net_crimsonwoods_android_libs_uvccap_ThreadPolicy_AFFINITY
+#define net_crimsonwoods_android_libs_uvccap_ThreadPolicy_AFFINITY 1L
+#undef net_crimsonwoods_android_libs_uvccap_ThreadPolicy_FIFO
+#define net_crimsonwoods_android_libs_uvccap_ThreadPolicy_FIFO 2L
+#undef net_crimsonwoods_android_libs_uvccap_ThreadPolicy_NICE
+#define net_crimsonwoods_android_libs_uvccap_ThreadPolicy_NICE 4L
+#undef net_crimsonwoods_android_libs_uvccap_ThreadPolicy_MLOCK
+#define net_crimsonwoods_android_libs_uvccap_ThreadPolicy_MLOCK 8L
+/*
+ * Class:     net_crimsonwoods_android_libs_uvccap_ThreadPolicy
+ * Method:    n_applyToCurrentThread
+ * Signature: ([I[I)V
+ */
+JNIEXPORT void JNICALL Java_net_crimsonwoods_android_libs_uvccap_ThreadPolicy_n_1applyToCurrentThread
+  (JNIEnv *, jclass, jintArray, jintArray);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,142 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+#include "uvccap.h"
+#include "uvcctrace.h"
+
+typedef struct trace_record_t_ {
+	volatile uint32_t stamp; // index + 1 once the record is complete, 0 while written.
+	uint32_t event;
+	uint32_t arg;
+	uint32_t tid;
+	int64_t  time_ns;
+} trace_record_t;
+
+struct uvcc_trace_t_ {
+	trace_record_t   *records;
+	uint32_t          mask;
+	volatile uint32_t head;
+};
+
+typedef struct trace_event_desc_t_ {
+	char const *name;
+	char        phase;
+} trace_event_desc_t;
+
+// the wait for a frame is a duration event closed by the dequeue.
+static trace_event_desc_t const EVENT_DESCS[UVCC_TRACE_EVENT_COUNT] = {
+	{ "wait",         'B' }, // UVCC_TRACE_WAIT_BEGIN
+	{ "wait",         'E' }, // UVCC_TRACE_DQBUF
+	{ "copy-done",    'i' }, // UVCC_TRACE_COPY_DONE
+	{ "qbuf",         'i' }, // UVCC_TRACE_QBUF
+	{ "convert-done", 'i' }, // UVCC_TRACE_CONVERT_DONE
+};
+
+static int64_t now_ns(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+uvcc_trace_t *uvcc_trace_create(uint32_t capacity) {
+	uvcc_trace_t *trace;
+	uint32_t size = 1;
+
+	if ((0 == capacity) || (capacity > (1u << 24))) {
+		return NULL;
+	}
+	while (size < capacity) {
+		size <<= 1;
+	}
+
+	trace = (uvcc_trace_t*)malloc(sizeof(uvcc_trace_t));
+	if (NULL == trace) {
+		return NULL;
+	}
+	trace->records = (trace_record_t*)calloc(size, sizeof(trace_record_t));
+	if (NULL == trace->records) {
+		free(trace);
+		return NULL;
+	}
+	trace->mask = size - 1;
+	trace->head = 0;
+
+	return trace;
+}
+
+void uvcc_trace_destroy(uvcc_trace_t *trace) {
+	if (NULL == trace) {
+		return;
+	}
+	free(trace->records);
+	free(trace);
+}
+
+void uvcc_trace_record(uvcc_trace_t *trace, uint32_t event, uint32_t arg) {
+	uint32_t const index = __sync_fetch_and_add(&trace->head, 1);
+	trace_record_t *record = &trace->records[index & trace->mask];
+
+	record->stamp = 0;
+	__sync_synchronize();
+	record->event   = event;
+	record->arg     = arg;
+	record->tid     = (uint32_t)syscall(__NR_gettid);
+	record->time_ns = now_ns();
+	__sync_synchronize();
+	record->stamp = index + 1;
+}
+
+int uvcc_trace_dump(uvcc_trace_t *trace, char const *path) {
+	FILE *fp;
+	trace_record_t record;
+	uint32_t head, count, index;
+	int const pid = getpid();
+	int first = 1;
+
+	if ((NULL == trace) || (NULL == path)) {
+		return INVALID_ARGUMENTS;
+	}
+
+	fp = fopen(path, "w");
+	if (NULL == fp) {
+		return IO_FILE_NOT_CREATED;
+	}
+
+	__sync_synchronize();
+	head  = trace->head;
+	count = (head > trace->mask) ? trace->mask + 1 : head;
+
+	fprintf(fp, "{\"traceEvents\":[\n");
+	for (index = head - count; index != head; ++index) {
+		trace_record_t const *slot = &trace->records[index & trace->mask];
+		if (slot->stamp != index + 1) {
+			continue; // overwritten or still being written.
+		}
+		__sync_synchronize();
+		memcpy(&record, (void const*)slot, sizeof(record));
+		__sync_synchronize();
+		if ((slot->stamp != index + 1) || (record.event >= UVCC_TRACE_EVENT_COUNT)) {
+			continue;
+		}
+		fprintf(fp, "%s{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%lld.%03d,\"pid\":%d,\"tid\":%u%s,\"args\":{\"arg\":%u}}",
+			first ? "" : ",\n",
+			EVENT_DESCS[record.event].name, EVENT_DESCS[record.event].phase,
+			(long long)(record.time_ns / 1000), (int)(record.time_ns % 1000),
+			pid, record.tid,
+			('i' == EVENT_DESCS[record.event].phase) ? ",\"s\":\"t\"" : "",
+			record.arg);
+		first = 0;
+	}
+	fprintf(fp, "\n],\"displayTimeUnit\":\"ms\"}\n");
+
+	if (0 != fclose(fp)) {
+		return IO_ERROR;
+	}
+
+	return NOERROR;
+}
@@ -0,0 +1,27 @@
+#ifndef UVCC_TRACE_H
+#define UVCC_TRACE_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Fixed size ring of timestamped events. Recording is lock-free and may be
+ * done from any thread; the oldest events are overwritten when the ring is
+ * full. Events are dumped in the Chrome trace event format (JSON), which
+ * chrome://tracing and Perfetto can load.
+ */
+typedef struct uvcc_trace_t_ uvcc_trace_t;
+
+extern uvcc_trace_t *uvcc_trace_create(uint32_t capacity);
+extern void uvcc_trace_destroy(uvcc_trace_t *trace);
+extern void uvcc_trace_record(uvcc_trace_t *trace, uint32_t event, uint32_t arg);
+extern int  uvcc_trace_dump(uvcc_trace_t *trace, char const *path);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,105 @@
+package net.crimsonwoods.android.libs.uvccap;
+
+import java.nio.ByteBuffer;
+
+/**
+ * Several cameras captured together. Frames are paired by the time the
+ * driver stamped them, a set is only returned once every camera has a
+ * frame within the tolerance of the others; frames that can't be paired
+ * are dropped.
+ * While a camera belongs to a group, its own capture methods fail with
+ * IllegalStateException.
+ */
+public final class CaptureGroup {
+	private final UVCCamera[] cameras;
+	private long nativeHandle;
+	
+	private CaptureGroup(UVCCamera[] cameras, long handle) {
+		this.cameras = cameras;
+		this.nativeHandle = handle;
+	}
+	
+	/**
+	 * @param toleranceMicros largest difference of timestamps within a set.
+	 * @param depth frames each camera may have waiting for a match.
+	 */
+	public static CaptureGroup create(UVCCamera[] cameras, int toleranceMicros, int depth) {
+		final UVCCamera[] members = cameras.clone();
+		final long[] handles = new long[members.length];
+		int attached = 0;
+		CaptureGroup group = null;
+		try {
+			for (; attached < members.length; ++attached) {
+				handles[attached] = members[attached].attachGroup();
+			}
+			group = new CaptureGroup(members, n_create(handles, toleranceMicros, depth));
+		} finally {
+			if (null == group) {
+				for (int i = 0; i < attached; ++i) {
+					members[i].detachGroup();
+				}
+			}
+		}
+		return group;
+	}
+	
+	/**
+	 * Wait for the next set and copy the frame of cameras[i] into frames[i],
+	 * the planes back to back as {@link UVCCamera#capture(FramePool)} does.
+	 * @param frames direct buffers, one for each camera.
+	 * @param timestampsUs receives the timestamps of the frames, may be null.
+	 * @param timeoutMs negative waits until a set is complete.
+	 * @return false on timeout.
+	 */
+	public synchronized boolean capture(ByteBuffer[] frames, long[] timestampsUs, int timeoutMs) {
+		checkNotClosed();
+		if (frames.length != cameras.length) {
+			throw new IllegalArgumentException("'frames' have to have a buffer for each camera.");
+		}
+		return n_capture(nativeHandle, frames, timestampsUs, timeoutMs);
+	}
+	
+	public synchronized Stats getStats() {
+		checkNotClosed();
+		return n_getStats(nativeHandle);
+	}
+	
+	/**
+	 * Give the cameras back. Streaming keeps running.
+	 */
+	public synchronized void close() {
+		if (0 == nativeHandle) {
+			return;
+		}
+		n_destroy(nativeHandle);
+		nativeHandle = 0;
+		for (UVCCamera camera : cameras) {
+			camera.detachGroup();
+		}
+	}
+	
+	private void checkNotClosed() {
+		if (0 == nativeHandle) {
+			throw new IllegalStateException("Group is closed.");
+		}
+	}
+	
+	public static final class Stats {
+		/** sets returned so far. */
+		public int sets;
+		/** frames that could not be paired. */
+		public int dropped;
+		/** spread of timestamps within the last set. */
+		public int lastSkewMicros;
+		public int maxSkewMicros;
+		public int meanSkewMicros;
+		
+		Stats() {
+		}
+	}
+	
+	private static native long n_create(long[] handles, int toleranceUs, int depth);
+	private static native void n_destroy(long handle);
+	private static native boolean n_capture(long handle, ByteBuffer[] frames, long[] timestampsUs, int timeoutMs);
+	private static native Stats n_getStats(long handle);
+}
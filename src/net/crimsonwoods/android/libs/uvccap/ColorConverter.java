@@ -1,8 +1,114 @@
 package net.crimsonwoods.android.libs.uvccap;
 
+import java.nio.ByteBuffer;
+
 public class ColorConverter {
+	/** Mirror left and right, applied before the rotation. */
+	public static final int FLIP_HORIZONTAL = 0x01;
+	/** Mirror top and bottom, applied before the rotation. */
+	public static final int FLIP_VERTICAL = 0x02;
+	
+	private static final int PACKED_YUYV = 0;
+	private static final int PACKED_UYVY = 1;
+	private static final int PLANAR_I420 = 0;
+	private static final int PLANAR_NV12 = 1;
+	private static final int PLANAR_NV21 = 2;
+	
 	static {
 		System.loadLibrary("cconv");
 	}
-	public static native void yuyvtorgb(int[] rgba, byte[] yuyv, int width, int height);
+	/**
+	 * Rows of both arrays are tightly packed.
+	 * @see #yuyvtorgb(int[], int, byte[], int, int, int)
+	 */
+	public static void yuyvtorgb(int[] rgba, byte[] yuyv, int width, int height) {
+		n_yuyvtorgb(rgba, width * 4, yuyv, width * 2, width, height);
+	}
+	
+	/**
+	 * Array variant with padded rows, e.g. a frame from
+	 * {@link UVCCamera#capture(byte[])} whose rows are
+	 * {@link UVCCamera#getStride(int)} bytes apart. Strides are in bytes,
+	 * rgbaStride a multiple of 4.
+	 */
+	public static void yuyvtorgb(int[] rgba, int rgbaStride, byte[] yuyv, int yuyvStride, int width, int height) {
+		n_yuyvtorgb(rgba, rgbaStride, yuyv, yuyvStride, width, height);
+	}
+	
+	/**
+	 * Direct buffer variant, rgba receives native-endian ARGB words.
+	 */
+	public static void yuyvtorgb(ByteBuffer rgba, ByteBuffer yuyv, int width, int height) {
+		n_yuyvtorgbDirect(rgba, width * 4, yuyv, width * 2, width, height);
+	}
+	
+	/**
+	 * Strided variant, rows of both buffers may be padded (e.g. the
+	 * driver's bytes per line, see {@link UVCCamera#getStride(int)}).
+	 * Strides are in bytes.
+	 */
+	public static void yuyvtorgb(ByteBuffer rgba, int rgbaStride, ByteBuffer yuyv, int yuyvStride, int width, int height) {
+		n_yuyvtorgbDirect(rgba, rgbaStride, yuyv, yuyvStride, width, height);
+	}
+	
+	/**
+	 * Convert, mirror and rotate in one pass. The output is height x width
+	 * when rotated by 90 or 270 degrees, rgbaStride is that of the output.
+	 * @param rotation clockwise, one of 0, 90, 180 or 270.
+	 * @param flip FLIP_HORIZONTAL and/or FLIP_VERTICAL, or 0.
+	 */
+	public static void yuyvtorgb(ByteBuffer rgba, int rgbaStride, ByteBuffer yuyv, int yuyvStride, int width, int height, int rotation, int flip) {
+		if ((0 > rotation) || (270 < rotation) || (0 != (rotation % 90))) {
+			throw new IllegalArgumentException("'rotation' have to be 0, 90, 180 or 270.");
+		}
+		n_yuyvtorgbTransformed(rgba, rgbaStride, yuyv, yuyvStride, width, height, rotation / 90, flip);
+	}
+	
+	/**
+	 * Repack YUYV or UYVY into I420 (YUV420), NV12 or NV21 planes for
+	 * encoders, the chroma of each pair of rows is averaged. Samples are
+	 * not converted. Strides are in bytes, width has to be even.
+	 */
+	public static void toPlanar(ByteBuffer src, int srcStride, PixelFormat srcFormat,
+			ByteBuffer[] planes, int[] strides, PixelFormat dstFormat, int width, int height) {
+		n_packedToPlanar(src, srcStride, toPackedFormat(srcFormat), planes, strides, toPlanarFormat(dstFormat), width, height);
+	}
+	
+	/**
+	 * Repack a frame shared by the camera straight from the driver buffer.
+	 * @see #toPlanar(ByteBuffer, int, PixelFormat, ByteBuffer[], int[], PixelFormat, int, int)
+	 */
+	public static void toPlanar(FrameSubscriber.SharedFrame frame, PixelFormat srcFormat,
+			ByteBuffer[] planes, int[] strides, PixelFormat dstFormat, int width, int height) {
+		n_packedToPlanar(frame.getPlanes()[0], frame.strides[0], toPackedFormat(srcFormat), planes, strides, toPlanarFormat(dstFormat), width, height);
+	}
+	
+	private static int toPackedFormat(PixelFormat format) {
+		switch (format) {
+		case YUYV:
+			return PACKED_YUYV;
+		case UYVY:
+			return PACKED_UYVY;
+		default:
+			throw new IllegalArgumentException("Unsupported source format " + format + ".");
+		}
+	}
+	
+	private static int toPlanarFormat(PixelFormat format) {
+		switch (format) {
+		case YUV420:
+			return PLANAR_I420;
+		case NV12:
+			return PLANAR_NV12;
+		case NV21:
+			return PLANAR_NV21;
+		default:
+			throw new IllegalArgumentException("Unsupported destination format " + format + ".");
+		}
+	}
+	
+	private static native void n_yuyvtorgb(int[] rgba, int rgbaStride, byte[] yuyv, int yuyvStride, int width, int height);
+	private static native void n_yuyvtorgbDirect(ByteBuffer rgba, int rgbaStride, ByteBuffer yuyv, int yuyvStride, int width, int height);
+	private static native void n_yuyvtorgbTransformed(ByteBuffer rgba, int rgbaStride, ByteBuffer yuyv, int yuyvStride, int width, int height, int rotation, int flip);
+	private static native void n_packedToPlanar(ByteBuffer src, int srcStride, int srcFormat, ByteBuffer[] planes, int[] strides, int dstFormat, int width, int height);
 }
@@ -0,0 +1,14 @@
+package net.crimsonwoods.android.libs.uvccap;
+
+/**
+ * Thrown by a capture when the camera was unplugged or reset and could not
+ * be reconnected. {@link UVCCamera#reconnect(int)} brings it back once the
+ * device is present again.
+ */
+public class DeviceDisconnectedException extends RuntimeException {
+	private static final long serialVersionUID = 1L;
+	
+	public DeviceDisconnectedException(String message) {
+		super(message);
+	}
+}
@@ -0,0 +1,70 @@
+package net.crimsonwoods.android.libs.uvccap;
+
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.util.concurrent.atomic.AtomicInteger;
+
+/**
+ * Reference counted frame backed by a direct buffer.
+ * A frame obtained from a {@link FramePool} goes back to the pool when the
+ * last reference is released.
+ */
+public final class Frame {
+	private final ByteBuffer buffer;
+	private final AtomicInteger refCount = new AtomicInteger(0);
+	private final FramePool pool;
+	private int length = 0;
+	
+	Frame(FramePool pool, int capacity) {
+		this.pool = pool;
+		this.buffer = ByteBuffer.allocateDirect(capacity).order(ByteOrder.nativeOrder());
+	}
+	
+	public ByteBuffer getBuffer() {
+		return buffer;
+	}
+	
+	public int getCapacity() {
+		return buffer.capacity();
+	}
+	
+	/**
+	 * @return number of valid bytes from the head of the buffer.
+	 */
+	public int getLength() {
+		return length;
+	}
+	
+	void setLength(int length) {
+		this.length = length;
+		buffer.clear();
+		buffer.limit(length);
+	}
+	
+	/**
+	 * Add a reference, every call have to be paired with {@link #release()}.
+	 */
+	public Frame acquire() {
+		if (refCount.getAndIncrement() <= 0) {
+			refCount.getAndDecrement();
+			throw new IllegalStateException("Frame is already released.");
+		}
+		return this;
+	}
+	
+	public void release() {
+		final int count = refCount.decrementAndGet();
+		if (count < 0) {
+			refCount.incrementAndGet();
+			throw new IllegalStateException("Frame is already released.");
+		}
+		if ((0 == count) && (null != pool)) {
+			pool.recycle(this);
+		}
+	}
+	
+	void reset() {
+		refCount.set(1);
+		setLength(0);
+	}
+}
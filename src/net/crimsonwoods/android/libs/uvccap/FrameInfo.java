@@ -0,0 +1,42 @@
+package net.crimsonwoods.android.libs.uvccap;
+
+/**
+ * Metadata of one frame of {@link UVCCamera#captureBurst(java.nio.ByteBuffer, int, FrameInfo[])}.
+ */
+public final class FrameInfo {
+	int offset;
+	int length;
+	int sequence;
+	long timestampUs;
+	int gap;
+	
+	public FrameInfo() {
+	}
+	
+	/**
+	 * @return position of the frame in the burst buffer.
+	 */
+	public int getOffset() {
+		return offset;
+	}
+	
+	public int getLength() {
+		return length;
+	}
+	
+	public int getSequence() {
+		return sequence;
+	}
+	
+	public long getTimestampUs() {
+		return timestampUs;
+	}
+	
+	/**
+	 * @return frames the driver dropped between the previous frame of the
+	 * burst and this one.
+	 */
+	public int getGap() {
+		return gap;
+	}
+}
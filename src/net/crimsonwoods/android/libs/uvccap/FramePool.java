@@ -0,0 +1,65 @@
+package net.crimsonwoods.android.libs.uvccap;
+
+import java.util.ArrayList;
+
+import android.util.SparseArray;
+
+/**
+ * Pool of reusable frames keyed by capacity.
+ * Once the pool is warmed up, obtaining and releasing frames allocates nothing.
+ */
+public final class FramePool {
+	private final SparseArray<ArrayList<Frame>> freeFrames = new SparseArray<ArrayList<Frame>>();
+	private final int maxFramesPerSize;
+	
+	/**
+	 * @param maxFramesPerSize maximum number of idle frames kept for each capacity.
+	 */
+	public FramePool(int maxFramesPerSize) {
+		if (maxFramesPerSize <= 0) {
+			throw new IllegalArgumentException();
+		}
+		this.maxFramesPerSize = maxFramesPerSize;
+	}
+	
+	/**
+	 * @return a frame holding one reference.
+	 */
+	public Frame obtain(int capacity) {
+		Frame frame = null;
+		synchronized (freeFrames) {
+			final ArrayList<Frame> frames = freeFrames.get(capacity);
+			if ((null != frames) && !frames.isEmpty()) {
+				frame = frames.remove(frames.size() - 1);
+			}
+		}
+		if (null == frame) {
+			frame = new Frame(this, capacity);
+		}
+		frame.reset();
+		return frame;
+	}
+	
+	void recycle(Frame frame) {
+		final int capacity = frame.getCapacity();
+		synchronized (freeFrames) {
+			ArrayList<Frame> frames = freeFrames.get(capacity);
+			if (null == frames) {
+				frames = new ArrayList<Frame>(maxFramesPerSize);
+				freeFrames.put(capacity, frames);
+			}
+			if (frames.size() < maxFramesPerSize) {
+				frames.add(frame);
+			}
+		}
+	}
+	
+	/**
+	 * Drop every idle frame.
+	 */
+	public void clear() {
+		synchronized (freeFrames) {
+			freeFrames.clear();
+		}
+	}
+}
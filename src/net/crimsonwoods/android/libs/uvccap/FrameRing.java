@@ -0,0 +1,66 @@
+package net.crimsonwoods.android.libs.uvccap;
+
+import java.io.IOException;
+
+/**
+ * Ring of frames in shared memory for readers in other processes.
+ * Frames are written by {@link UVCCamera#publish(FrameRing)}; readers map
+ * the ring from the file descriptor with the native API of uvccshm.h and
+ * read the frames in place. Pass the descriptor with
+ * ParcelFileDescriptor.fromFd or over a unix socket.
+ */
+public final class FrameRing {
+	private long nativeHandle;
+	
+	static {
+		System.loadLibrary("uvccap");
+	}
+	
+	private FrameRing(long handle) {
+		nativeHandle = handle;
+	}
+	
+	/**
+	 * @param slotSize largest frame in bytes, see {@link UVCCamera#getFrameSize()}.
+	 * @param slotCount frames kept for the readers.
+	 */
+	public static FrameRing create(String name, int slotSize, int slotCount) throws IOException {
+		return new FrameRing(n_create(name, slotSize, slotCount));
+	}
+	
+	@Override
+	protected void finalize() throws Throwable {
+		close();
+	}
+	
+	/**
+	 * @return descriptor owned by the ring, valid until {@link #close()}.
+	 */
+	public synchronized int getFd() {
+		if (0 == nativeHandle) {
+			throw new IllegalStateException("Frame ring is closed.");
+		}
+		return n_getFd(nativeHandle);
+	}
+	
+	synchronized long getHandle() {
+		if (0 == nativeHandle) {
+			throw new IllegalStateException("Frame ring is closed.");
+		}
+		return nativeHandle;
+	}
+	
+	/**
+	 * Readers that already mapped the ring keep their mapping.
+	 */
+	public synchronized void close() {
+		if (0 != nativeHandle) {
+			n_destroy(nativeHandle);
+			nativeHandle = 0;
+		}
+	}
+	
+	private static native long n_create(String name, int slotSize, int slotCount) throws IOException;
+	private static native void n_destroy(long handle);
+	private static native int n_getFd(long handle);
+}
@@ -0,0 +1,70 @@
+package net.crimsonwoods.android.libs.uvccap;
+
+/**
+ * Luma statistics of a frame, filled by {@link UVCCamera#capture(FramePool, FrameStats)}
+ * while the frame is copied. An instance is meant to be reused for every
+ * frame, nothing is allocated by the capture.
+ * Formats without a luma plane (RGB and MJPEG) leave the statistics empty.
+ */
+public final class FrameStats {
+	public static final int BINS = 256;
+	
+	final int[] histogram = new int[BINS];
+	int samples;
+	int meanQ8;
+	int min;
+	int max;
+	int clipped;
+	final int clipLow;
+	final int clipHigh;
+	
+	/**
+	 * Count samples at or below 16 and at or above 235, the limits of
+	 * video range luma, as clipped.
+	 */
+	public FrameStats() {
+		this(16, 235);
+	}
+	
+	public FrameStats(int clipLow, int clipHigh) {
+		if ((0 > clipLow) || (clipLow >= clipHigh) || (BINS <= clipHigh)) {
+			throw new IllegalArgumentException("Invalid clipping range.");
+		}
+		this.clipLow = clipLow;
+		this.clipHigh = clipHigh;
+	}
+	
+	/**
+	 * @return the histogram of the last frame, owned by this object.
+	 */
+	public int[] getHistogram() {
+		return histogram;
+	}
+	
+	public int getSampleCount() {
+		return samples;
+	}
+	
+	public float getMean() {
+		return meanQ8 / 256.0f;
+	}
+	
+	public int getMin() {
+		return min;
+	}
+	
+	public int getMax() {
+		return max;
+	}
+	
+	public int getClippedCount() {
+		return clipped;
+	}
+	
+	/**
+	 * @return clipped samples over all samples, 0 for an empty frame.
+	 */
+	public float getClippedRatio() {
+		return (0 == samples) ? 0.0f : (float)clipped / samples;
+	}
+}
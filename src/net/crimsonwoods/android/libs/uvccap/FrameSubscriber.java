@@ -0,0 +1,197 @@
+package net.crimsonwoods.android.libs.uvccap;
+
+import java.nio.ByteBuffer;
+
+/**
+ * One consumer of the frames of a {@link UVCCamera}, created by
+ * {@link UVCCamera#subscribe(int, int, int)}.
+ * Every subscriber reads the same driver buffers without copying; a buffer
+ * goes back to the driver once all subscribers released it. A subscriber
+ * that does not keep up loses frames instead of stalling the others.
+ */
+public final class FrameSubscriber {
+	/** Queue every frame up to the depth of the subscriber. */
+	public static final int EVERY_FRAME = 0;
+	/** Keep only the newest frames, older waiting ones are dropped. */
+	public static final int LATEST_ONLY = 1;
+	/** Deliver one frame out of interval. */
+	public static final int EVERY_NTH = 2;
+	
+	private final UVCCamera camera;
+	private long nativeHandle;
+	private int users = 0;
+	
+	FrameSubscriber(UVCCamera camera, long handle) {
+		this.camera = camera;
+		this.nativeHandle = handle;
+	}
+	
+	private synchronized long use() {
+		if (0 == nativeHandle) {
+			throw new IllegalStateException("Subscriber is closed.");
+		}
+		++users;
+		return nativeHandle;
+	}
+	
+	private synchronized void unuse() {
+		if (0 == --users) {
+			notifyAll();
+		}
+	}
+	
+	synchronized boolean isClosed() {
+		return 0 == nativeHandle;
+	}
+	
+	/**
+	 * Wait for the next frame.
+	 * @param timeoutMs negative waits until a frame arrives.
+	 * @return null on timeout.
+	 */
+	public SharedFrame acquire(int timeoutMs) {
+		final long handle = use();
+		try {
+			final SharedFrame frame = new SharedFrame(this);
+			if (!n_acquire(handle, timeoutMs, frame)) {
+				return null;
+			}
+			return frame;
+		} finally {
+			unuse();
+		}
+	}
+	
+	void release(SharedFrame frame) {
+		final long handle;
+		synchronized (this) {
+			// frames still held are dropped by close.
+			if (0 == nativeHandle) {
+				return;
+			}
+			handle = nativeHandle;
+			++users;
+		}
+		try {
+			n_release(handle, frame.index);
+		} finally {
+			unuse();
+		}
+	}
+	
+	/**
+	 * @return number of frames this subscriber has missed.
+	 */
+	public int getDropped() {
+		final long handle = use();
+		try {
+			return n_getDropped(handle);
+		} finally {
+			unuse();
+		}
+	}
+	
+	/**
+	 * Stop receiving frames. A thread waiting in {@link #acquire(int)}
+	 * gets an IllegalStateException; frames not released yet are handed
+	 * back to the camera and must not be read anymore.
+	 */
+	public void close() {
+		long handle = 0;
+		boolean interrupted = false;
+		synchronized (this) {
+			if (0 != nativeHandle) {
+				handle = nativeHandle;
+				nativeHandle = 0;
+				n_close(handle);
+			}
+			// also when another thread is closing, the camera may free the
+			// subscriber as soon as this returns.
+			while (0 < users) {
+				try {
+					wait();
+				} catch (InterruptedException e) {
+					interrupted = true;
+				}
+			}
+		}
+		if (0 != handle) {
+			camera.unsubscribe(this, handle);
+		}
+		if (interrupted) {
+			Thread.currentThread().interrupt();
+		}
+	}
+	
+	/**
+	 * Frame shared with the other subscribers. The planes read the driver
+	 * buffer directly and are valid until {@link #release()} or until the
+	 * subscriber is closed; a buffer taken from {@link #getPlane(int)} must
+	 * not be kept past that either.
+	 */
+	public static final class SharedFrame {
+		private final FrameSubscriber subscriber;
+		private boolean isReleased = false;
+		int index;
+		int sequence;
+		long timestampUs;
+		ByteBuffer[] planes;
+		int[] strides;
+		
+		SharedFrame(FrameSubscriber subscriber) {
+			this.subscriber = subscriber;
+		}
+		
+		public int getSequence() {
+			return sequence;
+		}
+		
+		public long getTimestampUs() {
+			return timestampUs;
+		}
+		
+		public int getPlaneCount() {
+			return strides.length;
+		}
+		
+		/**
+		 * @return read-only view of the plane.
+		 * @throws IllegalStateException if the frame is released or the subscriber closed.
+		 */
+		public ByteBuffer getPlane(int plane) {
+			return getPlanes()[plane].asReadOnlyBuffer();
+		}
+		
+		/**
+		 * Planes for the converters of this package, checked like {@link #getPlane(int)}.
+		 */
+		synchronized ByteBuffer[] getPlanes() {
+			if (isReleased || subscriber.isClosed()) {
+				throw new IllegalStateException("Frame is already released.");
+			}
+			return planes;
+		}
+		
+		/**
+		 * @return bytes per line of the plane, 0 for compressed formats.
+		 */
+		public int getStride(int plane) {
+			return strides[plane];
+		}
+		
+		public synchronized void release() {
+			if (isReleased) {
+				throw new IllegalStateException("Frame is already released.");
+			}
+			isReleased = true;
+			// the buffers point into driver memory that is reused from now on.
+			planes = null;
+			subscriber.release(this);
+		}
+	}
+	
+	private static native boolean n_acquire(long handle, int timeoutMs, SharedFrame frame);
+	private static native void n_release(long handle, int index);
+	private static native void n_close(long handle);
+	private static native int n_getDropped(long handle);
+}
@@ -0,0 +1,98 @@
+package net.crimsonwoods.android.libs.uvccap;
+
+import java.nio.ByteBuffer;
+
+/**
+ * Encode baseline JPEG snapshots straight from YUV frames, without going
+ * through RGB. Packed 4:2:2 input is subsampled to 4:2:0 while it is read.
+ * An encoder keeps its scratch buffers between frames and is meant to be
+ * used by one thread at a time.
+ */
+public class JpegEncoder {
+	private static final int FORMAT_YUYV = 0;
+	private static final int FORMAT_UYVY = 1;
+	private static final int FORMAT_I420 = 2;
+	private static final int FORMAT_NV12 = 3;
+	private static final int FORMAT_NV21 = 4;
+	
+	private long nativeHandle = 0;
+	
+	static {
+		System.loadLibrary("cconv");
+	}
+	
+	public JpegEncoder() {
+		nativeHandle = n_create();
+	}
+	
+	@Override
+	protected void finalize() throws Throwable {
+		release();
+	}
+	
+	public synchronized void release() {
+		if (0 != nativeHandle) {
+			n_destroy(nativeHandle);
+			nativeHandle = 0;
+		}
+	}
+	
+	private static int toEncoderFormat(PixelFormat format) {
+		switch (format) {
+		case YUYV:
+			return FORMAT_YUYV;
+		case UYVY:
+			return FORMAT_UYVY;
+		case YUV420:
+			return FORMAT_I420;
+		case NV12:
+			return FORMAT_NV12;
+		case NV21:
+			return FORMAT_NV21;
+		default:
+			throw new IllegalArgumentException("Unsupported format " + format + ".");
+		}
+	}
+	
+	/**
+	 * @return size of dst that a frame of the given size fits in at any quality.
+	 */
+	public static int getMaxEncodedSize(int width, int height) {
+		return n_getMaxEncodedSize(width, height);
+	}
+	
+	/**
+	 * Encode a frame given as one packed plane, Y and interleaved UV, or Y,
+	 * U and V planes, all direct buffers.
+	 * @param quality from 1 to 100, as libjpeg scales its tables.
+	 * @return number of bytes written into dst.
+	 */
+	public synchronized int encode(ByteBuffer dst, PixelFormat format, int width, int height,
+			ByteBuffer[] planes, int[] strides, int quality) {
+		if (0 == nativeHandle) {
+			throw new IllegalStateException("Encoder is already released.");
+		}
+		return n_encode(nativeHandle, dst, toEncoderFormat(format), width, height, planes, strides, quality);
+	}
+	
+	/**
+	 * Encode a frame in the tightly packed layout of {@link UVCCamera#capture(FramePool)}.
+	 */
+	public int encode(ByteBuffer dst, PixelFormat format, int width, int height, ByteBuffer src, int quality) {
+		final int[] strides = new int[3];
+		return encode(dst, format, width, height, PackedLayout.split(src, format, width, height, strides), strides, quality);
+	}
+	
+	/**
+	 * Encode a frame shared by the camera without copying it first.
+	 */
+	public int encode(ByteBuffer dst, PixelFormat format, int width, int height, FrameSubscriber.SharedFrame frame, int quality) {
+		return encode(dst, format, width, height, frame.getPlanes(), frame.strides, quality);
+	}
+	
+	private static native long n_create();
+	private static native void n_destroy(long handle);
+	private static native int n_getMaxEncodedSize(int width, int height);
+	private static native int n_encode(long handle, ByteBuffer dst, int format, int width, int height,
+			ByteBuffer[] planes, int[] strides, int quality);
+}
@@ -0,0 +1,137 @@
+package net.crimsonwoods.android.libs.uvccap;
+
+import java.nio.ByteBuffer;
+
+/**
+ * Lossless compression of YUV frames for recording and IPC.
+ * Frames are read from and written to direct buffers, the planes of a
+ * {@link FrameSubscriber.SharedFrame} are compressed straight from the
+ * driver buffer.
+ */
+public final class LosslessCodec {
+	private static final int FORMAT_YUYV = 0;
+	private static final int FORMAT_UYVY = 1;
+	private static final int FORMAT_I420 = 2;
+	private static final int FORMAT_YUV422P = 3;
+	private static final int FORMAT_NV12 = 4;
+	private static final int FORMAT_NV21 = 5;
+	
+	static {
+		System.loadLibrary("cconv");
+	}
+	
+	private LosslessCodec() {
+	}
+	
+	private static int toCodecFormat(PixelFormat format) {
+		switch (format) {
+		case YUYV:
+			return FORMAT_YUYV;
+		case UYVY:
+			return FORMAT_UYVY;
+		case YUV420:
+			return FORMAT_I420;
+		case YUV422P:
+			return FORMAT_YUV422P;
+		case NV12:
+			return FORMAT_NV12;
+		case NV21:
+			return FORMAT_NV21;
+		default:
+			throw new IllegalArgumentException("Unsupported format " + format + ".");
+		}
+	}
+	
+	private static PixelFormat fromCodecFormat(int format) {
+		switch (format) {
+		case FORMAT_YUYV:
+			return PixelFormat.YUYV;
+		case FORMAT_UYVY:
+			return PixelFormat.UYVY;
+		case FORMAT_I420:
+			return PixelFormat.YUV420;
+		case FORMAT_YUV422P:
+			return PixelFormat.YUV422P;
+		case FORMAT_NV12:
+			return PixelFormat.NV12;
+		case FORMAT_NV21:
+			return PixelFormat.NV21;
+		default:
+			return PixelFormat.UNKNOWN;
+		}
+	}
+	
+	/**
+	 * @return size of dst that any frame of the given format and size fits in.
+	 */
+	public static int getMaxEncodedSize(PixelFormat format, int width, int height) {
+		return n_getMaxEncodedSize(toCodecFormat(format), width, height);
+	}
+	
+	/**
+	 * Compress a frame given as one packed plane, Y and interleaved UV, or
+	 * Y, U and V planes, all direct buffers.
+	 * @return number of bytes written into dst.
+	 */
+	public static int encode(ByteBuffer dst, PixelFormat format, int width, int height, ByteBuffer[] planes, int[] strides) {
+		return n_encode(dst, toCodecFormat(format), width, height, planes, strides);
+	}
+	
+	/**
+	 * Compress a frame in the tightly packed layout of {@link UVCCamera#capture(FramePool)}.
+	 */
+	public static int encode(ByteBuffer dst, PixelFormat format, int width, int height, ByteBuffer src) {
+		final int[] strides = new int[3];
+		return n_encode(dst, toCodecFormat(format), width, height, PackedLayout.split(src, format, width, height, strides), strides);
+	}
+	
+	/**
+	 * Compress a frame shared by the camera without copying it first.
+	 */
+	public static int encode(ByteBuffer dst, PixelFormat format, int width, int height, FrameSubscriber.SharedFrame frame) {
+		return n_encode(dst, toCodecFormat(format), width, height, frame.getPlanes(), frame.strides);
+	}
+	
+	/**
+	 * @return format of the compressed frame, UNKNOWN if src is not readable.
+	 */
+	public static PixelFormat getFormat(ByteBuffer src, int length) {
+		final int[] info = new int[3];
+		if (!n_getInfo(src, length, info)) {
+			return PixelFormat.UNKNOWN;
+		}
+		return fromCodecFormat(info[0]);
+	}
+	
+	/**
+	 * @return {width, height} of the compressed frame, or null if src is not readable.
+	 */
+	public static int[] getSize(ByteBuffer src, int length) {
+		final int[] info = new int[3];
+		if (!n_getInfo(src, length, info)) {
+			return null;
+		}
+		return new int[] { info[1], info[2] };
+	}
+	
+	public static void decode(ByteBuffer[] planes, int[] strides, ByteBuffer src, int length) {
+		n_decode(planes, strides, src, length);
+	}
+	
+	/**
+	 * Decode into the tightly packed layout.
+	 */
+	public static void decode(ByteBuffer dst, ByteBuffer src, int length) {
+		final int[] info = new int[3];
+		if (!n_getInfo(src, length, info)) {
+			throw new IllegalArgumentException("'src' is not a compressed frame.");
+		}
+		final int[] strides = new int[3];
+		n_decode(PackedLayout.split(dst, fromCodecFormat(info[0]), info[1], info[2], strides), strides, src, length);
+	}
+	
+	private static native int n_getMaxEncodedSize(int format, int width, int height);
+	private static native int n_encode(ByteBuffer dst, int format, int width, int height, ByteBuffer[] planes, int[] strides);
+	private static native boolean n_getInfo(ByteBuffer src, int length, int[] info);
+	private static native void n_decode(ByteBuffer[] planes, int[] strides, ByteBuffer src, int length);
+}
@@ -0,0 +1,113 @@
+package net.crimsonwoods.android.libs.uvccap;
+
+import java.nio.ByteBuffer;
+
+public class MjpegDecoder {
+	public static final int FORMAT_I420 = 0;
+	public static final int FORMAT_NV12 = 1;
+	private static final int FORMAT_RGBA = 2;
+	
+	private long nativeHandle = 0;
+	
+	static {
+		System.loadLibrary("cconv");
+	}
+	
+	/**
+	 * @param threads number of threads decoding restart intervals in parallel.
+	 */
+	public MjpegDecoder(int threads) {
+		nativeHandle = n_create(threads);
+	}
+	
+	@Override
+	protected void finalize() throws Throwable {
+		release();
+	}
+	
+	public synchronized void release() {
+		if (0 != nativeHandle) {
+			n_destroy(nativeHandle);
+			nativeHandle = 0;
+		}
+	}
+	
+	/**
+	 * Apply policy to the worker threads, MLOCK is ignored.
+	 * @return what all of the workers got, nothing if the decoder has none.
+	 */
+	public synchronized ThreadPolicy setThreadPolicy(ThreadPolicy policy) {
+		final int[] applied = new int[ThreadPolicy.FIELD_COUNT];
+		n_setThreadPolicy(nativeHandle, policy.toArray(), applied);
+		return ThreadPolicy.fromArray(applied);
+	}
+	
+	/**
+	 * @return {width, height} of the encoded frame, or null if the header is not readable.
+	 */
+	public static int[] getSize(byte[] jpeg, int length) {
+		final int[] size = new int[2];
+		if (!n_getSize(jpeg, length, size)) {
+			return null;
+		}
+		return size;
+	}
+	
+	/**
+	 * Decode into ARGB pixels, scaled by 1/scale (1, 2, 4 or 8).
+	 */
+	public synchronized void decodeToRgba(int[] rgba, byte[] jpeg, int length, int scale) {
+		n_decodeToRgba(nativeHandle, rgba, jpeg, length, scale);
+	}
+	
+	/**
+	 * Decode into full range I420 or NV12, scaled by 1/scale (1, 2, 4 or 8).
+	 */
+	public synchronized void decodeToYuv(byte[] yuv, byte[] jpeg, int length, int scale, int format) {
+		n_decodeToYuv(nativeHandle, yuv, jpeg, length, scale, format);
+	}
+	
+	/**
+	 * Direct buffer variant of {@link #decodeToRgba(int[], byte[], int, int)}.
+	 */
+	public synchronized void decodeToRgba(ByteBuffer rgba, ByteBuffer jpeg, int length, int scale) {
+		n_decodeDirect(nativeHandle, rgba, jpeg, length, scale, FORMAT_RGBA);
+	}
+	
+	/**
+	 * Direct buffer variant of {@link #decodeToYuv(byte[], byte[], int, int, int)}.
+	 */
+	public synchronized void decodeToYuv(ByteBuffer yuv, ByteBuffer jpeg, int length, int scale, int format) {
+		if ((FORMAT_I420 != format) && (FORMAT_NV12 != format)) {
+			throw new IllegalArgumentException("'format' have to be I420 or NV12.");
+		}
+		n_decodeDirect(nativeHandle, yuv, jpeg, length, scale, format);
+	}
+	
+	/**
+	 * Decode into caller laid out planes, strides are in bytes.
+	 * RGBA takes one plane, NV12 Y and UV, I420 Y, U and V.
+	 */
+	public synchronized void decodeToRgba(ByteBuffer rgba, int stride, ByteBuffer jpeg, int length, int scale) {
+		n_decodePlanes(nativeHandle, new ByteBuffer[] { rgba }, new int[] { stride }, jpeg, length, scale, FORMAT_RGBA);
+	}
+	
+	/**
+	 * @see #decodeToRgba(ByteBuffer, int, ByteBuffer, int, int)
+	 */
+	public synchronized void decodeToYuv(ByteBuffer[] planes, int[] strides, ByteBuffer jpeg, int length, int scale, int format) {
+		if ((FORMAT_I420 != format) && (FORMAT_NV12 != format)) {
+			throw new IllegalArgumentException("'format' have to be I420 or NV12.");
+		}
+		n_decodePlanes(nativeHandle, planes, strides, jpeg, length, scale, format);
+	}
+	
+	private static native long n_create(int threads);
+	private static native void n_destroy(long handle);
+	private static native void n_setThreadPolicy(long handle, int[] policy, int[] applied);
+	private static native boolean n_getSize(byte[] jpeg, int length, int[] size);
+	private static native void n_decodeToRgba(long handle, int[] rgba, byte[] jpeg, int length, int scale);
+	private static native void n_decodeToYuv(long handle, byte[] yuv, byte[] jpeg, int length, int scale, int format);
+	private static native void n_decodeDirect(long handle, ByteBuffer dst, ByteBuffer jpeg, int length, int scale, int format);
+	private static native void n_decodePlanes(long handle, ByteBuffer[] planes, int[] strides, ByteBuffer jpeg, int length, int scale, int format);
+}
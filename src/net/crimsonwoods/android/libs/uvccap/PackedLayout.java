@@ -0,0 +1,56 @@
+package net.crimsonwoods.android.libs.uvccap;
+
+import java.nio.ByteBuffer;
+
+/**
+ * Tightly packed layout of {@link UVCCamera#capture(FramePool)}: the planes
+ * of a frame follow each other in one buffer, rows without padding.
+ */
+final class PackedLayout {
+	private PackedLayout() {
+	}
+	
+	/**
+	 * Views of the planes of a frame packed in 'buffer'.
+	 * @param strides receives the bytes per row of each plane.
+	 */
+	static ByteBuffer[] split(ByteBuffer buffer, PixelFormat format, int width, int height, int[] strides) {
+		final int chromaWidth = (width + 1) / 2;
+		final int chromaHeight = (height + 1) / 2;
+		switch (format) {
+		case YUYV:
+		case UYVY:
+			strides[0] = width * 2;
+			return new ByteBuffer[] { buffer };
+		case NV12:
+		case NV21:
+			strides[0] = width;
+			strides[1] = chromaWidth * 2;
+			return new ByteBuffer[] {
+				slice(buffer, 0),
+				slice(buffer, width * height),
+			};
+		case YUV420:
+		case YUV422P: {
+			final int rows = (PixelFormat.YUV420 == format) ? chromaHeight : height;
+			strides[0] = width;
+			strides[1] = chromaWidth;
+			strides[2] = chromaWidth;
+			return new ByteBuffer[] {
+				slice(buffer, 0),
+				slice(buffer, width * height),
+				slice(buffer, width * height + chromaWidth * rows),
+			};
+		}
+		default:
+			throw new IllegalArgumentException("Unsupported format " + format + ".");
+		}
+	}
+	
+	private static ByteBuffer slice(ByteBuffer buffer, int offset) {
+		final ByteBuffer dup = buffer.duplicate();
+		dup.clear();
+		dup.position(Math.min(offset, dup.capacity()));
+		return dup.slice();
+	}
+}
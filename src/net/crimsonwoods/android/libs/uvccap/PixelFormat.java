@@ -11,6 +11,7 @@ public enum PixelFormat{
 	YUV422P(7),
 	NV12(8),
 	NV21(9),
+	MJPEG(10),
 	UNKNOWN(-1);
 	
 	int value;
@@ -31,6 +32,8 @@ public enum PixelFormat{
 			return YUYV;
 		case 4:
 			return UYVY;
+		case 5:
+			return YUV420;
 		case 6:
 			return YUV410;
 		case 7:
@@ -39,6 +42,8 @@ public enum PixelFormat{
 			return NV12;
 		case 9:
 			return NV21;
+		case 10:
+			return MJPEG;
 		default:
 			return UNKNOWN;
 		}
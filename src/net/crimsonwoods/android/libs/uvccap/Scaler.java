@@ -0,0 +1,90 @@
+package net.crimsonwoods.android.libs.uvccap;
+
+import java.nio.ByteBuffer;
+
+/**
+ * Resize frames to any size without converting them first. Filter
+ * coefficients are kept for the sizes last used, so scaling every frame of
+ * a stream to the same size costs only the filtering. A scaler is meant to
+ * be used by one thread at a time.
+ */
+public class Scaler {
+	/** Two taps per axis, for upscaling and slight downscaling. */
+	public static final int MODE_BILINEAR = 0;
+	/** Every covered source pixel weighted by its area, keeps detail when downscaling a lot. */
+	public static final int MODE_AREA = 1;
+	
+	private static final int FORMAT_YUYV = 0;
+	private static final int FORMAT_UYVY = 1;
+	private static final int FORMAT_I420 = 2;
+	private static final int FORMAT_YUV422P = 3;
+	private static final int FORMAT_NV12 = 4;
+	private static final int FORMAT_RGBA = 5;
+	
+	private long nativeHandle = 0;
+	
+	static {
+		System.loadLibrary("cconv");
+	}
+	
+	public Scaler() {
+		nativeHandle = n_create();
+	}
+	
+	@Override
+	protected void finalize() throws Throwable {
+		release();
+	}
+	
+	public synchronized void release() {
+		if (0 != nativeHandle) {
+			n_destroy(nativeHandle);
+			nativeHandle = 0;
+		}
+	}
+	
+	private static int toScalerFormat(PixelFormat format) {
+		switch (format) {
+		case YUYV:
+			return FORMAT_YUYV;
+		case UYVY:
+			return FORMAT_UYVY;
+		case YUV420:
+			return FORMAT_I420;
+		case YUV422P:
+			return FORMAT_YUV422P;
+		case NV12:
+		case NV21:
+			return FORMAT_NV12;
+		case RGB32:
+		case BGR32:
+			return FORMAT_RGBA;
+		default:
+			throw new IllegalArgumentException("Unsupported format " + format + ".");
+		}
+	}
+	
+	/**
+	 * Scale a frame given as one packed plane, Y and interleaved UV, or Y, U
+	 * and V planes, all direct buffers. Widths of packed YUV have to be even.
+	 */
+	public synchronized void scale(PixelFormat format, int mode,
+			ByteBuffer[] src, int[] srcStrides, int srcWidth, int srcHeight,
+			ByteBuffer[] dst, int[] dstStrides, int dstWidth, int dstHeight) {
+		n_scale(nativeHandle, toScalerFormat(format), mode, src, srcStrides, srcWidth, srcHeight, dst, dstStrides, dstWidth, dstHeight);
+	}
+	
+	/**
+	 * Scale a frame shared by the camera without copying it first.
+	 */
+	public void scale(PixelFormat format, int mode, FrameSubscriber.SharedFrame frame, int srcWidth, int srcHeight,
+			ByteBuffer[] dst, int[] dstStrides, int dstWidth, int dstHeight) {
+		scale(format, mode, frame.getPlanes(), frame.strides, srcWidth, srcHeight, dst, dstStrides, dstWidth, dstHeight);
+	}
+	
+	private static native long n_create();
+	private static native void n_destroy(long handle);
+	private static native void n_scale(long handle, int format, int mode,
+			ByteBuffer[] src, int[] srcStrides, int srcWidth, int srcHeight,
+			ByteBuffer[] dst, int[] dstStrides, int dstWidth, int dstHeight);
+}
@@ -0,0 +1,82 @@
+package net.crimsonwoods.android.libs.uvccap;
+
+/**
+ * CPU affinity, priority and memory locking asked for the threads the
+ * library owns (the subscriber pump, the idle monitor and the MJPEG decoder
+ * workers), and what they actually got. Settings the system refuses, most
+ * often SCHED_FIFO and negative nice values without CAP_SYS_NICE or mlock
+ * over RLIMIT_MEMLOCK, are left as they were and missing from the result.
+ */
+public final class ThreadPolicy {
+	/** Run only on the CPUs of {@link #cpuMask}. */
+	public static final int AFFINITY = 0x01;
+	/** SCHED_FIFO at {@link #fifoPriority}. */
+	public static final int FIFO = 0x02;
+	/** {@link #nice} under SCHED_OTHER, also used when SCHED_FIFO is refused. */
+	public static final int NICE = 0x04;
+	/** Keep the capture buffers resident. */
+	public static final int MLOCK = 0x08;
+	
+	static final int FIELD_COUNT = 4;
+	
+	/** Settings asked for, or the ones that took effect. */
+	public int flags;
+	/** Bit n allows CPU n. */
+	public int cpuMask;
+	/** 1 to 99. */
+	public int fifoPriority;
+	/** -20 to 19. */
+	public int nice;
+	
+	static {
+		System.loadLibrary("uvccap");
+	}
+	
+	public boolean has(int flag) {
+		return flag == (flags & flag);
+	}
+	
+	/**
+	 * Apply policy to the calling thread, such as the capture loop of the
+	 * application. MLOCK is ignored.
+	 * @return settings the thread ends up with.
+	 */
+	public static ThreadPolicy applyToCurrentThread(ThreadPolicy policy) {
+		final int[] applied = new int[FIELD_COUNT];
+		n_applyToCurrentThread(policy.toArray(), applied);
+		return fromArray(applied);
+	}
+	
+	int[] toArray() {
+		return new int[] { flags, cpuMask, fifoPriority, nice };
+	}
+	
+	static ThreadPolicy fromArray(int[] values) {
+		final ThreadPolicy policy = new ThreadPolicy();
+		policy.flags = values[0];
+		policy.cpuMask = values[1];
+		policy.fifoPriority = values[2];
+		policy.nice = values[3];
+		return policy;
+	}
+	
+	/**
+	 * @return the flags both got, the CPUs either may run on and the weaker priority.
+	 */
+	static ThreadPolicy merge(ThreadPolicy a, ThreadPolicy b) {
+		if (null == a) {
+			return b;
+		}
+		if (null == b) {
+			return a;
+		}
+		final ThreadPolicy merged = new ThreadPolicy();
+		merged.flags = a.flags & b.flags;
+		merged.cpuMask = a.cpuMask | b.cpuMask;
+		merged.fifoPriority = Math.min(a.fifoPriority, b.fifoPriority);
+		merged.nice = Math.max(a.nice, b.nice);
+		return merged;
+	}
+	
+	private static native void n_applyToCurrentThread(int[] policy, int[] applied);
+}
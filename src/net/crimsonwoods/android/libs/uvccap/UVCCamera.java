@@ -1,6 +1,7 @@
 package net.crimsonwoods.android.libs.uvccap;
 
 import java.io.IOException;
+import java.nio.ByteBuffer;
 import java.util.ArrayList;
 import java.util.List;
 
@@ -8,7 +9,26 @@ public class UVCCamera {
 	private static final String DEVICE_PATH_PREFIX = "/dev/video";
 	private boolean isStarted = false;
 	private long nativeHandle = 0;
+	private long pumpHandle = 0;
+	private boolean isGrouped = false;
+	private int idleTimeoutMillis = 0;
+	private boolean releaseBuffersOnIdle = false;
+	private long lastCaptureNanos = 0;
+	private Thread idleMonitor = null;
+	// thread policy asked last and what each owned thread got, guarded by the capture lock.
+	private ThreadPolicy threadPolicy = null;
+	private ThreadPolicy pumpApplied = null;
+	private ThreadPolicy idleMonitorApplied = null;
+	private boolean isIdleMonitorPolicyPending = false;
+	private boolean isBufferLocked = false;
 	private final String devicePath;
+	private final ArrayList<FrameSubscriber> subscribers = new ArrayList<FrameSubscriber>();
+	// guards the frame path, so metadata and stats never wait for a frame.
+	// Methods changing what the frame path sees take the monitor of the camera first.
+	private final Object captureLock = new Object();
+	// taken last and never across a capture, it keeps the native stats alive while read.
+	private final Object statsLock = new Object();
+	private volatile StreamInfo streamInfo = StreamInfo.NONE;
 	
 	static {
 		System.loadLibrary("uvccap");
@@ -18,6 +38,15 @@ public class UVCCamera {
 		devicePath = device;
 	}
 	
+	/**
+	 * Keep probed device capabilities under path so that the next open of
+	 * the same device skips the enumeration, null disables the cache.
+	 * Call before opening cameras.
+	 */
+	public static synchronized void setCacheDirectory(String path) {
+		n_setCacheDirectory(path);
+	}
+	
 	public static synchronized UVCCamera open(String devicePath) throws IOException {
 		final UVCCamera camera = new UVCCamera(devicePath);
 		camera.open();
@@ -31,43 +60,566 @@ public class UVCCamera {
 	
 	private synchronized void open() throws IOException {
 		nativeHandle = n_open(devicePath);
+		updateStreamInfo();
 	}
 	
 	public synchronized void init(int width, int height, PixelFormat format) throws IOException {
-		n_init(nativeHandle, width, height, format.value);
+		synchronized (captureLock) {
+			try {
+				n_init(nativeHandle, width, height, format.value);
+			} finally {
+				updateStreamInfo();
+			}
+		}
+	}
+	
+	/**
+	 * Select and apply the native stream mode that reaches the target frame rate
+	 * at the lowest combined USB bandwidth and conversion cost into outputFormat.
+	 */
+	public synchronized StreamMode initBest(int targetWidth, int targetHeight, int targetFps, PixelFormat outputFormat) throws IOException {
+		synchronized (captureLock) {
+			try {
+				return n_initBest(nativeHandle, targetWidth, targetHeight, targetFps, outputFormat.value);
+			} finally {
+				updateStreamInfo();
+			}
+		}
+	}
+	
+	/**
+	 * Switch to another size or format without closing the device.
+	 * Streaming keeps running if it was started.
+	 */
+	public synchronized ReconfigureStats reconfigure(int width, int height, PixelFormat format) {
+		synchronized (captureLock) {
+			checkNotShared();
+			try {
+				return n_reconfigure(nativeHandle, width, height, format.value);
+			} finally {
+				updateStreamInfo();
+			}
+		}
+	}
+	
+	// called with both locks held (or before the camera is shared), after anything that may change the stream parameters.
+	private void updateStreamInfo() {
+		if (0 == nativeHandle) {
+			streamInfo = StreamInfo.NONE;
+			return;
+		}
+		final int[] strides = new int[StreamInfo.MAX_PLANES];
+		for (int i = 0; i < strides.length; ++i) {
+			strides[i] = n_getStride(nativeHandle, i);
+		}
+		streamInfo = new StreamInfo(
+				PixelFormat.from(n_getPixelFormat(nativeHandle)),
+				n_getWidth(nativeHandle),
+				n_getHeight(nativeHandle),
+				n_getFrameSize(nativeHandle),
+				n_getBurstSlotSize(nativeHandle),
+				strides);
 	}
 	
 	public synchronized void release() {
-		if (isStarted) {
-			n_stop(nativeHandle);
-			isStarted = false;
+		if (isGrouped) {
+			throw new IllegalStateException("Camera belongs to a capture group.");
+		}
+		final ArrayList<FrameSubscriber> subs = new ArrayList<FrameSubscriber>(subscribers);
+		// close waits for the calls in flight on every subscriber, also those
+		// another thread is closing, so nothing uses them once the pump is gone.
+		for (FrameSubscriber sub : subs) {
+			sub.close();
+		}
+		synchronized (captureLock) {
+			if (0 != pumpHandle) {
+				n_destroyPump(pumpHandle);
+				pumpHandle = 0;
+				pumpApplied = null;
+				subscribers.clear();
+			}
+			idleMonitor = null;
+			idleMonitorApplied = null;
+			captureLock.notifyAll();
+			if (isStarted) {
+				n_stop(nativeHandle);
+				isStarted = false;
+			}
+			synchronized (statsLock) {
+				n_close(nativeHandle);
+				nativeHandle = 0;
+			}
+			streamInfo = StreamInfo.NONE;
+		}
+	}
+	
+	/**
+	 * Suspend the stream after timeoutMillis without a capture, the next
+	 * capture resumes it with the format already set. With releaseBuffers
+	 * the driver buffers are unmapped as well, which frees their memory at
+	 * the cost of a slower resume. Streams delivered to subscribers or a
+	 * capture group are never suspended.
+	 * @param timeoutMillis 0 disables the policy.
+	 */
+	public void setIdlePolicy(int timeoutMillis, boolean releaseBuffers) {
+		if (0 > timeoutMillis) {
+			throw new IllegalArgumentException("'timeoutMillis' have to be 0 or positive.");
+		}
+		synchronized (captureLock) {
+			if (0 == nativeHandle) {
+				throw new IllegalStateException("Camera is released.");
+			}
+			idleTimeoutMillis = timeoutMillis;
+			releaseBuffersOnIdle = releaseBuffers;
+			lastCaptureNanos = System.nanoTime();
+			if ((0 != timeoutMillis) && (null == idleMonitor)) {
+				idleMonitor = new Thread(new Runnable() {
+					public void run() {
+						monitorIdle();
+					}
+				}, "UVCCamera-idle");
+				idleMonitor.setDaemon(true);
+				idleMonitor.start();
+			}
+			captureLock.notifyAll();
+		}
+	}
+	
+	public IdleStats getIdleStats() {
+		synchronized (statsLock) {
+			return n_getIdleStats(nativeHandle);
+		}
+	}
+	
+	/**
+	 * Let captures reopen the camera by themselves when it is unplugged or
+	 * reset, waiting up to timeoutMillis for it to come back. The format,
+	 * frame rate and buffers are restored and the stream resumes.
+	 * Subscribers and capture groups still see the failure.
+	 * @param timeoutMillis 0 disables it.
+	 */
+	public void setAutoReconnect(int timeoutMillis) {
+		synchronized (captureLock) {
+			n_setAutoReconnect(nativeHandle, timeoutMillis);
+		}
+	}
+	
+	/**
+	 * Reopen the camera after a {@link DeviceDisconnectedException}. The
+	 * device is looked up by its USB port, so it is found even if it comes
+	 * back under another device node.
+	 */
+	public synchronized void reconnect(int timeoutMillis) throws IOException {
+		synchronized (captureLock) {
+			checkNotShared();
+			try {
+				n_reconnect(nativeHandle, timeoutMillis);
+			} finally {
+				updateStreamInfo();
+			}
+		}
+	}
+	
+	public ReconnectStats getReconnectStats() {
+		synchronized (statsLock) {
+			return n_getReconnectStats(nativeHandle);
+		}
+	}
+	
+	/**
+	 * Apply policy to the threads the camera owns, the subscriber pump and
+	 * the idle monitor, including those started later. MLOCK locks the
+	 * capture buffers, again whenever they are mapped anew.
+	 * @return what the running threads and the buffers got so far, see
+	 * {@link #getAppliedThreadPolicy()}.
+	 */
+	public synchronized ThreadPolicy setThreadPolicy(ThreadPolicy policy) {
+		synchronized (captureLock) {
+			if (0 == nativeHandle) {
+				throw new IllegalStateException("Camera is released.");
+			}
+			threadPolicy = ThreadPolicy.fromArray(policy.toArray());
+			isBufferLocked = n_setBufferLocking(nativeHandle, policy.has(ThreadPolicy.MLOCK));
+			applyPumpThreadPolicy();
+			if (null != idleMonitor) {
+				// only the monitor knows its native thread id, it applies the policy itself.
+				isIdleMonitorPolicyPending = true;
+				captureLock.notifyAll();
+			}
+			return getAppliedThreadPolicyLocked();
+		}
+	}
+	
+	/**
+	 * @return settings the threads of the camera run with, the flags are the
+	 * ones all of them got. Nothing is reported for threads not running.
+	 */
+	public ThreadPolicy getAppliedThreadPolicy() {
+		synchronized (captureLock) {
+			return getAppliedThreadPolicyLocked();
+		}
+	}
+	
+	private ThreadPolicy getAppliedThreadPolicyLocked() {
+		final ThreadPolicy threads = ThreadPolicy.merge(pumpApplied, idleMonitorApplied);
+		final ThreadPolicy applied = (null != threads) ? ThreadPolicy.fromArray(threads.toArray()) : new ThreadPolicy();
+		if (isBufferLocked) {
+			applied.flags |= ThreadPolicy.MLOCK;
+		}
+		return applied;
+	}
+	
+	// called with the capture lock held.
+	private void applyPumpThreadPolicy() {
+		if ((null == threadPolicy) || (0 == pumpHandle)) {
+			return;
+		}
+		final int[] applied = new int[ThreadPolicy.FIELD_COUNT];
+		n_setPumpThreadPolicy(pumpHandle, threadPolicy.toArray(), applied);
+		pumpApplied = ThreadPolicy.fromArray(applied);
+	}
+	
+	// runs on the idle monitor, the capture lock is only released while waiting.
+	private void monitorIdle() {
+		synchronized (captureLock) {
+			monitorIdleLocked();
 		}
-		n_close(nativeHandle);
-		nativeHandle = 0;
 	}
 	
-	public synchronized void capture(byte[] pixels) {
+	private void monitorIdleLocked() {
+		isIdleMonitorPolicyPending = (null != threadPolicy);
+		while (Thread.currentThread() == idleMonitor) {
+			if (0 == idleTimeoutMillis) {
+				idleMonitor = null;
+				idleMonitorApplied = null;
+				return;
+			}
+			if (isIdleMonitorPolicyPending) {
+				isIdleMonitorPolicyPending = false;
+				idleMonitorApplied = ThreadPolicy.applyToCurrentThread(threadPolicy);
+			}
+			long waitMillis = 0;
+			if (isStarted && (0 == pumpHandle) && !isGrouped) {
+				final long idleMillis = (System.nanoTime() - lastCaptureNanos) / 1000000;
+				if (idleMillis >= idleTimeoutMillis) {
+					n_suspend(nativeHandle, releaseBuffersOnIdle);
+					isStarted = false;
+				} else {
+					waitMillis = idleTimeoutMillis - idleMillis;
+				}
+			} else if (isStarted) {
+				// frames delivered to subscribers or a group count as captures.
+				lastCaptureNanos = System.nanoTime();
+				waitMillis = idleTimeoutMillis;
+			}
+			try {
+				captureLock.wait(waitMillis);
+			} catch (InterruptedException e) {
+				idleMonitorApplied = null;
+				return;
+			}
+		}
+	}
+	
+	// the frame size and layout are unknown (-1) until init.
+	private void checkInitialized() {
+		if (0 == nativeHandle) {
+			throw new IllegalStateException("Camera is released.");
+		}
+		if (0 > streamInfo.frameSize) {
+			throw new IllegalStateException("Camera is not initialized.");
+		}
+	}
+	
+	// called with the capture lock held.
+	private void startCapture() {
+		checkInitialized();
+		lastCaptureNanos = System.nanoTime();
 		if (!isStarted) {
 			n_start(nativeHandle);
 			isStarted = true;
+			// the idle monitor waits without a deadline while the stream is stopped.
+			captureLock.notifyAll();
 		}
-		n_capture(nativeHandle, pixels);
 	}
 	
-	public synchronized PixelFormat getPixelFormat() {
-		return PixelFormat.from(n_getPixelFormat(nativeHandle));
+	/**
+	 * Capture in the driver's layout: rows are {@link #getStride(int)} bytes
+	 * apart and each plane starts right after the last row of the previous
+	 * one, as {@link #capture(byte[], int[])} with the driver strides.
+	 * @return number of bytes written into pixels (the payload size for MJPEG).
+	 */
+	public int capture(byte[] pixels) {
+		synchronized (captureLock) {
+			checkNotShared();
+			startCapture();
+			return n_capture(nativeHandle, pixels);
+		}
 	}
 	
-	public synchronized int getFrameSize() {
-		return n_getFrameSize(nativeHandle);
+	/**
+	 * Capture with the rows of plane i strides[i] bytes apart (e.g. the
+	 * width for tightly packed rows), each plane starting right after the
+	 * last row of the previous one. Planes are those of
+	 * {@link #capture(ByteBuffer[], int[])}.
+	 * @return number of bytes written over all planes.
+	 */
+	public int capture(byte[] pixels, int[] strides) {
+		synchronized (captureLock) {
+			checkNotShared();
+			startCapture();
+			return n_captureStrided(nativeHandle, pixels, strides);
+		}
 	}
 	
-	public synchronized int getWidth() {
-		return n_getWidth(nativeHandle);
+	/**
+	 * Capture into a frame borrowed from pool, the caller owns one reference.
+	 * @throws IllegalStateException before {@link #init(int, int, PixelFormat)}.
+	 */
+	public Frame capture(FramePool pool) {
+		synchronized (captureLock) {
+			checkNotShared();
+			checkInitialized();
+			final Frame frame = pool.obtain(getFrameSize());
+			boolean captured = false;
+			try {
+				startCapture();
+				frame.setLength(n_captureDirect(nativeHandle, frame.getBuffer()));
+				captured = true;
+			} finally {
+				if (!captured) {
+					frame.release();
+				}
+			}
+			return frame;
+		}
 	}
 	
-	public synchronized int getHeight() {
-		return n_getHeight(nativeHandle);
+	/**
+	 * Capture into a frame borrowed from pool and fill stats with the luma
+	 * statistics of the frame, gathered during the copy.
+	 */
+	public Frame capture(FramePool pool, FrameStats stats) {
+		if (null == stats) {
+			return capture(pool);
+		}
+		synchronized (captureLock) {
+			checkNotShared();
+			checkInitialized();
+			final Frame frame = pool.obtain(getFrameSize());
+			boolean captured = false;
+			try {
+				startCapture();
+				frame.setLength(n_captureDirectStats(nativeHandle, frame.getBuffer(), stats));
+				captured = true;
+			} finally {
+				if (!captured) {
+					frame.release();
+				}
+			}
+			return frame;
+		}
+	}
+	
+	/**
+	 * Capture into separate planes laid out with the given strides (in
+	 * bytes), whatever padding the driver adds to its rows. Packed formats
+	 * take one plane, NV12/NV21 Y and UV, the other planar formats Y, U and V.
+	 * MJPEG payloads are copied as is into the first plane.
+	 * @return number of bytes written over all planes.
+	 */
+	public int capture(ByteBuffer[] planes, int[] strides) {
+		synchronized (captureLock) {
+			checkNotShared();
+			startCapture();
+			return n_capturePlanes(nativeHandle, planes, strides);
+		}
+	}
+	
+	/**
+	 * Capture count consecutive frames in one call. Frame i is written at
+	 * i * {@link #getBurstSlotSize()} of dst and described by out[i]; null
+	 * entries of out are filled with new objects.
+	 * @return number of frames the driver dropped during the burst.
+	 */
+	public int captureBurst(ByteBuffer dst, int count, FrameInfo[] out) {
+		synchronized (captureLock) {
+			checkNotShared();
+			startCapture();
+			return n_captureBurst(nativeHandle, dst, count, out);
+		}
+	}
+	
+	/**
+	 * @return bytes between two frames of a burst, the frame size rounded
+	 * up to the cache line.
+	 */
+	public int getBurstSlotSize() {
+		return streamInfo.burstSlotSize;
+	}
+	
+	/**
+	 * Capture one frame into the next slot of ring, where readers of other
+	 * processes pick it up.
+	 * @return sequence number of the frame.
+	 */
+	public int publish(FrameRing ring) {
+		synchronized (captureLock) {
+			checkNotShared();
+			synchronized (ring) {
+				startCapture();
+				return n_publish(nativeHandle, ring.getHandle());
+			}
+		}
+	}
+	
+	/**
+	 * Share the stream between several consumers. While a subscriber is
+	 * open the frames are only delivered through subscribers, capture and
+	 * reconfigure fail with IllegalStateException.
+	 * @param policy one of FrameSubscriber.EVERY_FRAME, LATEST_ONLY or EVERY_NTH.
+	 * @param interval frames per delivered frame for EVERY_NTH, ignored otherwise.
+	 * @param depth frames the subscriber may have waiting and acquired at once.
+	 */
+	public synchronized FrameSubscriber subscribe(int policy, int interval, int depth) {
+		synchronized (captureLock) {
+			if (isGrouped) {
+				throw new IllegalStateException("Frames are delivered to a capture group.");
+			}
+			if (0 == pumpHandle) {
+				startCapture();
+				pumpHandle = n_createPump(nativeHandle);
+				applyPumpThreadPolicy();
+			}
+			FrameSubscriber sub = null;
+			try {
+				sub = new FrameSubscriber(this, n_subscribe(pumpHandle, policy, interval, depth));
+				subscribers.add(sub);
+			} finally {
+				if (null == sub) {
+					destroyPumpIfUnused();
+				}
+			}
+			return sub;
+		}
+	}
+	
+	synchronized void unsubscribe(FrameSubscriber sub, long handle) {
+		synchronized (captureLock) {
+			if (!subscribers.remove(sub)) {
+				return;
+			}
+			n_unsubscribe(handle);
+			destroyPumpIfUnused();
+		}
+	}
+	
+	private void destroyPumpIfUnused() {
+		if (subscribers.isEmpty() && (0 != pumpHandle)) {
+			n_destroyPump(pumpHandle);
+			pumpHandle = 0;
+			pumpApplied = null;
+		}
+	}
+	
+	private void checkNotShared() {
+		if (0 != pumpHandle) {
+			throw new IllegalStateException("Frames are delivered to subscribers.");
+		}
+		if (isGrouped) {
+			throw new IllegalStateException("Frames are delivered to a capture group.");
+		}
+	}
+	
+	/**
+	 * Hand the stream over to a {@link CaptureGroup}, which starts it.
+	 * @return native handle of the device.
+	 */
+	synchronized long attachGroup() {
+		synchronized (captureLock) {
+			checkNotShared();
+			if (0 == nativeHandle) {
+				throw new IllegalStateException("Camera is released.");
+			}
+			isGrouped = true;
+			isStarted = true;
+			return nativeHandle;
+		}
+	}
+	
+	synchronized void detachGroup() {
+		synchronized (captureLock) {
+			isGrouped = false;
+		}
+	}
+	
+	/**
+	 * Record capture events into a ring of capacity entries.
+	 * Have to be called before the first capture.
+	 */
+	public void enableTrace(int capacity) {
+		synchronized (captureLock) {
+			n_enableTrace(nativeHandle, capacity);
+		}
+	}
+	
+	/**
+	 * Mark the end of the conversion of the last captured frame in the trace.
+	 */
+	public void traceConvertDone() {
+		synchronized (captureLock) {
+			n_traceConvertDone(nativeHandle);
+		}
+	}
+	
+	/**
+	 * Write the recorded events in the Chrome trace event format,
+	 * viewable with chrome://tracing or Perfetto.
+	 */
+	public void dumpTrace(String path) throws IOException {
+		synchronized (captureLock) {
+			n_dumpTrace(nativeHandle, path);
+		}
+	}
+	
+	/**
+	 * Drop the cached capabilities of this device, they are probed from the
+	 * driver again on the next query.
+	 */
+	public synchronized void invalidateCapabilityCache() {
+		n_invalidateCapabilityCache(nativeHandle);
+	}
+	
+	/*
+	 * Stream parameters only change with init, initBest, reconfigure and
+	 * reconnect, they are read from the copy taken then without locking.
+	 */
+	public PixelFormat getPixelFormat() {
+		return streamInfo.format;
+	}
+	
+	public int getFrameSize() {
+		return streamInfo.frameSize;
+	}
+	
+	public int getWidth() {
+		return streamInfo.width;
+	}
+	
+	public int getHeight() {
+		return streamInfo.height;
+	}
+	
+	/**
+	 * @return bytes per line of the plane as delivered by the driver, 0 if
+	 * the format has no such plane.
+	 */
+	public int getStride(int plane) {
+		final int[] strides = streamInfo.strides;
+		if ((0 > plane) || (strides.length <= plane)) {
+			return 0;
+		}
+		return strides[plane];
 	}
 	
 	private static final int fourcc(byte[] seq) {
@@ -77,7 +629,11 @@ public class UVCCamera {
 		return (seq[0] << 24) | (seq[1] << 16) | (seq[2] << 8) | seq[3];
 	}
 	
-	public List<FrameSize> getSupportedPreviewSizes(PixelFormat format) {
+	/*
+	 * Synchronized like invalidateCapabilityCache, which frees the cached
+	 * sizes read here, so the whole list comes from one enumeration.
+	 */
+	public synchronized List<FrameSize> getSupportedPreviewSizes(PixelFormat format) {
 		ArrayList<FrameSize> frameSizes = new ArrayList<FrameSize>();
 		for (int index = 0; ; ++index) {
 			final FrameSize size = n_enumFrameSize(nativeHandle, index, format.value);
@@ -89,20 +645,128 @@ public class UVCCamera {
 		return frameSizes;
 	}
 	
+	private static final class StreamInfo {
+		static final int MAX_PLANES = 3;
+		static final StreamInfo NONE = new StreamInfo(PixelFormat.UNKNOWN, 0, 0, -1, 0, new int[MAX_PLANES]);
+		final PixelFormat format;
+		final int width;
+		final int height;
+		final int frameSize;
+		final int burstSlotSize;
+		final int[] strides;
+		
+		StreamInfo(PixelFormat format, int width, int height, int frameSize, int burstSlotSize, int[] strides) {
+			this.format = format;
+			this.width = width;
+			this.height = height;
+			this.frameSize = frameSize;
+			this.burstSlotSize = burstSlotSize;
+			this.strides = strides;
+		}
+	}
+	
 	public static final class FrameSize {
 		public int width;
 		public int height;
 	}
 	
+	public static final class StreamMode {
+		public int format;
+		public int width;
+		public int height;
+		public int intervalNumerator;
+		public int intervalDenominator;
+		public int transferCost;
+		public int conversionCost;
+		
+		public PixelFormat getPixelFormat() {
+			return PixelFormat.from(format);
+		}
+		
+		public float getFrameRate() {
+			if (0 == intervalNumerator) {
+				return 0.0f;
+			}
+			return (float)intervalDenominator / intervalNumerator;
+		}
+		
+		public int getCost() {
+			return transferCost + conversionCost;
+		}
+	}
+	
+	/**
+	 * Time spent by each step of {@link UVCCamera#reconfigure}.
+	 */
+	public static final class ReconfigureStats {
+		public int stopMicros;
+		public int formatMicros;
+		public int bufferMicros;
+		public int startMicros;
+		public int totalMicros;
+		public boolean buffersReused;
+	}
+	
+	/**
+	 * Suspends made by the idle policy and the resumes that followed them.
+	 */
+	public static final class IdleStats {
+		public int suspendCount;
+		public int resumeCount;
+		/** From the restart of the stream to its first frame. */
+		public int lastResumeMicros;
+		public int maxResumeMicros;
+		public boolean suspended;
+		public boolean buffersReleased;
+	}
+	
+	/**
+	 * Reconnects of the camera, downtime runs from the failed capture to
+	 * the restored stream.
+	 */
+	public static final class ReconnectStats {
+		public int reconnectCount;
+		public int failedCount;
+		public int lastDowntimeMicros;
+		public int maxDowntimeMicros;
+		public long totalDowntimeMicros;
+	}
+	
 	private native int n_getPixelFormat(long handle);
 	private native int n_getFrameSize(long handle);
 	private native int n_getWidth(long handle);
 	private native int n_getHeight(long handle);
+	private native int n_getStride(long handle, int plane);
 	private native long n_open(String device) throws IOException;
 	private native void n_init(long handle, int width, int height, int pixelFormat) throws IOException;
 	private native void n_close(long handle);
-	private native void n_capture(long handle, byte[] pixels);
+	private native int n_capture(long handle, byte[] pixels);
+	private native int n_captureStrided(long handle, byte[] pixels, int[] strides);
+	private native int n_captureDirect(long handle, ByteBuffer pixels);
+	private native int n_captureDirectStats(long handle, ByteBuffer pixels, FrameStats stats);
+	private native int n_capturePlanes(long handle, ByteBuffer[] planes, int[] strides);
+	private native int n_captureBurst(long handle, ByteBuffer dst, int count, FrameInfo[] out);
+	private native int n_getBurstSlotSize(long handle);
 	private native void n_start(long handle);
 	private native void n_stop(long handle);
 	private native FrameSize n_enumFrameSize(long handle, int index, int pixelFormat);
+	private native StreamMode n_initBest(long handle, int width, int height, int fps, int pixelFormat) throws IOException;
+	private native ReconfigureStats n_reconfigure(long handle, int width, int height, int pixelFormat);
+	private native void n_suspend(long handle, boolean releaseBuffers);
+	private native IdleStats n_getIdleStats(long handle);
+	private native void n_reconnect(long handle, int timeout) throws IOException;
+	private native void n_setAutoReconnect(long handle, int timeout);
+	private native ReconnectStats n_getReconnectStats(long handle);
+	private native void n_enableTrace(long handle, int capacity);
+	private native void n_traceConvertDone(long handle);
+	private native void n_dumpTrace(long handle, String path) throws IOException;
+	private static native void n_setCacheDirectory(String path);
+	private native void n_invalidateCapabilityCache(long handle);
+	private native long n_createPump(long handle);
+	private native void n_destroyPump(long pump);
+	private native long n_subscribe(long pump, int policy, int interval, int depth);
+	private native void n_unsubscribe(long subscriber);
+	private native int n_publish(long handle, long ring);
+	private native void n_setPumpThreadPolicy(long pump, int[] policy, int[] applied);
+	private native boolean n_setBufferLocking(long handle, boolean enable);
 }
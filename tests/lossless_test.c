@@ -0,0 +1,160 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "lossless.h"
+
+#define PAD 13
+
+static int failures = 0;
+
+#define EXPECT(cond) \
+	do { \
+		if (!(cond)) { \
+			fprintf(stderr, "%s:%d: %s\n", __FILE__, __LINE__, #cond); \
+			++failures; \
+		} \
+	} while (0)
+
+static char const * const names[LOSSLESS_FORMAT_COUNT] = {
+	"YUYV", "UYVY", "I420", "YUV422P", "NV12", "NV21", "GREY",
+};
+
+// bytes of a row of 'plane', 0 if the format has no such plane.
+static int row_bytes(lossless_format_t format, int width, int plane) {
+	switch (format) {
+	case LOSSLESS_FORMAT_YUYV:
+	case LOSSLESS_FORMAT_UYVY:
+		return (0 == plane) ? width * 2 : 0;
+	case LOSSLESS_FORMAT_I420:
+	case LOSSLESS_FORMAT_YUV422P:
+		return (0 == plane) ? width : (width + 1) / 2;
+	case LOSSLESS_FORMAT_NV12:
+	case LOSSLESS_FORMAT_NV21:
+		return (2 == plane) ? 0 : (0 == plane) ? width : (width + 1) / 2 * 2;
+	case LOSSLESS_FORMAT_GREY:
+		return (0 == plane) ? width : 0;
+	default:
+		return 0;
+	}
+}
+
+static uint32_t next_random(uint32_t *state) {
+	*state = *state * 1664525u + 1013904223u;
+	return *state >> 24;
+}
+
+/*
+ * A gradient, with noise on the right half if 'noise' so the plane is
+ * stored rather than coded. Padding is a sentinel the codec must not touch.
+ */
+static void fill_plane(uint8_t *plane, int stride, int row, int rows, int noise, uint32_t *state) {
+	int x, y;
+
+	for (y = 0; y < rows; ++y) {
+		for (x = 0; x < stride; ++x) {
+			if (x >= row) {
+				plane[y * stride + x] = 0xa5;
+			} else if (!noise || (x < row / 2)) {
+				plane[y * stride + x] = (uint8_t)(x + y * 3);
+			} else {
+				plane[y * stride + x] = (uint8_t)next_random(state);
+			}
+		}
+	}
+}
+
+/*
+ * Encode 'width' x 'height' from planes padded to odd strides, decode into
+ * planes padded differently and compare every row and the padding.
+ */
+static void test_round_trip(lossless_format_t format, int width, int height, int noise) {
+	uint8_t *src[3] = { NULL, NULL, NULL }, *dst[3] = { NULL, NULL, NULL };
+	int src_strides[3] = { 0, 0, 0 }, dst_strides[3] = { 0, 0, 0 };
+	size_t sizes[3] = { 0, 0, 0 };
+	size_t const bound = lossless_bound(format, width, height);
+	uint8_t *coded = malloc(bound);
+	uint32_t state = 1;
+	size_t written = 0;
+	lossless_format_t info_format;
+	int info_width, info_height;
+	int rows[3] = { 0, 0, 0 };
+	int p, x, y, row, result;
+
+	for (p = 0; p < 3; ++p) {
+		row = row_bytes(format, width, p);
+		if (0 == row) {
+			continue;
+		}
+		src_strides[p] = row + PAD;
+		dst_strides[p] = row + PAD * 2;
+		sizes[p] = lossless_plane_size(format, width, height, p, src_strides[p]);
+		rows[p] = (int)((sizes[p] + src_strides[p] - 1) / src_strides[p]);
+		src[p] = malloc((size_t)src_strides[p] * rows[p]);
+		dst[p] = malloc((size_t)dst_strides[p] * rows[p]);
+		fill_plane(src[p], src_strides[p], row, rows[p], noise, &state);
+		memset(dst[p], 0xa5, (size_t)dst_strides[p] * rows[p]);
+	}
+
+	result = lossless_encode(format, width, height, (uint8_t const * const *)src, src_strides, coded, bound, &written);
+	if (LOSSLESS_NOERROR != result) {
+		fprintf(stderr, "%s %dx%d: encode failed with %d\n", names[format], width, height, result);
+		++failures;
+		goto done;
+	}
+	EXPECT(LOSSLESS_NOERROR == lossless_get_info(coded, written, &info_format, &info_width, &info_height));
+	EXPECT((format == info_format) && (width == info_width) && (height == info_height));
+
+	result = lossless_decode(coded, written, dst, dst_strides);
+	if (LOSSLESS_NOERROR != result) {
+		fprintf(stderr, "%s %dx%d: decode failed with %d\n", names[format], width, height, result);
+		++failures;
+		goto done;
+	}
+	for (p = 0; p < 3; ++p) {
+		row = row_bytes(format, width, p);
+		for (y = 0; y < rows[p]; ++y) {
+			uint8_t const *s = src[p] + (size_t)y * src_strides[p];
+			uint8_t const *d = dst[p] + (size_t)y * dst_strides[p];
+			for (x = 0; x < dst_strides[p]; ++x) {
+				if (d[x] != ((x < row) ? s[x] : 0xa5)) {
+					break;
+				}
+			}
+			if (x < dst_strides[p]) {
+				fprintf(stderr, "%s %dx%d: plane %d differs at %d,%d\n", names[format], width, height, p, x, y);
+				++failures;
+				break;
+			}
+		}
+	}
+
+	// a truncated frame fails instead of reading past the end.
+	EXPECT(LOSSLESS_NOERROR != lossless_decode(coded, written / 2, dst, dst_strides));
+
+done:
+	for (p = 0; p < 3; ++p) {
+		free(src[p]);
+		free(dst[p]);
+	}
+	free(coded);
+}
+
+int main(void) {
+	static int const sizes[][2] = { { 2, 2 }, { 64, 48 }, { 70, 38 }, { 322, 17 } };
+	int f, s;
+
+	for (f = 0; f < LOSSLESS_FORMAT_COUNT; ++f) {
+		for (s = 0; s < (int)(sizeof(sizes) / sizeof(sizes[0])); ++s) {
+			test_round_trip((lossless_format_t)f, sizes[s][0], sizes[s][1], 0);
+			test_round_trip((lossless_format_t)f, sizes[s][0], sizes[s][1], 1);
+		}
+	}
+
+	if (0 != failures) {
+		fprintf(stderr, "lossless_test: %d failure(s)\n", failures);
+		return 1;
+	}
+	printf("lossless_test: ok\n");
+	return 0;
+}
@@ -0,0 +1,267 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mjpegdec.h"
+#include "jpegenc.h"
+
+#define WIDTH  64
+#define HEIGHT 48
+
+static int failures = 0;
+
+#define EXPECT(cond) \
+	do { \
+		if (!(cond)) { \
+			fprintf(stderr, "%s:%d: %s\n", __FILE__, __LINE__, #cond); \
+			++failures; \
+		} \
+	} while (0)
+
+static size_t encode_frame(uint8_t *dst, size_t dst_size) {
+	static uint8_t yuyv[WIDTH * HEIGHT * 2];
+	uint8_t const *planes[3] = { yuyv, NULL, NULL };
+	int const strides[3] = { WIDTH * 2, 0, 0 };
+	jpegenc_t *enc = jpegenc_create();
+	size_t written = 0;
+	int x, y;
+
+	for (y = 0; y < HEIGHT; ++y) {
+		for (x = 0; x < WIDTH * 2; ++x) {
+			yuyv[y * WIDTH * 2 + x] = (x & 1) ? 128 : (uint8_t)(16 + (x + y) * 2);
+		}
+	}
+	EXPECT(JPEGENC_NOERROR == jpegenc_encode(enc, JPEGENC_FORMAT_YUYV, WIDTH, HEIGHT, planes, strides, 90, dst, dst_size, &written));
+	jpegenc_destroy(enc);
+	return written;
+}
+
+/*
+ * A smooth limited range I420 image and its luma as the full range samples
+ * the encoder turns it into.
+ */
+static void make_image(uint8_t *i420, double *luma) {
+	uint8_t *u = i420 + WIDTH * HEIGHT;
+	uint8_t *v = u + WIDTH * HEIGHT / 4;
+	int x, y;
+
+	for (y = 0; y < HEIGHT; ++y) {
+		for (x = 0; x < WIDTH; ++x) {
+			int const s = (int)(126.0 + 90.0 * sin(x / 5.0) * cos(y / 7.0) + 0.5);
+			i420[y * WIDTH + x] = (uint8_t)s;
+			luma[y * WIDTH + x] = (s - 16) * 255.0 / 219.0;
+		}
+	}
+	for (y = 0; y < HEIGHT / 2; ++y) {
+		for (x = 0; x < WIDTH / 2; ++x) {
+			u[y * WIDTH / 2 + x] = (uint8_t)(128 + x - y);
+			v[y * WIDTH / 2 + x] = (uint8_t)(128 - x + y);
+		}
+	}
+}
+
+/*
+ * PSNR of the decoded luma at 1/'scale' against the source averaged over
+ * 'scale' x 'scale' boxes, which is what a DCT domain downscale approximates.
+ */
+static double luma_psnr(double const *luma, uint8_t const *out, int stride, int scale) {
+	int const w = WIDTH / scale, h = HEIGHT / scale;
+	double sse = 0.0;
+	int x, y, i, j;
+
+	for (y = 0; y < h; ++y) {
+		for (x = 0; x < w; ++x) {
+			double box = 0.0, d;
+			for (j = 0; j < scale; ++j) {
+				for (i = 0; i < scale; ++i) {
+					box += luma[(y * scale + j) * WIDTH + x * scale + i];
+				}
+			}
+			d = box / (scale * scale) - out[y * stride + x];
+			sse += d * d;
+		}
+	}
+	return (0.0 == sse) ? 99.0 : 10.0 * log10(255.0 * 255.0 * w * h / sse);
+}
+
+static int decode_i420(mjpeg_decoder_t *dec, uint8_t const *jpeg, size_t size) {
+	static uint8_t out[WIDTH * HEIGHT * 2];
+	uint8_t * const planes[3] = { out, out + WIDTH * HEIGHT, out + WIDTH * HEIGHT * 5 / 4 };
+	int const strides[3] = { WIDTH, WIDTH / 2, WIDTH / 2 };
+
+	return mjpeg_decode(dec, jpeg, size, WIDTH, HEIGHT, 1, MJPEG_OUTPUT_I420, planes, strides);
+}
+
+// an encoded frame still decodes, so the corrupt case below fails for its own reason.
+static void test_valid_frame(mjpeg_decoder_t *dec, uint8_t const *jpeg, size_t size) {
+	EXPECT(MJPEG_NOERROR == decode_i420(dec, jpeg, size));
+}
+
+// a quality 100 frame comes back close to the source at every scale, into padded planes.
+static void test_decoded_samples(mjpeg_decoder_t *dec) {
+	static double const min_psnr[4] = { 50.0, 45.0, 45.0, 45.0 };
+	static uint8_t i420[WIDTH * HEIGHT * 3 / 2];
+	static double luma[WIDTH * HEIGHT];
+	static uint8_t jpeg[64 * 1024];
+	static uint8_t out[(WIDTH + 16) * HEIGHT * 2];
+	uint8_t const *src[3] = { i420, i420 + WIDTH * HEIGHT, i420 + WIDTH * HEIGHT * 5 / 4 };
+	int const src_strides[3] = { WIDTH, WIDTH / 2, WIDTH / 2 };
+	jpegenc_t *enc = jpegenc_create();
+	size_t size = 0;
+	int n;
+
+	make_image(i420, luma);
+	EXPECT(JPEGENC_NOERROR == jpegenc_encode(enc, JPEGENC_FORMAT_I420, WIDTH, HEIGHT, src, src_strides, 100, jpeg, sizeof(jpeg), &size));
+	jpegenc_destroy(enc);
+
+	for (n = 0; n < 4; ++n) {
+		int const scale = 1 << n;
+		int const w = WIDTH / scale, h = HEIGHT / scale;
+		int const strides[3] = { w + 16, w / 2 + 8, w / 2 + 8 };
+		uint8_t * const planes[3] = { out, out + strides[0] * h, out + strides[0] * h + strides[1] * h / 2 };
+		double psnr;
+
+		EXPECT(MJPEG_NOERROR == mjpeg_decode(dec, jpeg, size, WIDTH, HEIGHT, scale, MJPEG_OUTPUT_I420, planes, strides));
+		psnr = luma_psnr(luma, out, strides[0], scale);
+		if (psnr < min_psnr[n]) {
+			fprintf(stderr, "scale %d: %.1f dB\n", scale, psnr);
+			++failures;
+		}
+	}
+}
+
+/*
+ * A DHT whose code counts exceed what 'len' bits can hold, which used to
+ * run the codes past the fast lookup table before being noticed.
+ */
+static void test_corrupt_dht(mjpeg_decoder_t *dec, uint8_t const *jpeg, size_t size) {
+	uint8_t *corrupt = malloc(size + 256);
+	uint8_t *dht;
+	size_t const head = 2;
+	int const n = 200;
+	int i;
+
+	// SOI, then a DC table with 200 codes of length 1, then the valid frame.
+	memcpy(corrupt, jpeg, head);
+	dht = corrupt + head;
+	dht[0] = 0xff;
+	dht[1] = 0xc4;
+	dht[2] = (uint8_t)((2 + 17 + n) >> 8);
+	dht[3] = (uint8_t)(2 + 17 + n);
+	dht[4] = 0x00;
+	memset(dht + 5, 0, 16);
+	dht[5] = n;
+	for (i = 0; i < n; ++i) {
+		dht[21 + i] = (uint8_t)i;
+	}
+	memcpy(dht + 21 + n, jpeg + head, size - head);
+
+	EXPECT(MJPEG_CORRUPTED == decode_i420(dec, corrupt, size + 21 + n));
+	free(corrupt);
+}
+
+// offset of the first 'marker' segment up to the scan, 0 if there is none.
+static size_t find_segment(uint8_t const *jpeg, size_t size, int marker) {
+	size_t p = 2;
+
+	while ((p + 4 <= size) && (0xff == jpeg[p])) {
+		if (marker == jpeg[p + 1]) {
+			return p;
+		}
+		if (0xda == jpeg[p + 1]) {
+			break;
+		}
+		p += 2 + ((jpeg[p + 2] << 8) | jpeg[p + 3]);
+	}
+	return 0;
+}
+
+/*
+ * A second SOF claiming a larger frame after the first one, the planes are
+ * sized from one of them and the decode must not follow the other.
+ */
+static void test_double_sof(mjpeg_decoder_t *dec, uint8_t const *jpeg, size_t size) {
+	size_t const sof = find_segment(jpeg, size, 0xc0);
+	size_t const len = 2 + ((jpeg[sof + 2] << 8) | jpeg[sof + 3]);
+	uint8_t *corrupt = malloc(size + len);
+	int width = 0, height = 0;
+
+	EXPECT(0 != sof);
+	memcpy(corrupt, jpeg, sof + len);
+	memcpy(corrupt + sof + len, jpeg + sof, len);
+	memcpy(corrupt + sof + len * 2, jpeg + sof + len, size - sof - len);
+	// 16x16 first, WIDTH x HEIGHT second.
+	corrupt[sof + 5] = 0;
+	corrupt[sof + 6] = 16;
+	corrupt[sof + 7] = 0;
+	corrupt[sof + 8] = 16;
+
+	EXPECT(MJPEG_CORRUPTED == mjpeg_get_size(corrupt, size + len, &width, &height));
+	EXPECT(MJPEG_CORRUPTED == decode_i420(dec, corrupt, size + len));
+	free(corrupt);
+}
+
+/*
+ * 16 bit quantization tables at their maximum, the dequantized coefficients
+ * overflowed the IDCT before they were clamped to the 12 bit range.
+ */
+static void test_huge_quantizers(mjpeg_decoder_t *dec, uint8_t const *jpeg, size_t size) {
+	size_t const sos = find_segment(jpeg, size, 0xda);
+	uint8_t *corrupt = malloc(size + 2 * (2 + 2 + 1 + 128));
+	uint8_t *p;
+	int t;
+
+	// replace both tables right before the scan.
+	EXPECT(0 != sos);
+	memcpy(corrupt, jpeg, sos);
+	p = corrupt + sos;
+	for (t = 0; t < 2; ++t) {
+		*p++ = 0xff;
+		*p++ = 0xdb;
+		*p++ = 0;
+		*p++ = 2 + 1 + 128;
+		*p++ = (uint8_t)(0x10 | t);
+		memset(p, 0xff, 128);
+		p += 128;
+	}
+	memcpy(p, jpeg + sos, size - sos);
+	p += size - sos;
+
+	EXPECT(MJPEG_NOERROR == decode_i420(dec, corrupt, (size_t)(p - corrupt)));
+	free(corrupt);
+}
+
+// planes laid out for another frame size are refused rather than overrun.
+static void test_size_mismatch(mjpeg_decoder_t *dec, uint8_t const *jpeg, size_t size) {
+	static uint8_t out[16 * 16 * 2];
+	uint8_t * const planes[3] = { out, out + 16 * 16, out + 16 * 16 * 5 / 4 };
+	int const strides[3] = { 16, 8, 8 };
+	int width = 0, height = 0;
+
+	EXPECT(MJPEG_NOERROR == mjpeg_get_size(jpeg, size, &width, &height));
+	EXPECT((WIDTH == width) && (HEIGHT == height));
+	EXPECT(MJPEG_CORRUPTED == mjpeg_decode(dec, jpeg, size, 16, 16, 1, MJPEG_OUTPUT_I420, planes, strides));
+}
+
+int main(void) {
+	static uint8_t jpeg[64 * 1024];
+	mjpeg_decoder_t *dec = mjpeg_decoder_create(1);
+	size_t const size = encode_frame(jpeg, sizeof(jpeg));
+
+	EXPECT(0 != size);
+	test_valid_frame(dec, jpeg, size);
+	test_decoded_samples(dec);
+	test_corrupt_dht(dec, jpeg, size);
+	test_double_sof(dec, jpeg, size);
+	test_size_mismatch(dec, jpeg, size);
+	test_huge_quantizers(dec, jpeg, size);
+	mjpeg_decoder_destroy(dec);
+
+	if (0 != failures) {
+		fprintf(stderr, "mjpegdec_test: %d failure(s)\n", failures);
+		return 1;
+	}
+	printf("mjpegdec_test: ok\n");
+	return 0;
+}